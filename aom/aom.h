@@ -60,6 +60,9 @@ enum aom_com_control_id {
       192, /**< get a pointer to the new frame, aom_image_t* parameter */
   AV1_COPY_NEW_FRAME_IMAGE = 193, /**< copy the new frame to an external buffer,
                                      aom_image_t* parameter */
+  AV1_GET_MEMORY_USAGE = 194,     /**< get the memory used by the codec,
+                                     aom_memory_usage_t* parameter. Requires a
+                                     build with CONFIG_MEM_TRACKING */
 
   AOM_DECODER_CTRL_ID_START = 256
 };
@@ -74,6 +77,32 @@ typedef struct av1_ref_frame {
   aom_image_t img;      /**< img structure to populate (output) */
 } av1_ref_frame_t;
 
+/*!\brief Subsystems the memory used by a codec is reported for
+ *
+ * The allocations of a subsystem made by its own frame buffers are reported
+ * for the subsystem rather than for AOM_MEM_TAG_FRAME_BUFFERS.
+ */
+typedef enum aom_mem_tag {
+  AOM_MEM_TAG_OTHER,         /**< Allocations of no other subsystem */
+  AOM_MEM_TAG_FRAME_BUFFERS, /**< Frame buffers */
+  AOM_MEM_TAG_LOOKAHEAD,     /**< Lookahead queue of the encoder */
+  AOM_MEM_TAG_TPL,           /**< Temporal dependency model of the encoder */
+  AOM_MEM_TAG_CONTEXT_TREE,  /**< Partition search trees of the encoder */
+  AOM_MEM_TAG_HASH,          /**< Block hash tables of the encoder */
+  AOM_MEM_TAG_ROW_MT,        /**< Row multithreading synchronization */
+  AOM_MEM_TAGS               /**< Number of subsystems */
+} aom_mem_tag_t;
+
+/*!\brief Memory used by a codec, in bytes, per aom_mem_tag_t
+ *
+ * Only the allocations made by the thread calling the codec are counted,
+ * not those made by its worker threads.
+ */
+typedef struct aom_memory_usage {
+  uint64_t current_bytes[AOM_MEM_TAGS]; /**< Bytes currently allocated */
+  uint64_t peak_bytes[AOM_MEM_TAGS];    /**< Maximum of current_bytes */
+} aom_memory_usage_t;
+
 /*!\cond */
 /*!\brief aom decoder control function parameter type
  *
@@ -99,6 +128,9 @@ AOM_CTRL_USE_TYPE(AV1_GET_NEW_FRAME_IMAGE, aom_image_t *)
 AOM_CTRL_USE_TYPE(AV1_COPY_NEW_FRAME_IMAGE, aom_image_t *)
 #define AOM_CTRL_AV1_COPY_NEW_FRAME_IMAGE
 
+AOM_CTRL_USE_TYPE(AV1_GET_MEMORY_USAGE, aom_memory_usage_t *)
+#define AOM_CTRL_AV1_GET_MEMORY_USAGE
+
 /*!\endcond */
 /*! @} - end defgroup aom */
 
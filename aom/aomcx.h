@@ -1307,6 +1307,50 @@ enum aome_enc_control_id {
   /*!\brief Control to get baseline gf interval
    */
   AV1E_GET_BASELINE_GF_INTERVAL = 158,
+
+  /*!\brief Codec control function to let the encoder use the buffers of the
+   * input images instead of copying them, aom_zero_copy_input_t* parameter
+   *
+   * Once set with a non-NULL release_cb, the encoder borrows the buffers of
+   * the images passed to aom_codec_encode() until it no longer needs them,
+   * which is at the latest when they leave the lookahead queue or when the
+   * encoder is destroyed. It then calls release_cb. Until then, the
+   * application must not modify or free the image buffers, and the encoder
+   * writes to their borders.
+   *
+   * Only images allocated with aom_img_alloc_with_border() with an align of
+   * 32, a size_align of 8 and the border of the encoder frames are borrowed:
+   * AOM_BORDER_IN_PIXELS if resize or superres is enabled, and
+   * AOM_ENC_NO_SCALE_BORDER otherwise. They must also use high bitdepth
+   * samples if and only if the encoder does, and not be monochrome. Other
+   * images are copied, and release_cb is called for them before
+   * aom_codec_encode() returns.
+   *
+   * release_cb is called exactly once for each image, except for images
+   * passed to a call of aom_codec_encode() which fails. After such a
+   * failure, the encoder must be destroyed before the images are reused.
+   *
+   * Passing NULL or a NULL release_cb turns this mode off for the next
+   * images.
+   */
+  AV1E_SET_ZERO_COPY_INPUT = 159,
+
+  /*!\brief Codec control function to limit the memory of the frame buffers of
+   * the encoder, unsigned int parameter
+   *
+   * The limit is in MiB, and covers the frame buffers of the encoder and the
+   * lookahead queue, including the buffers kept for reuse. Once it is
+   * reached, the encoding of the next frames fails with AOM_CODEC_MEM_ERROR
+   * instead of allocating more frame buffers.
+   *
+   * 0 (default) means no limit.
+   */
+  AV1E_SET_MAX_FRAME_BUFFER_MEMORY = 160,
+
+  /*!\brief Codec control function to get the memory usage of the frame
+   * buffers of the encoder, aom_frame_buffer_memory_t* parameter
+   */
+  AV1E_GET_FRAME_BUFFER_MEMORY = 161,
 };
 
 /*!\brief aom 1-D scaling mode
@@ -1426,6 +1470,33 @@ typedef struct aom_svc_params {
   int framerate_factor[AOM_MAX_TS_LAYERS];
 } aom_svc_params_t;
 
+/*!\brief Callback releasing an input image borrowed by the encoder
+ *
+ * \param[in] cb_priv    cb_priv field of aom_zero_copy_input_t
+ * \param[in] user_priv  user_priv field of the released aom_image_t
+ */
+typedef void (*aom_release_input_image_cb_fn_t)(void *cb_priv,
+                                                void *user_priv);
+
+/*!brief Parameters for AV1E_SET_ZERO_COPY_INPUT */
+typedef struct aom_zero_copy_input {
+  aom_release_input_image_cb_fn_t release_cb; /**< Release callback */
+  void *cb_priv; /**< Private data passed to release_cb */
+} aom_zero_copy_input_t;
+
+/*!brief Memory usage of the frame buffers of an encoder
+ *
+ * Freed frame buffers are kept for reuse by the next frame buffers of a
+ * similar size, so current_bytes includes unused_bytes.
+ */
+typedef struct aom_frame_buffer_memory {
+  uint64_t current_bytes; /**< Bytes currently allocated */
+  uint64_t peak_bytes;    /**< Maximum of current_bytes so far */
+  uint64_t unused_bytes;  /**< Bytes kept for reuse */
+  uint64_t num_allocs;    /**< Number of allocations made */
+  uint64_t num_reuses;    /**< Number of allocations reused */
+} aom_frame_buffer_memory_t;
+
 /*!brief Parameters for setting ref frame config */
 typedef struct aom_svc_ref_frame_config {
   // 7 references: LAST_FRAME (0), LAST2_FRAME(1), LAST3_FRAME(2),
@@ -1829,6 +1900,15 @@ AOM_CTRL_USE_TYPE(AV1E_ENABLE_SB_MULTIPASS_UNIT_TEST, unsigned int)
 AOM_CTRL_USE_TYPE(AV1E_SET_VBR_CORPUS_COMPLEXITY_LAP, unsigned int)
 #define AOM_CTRL_AV1E_SET_VBR_CORPUS_COMPLEXITY_LAP
 
+AOM_CTRL_USE_TYPE(AV1E_SET_ZERO_COPY_INPUT, aom_zero_copy_input_t *)
+#define AOM_CTRL_AV1E_SET_ZERO_COPY_INPUT
+
+AOM_CTRL_USE_TYPE(AV1E_SET_MAX_FRAME_BUFFER_MEMORY, unsigned int)
+#define AOM_CTRL_AV1E_SET_MAX_FRAME_BUFFER_MEMORY
+
+AOM_CTRL_USE_TYPE(AV1E_GET_FRAME_BUFFER_MEMORY, aom_frame_buffer_memory_t *)
+#define AOM_CTRL_AV1E_GET_FRAME_BUFFER_MEMORY
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
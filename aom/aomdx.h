@@ -381,6 +381,19 @@ enum aom_dec_control_id {
    */
   AV1D_SET_SKIP_FILM_GRAIN,
 
+  /*!\brief Codec control function to overlap the post-filtering of a frame
+   * with its tile decoding, unsigned int parameter
+   *
+   * When enabled together with row based multi-threading, the loop filter,
+   * cdef and loop restoration of a superblock row start as soon as the rows
+   * they read are reconstructed, instead of after the whole frame is decoded.
+   * The output is identical either way.
+   *
+   * - 0 = disabled (default)
+   * - 1 = enabled
+   */
+  AV1D_SET_POSTFILTER_OVERLAP,
+
   AOM_DECODER_CTRL_ID_MAX,
 
   /*!\brief Codec control function to check the presence of forward key frames
@@ -531,6 +544,9 @@ AOM_CTRL_USE_TYPE(AV1D_SET_ROW_MT, unsigned int)
 AOM_CTRL_USE_TYPE(AV1D_SET_SKIP_FILM_GRAIN, int)
 #define AOM_CTRL_AV1D_SET_SKIP_FILM_GRAIN
 
+AOM_CTRL_USE_TYPE(AV1D_SET_POSTFILTER_OVERLAP, unsigned int)
+#define AOM_CTRL_AV1D_SET_POSTFILTER_OVERLAP
+
 AOM_CTRL_USE_TYPE(AV1D_SET_IS_ANNEXB, unsigned int)
 #define AOM_CTRL_AV1D_SET_IS_ANNEXB
 
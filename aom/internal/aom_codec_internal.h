@@ -47,6 +47,7 @@
 #define AOM_AOM_INTERNAL_AOM_CODEC_INTERNAL_H_
 #include "../aom_decoder.h"
 #include "../aom_encoder.h"
+#include "aom_mem/aom_mem.h"
 #include <stdarg.h>
 
 #ifdef __cplusplus
@@ -311,6 +312,8 @@ struct aom_codec_priv {
     unsigned int cx_data_pad_after;
     aom_codec_cx_pkt_t cx_data_pkt;
   } enc;
+  // Memory used by the instance, if CONFIG_MEM_TRACKING is enabled.
+  aom_mem_tracker_t mem_tracker;
 };
 
 #define CAST(id, arg) va_arg((arg), aom_codec_control_type_##id)
@@ -103,10 +103,13 @@ aom_codec_err_t aom_codec_control(aom_codec_ctx_t *ctx, int ctrl_id, ...) {
   for (aom_codec_ctrl_fn_map_t *entry = ctx->iface->ctrl_maps;
        !at_ctrl_map_end(entry); ++entry) {
     if (entry->ctrl_id == ctrl_id) {
+      aom_mem_tracker_t *const prev_tracker =
+          aom_mem_set_tracker(&ctx->priv->mem_tracker);
       va_list ap;
       va_start(ap, ctrl_id);
       ctx->err = entry->fn((aom_codec_alg_priv_t *)ctx->priv, ap);
       va_end(ap);
+      aom_mem_set_tracker(prev_tracker);
       return ctx->err;
     }
   }
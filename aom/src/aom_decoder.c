@@ -100,7 +100,10 @@ aom_codec_err_t aom_codec_decode(aom_codec_ctx_t *ctx, const uint8_t *data,
   else if (!ctx->iface || !ctx->priv)
     res = AOM_CODEC_ERROR;
   else {
+    aom_mem_tracker_t *const prev_tracker =
+        aom_mem_set_tracker(&ctx->priv->mem_tracker);
     res = ctx->iface->dec.decode(get_alg_priv(ctx), data, data_sz, user_priv);
+    aom_mem_set_tracker(prev_tracker);
   }
 
   return SAVE_STATUS(ctx, res);
@@ -111,8 +114,12 @@ aom_image_t *aom_codec_get_frame(aom_codec_ctx_t *ctx, aom_codec_iter_t *iter) {
 
   if (!ctx || !iter || !ctx->iface || !ctx->priv)
     img = NULL;
-  else
+  else {
+    aom_mem_tracker_t *const prev_tracker =
+        aom_mem_set_tracker(&ctx->priv->mem_tracker);
     img = ctx->iface->dec.get_frame(get_alg_priv(ctx), iter);
+    aom_mem_set_tracker(prev_tracker);
+  }
 
   return img;
 }
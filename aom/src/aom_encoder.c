@@ -151,9 +151,12 @@ aom_codec_err_t aom_codec_encode(aom_codec_ctx_t *ctx, const aom_image_t *img,
     /* Execute in a normalized floating point environment, if the platform
      * requires it.
      */
+    aom_mem_tracker_t *const prev_tracker =
+        aom_mem_set_tracker(&ctx->priv->mem_tracker);
     FLOATING_POINT_INIT
     res = ctx->iface->enc.encode(get_alg_priv(ctx), img, pts, duration, flags);
     FLOATING_POINT_RESTORE
+    aom_mem_set_tracker(prev_tracker);
   }
 
   return SAVE_STATUS(ctx, res);
@@ -170,8 +173,12 @@ const aom_codec_cx_pkt_t *aom_codec_get_cx_data(aom_codec_ctx_t *ctx,
       ctx->err = AOM_CODEC_ERROR;
     else if (!(ctx->iface->caps & AOM_CODEC_CAP_ENCODER))
       ctx->err = AOM_CODEC_INCAPABLE;
-    else
+    else {
+      aom_mem_tracker_t *const prev_tracker =
+          aom_mem_set_tracker(&ctx->priv->mem_tracker);
       pkt = ctx->iface->enc.get_cx_data(get_alg_priv(ctx), iter);
+      aom_mem_set_tracker(prev_tracker);
+    }
   }
 
   if (pkt && pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
@@ -267,8 +274,12 @@ aom_codec_err_t aom_codec_enc_config_set(aom_codec_ctx_t *ctx,
     res = AOM_CODEC_INVALID_PARAM;
   else if (!(ctx->iface->caps & AOM_CODEC_CAP_ENCODER))
     res = AOM_CODEC_INCAPABLE;
-  else
+  else {
+    aom_mem_tracker_t *const prev_tracker =
+        aom_mem_set_tracker(&ctx->priv->mem_tracker);
     res = ctx->iface->enc.cfg_set(get_alg_priv(ctx), cfg);
+    aom_mem_set_tracker(prev_tracker);
+  }
 
   return SAVE_STATUS(ctx, res);
 }
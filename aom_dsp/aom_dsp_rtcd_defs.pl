@@ -493,6 +493,20 @@ if (aom_config("CONFIG_AV1_HIGHBITDEPTH") eq "yes") {
   specialize qw/aom_highbd_lpf_horizontal_4_dual sse2 avx2/;
 }
 
+#
+# Film grain synthesis
+#
+if (aom_config("CONFIG_AV1_DECODER") eq "yes") {
+  add_proto qw/void aom_film_grain_add_noise_row/, "uint8_t *dst, const int *scale, const int *grain, int width, int scaling_shift, int min_val, int max_val";
+  specialize qw/aom_film_grain_add_noise_row sse4_1 avx2 neon/;
+
+  add_proto qw/void aom_highbd_film_grain_add_noise_row/, "uint16_t *dst, const int *scale, const int *grain, int width, int scaling_shift, int min_val, int max_val";
+  specialize qw/aom_highbd_film_grain_add_noise_row sse4_1 avx2 neon/;
+
+  add_proto qw/void aom_film_grain_blend_row/, "const int *a, const int *b, int *dst, int width, int weight_a, int weight_b, int min_val, int max_val";
+  specialize qw/aom_film_grain_blend_row sse4_1 avx2 neon/;
+}
+
 #
 # Encoder functions.
 #
@@ -24,15 +24,21 @@
 
 #define SIMD_CHECK 1  // Sanity checks in C equivalents
 
+// AOM_SIMD_NATIVE is set when the intrinsics map onto vector instructions
+// rather than onto their C model, for code that only uses them when that is
+// a win over plain C.
 #if HAVE_NEON
 #include "simd/v256_intrinsics_arm.h"
+#define AOM_SIMD_NATIVE 1
 // VS compiling for 32 bit targets does not support vector types in
 // structs as arguments, which makes the v256 type of the intrinsics
 // hard to support, so optimizations for this target are disabled.
 #elif HAVE_SSE2 && (defined(_WIN64) || !defined(_MSC_VER) || defined(__clang__))
 #include "simd/v256_intrinsics_x86.h"
+#define AOM_SIMD_NATIVE 1
 #else
 #include "simd/v256_intrinsics.h"
+#define AOM_SIMD_NATIVE 0
 #endif
 
 #endif  // AOM_AOM_DSP_AOM_SIMD_H_
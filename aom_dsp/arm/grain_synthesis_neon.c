@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <arm_neon.h>
+
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "config/aom_dsp_rtcd.h"
+
+// Returns clamp(pel + ((scale * grain + round) >> shift), min, max) for 4
+// samples. shift holds the negated scaling shift.
+static INLINE int32x4_t add_noise_4(const int32x4_t pel, const int *scale,
+                                    const int *grain, const int32x4_t round,
+                                    const int32x4_t shift,
+                                    const int32x4_t min_val,
+                                    const int32x4_t max_val) {
+  const int32x4_t s = vld1q_s32(scale);
+  const int32x4_t g = vld1q_s32(grain);
+  const int32x4_t noise = vshlq_s32(vmlaq_s32(round, s, g), shift);
+  return vminq_s32(vmaxq_s32(vaddq_s32(pel, noise), min_val), max_val);
+}
+
+void aom_film_grain_add_noise_row_neon(uint8_t *dst, const int *scale,
+                                       const int *grain, int width,
+                                       int scaling_shift, int min_val,
+                                       int max_val) {
+  const int32x4_t round = vdupq_n_s32(1 << (scaling_shift - 1));
+  const int32x4_t shift = vdupq_n_s32(-scaling_shift);
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  int j = 0;
+
+  for (; j + 8 <= width; j += 8) {
+    const uint16x8_t p = vmovl_u8(vld1_u8(dst + j));
+    const int32x4_t lo =
+        add_noise_4(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(p))),
+                    scale + j, grain + j, round, shift, vmin, vmax);
+    const int32x4_t hi =
+        add_noise_4(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(p))),
+                    scale + j + 4, grain + j + 4, round, shift, vmin, vmax);
+    const int16x8_t res = vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+    vst1_u8(dst + j, vqmovun_s16(res));
+  }
+  for (; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + (1 << (scaling_shift - 1))) >>
+                  scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_highbd_film_grain_add_noise_row_neon(uint16_t *dst, const int *scale,
+                                              const int *grain, int width,
+                                              int scaling_shift, int min_val,
+                                              int max_val) {
+  const int32x4_t round = vdupq_n_s32(1 << (scaling_shift - 1));
+  const int32x4_t shift = vdupq_n_s32(-scaling_shift);
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  int j = 0;
+
+  for (; j + 8 <= width; j += 8) {
+    const uint16x8_t p = vld1q_u16(dst + j);
+    const int32x4_t lo =
+        add_noise_4(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(p))),
+                    scale + j, grain + j, round, shift, vmin, vmax);
+    const int32x4_t hi =
+        add_noise_4(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(p))),
+                    scale + j + 4, grain + j + 4, round, shift, vmin, vmax);
+    vst1q_u16(dst + j, vcombine_u16(vqmovun_s32(lo), vqmovun_s32(hi)));
+  }
+  for (; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + (1 << (scaling_shift - 1))) >>
+                  scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_film_grain_blend_row_neon(const int *a, const int *b, int *dst,
+                                   int width, int weight_a, int weight_b,
+                                   int min_val, int max_val) {
+  const int32x4_t vmin = vdupq_n_s32(min_val);
+  const int32x4_t vmax = vdupq_n_s32(max_val);
+  int j = 0;
+
+  for (; j + 4 <= width; j += 4) {
+    int32x4_t sum = vmulq_n_s32(vld1q_s32(a + j), weight_a);
+    sum = vmlaq_n_s32(sum, vld1q_s32(b + j), weight_b);
+    const int32x4_t res = vshrq_n_s32(vaddq_s32(sum, vdupq_n_s32(16)), 5);
+    vst1q_s32(dst + j, vminq_s32(vmaxq_s32(res, vmin), vmax));
+  }
+  for (; j < width; j++) {
+    dst[j] =
+        clamp((weight_a * a[j] + weight_b * b[j] + 16) >> 5, min_val, max_val);
+  }
+}
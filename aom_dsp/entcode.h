@@ -14,6 +14,7 @@
 
 #include <limits.h>
 #include <stddef.h>
+#include "config/aom_config.h"
 #include "av1/common/odintrin.h"
 #include "aom_dsp/prob.h"
 
@@ -21,8 +22,15 @@
 #define EC_MIN_PROB 4  // must be <= (1<<EC_PROB_SHIFT)/16
 
 /*OPT: od_ec_window must be at least 32 bits, but if you have fast arithmetic
-   on a larger type, you can speed up the decoder by using it here.*/
+   on a larger type, you can speed up the decoder by using it here.
+  With CONFIG_EC_64BIT_WINDOW the decoder refills and the encoder flushes
+   several bytes at a time, and the encoder writes its output bytes directly
+   instead of going through a pre-carry buffer.*/
+#if CONFIG_EC_64BIT_WINDOW
+typedef uint64_t od_ec_window;
+#else
 typedef uint32_t od_ec_window;
+#endif
 
 /*The size in bits of od_ec_window.*/
 #define OD_EC_WINDOW_SIZE ((int)sizeof(od_ec_window) * CHAR_BIT)
@@ -143,7 +143,10 @@ static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_window dif, unsigned rng,
 void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
                     uint32_t storage) {
   dec->buf = buf;
-  dec->tell_offs = 10 - (OD_EC_WINDOW_SIZE - 8);
+  /*The refill below raises cnt from -15 by as many bits as it reads, so this
+     makes od_ec_dec_tell() start at 1, like od_ec_enc_tell(), whatever the
+     window size.*/
+  dec->tell_offs = 1 - 15;
   dec->end = buf + storage;
   dec->bptr = buf;
   dec->dif = ((od_ec_window)1 << (OD_EC_WINDOW_SIZE - 1)) - 1;
@@ -181,6 +184,97 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
   return od_ec_dec_normalize(dec, dif, r_new, ret);
 }
 
+#if AOM_SIMD_NATIVE
+/*Returns, in each 16-bit lane, the lower end of the range of the symbol idx
+   in that lane, computed as in od_ec_decode_cdf_q15().
+  The 17-bit product of the range and the probability is put together from
+   its low and high 16 bits, which cannot be done with a single multiply.*/
+static INLINE v64 od_ec_symbol_bounds_v64(v64 icdf, v64 idx, unsigned r,
+                                          int N) {
+  const int shift = 7 - EC_PROB_SHIFT - CDF_SHIFT;
+  const v64 rr = v64_dup_16(r >> 8);
+  const v64 p = v64_shr_u16(icdf, EC_PROB_SHIFT);
+  const v64 v = v64_or(v64_shr_u16(v64_mullo_s16(rr, p), shift),
+                       v64_shl_16(v64_mulhi_s16(rr, p), 16 - shift));
+  return v64_add_16(v, v64_mullo_s16(v64_dup_16(EC_MIN_PROB),
+                                     v64_sub_16(v64_dup_16(N), idx)));
+}
+
+static INLINE v128 od_ec_symbol_bounds_v128(v128 icdf, v128 idx, unsigned r,
+                                            int N) {
+  const int shift = 7 - EC_PROB_SHIFT - CDF_SHIFT;
+  const v128 rr = v128_dup_16(r >> 8);
+  const v128 p = v128_shr_u16(icdf, EC_PROB_SHIFT);
+  const v128 v = v128_or(v128_shr_u16(v128_mullo_s16(rr, p), shift),
+                         v128_shl_16(v128_mulhi_s16(rr, p), 16 - shift));
+  return v128_add_16(v, v128_mullo_s16(v128_dup_16(EC_MIN_PROB),
+                                       v128_sub_16(v128_dup_16(N), idx)));
+}
+
+/*Returns a mask of the lanes, with first <= idx < last, whose symbol's lower
+   bound is above c, i.e., of the symbols before the one c falls in.*/
+static INLINE v64 od_ec_symbols_above_v64(v64 bounds, v64 idx, unsigned c,
+                                          int first, int last) {
+  /*The bounds and c are unsigned, so compare them with their top bit
+     flipped.*/
+  const v64 flip = v64_dup_16(0x8000);
+  const v64 above =
+      v64_cmplt_s16(v64_xor(v64_dup_16(c), flip), v64_xor(bounds, flip));
+  const v64 in_range = v64_andn(v64_cmplt_s16(idx, v64_dup_16(last)),
+                                v64_cmplt_s16(idx, v64_dup_16(first)));
+  return v64_and(above, in_range);
+}
+
+static INLINE v128 od_ec_symbols_above_v128(v128 bounds, v128 idx, unsigned c,
+                                            int first, int last) {
+  const v128 flip = v128_dup_16(0x8000);
+  const v128 above =
+      v128_cmplt_s16(v128_xor(v128_dup_16(c), flip), v128_xor(bounds, flip));
+  const v128 in_range = v128_andn(v128_cmplt_s16(idx, v128_dup_16(last)),
+                                  v128_cmplt_s16(idx, v128_dup_16(first)));
+  return v128_and(above, in_range);
+}
+
+/*Returns the number of set lanes in the masks that were added up into m.*/
+static INLINE int od_ec_count_lanes_v64(v64 m) {
+  const uint64_t ones = 0x0001000100010001ULL;
+  return (int)((v64_u64(v64_sub_16(v64_zero(), m)) * ones) >> 48);
+}
+
+/*Finds the symbol that c falls in, which is the number of symbols whose lower
+   bound is above c, since the bounds decrease with the symbol index.
+  The CDF is read in two overlapping vectors that do not go past its end, and
+   each symbol is only counted in the first vector that holds it.*/
+static INLINE int od_ec_find_symbol(const uint16_t *icdf, unsigned c,
+                                    unsigned r, int nsyms) {
+  const int N = nsyms - 1;
+  if (nsyms <= 8) {
+    const int off = AOMMAX(nsyms - 4, 0);
+    const v64 idx = v64_from_16(3, 2, 1, 0);
+    const v64 idx_hi = v64_add_16(idx, v64_dup_16(off));
+    const v64 lo = od_ec_symbol_bounds_v64(v64_load_unaligned(icdf), idx, r, N);
+    const v64 hi =
+        od_ec_symbol_bounds_v64(v64_load_unaligned(icdf + off), idx_hi, r, N);
+    return od_ec_count_lanes_v64(
+        v64_add_16(od_ec_symbols_above_v64(lo, idx, c, 0, N),
+                   od_ec_symbols_above_v64(hi, idx_hi, c, 4, N)));
+  } else {
+    const int off = nsyms - 8;
+    const v128 idx =
+        v128_from_v64(v64_from_16(7, 6, 5, 4), v64_from_16(3, 2, 1, 0));
+    const v128 idx_hi = v128_add_16(idx, v128_dup_16(off));
+    const v128 lo =
+        od_ec_symbol_bounds_v128(v128_load_unaligned(icdf), idx, r, N);
+    const v128 hi =
+        od_ec_symbol_bounds_v128(v128_load_unaligned(icdf + off), idx_hi, r, N);
+    const v128 m = v128_add_16(od_ec_symbols_above_v128(lo, idx, c, 0, N),
+                               od_ec_symbols_above_v128(hi, idx_hi, c, 8, N));
+    return od_ec_count_lanes_v64(
+        v64_add_16(v128_low_v64(m), v128_high_v64(m)));
+  }
+}
+#endif  // AOM_SIMD_NATIVE
+
 /*Decodes a symbol given an inverse cumulative distribution function (CDF)
    table in Q15.
   icdf: CDF_PROB_TOP minus the CDF, such that symbol s falls in the range
@@ -207,6 +301,24 @@ int od_ec_decode_cdf_q15(od_ec_dec *dec, const uint16_t *icdf, int nsyms) {
   assert(32768U <= r);
   assert(7 - EC_PROB_SHIFT - CDF_SHIFT >= 0);
   c = (unsigned)(dif >> (OD_EC_WINDOW_SIZE - 16));
+#if AOM_SIMD_NATIVE
+  if (nsyms > 2) {
+    ret = od_ec_find_symbol(icdf, c, r, nsyms);
+    u = r;
+    if (ret > 0) {
+      u = ((r >> 8) * (uint32_t)(icdf[ret - 1] >> EC_PROB_SHIFT) >>
+           (7 - EC_PROB_SHIFT - CDF_SHIFT));
+      u += EC_MIN_PROB * (N - (ret - 1));
+    }
+    v = ((r >> 8) * (uint32_t)(icdf[ret] >> EC_PROB_SHIFT) >>
+         (7 - EC_PROB_SHIFT - CDF_SHIFT));
+    v += EC_MIN_PROB * (N - ret);
+    assert(v <= c && c < u);
+    r = u - v;
+    dif -= (od_ec_window)v << (OD_EC_WINDOW_SIZE - 16);
+    return od_ec_dec_normalize(dec, dif, r, ret);
+  }
+#endif  // AOM_SIMD_NATIVE
   v = r;
   ret = -1;
   do {
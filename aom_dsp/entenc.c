@@ -48,6 +48,71 @@
    URL="http://researchcommons.waikato.ac.nz/bitstream/handle/10289/78/content.pdf"
   }*/
 
+#if CONFIG_EC_64BIT_WINDOW
+/*Adds a carry to the bytes already output, which are buf[0...offs-1].
+  A carry out of the first byte is dropped, as it is when the pre-carry buffer
+   is resolved.*/
+static void od_ec_enc_propagate_carry(unsigned char *buf, uint32_t offs) {
+  while (offs > 0 && ++buf[--offs] == 0) {
+  }
+}
+
+/*Takes updated low and range values, renormalizes them so that
+   32768 <= rng < 65536 (flushing bytes from low to the output buffer if
+   necessary), and stores them back in the encoder context.
+  low: The new value of low.
+  rng: The new value of the range.*/
+static void od_ec_enc_normalize(od_ec_enc *enc, od_ec_window low,
+                                unsigned rng) {
+  int d;
+  int c;
+  int s;
+  c = enc->cnt;
+  assert(rng <= 65535U);
+  /*The number of leading zeros in the 16-bit binary representation of rng.*/
+  d = 16 - OD_ILOG_NZ(rng);
+  s = c + d;
+  /*low holds cnt + 25 bits, counting the carry, so we flush right before
+     shifting it by d would push bits off the end of the window.*/
+  if (s >= OD_EC_WINDOW_SIZE - 24) {
+    unsigned char *buf;
+    uint32_t storage;
+    uint32_t offs;
+    od_ec_window out;
+    int n;
+    int i;
+    buf = enc->buf;
+    storage = enc->storage;
+    offs = enc->offs;
+    if (offs + 8 > storage) {
+      storage = 2 * storage + 8;
+      buf = (unsigned char *)realloc(buf, sizeof(*buf) * storage);
+      if (buf == NULL) {
+        enc->error = -1;
+        enc->offs = 0;
+        return;
+      }
+      enc->buf = buf;
+      enc->storage = storage;
+    }
+    /*The number of whole bytes above the 16 + 8 bits kept in the window.*/
+    n = (s >> 3) + 1;
+    c += 24 - (n << 3);
+    out = low >> c;
+    low &= ((od_ec_window)1 << c) - 1;
+    if (out >> (n << 3)) od_ec_enc_propagate_carry(buf, offs);
+    for (i = n - 1; i >= 0; i--) {
+      buf[offs + i] = (unsigned char)out;
+      out >>= 8;
+    }
+    enc->offs = offs + n;
+    s = c + d - 24;
+  }
+  enc->low = low << d;
+  enc->rng = rng << d;
+  enc->cnt = s;
+}
+#else
 /*Takes updated low and range values, renormalizes them so that
    32768 <= rng < 65536 (flushing bytes from low to the pre-carry buffer if
    necessary), and stores them back in the encoder context.
@@ -63,11 +128,8 @@ static void od_ec_enc_normalize(od_ec_enc *enc, od_ec_window low,
   /*The number of leading zeros in the 16-bit binary representation of rng.*/
   d = 16 - OD_ILOG_NZ(rng);
   s = c + d;
-  /*TODO: Right now we flush every time we have at least one byte available.
-    Instead we should use an od_ec_window and flush right before we're about to
-     shift bits off the end of the window.
-    For a 32-bit window this is about the same amount of work, but for a 64-bit
-     window it should be a fair win.*/
+  /*With a 32-bit window we flush every time we have at least one byte
+     available, see the CONFIG_EC_64BIT_WINDOW version above.*/
   if (s >= 0) {
     uint16_t *buf;
     uint32_t storage;
@@ -106,6 +168,7 @@ static void od_ec_enc_normalize(od_ec_enc *enc, od_ec_window low,
   enc->rng = rng << d;
   enc->cnt = s;
 }
+#endif  // CONFIG_EC_64BIT_WINDOW
 
 /*Initializes the encoder.
   size: The initial size of the buffer, in bytes.*/
@@ -117,12 +180,14 @@ void od_ec_enc_init(od_ec_enc *enc, uint32_t size) {
     enc->storage = 0;
     enc->error = -1;
   }
+#if !CONFIG_EC_64BIT_WINDOW
   enc->precarry_buf = (uint16_t *)malloc(sizeof(*enc->precarry_buf) * size);
   enc->precarry_storage = size;
   if (size > 0 && enc->precarry_buf == NULL) {
     enc->precarry_storage = 0;
     enc->error = -1;
   }
+#endif
 }
 
 /*Reinitializes the encoder.*/
@@ -142,7 +207,9 @@ void od_ec_enc_reset(od_ec_enc *enc) {
 
 /*Frees the buffers used by the encoder.*/
 void od_ec_enc_clear(od_ec_enc *enc) {
+#if !CONFIG_EC_64BIT_WINDOW
   free(enc->precarry_buf);
+#endif
   free(enc->buf);
 }
 
@@ -251,8 +318,13 @@ void od_ec_enc_patch_initial_bits(od_ec_enc *enc, unsigned val, int nbits) {
   mask = ((1U << nbits) - 1) << shift;
   if (enc->offs > 0) {
     /*The first byte has been finalized.*/
+#if CONFIG_EC_64BIT_WINDOW
+    /*Carries propagated into it so far are already included.*/
+    enc->buf[0] = (unsigned char)((enc->buf[0] & ~mask) | val << shift);
+#else
     enc->precarry_buf[0] =
         (uint16_t)((enc->precarry_buf[0] & ~mask) | val << shift);
+#endif
   } else if (9 + enc->cnt + (enc->rng == 0x8000) > nbits) {
     /*The first byte has yet to be output.*/
     enc->low = (enc->low & ~((od_ec_window)mask << (16 + enc->cnt))) |
@@ -276,7 +348,9 @@ void od_ec_enc_patch_initial_bits(od_ec_enc *enc, unsigned val, int nbits) {
 unsigned char *od_ec_enc_done(od_ec_enc *enc, uint32_t *nbytes) {
   unsigned char *out;
   uint32_t storage;
+#if !CONFIG_EC_64BIT_WINDOW
   uint16_t *buf;
+#endif
   uint32_t offs;
   od_ec_window m;
   od_ec_window e;
@@ -304,6 +378,39 @@ unsigned char *od_ec_enc_done(od_ec_enc *enc, uint32_t *nbytes) {
   e = ((l + m) & ~m) | (m + 1);
   s += c;
   offs = enc->offs;
+#if CONFIG_EC_64BIT_WINDOW
+  out = enc->buf;
+  if (s > 0) {
+    od_ec_window n;
+    storage = enc->storage;
+    if (offs + ((s + 7) >> 3) > storage) {
+      storage = offs + ((s + 7) >> 3);
+      out = (unsigned char *)realloc(out, sizeof(*out) * storage);
+      if (out == NULL) {
+        enc->error = -1;
+        return NULL;
+      }
+      enc->buf = out;
+      enc->storage = storage;
+    }
+    n = ((od_ec_window)1 << (c + 16)) - 1;
+    do {
+      const od_ec_window val = e >> (c + 16);
+      assert(offs < storage);
+      if (val >> 8) od_ec_enc_propagate_carry(out, offs);
+      out[offs++] = (unsigned char)val;
+      e &= n;
+      s -= 8;
+      c -= 8;
+      n >>= 8;
+    } while (s > 0);
+  }
+  *nbytes = offs;
+  /*Note: The bytes are written in place, so unlike with the pre-carry buffer,
+     the encoder cannot keep encoding into the current buffer once this has
+     been called.*/
+  return out;
+#else
   buf = enc->precarry_buf;
   if (s > 0) {
     unsigned n;
@@ -360,6 +467,7 @@ unsigned char *od_ec_enc_done(od_ec_enc *enc, uint32_t *nbytes) {
     However, this function is O(N) where N is the amount of data coded so far,
      so calling it more than once for a given packet is a bad idea.*/
   return out;
+#endif  // CONFIG_EC_64BIT_WINDOW
 }
 
 /*Returns the number of bits "used" by the encoded symbols so far.
@@ -403,21 +511,29 @@ void od_ec_enc_checkpoint(od_ec_enc *dst, const od_ec_enc *src) {
    state's history: you can not switch backwards and forwards or otherwise
    switch to a state which isn't a casual ancestor of the current state.
   Restore is also incompatible with patching the initial bits, as the
-   changes will remain in the restored version.*/
+   changes will remain in the restored version.
+  With CONFIG_EC_64BIT_WINDOW, neither are carries propagated into the bytes
+   output before the checkpoint undone.*/
 void od_ec_enc_rollback(od_ec_enc *dst, const od_ec_enc *src) {
   unsigned char *buf;
   uint32_t storage;
+#if !CONFIG_EC_64BIT_WINDOW
   uint16_t *precarry_buf;
   uint32_t precarry_storage;
+#endif
   assert(dst->storage >= src->storage);
-  assert(dst->precarry_storage >= src->precarry_storage);
   buf = dst->buf;
   storage = dst->storage;
+#if !CONFIG_EC_64BIT_WINDOW
+  assert(dst->precarry_storage >= src->precarry_storage);
   precarry_buf = dst->precarry_buf;
   precarry_storage = dst->precarry_storage;
+#endif
   OD_COPY(dst, src, 1);
   dst->buf = buf;
   dst->storage = storage;
+#if !CONFIG_EC_64BIT_WINDOW
   dst->precarry_buf = precarry_buf;
   dst->precarry_storage = precarry_storage;
+#endif
 }
@@ -26,14 +26,19 @@ typedef struct od_ec_enc od_ec_enc;
 struct od_ec_enc {
   /*Buffered output.
     This contains only the raw bits until the final call to od_ec_enc_done(),
-     where all the arithmetic-coded data gets prepended to it.*/
+     where all the arithmetic-coded data gets prepended to it.
+    With CONFIG_EC_64BIT_WINDOW, bytes are instead written here as soon as
+     they leave the window, and carries are propagated into the bytes already
+     written.*/
   unsigned char *buf;
   /*The size of the buffer.*/
   uint32_t storage;
+#if !CONFIG_EC_64BIT_WINDOW
   /*A buffer for output bytes with their associated carry flags.*/
   uint16_t *precarry_buf;
   /*The size of the pre-carry buffer.*/
   uint32_t precarry_storage;
+#endif
   /*The offset at which the next entropy-coded byte will be written.*/
   uint32_t offs;
   /*The low end of the current range.*/
@@ -18,6 +18,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#include "config/aom_dsp_rtcd.h"
+
 #include "aom_dsp/grain_synthesis.h"
 #include "aom_mem/aom_mem.h"
 
@@ -216,6 +218,9 @@ static const int gaussian_sequence[2048] = {
 
 static const int gauss_bits = 11;
 
+// Maximum width of the blocks add_noise_to_block() works on.
+#define MAX_GRAIN_BLOCK_WIDTH 32
+
 static int luma_subblock_size_y = 32;
 static int luma_subblock_size_x = 32;
 
@@ -235,16 +240,53 @@ static int scaling_lut_cr[256];
 static int grain_min;
 static int grain_max;
 
-static uint16_t random_register = 0;  // random number generator register
+// Frame level film grain state, shared by all the 32 luma row strips.
+typedef struct {
+  const aom_film_grain_t *params;
+  uint8_t *luma;
+  uint8_t *cb;
+  uint8_t *cr;
+  int height;
+  int width;
+  int luma_stride;
+  int chroma_stride;
+  int use_high_bit_depth;
+  int chroma_subsamp_y;
+  int chroma_subsamp_x;
+  int mc_identity;
+  int left_pad;
+  int top_pad;
+  int ar_padding;
+  int *luma_grain_block;
+  int *cb_grain_block;
+  int *cr_grain_block;
+  int luma_grain_stride;
+  int chroma_grain_stride;
+} GrainFrameInfo;
 
-static void init_arrays(const aom_film_grain_t *params, int luma_stride,
-                        int chroma_stride, int ***pred_pos_luma_p,
-                        int ***pred_pos_chroma_p, int **luma_grain_block,
-                        int **cb_grain_block, int **cr_grain_block,
-                        int **y_line_buf, int **cb_line_buf, int **cr_line_buf,
-                        int **y_col_buf, int **cb_col_buf, int **cr_col_buf,
-                        int luma_grain_samples, int chroma_grain_samples,
-                        int chroma_subsamp_y, int chroma_subsamp_x) {
+// Grain samples carried from a block to its right and bottom neighbors for
+// the overlap. Each thread working on the frame has its own set.
+typedef struct {
+  int *y_line_buf;
+  int *cb_line_buf;
+  int *cr_line_buf;
+  int *y_col_buf;
+  int *cb_col_buf;
+  int *cr_col_buf;
+} GrainOverlapBufs;
+
+// Range of 32 luma row strips of a frame processed by one worker.
+typedef struct {
+  GrainOverlapBufs bufs;
+  int y_start;
+  int y_end;
+} GrainWorkerData;
+
+static void init_arrays(const aom_film_grain_t *params,
+                        int ***pred_pos_luma_p, int ***pred_pos_chroma_p,
+                        int **luma_grain_block, int **cb_grain_block,
+                        int **cr_grain_block, int luma_grain_samples,
+                        int chroma_grain_samples) {
   memset(scaling_lut_y, 0, sizeof(*scaling_lut_y) * 256);
   memset(scaling_lut_cb, 0, sizeof(*scaling_lut_cb) * 256);
   memset(scaling_lut_cr, 0, sizeof(*scaling_lut_cr) * 256);
@@ -306,23 +348,6 @@ static void init_arrays(const aom_film_grain_t *params, int luma_stride,
   *pred_pos_luma_p = pred_pos_luma;
   *pred_pos_chroma_p = pred_pos_chroma;
 
-  *y_line_buf = (int *)aom_malloc(sizeof(**y_line_buf) * luma_stride * 2);
-  *cb_line_buf = (int *)aom_malloc(sizeof(**cb_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-  *cr_line_buf = (int *)aom_malloc(sizeof(**cr_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-
-  *y_col_buf =
-      (int *)aom_malloc(sizeof(**y_col_buf) * (luma_subblock_size_y + 2) * 2);
-  *cb_col_buf =
-      (int *)aom_malloc(sizeof(**cb_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
-                        (2 >> chroma_subsamp_x));
-  *cr_col_buf =
-      (int *)aom_malloc(sizeof(**cr_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
-                        (2 >> chroma_subsamp_x));
-
   *luma_grain_block =
       (int *)aom_malloc(sizeof(**luma_grain_block) * luma_grain_samples);
   *cb_grain_block =
@@ -333,10 +358,7 @@ static void init_arrays(const aom_film_grain_t *params, int luma_stride,
 
 static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
                            int ***pred_pos_chroma, int **luma_grain_block,
-                           int **cb_grain_block, int **cr_grain_block,
-                           int **y_line_buf, int **cb_line_buf,
-                           int **cr_line_buf, int **y_col_buf, int **cb_col_buf,
-                           int **cr_col_buf) {
+                           int **cb_grain_block, int **cr_grain_block) {
   int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   int num_pos_chroma = num_pos_luma;
   if (params->num_y_points > 0) ++num_pos_chroma;
@@ -351,18 +373,6 @@ static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
   }
   aom_free((*pred_pos_chroma));
 
-  aom_free(*y_line_buf);
-
-  aom_free(*cb_line_buf);
-
-  aom_free(*cr_line_buf);
-
-  aom_free(*y_col_buf);
-
-  aom_free(*cb_col_buf);
-
-  aom_free(*cr_col_buf);
-
   aom_free(*luma_grain_block);
 
   aom_free(*cb_grain_block);
@@ -370,36 +380,78 @@ static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
   aom_free(*cr_grain_block);
 }
 
+static void dealloc_overlap_bufs(GrainOverlapBufs *bufs) {
+  aom_free(bufs->y_line_buf);
+  aom_free(bufs->cb_line_buf);
+  aom_free(bufs->cr_line_buf);
+  aom_free(bufs->y_col_buf);
+  aom_free(bufs->cb_col_buf);
+  aom_free(bufs->cr_col_buf);
+  memset(bufs, 0, sizeof(*bufs));
+}
+
+// Return 0 for success, -1 for failure
+static int alloc_overlap_bufs(GrainOverlapBufs *bufs, int luma_stride,
+                              int chroma_stride, int chroma_subsamp_y,
+                              int chroma_subsamp_x) {
+  bufs->y_line_buf =
+      (int *)aom_malloc(sizeof(*bufs->y_line_buf) * luma_stride * 2);
+  bufs->cb_line_buf = (int *)aom_malloc(
+      sizeof(*bufs->cb_line_buf) * chroma_stride * (2 >> chroma_subsamp_y));
+  bufs->cr_line_buf = (int *)aom_malloc(
+      sizeof(*bufs->cr_line_buf) * chroma_stride * (2 >> chroma_subsamp_y));
+
+  bufs->y_col_buf = (int *)aom_malloc(sizeof(*bufs->y_col_buf) *
+                                      (luma_subblock_size_y + 2) * 2);
+  bufs->cb_col_buf =
+      (int *)aom_malloc(sizeof(*bufs->cb_col_buf) *
+                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
+                        (2 >> chroma_subsamp_x));
+  bufs->cr_col_buf =
+      (int *)aom_malloc(sizeof(*bufs->cr_col_buf) *
+                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
+                        (2 >> chroma_subsamp_x));
+
+  if (!bufs->y_line_buf || !bufs->cb_line_buf || !bufs->cr_line_buf ||
+      !bufs->y_col_buf || !bufs->cb_col_buf || !bufs->cr_col_buf) {
+    dealloc_overlap_bufs(bufs);
+    return -1;
+  }
+  return 0;
+}
+
 // get a number between 0 and 2^bits - 1
-static INLINE int get_random_number(int bits) {
+static INLINE int get_random_number(uint16_t *random_register, int bits) {
   uint16_t bit;
-  bit = ((random_register >> 0) ^ (random_register >> 1) ^
-         (random_register >> 3) ^ (random_register >> 12)) &
+  bit = ((*random_register >> 0) ^ (*random_register >> 1) ^
+         (*random_register >> 3) ^ (*random_register >> 12)) &
         1;
-  random_register = (random_register >> 1) | (bit << 15);
-  return (random_register >> (16 - bits)) & ((1 << bits) - 1);
+  *random_register = (*random_register >> 1) | (bit << 15);
+  return (*random_register >> (16 - bits)) & ((1 << bits) - 1);
 }
 
-static void init_random_generator(int luma_line, uint16_t seed) {
+static void init_random_generator(uint16_t *random_register, int luma_line,
+                                  uint16_t seed) {
   // same for the picture
 
   uint16_t msb = (seed >> 8) & 255;
   uint16_t lsb = seed & 255;
 
-  random_register = (msb << 8) + lsb;
+  *random_register = (msb << 8) + lsb;
 
   //  changes for each row
   int luma_num = luma_line >> 5;
 
-  random_register ^= ((luma_num * 37 + 178) & 255) << 8;
-  random_register ^= ((luma_num * 173 + 105) & 255);
+  *random_register ^= ((luma_num * 37 + 178) & 255) << 8;
+  *random_register ^= ((luma_num * 173 + 105) & 255);
 }
 
 // Return 0 for success, -1 for failure
 static int generate_luma_grain_block(
-    const aom_film_grain_t *params, int **pred_pos_luma, int *luma_grain_block,
-    int luma_block_size_y, int luma_block_size_x, int luma_grain_stride,
-    int left_pad, int top_pad, int right_pad, int bottom_pad) {
+    const aom_film_grain_t *params, uint16_t *random_register,
+    int **pred_pos_luma, int *luma_grain_block, int luma_block_size_y,
+    int luma_block_size_x, int luma_grain_stride, int left_pad, int top_pad,
+    int right_pad, int bottom_pad) {
   if (params->num_y_points == 0) {
     memset(luma_grain_block, 0,
            sizeof(*luma_grain_block) * luma_block_size_y * luma_grain_stride);
@@ -415,7 +467,8 @@ static int generate_luma_grain_block(
   for (int i = 0; i < luma_block_size_y; i++)
     for (int j = 0; j < luma_block_size_x; j++)
       luma_grain_block[i * luma_grain_stride + j] =
-          (gaussian_sequence[get_random_number(gauss_bits)] +
+          (gaussian_sequence[get_random_number(random_register,
+                                               gauss_bits)] +
            ((1 << gauss_sec_shift) >> 1)) >>
           gauss_sec_shift;
 
@@ -451,14 +504,16 @@ static int generate_chroma_grain_blocks(
   if (params->num_y_points > 0) ++num_pos_chroma;
   int rounding_offset = (1 << (params->ar_coeff_shift - 1));
   int chroma_grain_block_size = chroma_block_size_y * chroma_grain_stride;
+  uint16_t random_register;
 
   if (params->num_cb_points || params->chroma_scaling_from_luma) {
-    init_random_generator(7 << 5, params->random_seed);
+    init_random_generator(&random_register, 7 << 5, params->random_seed);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cb_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(&random_register,
+                                                 gauss_bits)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   } else {
@@ -467,12 +522,13 @@ static int generate_chroma_grain_blocks(
   }
 
   if (params->num_cr_points || params->chroma_scaling_from_luma) {
-    init_random_generator(11 << 5, params->random_seed);
+    init_random_generator(&random_register, 11 << 5, params->random_seed);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cr_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(&random_register,
+                                                 gauss_bits)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   } else {
@@ -586,8 +642,6 @@ static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
   int cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
   int cr_offset = params->cr_offset - 256;
 
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
   int apply_y = params->num_y_points > 0 ? 1 : 0;
   int apply_cb =
       (params->num_cb_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
@@ -622,8 +676,17 @@ static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
     max_luma = max_chroma = 255;
   }
 
+  // The scaling function values of a row, applied to the grain by the
+  // aom_film_grain_add_noise_row() kernel.
+  int scale_cb[MAX_GRAIN_BLOCK_WIDTH];
+  int scale_cr[MAX_GRAIN_BLOCK_WIDTH];
+  int scale_y[MAX_GRAIN_BLOCK_WIDTH];
+  const int chroma_width = half_luma_width << (1 - chroma_subsamp_x);
+  assert(chroma_width <= MAX_GRAIN_BLOCK_WIDTH);
+  assert((half_luma_width << 1) <= MAX_GRAIN_BLOCK_WIDTH);
+
   for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
+    for (int j = 0; j < chroma_width; j++) {
       int average_luma = 0;
       if (chroma_subsamp_x) {
         average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
@@ -637,50 +700,47 @@ static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
       }
 
       if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
+        scale_cb[j] = scale_LUT(
+            scaling_lut_cb,
+            clamp(((average_luma * cb_luma_mult +
+                    cb_mult * cb[i * chroma_stride + j]) >>
+                   6) +
+                      cb_offset,
+                  0, (256 << (bit_depth - 8)) - 1),
+            8);
       }
 
       if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
+        scale_cr[j] = scale_LUT(
+            scaling_lut_cr,
+            clamp(((average_luma * cr_luma_mult +
+                    cr_mult * cr[i * chroma_stride + j]) >>
+                   6) +
+                      cr_offset,
+                  0, (256 << (bit_depth - 8)) - 1),
+            8);
       }
     }
+
+    if (apply_cb) {
+      aom_film_grain_add_noise_row(
+          cb + i * chroma_stride, scale_cb, cb_grain + i * chroma_grain_stride,
+          chroma_width, params->scaling_shift, min_chroma, max_chroma);
+    }
+    if (apply_cr) {
+      aom_film_grain_add_noise_row(
+          cr + i * chroma_stride, scale_cr, cr_grain + i * chroma_grain_stride,
+          chroma_width, params->scaling_shift, min_chroma, max_chroma);
+    }
   }
 
   if (apply_y) {
     for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j], 8) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
-      }
+      for (int j = 0; j < (half_luma_width << 1); j++)
+        scale_y[j] = scale_LUT(scaling_lut_y, luma[i * luma_stride + j], 8);
+      aom_film_grain_add_noise_row(
+          luma + i * luma_stride, scale_y, luma_grain + i * luma_grain_stride,
+          half_luma_width << 1, params->scaling_shift, min_luma, max_luma);
     }
   }
 }
@@ -701,8 +761,6 @@ static void add_noise_to_block_hbd(
   // offset value depends on the bit depth
   int cr_offset = (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
 
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
   int apply_y = params->num_y_points > 0 ? 1 : 0;
   int apply_cb =
       (params->num_cb_points > 0 || params->chroma_scaling_from_luma) > 0 ? 1
@@ -739,8 +797,17 @@ static void add_noise_to_block_hbd(
     max_luma = max_chroma = (256 << (bit_depth - 8)) - 1;
   }
 
+  // The scaling function values of a row, applied to the grain by the
+  // aom_highbd_film_grain_add_noise_row() kernel.
+  int scale_cb[MAX_GRAIN_BLOCK_WIDTH];
+  int scale_cr[MAX_GRAIN_BLOCK_WIDTH];
+  int scale_y[MAX_GRAIN_BLOCK_WIDTH];
+  const int chroma_width = half_luma_width << (1 - chroma_subsamp_x);
+  assert(chroma_width <= MAX_GRAIN_BLOCK_WIDTH);
+  assert((half_luma_width << 1) <= MAX_GRAIN_BLOCK_WIDTH);
+
   for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
+    for (int j = 0; j < chroma_width; j++) {
       int average_luma = 0;
       if (chroma_subsamp_x) {
         average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
@@ -754,54 +821,85 @@ static void add_noise_to_block_hbd(
       }
 
       if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
+        scale_cb[j] = scale_LUT(
+            scaling_lut_cb,
+            clamp(((average_luma * cb_luma_mult +
+                    cb_mult * cb[i * chroma_stride + j]) >>
+                   6) +
+                      cb_offset,
+                  0, (256 << (bit_depth - 8)) - 1),
+            bit_depth);
       }
       if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
+        scale_cr[j] = scale_LUT(
+            scaling_lut_cr,
+            clamp(((average_luma * cr_luma_mult +
+                    cr_mult * cr[i * chroma_stride + j]) >>
+                   6) +
+                      cr_offset,
+                  0, (256 << (bit_depth - 8)) - 1),
+            bit_depth);
       }
     }
+
+    if (apply_cb) {
+      aom_highbd_film_grain_add_noise_row(
+          cb + i * chroma_stride, scale_cb, cb_grain + i * chroma_grain_stride,
+          chroma_width, params->scaling_shift, min_chroma, max_chroma);
+    }
+    if (apply_cr) {
+      aom_highbd_film_grain_add_noise_row(
+          cr + i * chroma_stride, scale_cr, cr_grain + i * chroma_grain_stride,
+          chroma_width, params->scaling_shift, min_chroma, max_chroma);
+    }
   }
 
   if (apply_y) {
     for (int i = 0; i < (half_luma_height << 1); i++) {
       for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j],
-                                  bit_depth) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
+        scale_y[j] =
+            scale_LUT(scaling_lut_y, luma[i * luma_stride + j], bit_depth);
       }
+      aom_highbd_film_grain_add_noise_row(
+          luma + i * luma_stride, scale_y, luma_grain + i * luma_grain_stride,
+          half_luma_width << 1, params->scaling_shift, min_luma, max_luma);
     }
   }
 }
 
+void aom_film_grain_add_noise_row_c(uint8_t *dst, const int *scale,
+                                    const int *grain, int width,
+                                    int scaling_shift, int min_val,
+                                    int max_val) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+  for (int j = 0; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + rounding_offset) >> scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_highbd_film_grain_add_noise_row_c(uint16_t *dst, const int *scale,
+                                           const int *grain, int width,
+                                           int scaling_shift, int min_val,
+                                           int max_val) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+  for (int j = 0; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + rounding_offset) >> scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_film_grain_blend_row_c(const int *a, const int *b, int *dst,
+                                int width, int weight_a, int weight_b,
+                                int min_val, int max_val) {
+  for (int j = 0; j < width; j++) {
+    dst[j] =
+        clamp((weight_a * a[j] + weight_b * b[j] + 16) >> 5, min_val, max_val);
+  }
+}
+
 static void copy_rect(uint8_t *src, int src_stride, uint8_t *dst,
                       int dst_stride, int width, int height,
                       int use_high_bit_depth) {
@@ -888,34 +986,492 @@ static void hor_boundary_overlap(int *top_block, int top_stride,
                                  int *dst_block, int dst_stride, int width,
                                  int height) {
   if (height == 1) {
-    while (width) {
-      *dst_block = clamp((*top_block * 23 + *bottom_block * 22 + 16) >> 5,
-                         grain_min, grain_max);
-      ++top_block;
-      ++bottom_block;
-      ++dst_block;
-      --width;
-    }
+    aom_film_grain_blend_row(top_block, bottom_block, dst_block, width, 23, 22,
+                             grain_min, grain_max);
     return;
   } else if (height == 2) {
-    while (width) {
-      dst_block[0] = clamp((27 * top_block[0] + 17 * bottom_block[0] + 16) >> 5,
-                           grain_min, grain_max);
-      dst_block[dst_stride] = clamp((17 * top_block[top_stride] +
-                                     27 * bottom_block[bottom_stride] + 16) >>
-                                        5,
-                                    grain_min, grain_max);
-      ++top_block;
-      ++bottom_block;
-      ++dst_block;
-      --width;
-    }
+    aom_film_grain_blend_row(top_block, bottom_block, dst_block, width, 27, 17,
+                             grain_min, grain_max);
+    aom_film_grain_blend_row(top_block + top_stride,
+                             bottom_block + bottom_stride,
+                             dst_block + dst_stride, width, 17, 27, grain_min,
+                             grain_max);
     return;
   }
 }
 
+// Adds the grain to the block at position (y, x) of the frame, in units of 2
+// luma samples.
+static void add_noise_to_frame_block(const GrainFrameInfo *fi, int y, int x,
+                                     int *luma_grain, int *cb_grain,
+                                     int *cr_grain, int luma_grain_stride,
+                                     int chroma_grain_stride,
+                                     int half_luma_height,
+                                     int half_luma_width) {
+  const int chroma_subsamp_y = fi->chroma_subsamp_y;
+  const int chroma_subsamp_x = fi->chroma_subsamp_x;
+  const int luma_offset = (y << 1) * fi->luma_stride + (x << 1);
+  const int chroma_offset =
+      (y << (1 - chroma_subsamp_y)) * fi->chroma_stride +
+      (x << (1 - chroma_subsamp_x));
+
+  if (fi->use_high_bit_depth) {
+    add_noise_to_block_hbd(
+        fi->params, (uint16_t *)fi->luma + luma_offset,
+        (uint16_t *)fi->cb + chroma_offset, (uint16_t *)fi->cr + chroma_offset,
+        fi->luma_stride, fi->chroma_stride, luma_grain, cb_grain, cr_grain,
+        luma_grain_stride, chroma_grain_stride, half_luma_height,
+        half_luma_width, fi->params->bit_depth, chroma_subsamp_y,
+        chroma_subsamp_x, fi->mc_identity);
+  } else {
+    add_noise_to_block(
+        fi->params, fi->luma + luma_offset, fi->cb + chroma_offset,
+        fi->cr + chroma_offset, fi->luma_stride, fi->chroma_stride, luma_grain,
+        cb_grain, cr_grain, luma_grain_stride, chroma_grain_stride,
+        half_luma_height, half_luma_width, fi->params->bit_depth,
+        chroma_subsamp_y, chroma_subsamp_x, fi->mc_identity);
+  }
+}
+
+// Adds grain to the strip of 32 luma rows starting at luma row 2 * y, and to
+// the co-located chroma rows. With overlap, the line buffers must hold the
+// grain of the strip above, as left by a call for that strip. If apply_noise
+// is 0, only the line buffers are updated.
+static void add_film_grain_strip(const GrainFrameInfo *fi,
+                                 GrainOverlapBufs *bufs, int y,
+                                 int apply_noise) {
+  const aom_film_grain_t *params = fi->params;
+  const int height = fi->height;
+  const int width = fi->width;
+  const int luma_stride = fi->luma_stride;
+  const int chroma_stride = fi->chroma_stride;
+  const int chroma_subsamp_y = fi->chroma_subsamp_y;
+  const int chroma_subsamp_x = fi->chroma_subsamp_x;
+  const int left_pad = fi->left_pad;
+  const int top_pad = fi->top_pad;
+  const int ar_padding = fi->ar_padding;
+  int *luma_grain_block = fi->luma_grain_block;
+  int *cb_grain_block = fi->cb_grain_block;
+  int *cr_grain_block = fi->cr_grain_block;
+  const int luma_grain_stride = fi->luma_grain_stride;
+  const int chroma_grain_stride = fi->chroma_grain_stride;
+
+  int *y_line_buf = bufs->y_line_buf;
+  int *cb_line_buf = bufs->cb_line_buf;
+  int *cr_line_buf = bufs->cr_line_buf;
+  int *y_col_buf = bufs->y_col_buf;
+  int *cb_col_buf = bufs->cb_col_buf;
+  int *cr_col_buf = bufs->cr_col_buf;
+
+  const int overlap = params->overlap_flag;
+
+  uint16_t random_register;
+  init_random_generator(&random_register, y * 2, params->random_seed);
+
+  for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
+    int offset_y = get_random_number(&random_register, 8);
+    int offset_x = (offset_y >> 4) & 15;
+    offset_y &= 15;
+
+    int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
+    int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
+
+    int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                          offset_y * (2 >> chroma_subsamp_y);
+    int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                          offset_x * (2 >> chroma_subsamp_x);
+
+    if (overlap && x) {
+      ver_boundary_overlap(
+          y_col_buf, 2,
+          luma_grain_block + luma_offset_y * luma_grain_stride + luma_offset_x,
+          luma_grain_stride, y_col_buf, 2, 2,
+          AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
+
+      ver_boundary_overlap(
+          cb_col_buf, 2 >> chroma_subsamp_x,
+          cb_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x,
+          chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+          2 >> chroma_subsamp_x,
+          AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                 (height - (y << 1)) >> chroma_subsamp_y));
+
+      ver_boundary_overlap(
+          cr_col_buf, 2 >> chroma_subsamp_x,
+          cr_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x,
+          chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+          2 >> chroma_subsamp_x,
+          AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                 (height - (y << 1)) >> chroma_subsamp_y));
+
+      int i = y ? 1 : 0;
+
+      if (apply_noise) {
+        add_noise_to_frame_block(
+            fi, y + i, x, y_col_buf + i * 4,
+            cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+            cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+            2, (2 - chroma_subsamp_x),
+            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1);
+      }
+    }
+
+    if (overlap && y && apply_noise) {
+      if (x) {
+        hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
+                             y_line_buf + (x << 1), luma_stride, 2, 2);
+
+        hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+                             cb_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, 2 >> chroma_subsamp_x,
+                             2 >> chroma_subsamp_y);
+
+        hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+                             cr_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_stride, 2 >> chroma_subsamp_x,
+                             2 >> chroma_subsamp_y);
+      }
+
+      hor_boundary_overlap(
+          y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          luma_grain_block + luma_offset_y * luma_grain_stride + luma_offset_x +
+              (x ? 2 : 0),
+          luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
+                 width - ((x ? x + 1 : 0) << 1)),
+          2);
+
+      hor_boundary_overlap(
+          cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          cb_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y);
+
+      hor_boundary_overlap(
+          cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          cr_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y);
+
+      add_noise_to_frame_block(
+          fi, y, x, y_line_buf + (x << 1),
+          cb_line_buf + (x << (1 - chroma_subsamp_x)),
+          cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
+          chroma_stride, 1, AOMMIN(luma_subblock_size_x >> 1, width / 2 - x));
+    }
+
+    int i = overlap && y ? 1 : 0;
+    int j = overlap && x ? 1 : 0;
+
+    if (apply_noise) {
+      add_noise_to_frame_block(
+          fi, y + i, x + j,
+          luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
+              luma_offset_x + (j << 1),
+          cb_grain_block +
+              (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                  chroma_grain_stride +
+              chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+          cr_grain_block +
+              (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                  chroma_grain_stride +
+              chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+          luma_grain_stride, chroma_grain_stride,
+          AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
+          AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j);
+    }
+
+    if (overlap) {
+      if (x) {
+        // Copy overlapped column bufer to line buffer
+        copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
+                  y_line_buf + (x << 1), luma_stride, 2, 2);
+
+        copy_area(
+            cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+            2 >> chroma_subsamp_x, cb_line_buf + (x << (1 - chroma_subsamp_x)),
+            chroma_stride, 2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+
+        copy_area(
+            cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+            2 >> chroma_subsamp_x, cr_line_buf + (x << (1 - chroma_subsamp_x)),
+            chroma_stride, 2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+      }
+
+      // Copy grain to the line buffer for overlap with a bottom block
+      copy_area(
+          luma_grain_block +
+              (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
+              luma_offset_x + ((x ? 2 : 0)),
+          luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
+
+      copy_area(cb_grain_block +
+                    (chroma_offset_y + chroma_subblock_size_y) *
+                        chroma_grain_stride +
+                    chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
+                chroma_grain_stride,
+                cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+                chroma_stride,
+                AOMMIN(chroma_subblock_size_x,
+                       ((width - (x << 1)) >> chroma_subsamp_x)) -
+                    (x ? 2 >> chroma_subsamp_x : 0),
+                2 >> chroma_subsamp_y);
+
+      copy_area(cr_grain_block +
+                    (chroma_offset_y + chroma_subblock_size_y) *
+                        chroma_grain_stride +
+                    chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
+                chroma_grain_stride,
+                cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+                chroma_stride,
+                AOMMIN(chroma_subblock_size_x,
+                       ((width - (x << 1)) >> chroma_subsamp_x)) -
+                    (x ? 2 >> chroma_subsamp_x : 0),
+                2 >> chroma_subsamp_y);
+
+      // Copy grain to the column buffer for overlap with the next block to
+      // the right
+
+      copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
+                    luma_offset_x + luma_subblock_size_x,
+                luma_grain_stride, y_col_buf, 2, 2,
+                AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
+
+      copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
+                    chroma_offset_x + chroma_subblock_size_x,
+                chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+                2 >> chroma_subsamp_x,
+                AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                       (height - (y << 1)) >> chroma_subsamp_y));
+
+      copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
+                    chroma_offset_x + chroma_subblock_size_x,
+                chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+                2 >> chroma_subsamp_x,
+                AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                       (height - (y << 1)) >> chroma_subsamp_y));
+    }
+  }
+}
+
+// Adds grain to the strips starting at half luma rows y_start to y_end - 1.
+static void add_film_grain_rows(const GrainFrameInfo *fi,
+                                GrainOverlapBufs *bufs, int y_start,
+                                int y_end) {
+  const int strip_step = luma_subblock_size_y >> 1;
+
+  // The overlap with the strip above only needs its grain, rebuild it.
+  if (fi->params->overlap_flag && y_start > 0)
+    add_film_grain_strip(fi, bufs, y_start - strip_step, 0);
+
+  for (int y = y_start; y < y_end; y += strip_step)
+    add_film_grain_strip(fi, bufs, y, 1);
+}
+
+static int grain_worker_hook(void *arg1, void *arg2) {
+  const GrainFrameInfo *const fi = (const GrainFrameInfo *)arg1;
+  GrainWorkerData *const data = (GrainWorkerData *)arg2;
+  add_film_grain_rows(fi, &data->bufs, data->y_start, data->y_end);
+  return 1;
+}
+
+static int add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
+                              uint8_t *cb, uint8_t *cr, int height, int width,
+                              int luma_stride, int chroma_stride,
+                              int use_high_bit_depth, int chroma_subsamp_y,
+                              int chroma_subsamp_x, int mc_identity,
+                              AVxWorker *workers, int num_workers) {
+  int **pred_pos_luma;
+  int **pred_pos_chroma;
+  int *luma_grain_block;
+  int *cb_grain_block;
+  int *cr_grain_block;
+
+  uint16_t random_register = params->random_seed;
+
+  int left_pad = 3;
+  int right_pad = 3;  // padding to offset for AR coefficients
+  int top_pad = 3;
+  int bottom_pad = 0;
+
+  int ar_padding = 3;  // maximum lag used for stabilization of AR coefficients
+
+  luma_subblock_size_y = 32;
+  luma_subblock_size_x = 32;
+
+  chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
+  chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
+
+  // Initial padding is only needed for generation of
+  // film grain templates (to stabilize the AR process)
+  // Only a 64x64 luma and 32x32 chroma part of a template
+  // is used later for adding grain, padding can be discarded
+
+  int luma_block_size_y =
+      top_pad + 2 * ar_padding + luma_subblock_size_y * 2 + bottom_pad;
+  int luma_block_size_x = left_pad + 2 * ar_padding + luma_subblock_size_x * 2 +
+                          2 * ar_padding + right_pad;
+
+  int chroma_block_size_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                            chroma_subblock_size_y * 2 + bottom_pad;
+  int chroma_block_size_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                            chroma_subblock_size_x * 2 +
+                            (2 >> chroma_subsamp_x) * ar_padding + right_pad;
+
+  int luma_grain_stride = luma_block_size_x;
+  int chroma_grain_stride = chroma_block_size_x;
+
+  int bit_depth = params->bit_depth;
+
+  const int grain_center = 128 << (bit_depth - 8);
+  grain_min = 0 - grain_center;
+  grain_max = grain_center - 1;
+
+  init_arrays(params, &pred_pos_luma, &pred_pos_chroma, &luma_grain_block,
+              &cb_grain_block, &cr_grain_block,
+              luma_block_size_y * luma_block_size_x,
+              chroma_block_size_y * chroma_block_size_x);
+
+  if (generate_luma_grain_block(params, &random_register, pred_pos_luma,
+                                luma_grain_block, luma_block_size_y,
+                                luma_block_size_x, luma_grain_stride, left_pad,
+                                top_pad, right_pad, bottom_pad))
+    return -1;
+
+  if (generate_chroma_grain_blocks(
+          params,
+          //                               pred_pos_luma,
+          pred_pos_chroma, luma_grain_block, cb_grain_block, cr_grain_block,
+          luma_grain_stride, chroma_block_size_y, chroma_block_size_x,
+          chroma_grain_stride, left_pad, top_pad, right_pad, bottom_pad,
+          chroma_subsamp_y, chroma_subsamp_x))
+    return -1;
+
+  init_scaling_function(params->scaling_points_y, params->num_y_points,
+                        scaling_lut_y);
+
+  if (params->chroma_scaling_from_luma) {
+    memcpy(scaling_lut_cb, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
+    memcpy(scaling_lut_cr, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
+  } else {
+    init_scaling_function(params->scaling_points_cb, params->num_cb_points,
+                          scaling_lut_cb);
+    init_scaling_function(params->scaling_points_cr, params->num_cr_points,
+                          scaling_lut_cr);
+  }
+
+  GrainFrameInfo fi;
+  fi.params = params;
+  fi.luma = luma;
+  fi.cb = cb;
+  fi.cr = cr;
+  fi.height = height;
+  fi.width = width;
+  fi.luma_stride = luma_stride;
+  fi.chroma_stride = chroma_stride;
+  fi.use_high_bit_depth = use_high_bit_depth;
+  fi.chroma_subsamp_y = chroma_subsamp_y;
+  fi.chroma_subsamp_x = chroma_subsamp_x;
+  fi.mc_identity = mc_identity;
+  fi.left_pad = left_pad;
+  fi.top_pad = top_pad;
+  fi.ar_padding = ar_padding;
+  fi.luma_grain_block = luma_grain_block;
+  fi.cb_grain_block = cb_grain_block;
+  fi.cr_grain_block = cr_grain_block;
+  fi.luma_grain_stride = luma_grain_stride;
+  fi.chroma_grain_stride = chroma_grain_stride;
+
+  // Split the 32 luma row strips into one contiguous range per worker.
+  const int strip_step = luma_subblock_size_y >> 1;
+  const int num_strips = (height / 2 + strip_step - 1) / strip_step;
+  if (workers == NULL) num_workers = 1;
+  num_workers = AOMMAX(1, AOMMIN(num_workers, num_strips));
+
+  int ret = 0;
+  GrainWorkerData *const worker_data =
+      (GrainWorkerData *)aom_calloc(num_workers, sizeof(*worker_data));
+  if (!worker_data) ret = -1;
+  for (int i = 0; i < num_workers && !ret; ++i) {
+    GrainWorkerData *const data = &worker_data[i];
+    if (alloc_overlap_bufs(&data->bufs, luma_stride, chroma_stride,
+                           chroma_subsamp_y, chroma_subsamp_x)) {
+      ret = -1;
+      break;
+    }
+    data->y_start = (num_strips * i / num_workers) * strip_step;
+    data->y_end = AOMMIN(height / 2,
+                         (num_strips * (i + 1) / num_workers) * strip_step);
+  }
+
+  if (!ret && num_workers == 1) {
+    add_film_grain_rows(&fi, &worker_data[0].bufs, worker_data[0].y_start,
+                        worker_data[0].y_end);
+  } else if (!ret) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = num_workers - 1; i >= 0; --i) {
+      AVxWorker *const worker = &workers[i];
+      worker->hook = grain_worker_hook;
+      worker->data1 = &fi;
+      worker->data2 = &worker_data[i];
+      if (i == num_workers - 1)
+        winterface->execute(worker);
+      else
+        winterface->launch(worker);
+    }
+    for (int i = num_workers - 1; i >= 0; --i) {
+      if (!winterface->sync(&workers[i])) ret = -1;
+    }
+  }
+
+  if (worker_data) {
+    for (int i = 0; i < num_workers; ++i)
+      dealloc_overlap_bufs(&worker_data[i].bufs);
+    aom_free(worker_data);
+  }
+  dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &luma_grain_block,
+                 &cb_grain_block, &cr_grain_block);
+  return ret;
+}
+
+int av1_add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
+                           uint8_t *cb, uint8_t *cr, int height, int width,
+                           int luma_stride, int chroma_stride,
+                           int use_high_bit_depth, int chroma_subsamp_y,
+                           int chroma_subsamp_x, int mc_identity) {
+  return add_film_grain_run(params, luma, cb, cr, height, width, luma_stride,
+                            chroma_stride, use_high_bit_depth,
+                            chroma_subsamp_y, chroma_subsamp_x, mc_identity,
+                            NULL, 0);
+}
+
 int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
                        aom_image_t *dst) {
+  return av1_add_film_grain_mt(params, src, dst, NULL, 0);
+}
+
+int av1_add_film_grain_mt(const aom_film_grain_t *params,
+                          const aom_image_t *src, aom_image_t *dst,
+                          AVxWorker *workers, int num_workers) {
   uint8_t *luma, *cb, *cr;
   int height, width, luma_stride, chroma_stride;
   int use_high_bit_depth = 0;
@@ -1015,394 +1571,8 @@ int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
   luma_stride = dst->stride[AOM_PLANE_Y] >> use_high_bit_depth;
   chroma_stride = dst->stride[AOM_PLANE_U] >> use_high_bit_depth;
 
-  return av1_add_film_grain_run(
-      params, luma, cb, cr, height, width, luma_stride, chroma_stride,
-      use_high_bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-}
-
-int av1_add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
-                           uint8_t *cb, uint8_t *cr, int height, int width,
-                           int luma_stride, int chroma_stride,
-                           int use_high_bit_depth, int chroma_subsamp_y,
-                           int chroma_subsamp_x, int mc_identity) {
-  int **pred_pos_luma;
-  int **pred_pos_chroma;
-  int *luma_grain_block;
-  int *cb_grain_block;
-  int *cr_grain_block;
-
-  int *y_line_buf;
-  int *cb_line_buf;
-  int *cr_line_buf;
-
-  int *y_col_buf;
-  int *cb_col_buf;
-  int *cr_col_buf;
-
-  random_register = params->random_seed;
-
-  int left_pad = 3;
-  int right_pad = 3;  // padding to offset for AR coefficients
-  int top_pad = 3;
-  int bottom_pad = 0;
-
-  int ar_padding = 3;  // maximum lag used for stabilization of AR coefficients
-
-  luma_subblock_size_y = 32;
-  luma_subblock_size_x = 32;
-
-  chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
-  chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
-
-  // Initial padding is only needed for generation of
-  // film grain templates (to stabilize the AR process)
-  // Only a 64x64 luma and 32x32 chroma part of a template
-  // is used later for adding grain, padding can be discarded
-
-  int luma_block_size_y =
-      top_pad + 2 * ar_padding + luma_subblock_size_y * 2 + bottom_pad;
-  int luma_block_size_x = left_pad + 2 * ar_padding + luma_subblock_size_x * 2 +
-                          2 * ar_padding + right_pad;
-
-  int chroma_block_size_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            chroma_subblock_size_y * 2 + bottom_pad;
-  int chroma_block_size_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            chroma_subblock_size_x * 2 +
-                            (2 >> chroma_subsamp_x) * ar_padding + right_pad;
-
-  int luma_grain_stride = luma_block_size_x;
-  int chroma_grain_stride = chroma_block_size_x;
-
-  int overlap = params->overlap_flag;
-  int bit_depth = params->bit_depth;
-
-  const int grain_center = 128 << (bit_depth - 8);
-  grain_min = 0 - grain_center;
-  grain_max = grain_center - 1;
-
-  init_arrays(params, luma_stride, chroma_stride, &pred_pos_luma,
-              &pred_pos_chroma, &luma_grain_block, &cb_grain_block,
-              &cr_grain_block, &y_line_buf, &cb_line_buf, &cr_line_buf,
-              &y_col_buf, &cb_col_buf, &cr_col_buf,
-              luma_block_size_y * luma_block_size_x,
-              chroma_block_size_y * chroma_block_size_x, chroma_subsamp_y,
-              chroma_subsamp_x);
-
-  if (generate_luma_grain_block(params, pred_pos_luma, luma_grain_block,
-                                luma_block_size_y, luma_block_size_x,
-                                luma_grain_stride, left_pad, top_pad, right_pad,
-                                bottom_pad))
-    return -1;
-
-  if (generate_chroma_grain_blocks(
-          params,
-          //                               pred_pos_luma,
-          pred_pos_chroma, luma_grain_block, cb_grain_block, cr_grain_block,
-          luma_grain_stride, chroma_block_size_y, chroma_block_size_x,
-          chroma_grain_stride, left_pad, top_pad, right_pad, bottom_pad,
-          chroma_subsamp_y, chroma_subsamp_x))
-    return -1;
-
-  init_scaling_function(params->scaling_points_y, params->num_y_points,
-                        scaling_lut_y);
-
-  if (params->chroma_scaling_from_luma) {
-    memcpy(scaling_lut_cb, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-    memcpy(scaling_lut_cr, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-  } else {
-    init_scaling_function(params->scaling_points_cb, params->num_cb_points,
-                          scaling_lut_cb);
-    init_scaling_function(params->scaling_points_cr, params->num_cr_points,
-                          scaling_lut_cr);
-  }
-  for (int y = 0; y < height / 2; y += (luma_subblock_size_y >> 1)) {
-    init_random_generator(y * 2, params->random_seed);
-
-    for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
-      int offset_y = get_random_number(8);
-      int offset_x = (offset_y >> 4) & 15;
-      offset_y &= 15;
-
-      int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
-      int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
-
-      int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            offset_y * (2 >> chroma_subsamp_y);
-      int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            offset_x * (2 >> chroma_subsamp_x);
-
-      if (overlap && x) {
-        ver_boundary_overlap(
-            y_col_buf, 2,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x,
-            luma_grain_stride, y_col_buf, 2, 2,
-            AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        ver_boundary_overlap(
-            cb_col_buf, 2 >> chroma_subsamp_x,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        ver_boundary_overlap(
-            cr_col_buf, 2 >> chroma_subsamp_x,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        int i = y ? 1 : 0;
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params,
-              (uint16_t *)luma + ((y + i) << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              (uint16_t *)cr +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        } else {
-          add_noise_to_block(
-              params, luma + ((y + i) << 1) * luma_stride + (x << 1),
-              cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        }
-      }
-
-      if (overlap && y) {
-        if (x) {
-          hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
-                               y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                               cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-
-          hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                               cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-        }
-
-        hor_boundary_overlap(
-            y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x + (x ? 2 : 0),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
-                   width - ((x ? x + 1 : 0) << 1)),
-            2);
-
-        hor_boundary_overlap(
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        hor_boundary_overlap(
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params, (uint16_t *)luma + (y << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              (uint16_t *)cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        } else {
-          add_noise_to_block(
-              params, luma + (y << 1) * luma_stride + (x << 1),
-              cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        }
-      }
-
-      int i = overlap && y ? 1 : 0;
-      int j = overlap && x ? 1 : 0;
-
-      if (use_high_bit_depth) {
-        add_noise_to_block_hbd(
-            params,
-            (uint16_t *)luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            (uint16_t *)cb +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            (uint16_t *)cr +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-      } else {
-        add_noise_to_block(
-            params, luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-      }
-
-      if (overlap) {
-        if (x) {
-          // Copy overlapped column bufer to line buffer
-          copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
-                    y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          copy_area(
-              cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-
-          copy_area(
-              cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-        }
-
-        // Copy grain to the line buffer for overlap with a bottom block
-        copy_area(
-            luma_grain_block +
-                (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
-                luma_offset_x + ((x ? 2 : 0)),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
-
-        copy_area(cb_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        copy_area(cr_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        // Copy grain to the column buffer for overlap with the next block to
-        // the right
-
-        copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
-                      luma_offset_x + luma_subblock_size_x,
-                  luma_grain_stride, y_col_buf, 2, 2,
-                  AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-
-        copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-      }
-    }
-  }
-
-  dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &luma_grain_block,
-                 &cb_grain_block, &cr_grain_block, &y_line_buf, &cb_line_buf,
-                 &cr_line_buf, &y_col_buf, &cb_col_buf, &cr_col_buf);
-  return 0;
+  return add_film_grain_run(params, luma, cb, cr, height, width, luma_stride,
+                            chroma_stride, use_high_bit_depth,
+                            chroma_subsamp_y, chroma_subsamp_x, mc_identity,
+                            workers, num_workers);
 }
@@ -24,6 +24,7 @@ extern "C" {
 
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom/aom_image.h"
+#include "aom_util/aom_thread.h"
 
 /*!\brief Structure containing film grain synthesis parameters for a frame
  *
@@ -185,6 +186,24 @@ int av1_add_film_grain_run(const aom_film_grain_t *grain_params, uint8_t *luma,
 int av1_add_film_grain(const aom_film_grain_t *grain_params,
                        const aom_image_t *src, aom_image_t *dst);
 
+/*!\brief Add film grain using multiple threads
+ *
+ * Same as av1_add_film_grain(), with the strips of 32 luma rows of the image
+ * split between the workers. The last worker runs on the calling thread. The
+ * result does not depend on the number of workers.
+ *
+ * Returns 0 for success, -1 for failure
+ *
+ * \param[in]    grain_params     Grain parameters
+ * \param[in]    src              Source image
+ * \param[out]   dst              Resulting image with grain
+ * \param[in]    workers          Idle workers, or NULL
+ * \param[in]    num_workers      Number of workers
+ */
+int av1_add_film_grain_mt(const aom_film_grain_t *grain_params,
+                          const aom_image_t *src, aom_image_t *dst,
+                          AVxWorker *workers, int num_workers);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -18,6 +18,7 @@
 #include "config/aom_config.h"
 
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/aom_simd.h"
 #include "aom_dsp/entcode.h"
 #include "aom_ports/bitops.h"
 #include "aom_ports/mem.h"
@@ -640,15 +641,19 @@ static INLINE uint8_t get_prob(unsigned int num, unsigned int den) {
   }
 }
 
-static INLINE void update_cdf(aom_cdf_prob *cdf, int8_t val, int nsymbs) {
-  int rate;
-  int i, tmp;
-
+static INLINE int get_cdf_update_rate(const aom_cdf_prob *cdf, int nsymbs) {
   static const int nsymbs2speed[17] = { 0, 0, 1, 1, 2, 2, 2, 2, 2,
                                         2, 2, 2, 2, 2, 2, 2, 2 };
   assert(nsymbs < 17);
-  rate = 3 + (cdf[nsymbs] > 15) + (cdf[nsymbs] > 31) +
+  return 3 + (cdf[nsymbs] > 15) + (cdf[nsymbs] > 31) +
          nsymbs2speed[nsymbs];  // + get_msb(nsymbs);
+}
+
+static INLINE void update_cdf_c(aom_cdf_prob *cdf, int8_t val, int nsymbs) {
+  int rate;
+  int i, tmp;
+
+  rate = get_cdf_update_rate(cdf, nsymbs);
   tmp = AOM_ICDF(0);
 
   // Single loop (faster)
@@ -663,6 +668,62 @@ static INLINE void update_cdf(aom_cdf_prob *cdf, int8_t val, int nsymbs) {
   cdf[nsymbs] += (cdf[nsymbs] < 32);
 }
 
+#if AOM_SIMD_NATIVE
+// Moves the entries of c for the symbols before val up towards AOM_ICDF(0),
+// and the others down towards 0, as update_cdf_c() does. idx holds the
+// symbol index of each lane.
+static INLINE v64 update_cdf_v64(v64 c, v64 idx, int8_t val, int rate) {
+  const v64 up = v64_cmplt_s16(idx, v64_dup_16(val));
+  const v64 inc = v64_and(v64_sub_16(v64_dup_16(AOM_ICDF(0)), c), up);
+  const v64 dec = v64_andn(c, up);
+  return v64_sub_16(v64_add_16(c, v64_shr_u16(inc, rate)),
+                    v64_shr_u16(dec, rate));
+}
+
+static INLINE v128 update_cdf_v128(v128 c, v128 idx, int8_t val, int rate) {
+  const v128 up = v128_cmplt_s16(idx, v128_dup_16(val));
+  const v128 inc = v128_and(v128_sub_16(v128_dup_16(AOM_ICDF(0)), c), up);
+  const v128 dec = v128_andn(c, up);
+  return v128_sub_16(v128_add_16(c, v128_shr_u16(inc, rate)),
+                     v128_shr_u16(dec, rate));
+}
+#endif  // AOM_SIMD_NATIVE
+
+static INLINE void update_cdf(aom_cdf_prob *cdf, int8_t val, int nsymbs) {
+#if AOM_SIMD_NATIVE
+  if (nsymbs > 2) {
+    const int rate = get_cdf_update_rate(cdf, nsymbs);
+    const aom_cdf_prob count = cdf[nsymbs];
+    // The entries are updated in two overlapping vectors, both loaded before
+    // either is stored, so that nothing past the counter is accessed. Entry
+    // nsymbs - 1 stays 0, and the counter is rewritten afterwards.
+    if (nsymbs < 8) {
+      const int off = nsymbs + 1 - 4;
+      const v64 idx = v64_from_16(3, 2, 1, 0);
+      const v64 lo = v64_load_unaligned(cdf);
+      const v64 hi = v64_load_unaligned(cdf + off);
+      v64_store_unaligned(cdf, update_cdf_v64(lo, idx, val, rate));
+      v64_store_unaligned(
+          cdf + off,
+          update_cdf_v64(hi, v64_add_16(idx, v64_dup_16(off)), val, rate));
+    } else {
+      const int off = AOMMIN(nsymbs + 1, 16) - 8;
+      const v128 idx =
+          v128_from_v64(v64_from_16(7, 6, 5, 4), v64_from_16(3, 2, 1, 0));
+      const v128 lo = v128_load_unaligned(cdf);
+      const v128 hi = v128_load_unaligned(cdf + off);
+      v128_store_unaligned(cdf, update_cdf_v128(lo, idx, val, rate));
+      v128_store_unaligned(
+          cdf + off,
+          update_cdf_v128(hi, v128_add_16(idx, v128_dup_16(off)), val, rate));
+    }
+    cdf[nsymbs] = count + (count < 32);
+    return;
+  }
+#endif  // AOM_SIMD_NATIVE
+  update_cdf_c(cdf, val, nsymbs);
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2020, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/x86/synonyms.h"
+
+#include "config/aom_dsp_rtcd.h"
+
+// Returns clamp(pel + ((scale * grain + round) >> shift), min, max) for 8
+// samples.
+static INLINE __m256i add_noise_8(const __m256i pel, const int *scale,
+                                  const int *grain, const __m256i round,
+                                  const __m128i shift, const __m256i min_val,
+                                  const __m256i max_val) {
+  const __m256i s = _mm256_loadu_si256((const __m256i *)scale);
+  const __m256i g = _mm256_loadu_si256((const __m256i *)grain);
+  const __m256i noise = _mm256_sra_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(s, g), round), shift);
+  return _mm256_min_epi32(
+      _mm256_max_epi32(_mm256_add_epi32(pel, noise), min_val), max_val);
+}
+
+// Packs 8 32-bit values to unsigned 16 bits, in order.
+static INLINE __m128i pack_u16_8(const __m256i v) {
+  return _mm_packus_epi32(_mm256_castsi256_si128(v),
+                          _mm256_extracti128_si256(v, 1));
+}
+
+void aom_film_grain_add_noise_row_avx2(uint8_t *dst, const int *scale,
+                                       const int *grain, int width,
+                                       int scaling_shift, int min_val,
+                                       int max_val) {
+  const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  int j = 0;
+
+  for (; j + 16 <= width; j += 16) {
+    const __m128i p = xx_loadu_128(dst + j);
+    const __m256i lo = add_noise_8(_mm256_cvtepu8_epi32(p), scale + j,
+                                   grain + j, round, shift, vmin, vmax);
+    const __m256i hi =
+        add_noise_8(_mm256_cvtepu8_epi32(_mm_srli_si128(p, 8)), scale + j + 8,
+                    grain + j + 8, round, shift, vmin, vmax);
+    xx_storeu_128(dst + j, _mm_packus_epi16(pack_u16_8(lo), pack_u16_8(hi)));
+  }
+  for (; j + 8 <= width; j += 8) {
+    const __m256i res =
+        add_noise_8(_mm256_cvtepu8_epi32(xx_loadl_64(dst + j)), scale + j,
+                    grain + j, round, shift, vmin, vmax);
+    const __m128i res16 = pack_u16_8(res);
+    xx_storel_64(dst + j, _mm_packus_epi16(res16, res16));
+  }
+  for (; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + (1 << (scaling_shift - 1))) >>
+                  scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_highbd_film_grain_add_noise_row_avx2(uint16_t *dst, const int *scale,
+                                              const int *grain, int width,
+                                              int scaling_shift, int min_val,
+                                              int max_val) {
+  const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  int j = 0;
+
+  for (; j + 8 <= width; j += 8) {
+    const __m256i res =
+        add_noise_8(_mm256_cvtepu16_epi32(xx_loadu_128(dst + j)), scale + j,
+                    grain + j, round, shift, vmin, vmax);
+    xx_storeu_128(dst + j, pack_u16_8(res));
+  }
+  for (; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + (1 << (scaling_shift - 1))) >>
+                  scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_film_grain_blend_row_avx2(const int *a, const int *b, int *dst,
+                                   int width, int weight_a, int weight_b,
+                                   int min_val, int max_val) {
+  const __m256i wa = _mm256_set1_epi32(weight_a);
+  const __m256i wb = _mm256_set1_epi32(weight_b);
+  const __m256i round = _mm256_set1_epi32(16);
+  const __m256i vmin = _mm256_set1_epi32(min_val);
+  const __m256i vmax = _mm256_set1_epi32(max_val);
+  int j = 0;
+
+  for (; j + 8 <= width; j += 8) {
+    const __m256i va = _mm256_loadu_si256((const __m256i *)(a + j));
+    const __m256i vb = _mm256_loadu_si256((const __m256i *)(b + j));
+    const __m256i sum = _mm256_add_epi32(_mm256_mullo_epi32(va, wa),
+                                         _mm256_mullo_epi32(vb, wb));
+    const __m256i res = _mm256_srai_epi32(_mm256_add_epi32(sum, round), 5);
+    _mm256_storeu_si256((__m256i *)(dst + j),
+                        _mm256_min_epi32(_mm256_max_epi32(res, vmin), vmax));
+  }
+  for (; j < width; j++) {
+    dst[j] =
+        clamp((weight_a * a[j] + weight_b * b[j] + 16) >> 5, min_val, max_val);
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>  // SSE4.1
+
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/x86/synonyms.h"
+
+#include "config/aom_dsp_rtcd.h"
+
+// Returns clamp(pel + ((scale * grain + round) >> shift), min, max) for 4
+// samples.
+static INLINE __m128i add_noise_4(const __m128i pel, const int *scale,
+                                  const int *grain, const __m128i round,
+                                  const __m128i shift, const __m128i min_val,
+                                  const __m128i max_val) {
+  const __m128i s = xx_loadu_128(scale);
+  const __m128i g = xx_loadu_128(grain);
+  const __m128i noise =
+      _mm_sra_epi32(_mm_add_epi32(_mm_mullo_epi32(s, g), round), shift);
+  return _mm_min_epi32(_mm_max_epi32(_mm_add_epi32(pel, noise), min_val),
+                       max_val);
+}
+
+void aom_film_grain_add_noise_row_sse4_1(uint8_t *dst, const int *scale,
+                                         const int *grain, int width,
+                                         int scaling_shift, int min_val,
+                                         int max_val) {
+  const __m128i round = _mm_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  int j = 0;
+
+  for (; j + 8 <= width; j += 8) {
+    const __m128i p = xx_loadl_64(dst + j);
+    const __m128i lo = add_noise_4(_mm_cvtepu8_epi32(p), scale + j, grain + j,
+                                   round, shift, vmin, vmax);
+    const __m128i hi =
+        add_noise_4(_mm_cvtepu8_epi32(_mm_srli_si128(p, 4)), scale + j + 4,
+                    grain + j + 4, round, shift, vmin, vmax);
+    const __m128i res = _mm_packus_epi32(lo, hi);
+    xx_storel_64(dst + j, _mm_packus_epi16(res, res));
+  }
+  for (; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + (1 << (scaling_shift - 1))) >>
+                  scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_highbd_film_grain_add_noise_row_sse4_1(uint16_t *dst,
+                                                const int *scale,
+                                                const int *grain, int width,
+                                                int scaling_shift, int min_val,
+                                                int max_val) {
+  const __m128i round = _mm_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  const __m128i zero = _mm_setzero_si128();
+  int j = 0;
+
+  for (; j + 8 <= width; j += 8) {
+    const __m128i p = xx_loadu_128(dst + j);
+    const __m128i lo = add_noise_4(_mm_unpacklo_epi16(p, zero), scale + j,
+                                   grain + j, round, shift, vmin, vmax);
+    const __m128i hi = add_noise_4(_mm_unpackhi_epi16(p, zero), scale + j + 4,
+                                   grain + j + 4, round, shift, vmin, vmax);
+    xx_storeu_128(dst + j, _mm_packus_epi32(lo, hi));
+  }
+  for (; j < width; j++) {
+    dst[j] = clamp(
+        dst[j] + ((scale[j] * grain[j] + (1 << (scaling_shift - 1))) >>
+                  scaling_shift),
+        min_val, max_val);
+  }
+}
+
+void aom_film_grain_blend_row_sse4_1(const int *a, const int *b, int *dst,
+                                     int width, int weight_a, int weight_b,
+                                     int min_val, int max_val) {
+  const __m128i wa = _mm_set1_epi32(weight_a);
+  const __m128i wb = _mm_set1_epi32(weight_b);
+  const __m128i round = _mm_set1_epi32(16);
+  const __m128i vmin = _mm_set1_epi32(min_val);
+  const __m128i vmax = _mm_set1_epi32(max_val);
+  int j = 0;
+
+  for (; j + 4 <= width; j += 4) {
+    const __m128i sum =
+        _mm_add_epi32(_mm_mullo_epi32(xx_loadu_128(a + j), wa),
+                      _mm_mullo_epi32(xx_loadu_128(b + j), wb));
+    const __m128i res = _mm_srai_epi32(_mm_add_epi32(sum, round), 5);
+    xx_storeu_128(dst + j, _mm_min_epi32(_mm_max_epi32(res, vmin), vmax));
+  }
+  for (; j < width; j++) {
+    dst[j] =
+        clamp((weight_a * a[j] + weight_b * b[j] + 16) >> 5, min_val, max_val);
+  }
+}
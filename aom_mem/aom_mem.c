@@ -27,8 +27,93 @@ static int check_size_argument_overflow(uint64_t nmemb, uint64_t size) {
 }
 #endif
 
+#if CONFIG_MEM_TRACKING
+#if !CONFIG_MULTITHREAD
+#define AOM_THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define AOM_THREAD_LOCAL __declspec(thread)
+#else
+#define AOM_THREAD_LOCAL __thread
+#endif
+
+#if !CONFIG_MULTITHREAD
+static INLINE int64_t add_bytes(int64_t *p, int64_t v) { return *p += v; }
+static INLINE int64_t load_bytes(const int64_t *p) { return *p; }
+#elif defined(__GNUC__)
+static INLINE int64_t add_bytes(int64_t *p, int64_t v) {
+  return __atomic_add_fetch(p, v, __ATOMIC_RELAXED);
+}
+static INLINE int64_t load_bytes(const int64_t *p) {
+  return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+#elif defined(_MSC_VER)
+#include <intrin.h>
+static INLINE int64_t add_bytes(int64_t *p, int64_t v) {
+  return _InterlockedExchangeAdd64((volatile __int64 *)p, v) + v;
+}
+static INLINE int64_t load_bytes(const int64_t *p) {
+  return _InterlockedOr64((volatile __int64 *)p, 0);
+}
+#else
+#error "CONFIG_MEM_TRACKING requires GCC-style or MSVC atomic builtins."
+#endif
+
+// Tracker and subsystem of the allocations of the calling thread.
+static AOM_THREAD_LOCAL aom_mem_tracker_t *current_tracker;
+static AOM_THREAD_LOCAL aom_mem_tag_t current_tag;
+
+// Stored at the start of the malloc() allocation, so that aom_free() accounts
+// the block to the tracker and subsystem it was allocated for.
+typedef struct {
+  aom_mem_tracker_t *tracker;
+  size_t size;
+  aom_mem_tag_t tag;
+} AllocInfo;
+
+#define ALLOC_INFO_SIZE sizeof(AllocInfo)
+
+static void account(const AllocInfo *info, int64_t bytes) {
+  aom_mem_tracker_t *const tracker = info->tracker;
+  const int64_t current = add_bytes(&tracker->current_bytes[info->tag], bytes);
+  // Allocations are made by the thread calling the codec, so a race with a
+  // free in a worker thread can only make the peak lag behind.
+  if (current > load_bytes(&tracker->peak_bytes[info->tag])) {
+    tracker->peak_bytes[info->tag] = current;
+  }
+}
+
+aom_mem_tracker_t *aom_mem_set_tracker(aom_mem_tracker_t *tracker) {
+  aom_mem_tracker_t *const prev = current_tracker;
+  current_tracker = tracker;
+  current_tag = AOM_MEM_TAG_OTHER;
+  return prev;
+}
+
+aom_mem_tag_t aom_mem_set_tag(aom_mem_tag_t tag) {
+  const aom_mem_tag_t prev = current_tag;
+  current_tag = tag;
+  return prev;
+}
+
+aom_mem_tag_t aom_mem_set_default_tag(aom_mem_tag_t tag) {
+  const aom_mem_tag_t prev = current_tag;
+  if (prev == AOM_MEM_TAG_OTHER) current_tag = tag;
+  return prev;
+}
+
+void aom_mem_get_usage(const aom_mem_tracker_t *tracker,
+                       aom_memory_usage_t *usage) {
+  for (int i = 0; i < AOM_MEM_TAGS; ++i) {
+    usage->current_bytes[i] = (uint64_t)load_bytes(&tracker->current_bytes[i]);
+    usage->peak_bytes[i] = (uint64_t)load_bytes(&tracker->peak_bytes[i]);
+  }
+}
+#else
+#define ALLOC_INFO_SIZE 0
+#endif  // CONFIG_MEM_TRACKING
+
 static size_t GetAlignedMallocSize(size_t size, size_t align) {
-  return size + align - 1 + ADDRESS_STORAGE_SIZE;
+  return size + align - 1 + ADDRESS_STORAGE_SIZE + ALLOC_INFO_SIZE;
 }
 
 static size_t *GetMallocAddressLocation(void *const mem) {
@@ -54,8 +139,18 @@ void *aom_memalign(size_t align, size_t size) {
 #endif
   void *const addr = malloc(aligned_size);
   if (addr) {
-    x = aom_align_addr((unsigned char *)addr + ADDRESS_STORAGE_SIZE, align);
+    x = aom_align_addr(
+        (unsigned char *)addr + ADDRESS_STORAGE_SIZE + ALLOC_INFO_SIZE, align);
     SetActualMallocAddress(x, addr);
+#if CONFIG_MEM_TRACKING
+    if (current_tracker) {
+      const AllocInfo info = { current_tracker, size, current_tag };
+      account(&info, (int64_t)size);
+      *(AllocInfo *)addr = info;
+    } else {
+      memset(addr, 0, sizeof(AllocInfo));
+    }
+#endif
   }
   return x;
 }
@@ -72,6 +167,10 @@ void *aom_calloc(size_t num, size_t size) {
 void aom_free(void *memblk) {
   if (memblk) {
     void *addr = GetActualMallocAddress(memblk);
+#if CONFIG_MEM_TRACKING
+    const AllocInfo *const info = (const AllocInfo *)addr;
+    if (info->tracker) account(info, -(int64_t)info->size);
+#endif
     free(addr);
   }
 }
@@ -12,6 +12,7 @@
 #ifndef AOM_AOM_MEM_AOM_MEM_H_
 #define AOM_AOM_MEM_AOM_MEM_H_
 
+#include "aom/aom.h"
 #include "aom/aom_integer.h"
 #include "config/aom_config.h"
 
@@ -38,6 +39,47 @@ void *aom_calloc(size_t num, size_t size);
 void aom_free(void *memblk);
 void *aom_memset16(void *dest, int val, size_t length);
 
+// Memory used by a codec instance, per aom_mem_tag_t. The counters are only
+// maintained when CONFIG_MEM_TRACKING is enabled.
+typedef struct aom_mem_tracker {
+  int64_t current_bytes[AOM_MEM_TAGS];
+  int64_t peak_bytes[AOM_MEM_TAGS];
+} aom_mem_tracker_t;
+
+#if CONFIG_MEM_TRACKING
+// Sets the tracker the next allocations of the calling thread are accounted
+// to, or NULL for none, and returns the previous one. The subsystem is reset
+// to AOM_MEM_TAG_OTHER.
+aom_mem_tracker_t *aom_mem_set_tracker(aom_mem_tracker_t *tracker);
+
+// Sets the subsystem the next allocations of the calling thread are accounted
+// to and returns the previous one.
+aom_mem_tag_t aom_mem_set_tag(aom_mem_tag_t tag);
+
+// Same as aom_mem_set_tag(), except that the current subsystem is kept unless
+// it is AOM_MEM_TAG_OTHER.
+aom_mem_tag_t aom_mem_set_default_tag(aom_mem_tag_t tag);
+
+void aom_mem_get_usage(const aom_mem_tracker_t *tracker,
+                       aom_memory_usage_t *usage);
+#else
+static INLINE aom_mem_tracker_t *aom_mem_set_tracker(
+    aom_mem_tracker_t *tracker) {
+  (void)tracker;
+  return NULL;
+}
+
+static INLINE aom_mem_tag_t aom_mem_set_tag(aom_mem_tag_t tag) {
+  (void)tag;
+  return AOM_MEM_TAG_OTHER;
+}
+
+static INLINE aom_mem_tag_t aom_mem_set_default_tag(aom_mem_tag_t tag) {
+  (void)tag;
+  return AOM_MEM_TAG_OTHER;
+}
+#endif  // CONFIG_MEM_TRACKING
+
 /*returns an addr aligned to the byte boundary specified by align*/
 #define aom_align_addr(addr, align) \
   (void *)(((uintptr_t)(addr) + ((align)-1)) & ~(uintptr_t)((align)-1))
@@ -25,11 +25,106 @@
  *
  ****************************************************************************/
 
+// Returns the size of the allocation of a pool holding size bytes. There are 8
+// size classes per power of 2, so that the frame buffers of close dimensions
+// share allocations at the cost of at most 12.5% of unused memory.
+static size_t pool_alloc_size(size_t size) {
+  size_t step = 64;
+  while (step <= size / 16) step <<= 1;
+  return (size + step - 1) & ~(step - 1);
+}
+
+static void pool_free_oldest(aom_frame_buffer_pool_t *pool) {
+  assert(pool->num_free > 0);
+  aom_free(pool->free_allocs[0]);
+  pool->allocated_bytes -= pool->free_sizes[0];
+  --pool->num_free;
+  memmove(pool->free_allocs, pool->free_allocs + 1,
+          pool->num_free * sizeof(*pool->free_allocs));
+  memmove(pool->free_sizes, pool->free_sizes + 1,
+          pool->num_free * sizeof(*pool->free_sizes));
+}
+
+// Returns an allocation of pool holding size bytes, or NULL if there is not
+// enough memory or if it would exceed the limit of pool.
+static uint8_t *pool_acquire(aom_frame_buffer_pool_t *pool, size_t size) {
+  const size_t alloc_size = pool_alloc_size(size);
+  if (alloc_size < size) return NULL;
+
+  // Prefer the most recently freed allocations, which are more likely to be
+  // cached.
+  for (int i = pool->num_free - 1; i >= 0; --i) {
+    if (pool->free_sizes[i] != alloc_size) continue;
+    uint8_t *const buf = pool->free_allocs[i];
+    --pool->num_free;
+    memmove(pool->free_allocs + i, pool->free_allocs + i + 1,
+            (pool->num_free - i) * sizeof(*pool->free_allocs));
+    memmove(pool->free_sizes + i, pool->free_sizes + i + 1,
+            (pool->num_free - i) * sizeof(*pool->free_sizes));
+    pool->in_use_bytes += alloc_size;
+    ++pool->num_reuses;
+    return buf;
+  }
+
+  while (pool->max_bytes > 0 &&
+         (alloc_size > pool->max_bytes ||
+          pool->allocated_bytes > pool->max_bytes - alloc_size)) {
+    if (pool->num_free == 0) return NULL;
+    pool_free_oldest(pool);
+  }
+  uint8_t *const buf = (uint8_t *)aom_memalign(32, alloc_size);
+  if (!buf) return NULL;
+  pool->allocated_bytes += alloc_size;
+  pool->in_use_bytes += alloc_size;
+  if (pool->allocated_bytes > pool->peak_bytes) {
+    pool->peak_bytes = pool->allocated_bytes;
+  }
+  ++pool->num_allocs;
+  return buf;
+}
+
+// Gives back an allocation of pool holding size bytes.
+static void pool_release(aom_frame_buffer_pool_t *pool, uint8_t *buf,
+                         size_t size) {
+  const size_t alloc_size = pool_alloc_size(size);
+  assert(pool->in_use_bytes >= alloc_size);
+  pool->in_use_bytes -= alloc_size;
+  if (pool->num_free == AOM_FRAME_BUFFER_POOL_SIZE) pool_free_oldest(pool);
+  pool->free_allocs[pool->num_free] = buf;
+  pool->free_sizes[pool->num_free] = alloc_size;
+  ++pool->num_free;
+}
+
+void aom_frame_buffer_pool_set_limit(aom_frame_buffer_pool_t *pool,
+                                     size_t max_bytes) {
+  pool->max_bytes = max_bytes;
+  while (max_bytes > 0 && pool->allocated_bytes > max_bytes &&
+         pool->num_free > 0) {
+    pool_free_oldest(pool);
+  }
+}
+
+void aom_free_frame_buffer_pool(aom_frame_buffer_pool_t *pool) {
+  assert(pool->in_use_bytes == 0);
+  while (pool->num_free > 0) pool_free_oldest(pool);
+}
+
+static void free_buffer_alloc(YV12_BUFFER_CONFIG *ybf) {
+  if (ybf->pool) {
+    pool_release(ybf->pool, ybf->buffer_alloc, ybf->buffer_alloc_sz);
+  } else {
+    aom_free(ybf->buffer_alloc);
+  }
+  ybf->buffer_alloc = NULL;
+  ybf->buffer_alloc_sz = 0;
+  ybf->pool = NULL;
+}
+
 // TODO(jkoleszar): Maybe replace this with struct aom_image
 int aom_free_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
   if (ybf) {
     if (ybf->buffer_alloc_sz > 0) {
-      aom_free(ybf->buffer_alloc);
+      free_buffer_alloc(ybf);
     }
     if (ybf->y_buffer_8bit) aom_free(ybf->y_buffer_8bit);
     aom_remove_metadata_from_frame_buffer(ybf);
@@ -50,7 +145,8 @@ static int realloc_frame_buffer_aligned(
     void *cb_priv, const int y_stride, const uint64_t yplane_size,
     const uint64_t uvplane_size, const int aligned_width,
     const int aligned_height, const int uv_width, const int uv_height,
-    const int uv_stride, const int uv_border_w, const int uv_border_h) {
+    const int uv_stride, const int uv_border_w, const int uv_border_h,
+    aom_frame_buffer_pool_t *pool) {
   if (ybf) {
     const int aom_byte_align = (byte_alignment == 0) ? 1 : byte_alignment;
     const uint64_t frame_size =
@@ -98,16 +194,19 @@ static int realloc_frame_buffer_aligned(
 #endif
     } else if (frame_size > ybf->buffer_alloc_sz) {
       // Allocation to hold larger frame, or first allocation.
-      aom_free(ybf->buffer_alloc);
-      ybf->buffer_alloc = NULL;
-      ybf->buffer_alloc_sz = 0;
+      free_buffer_alloc(ybf);
 
       if (frame_size != (size_t)frame_size) return AOM_CODEC_MEM_ERROR;
 
-      ybf->buffer_alloc = (uint8_t *)aom_memalign(32, (size_t)frame_size);
+      if (pool) {
+        ybf->buffer_alloc = pool_acquire(pool, (size_t)frame_size);
+      } else {
+        ybf->buffer_alloc = (uint8_t *)aom_memalign(32, (size_t)frame_size);
+      }
       if (!ybf->buffer_alloc) return AOM_CODEC_MEM_ERROR;
 
       ybf->buffer_alloc_sz = (size_t)frame_size;
+      ybf->pool = pool;
 
       // This memset is needed for fixing valgrind error from C loop filter
       // due to access uninitialized memory in frame border. It could be
@@ -194,11 +293,12 @@ static int calc_stride_and_planesize(const int ss_x, const int ss_y,
   return 0;
 }
 
-int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
-                             int ss_x, int ss_y, int use_highbitdepth,
-                             int border, int byte_alignment,
-                             aom_codec_frame_buffer_t *fb,
-                             aom_get_frame_buffer_cb_fn_t cb, void *cb_priv) {
+static int realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
+                                int ss_x, int ss_y, int use_highbitdepth,
+                                int border, int byte_alignment,
+                                aom_codec_frame_buffer_t *fb,
+                                aom_get_frame_buffer_cb_fn_t cb, void *cb_priv,
+                                aom_frame_buffer_pool_t *pool) {
 #if CONFIG_SIZE_LIMIT
   if (width > DECODE_WIDTH_LIMIT || height > DECODE_HEIGHT_LIMIT)
     return AOM_CODEC_MEM_ERROR;
@@ -220,15 +320,37 @@ int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
         ss_x, ss_y, aligned_width, aligned_height, border, byte_alignment,
         &y_stride, &uv_stride, &yplane_size, &uvplane_size, uv_height);
     if (error) return error;
-    return realloc_frame_buffer_aligned(
+    const aom_mem_tag_t prev_tag =
+        aom_mem_set_default_tag(AOM_MEM_TAG_FRAME_BUFFERS);
+    error = realloc_frame_buffer_aligned(
         ybf, width, height, ss_x, ss_y, use_highbitdepth, border,
         byte_alignment, fb, cb, cb_priv, y_stride, yplane_size, uvplane_size,
         aligned_width, aligned_height, uv_width, uv_height, uv_stride,
-        uv_border_w, uv_border_h);
+        uv_border_w, uv_border_h, pool);
+    aom_mem_set_tag(prev_tag);
+    return error;
   }
   return AOM_CODEC_MEM_ERROR;
 }
 
+int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
+                             int ss_x, int ss_y, int use_highbitdepth,
+                             int border, int byte_alignment,
+                             aom_codec_frame_buffer_t *fb,
+                             aom_get_frame_buffer_cb_fn_t cb, void *cb_priv) {
+  return realloc_frame_buffer(ybf, width, height, ss_x, ss_y, use_highbitdepth,
+                              border, byte_alignment, fb, cb, cb_priv, NULL);
+}
+
+int aom_realloc_frame_buffer_from_pool(YV12_BUFFER_CONFIG *ybf, int width,
+                                       int height, int ss_x, int ss_y,
+                                       int use_highbitdepth, int border,
+                                       int byte_alignment,
+                                       aom_frame_buffer_pool_t *pool) {
+  return realloc_frame_buffer(ybf, width, height, ss_x, ss_y, use_highbitdepth,
+                              border, byte_alignment, NULL, NULL, NULL, pool);
+}
+
 int aom_alloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
                            int ss_x, int ss_y, int use_highbitdepth, int border,
                            int byte_alignment) {
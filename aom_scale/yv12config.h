@@ -31,6 +31,28 @@ extern "C" {
 #define AOM_ENC_NO_SCALE_BORDER 160
 #define AOM_DEC_BORDER_IN_PIXELS 64
 
+#define AOM_FRAME_BUFFER_POOL_SIZE 16
+
+// Allocations of frame buffers shared by the frame buffers of an encoder. The
+// allocation of a freed frame buffer is kept for the next frame buffer of the
+// same size class, instead of being returned to the system. The pool is not
+// thread safe.
+typedef struct aom_frame_buffer_pool {
+  // Allocations not used by any frame buffer, oldest first, and their sizes.
+  uint8_t *free_allocs[AOM_FRAME_BUFFER_POOL_SIZE];
+  size_t free_sizes[AOM_FRAME_BUFFER_POOL_SIZE];
+  int num_free;
+  // Limit of allocated_bytes, or 0 for no limit.
+  size_t max_bytes;
+  // Sizes of the allocations of the pool, including the unused ones.
+  size_t allocated_bytes;
+  size_t peak_bytes;
+  size_t in_use_bytes;
+  // Number of allocations made, and number of unused allocations reused.
+  uint64_t num_allocs;
+  uint64_t num_reuses;
+} aom_frame_buffer_pool_t;
+
 /*!\endcond */
 /*!
  * \brief YV12 frame buffer data structure
@@ -96,6 +118,8 @@ typedef struct yv12_buffer_config {
 
   uint8_t *buffer_alloc;
   size_t buffer_alloc_sz;
+  // Pool buffer_alloc comes from, or NULL if it is allocated on its own.
+  aom_frame_buffer_pool_t *pool;
   int border;
   size_t frame_size;
   int subsampling_x;
@@ -139,6 +163,25 @@ int aom_realloc_frame_buffer(YV12_BUFFER_CONFIG *ybf, int width, int height,
 
 int aom_free_frame_buffer(YV12_BUFFER_CONFIG *ybf);
 
+// Same as aom_realloc_frame_buffer() without callbacks, except that a new
+// allocation is taken from pool if it is not NULL. It is then given back to
+// pool when the frame buffer is freed or reallocated. Returns
+// AOM_CODEC_MEM_ERROR if the allocation would exceed the limit of pool.
+int aom_realloc_frame_buffer_from_pool(YV12_BUFFER_CONFIG *ybf, int width,
+                                       int height, int ss_x, int ss_y,
+                                       int use_highbitdepth, int border,
+                                       int byte_alignment,
+                                       aom_frame_buffer_pool_t *pool);
+
+// Sets the limit of the bytes allocated by pool, freeing unused allocations
+// as needed to stay below it. 0 means no limit.
+void aom_frame_buffer_pool_set_limit(aom_frame_buffer_pool_t *pool,
+                                     size_t max_bytes);
+
+// Frees the unused allocations of pool. The frame buffers allocated from pool
+// must have been freed first.
+void aom_free_frame_buffer_pool(aom_frame_buffer_pool_t *pool);
+
 /*!\endcond */
 /*!\brief Removes metadata from YUV_BUFFER_CONFIG struct.
  *
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "config/aom_config.h"
+
+#include "aom_mem/aom_mem.h"
+#include "aom_util/aom_row_progress.h"
+
+#if CONFIG_MULTITHREAD && CONFIG_ROW_SYNC_ATOMIC
+
+#if ARCH_X86 || ARCH_X86_64
+#include "aom_ports/x86.h"
+#define cpu_pause() x86_pause_hint()
+#else
+#define cpu_pause()
+#endif
+
+// Number of times a waiting thread polls the progress before blocking.
+#define SPIN_COUNT 1024
+
+#if defined(__GNUC__)
+static INLINE int load_acquire(int *p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static INLINE int load_seq_cst(int *p) {
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+static INLINE void store_seq_cst(int *p, int v) {
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+static INLINE void add_seq_cst(int *p, int v) {
+  __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+#elif defined(_MSC_VER)
+#include <intrin.h>
+// Interlocked operations are full memory barriers.
+static INLINE int load_seq_cst(int *p) {
+  return (int)_InterlockedOr((volatile long *)p, 0);
+}
+static INLINE int load_acquire(int *p) {
+#if ARCH_X86 || ARCH_X86_64
+  // x86 loads are not reordered with later loads and stores.
+  const int v = *(volatile int *)p;
+  _ReadWriteBarrier();
+  return v;
+#else
+  return load_seq_cst(p);
+#endif
+}
+static INLINE void store_seq_cst(int *p, int v) {
+  _InterlockedExchange((volatile long *)p, v);
+}
+static INLINE void add_seq_cst(int *p, int v) {
+  _InterlockedExchangeAdd((volatile long *)p, v);
+}
+#else
+#error "CONFIG_ROW_SYNC_ATOMIC requires GCC-style or MSVC atomic builtins."
+#endif
+
+#endif  // CONFIG_MULTITHREAD && CONFIG_ROW_SYNC_ATOMIC
+
+AVxRowProgress *aom_row_progress_alloc(int num_rows) {
+  const aom_mem_tag_t prev_tag = aom_mem_set_default_tag(AOM_MEM_TAG_ROW_MT);
+  AVxRowProgress *const progress =
+      (AVxRowProgress *)aom_calloc(num_rows, sizeof(*progress));
+  aom_mem_set_tag(prev_tag);
+  if (progress == NULL) return NULL;
+#if CONFIG_MULTITHREAD
+  for (int i = 0; i < num_rows; ++i) {
+    if (pthread_mutex_init(&progress[i].mutex, NULL)) {
+      aom_row_progress_free(progress, i);
+      return NULL;
+    }
+    if (pthread_cond_init(&progress[i].cond, NULL)) {
+      pthread_mutex_destroy(&progress[i].mutex);
+      aom_row_progress_free(progress, i);
+      return NULL;
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+  return progress;
+}
+
+void aom_row_progress_free(AVxRowProgress *progress, int num_rows) {
+  if (progress == NULL) return;
+#if CONFIG_MULTITHREAD
+  for (int i = 0; i < num_rows; ++i) {
+    pthread_cond_destroy(&progress[i].cond);
+    pthread_mutex_destroy(&progress[i].mutex);
+  }
+#else
+  (void)num_rows;
+#endif  // CONFIG_MULTITHREAD
+  aom_free(progress);
+}
+
+void aom_row_progress_reset(AVxRowProgress *progress, int num_rows, int value) {
+  for (int i = 0; i < num_rows; ++i) progress[i].value = value;
+}
+
+void aom_row_progress_set(AVxRowProgress *progress, int value) {
+#if CONFIG_MULTITHREAD
+#if CONFIG_ROW_SYNC_ATOMIC
+  // A waiter increments num_waiters before it checks the progress, so either
+  // it sees the new progress or this load sees it waiting.
+  store_seq_cst(&progress->value, value);
+  if (load_seq_cst(&progress->num_waiters) > 0) {
+    pthread_mutex_lock(&progress->mutex);
+    pthread_cond_broadcast(&progress->cond);
+    pthread_mutex_unlock(&progress->mutex);
+  }
+#else
+  pthread_mutex_lock(&progress->mutex);
+  progress->value = value;
+  pthread_cond_broadcast(&progress->cond);
+  pthread_mutex_unlock(&progress->mutex);
+#endif  // CONFIG_ROW_SYNC_ATOMIC
+#else
+  progress->value = value;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void aom_row_progress_wait(AVxRowProgress *progress, int value) {
+#if CONFIG_MULTITHREAD
+#if CONFIG_ROW_SYNC_ATOMIC
+  for (int i = 0; i < SPIN_COUNT; ++i) {
+    if (load_acquire(&progress->value) >= value) return;
+    cpu_pause();
+  }
+  pthread_mutex_lock(&progress->mutex);
+  add_seq_cst(&progress->num_waiters, 1);
+  while (load_seq_cst(&progress->value) < value)
+    pthread_cond_wait(&progress->cond, &progress->mutex);
+  add_seq_cst(&progress->num_waiters, -1);
+  pthread_mutex_unlock(&progress->mutex);
+#else
+  pthread_mutex_lock(&progress->mutex);
+  while (progress->value < value)
+    pthread_cond_wait(&progress->cond, &progress->mutex);
+  pthread_mutex_unlock(&progress->mutex);
+#endif  // CONFIG_ROW_SYNC_ATOMIC
+#else
+  (void)progress;
+  (void)value;
+#endif  // CONFIG_MULTITHREAD
+}
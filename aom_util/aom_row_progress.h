@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+//
+// Row progress counters
+//
+// Row-based multi-threading lets a row start a block once the row above has
+// progressed far enough. Each row publishes its progress in an AVxRowProgress
+// and the row below waits for it.
+//
+// With CONFIG_ROW_SYNC_ATOMIC, the progress is an atomic counter: publishing
+// it is a single store unless a thread is blocked on it, and a waiting thread
+// spins on it for a while before blocking on a condition variable. Otherwise,
+// every access to the progress takes the mutex of the row.
+
+#ifndef AOM_AOM_UTIL_AOM_ROW_PROGRESS_H_
+#define AOM_AOM_UTIL_AOM_ROW_PROGRESS_H_
+
+#include "aom_util/aom_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AVxRowProgress {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#if CONFIG_ROW_SYNC_ATOMIC
+  // Number of threads blocked on cond, accessed atomically.
+  int num_waiters;
+#endif
+#endif  // CONFIG_MULTITHREAD
+  // Accessed atomically with CONFIG_ROW_SYNC_ATOMIC.
+  int value;
+} AVxRowProgress;
+
+// Allocates and initializes num_rows counters. Returns NULL in case of error.
+AVxRowProgress *aom_row_progress_alloc(int num_rows);
+
+// Frees num_rows counters allocated with aom_row_progress_alloc(). progress
+// may be NULL.
+void aom_row_progress_free(AVxRowProgress *progress, int num_rows);
+
+// Sets num_rows counters to value. No thread may access them concurrently.
+void aom_row_progress_reset(AVxRowProgress *progress, int num_rows, int value);
+
+// Publishes the progress of a row and wakes up the threads waiting for it.
+void aom_row_progress_set(AVxRowProgress *progress, int value);
+
+// Waits until the progress of a row is at least value.
+void aom_row_progress_wait(AVxRowProgress *progress, int value);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_UTIL_AOM_ROW_PROGRESS_H_
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "aom_mem/aom_mem.h"
+#include "aom_util/aom_task_pool.h"
+
+#define INITIAL_DEQUE_CAPACITY 16
+
+typedef struct {
+  AVxWorkerHook hook;
+  void *data1;
+  void *data2;
+} AVxTask;
+
+// Circular buffer of tasks. The owner thread takes tasks from the back, other
+// threads steal them from the front.
+typedef struct {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+#endif
+  AVxTask *tasks;
+  int capacity;
+  int head;
+  int size;
+} TaskDeque;
+
+struct AVxTaskPool {
+  int num_threads;
+  // deques[0] belongs to the thread calling aom_task_pool_wait(), deques[i] to
+  // workers[i - 1].
+  TaskDeque *deques;
+  AVxWorker *workers;
+  int num_workers;
+  int next_deque;
+#if CONFIG_MULTITHREAD
+  // Protects the counters and flags below. cond is signaled when a task is
+  // queued, and broadcast when the last pending task finishes or the pool
+  // shuts down.
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif
+  // Tasks queued and not yet taken by a thread.
+  int num_queued;
+  // Tasks queued and not yet finished.
+  int num_pending;
+  int had_error;
+  int shutdown;
+};
+
+static void pool_lock(AVxTaskPool *pool) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pool->mutex);
+#else
+  (void)pool;
+#endif
+}
+
+static void pool_unlock(AVxTaskPool *pool) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&pool->mutex);
+#else
+  (void)pool;
+#endif
+}
+
+static void deque_lock(TaskDeque *deque) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&deque->mutex);
+#else
+  (void)deque;
+#endif
+}
+
+static void deque_unlock(TaskDeque *deque) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&deque->mutex);
+#else
+  (void)deque;
+#endif
+}
+
+static int deque_push_back(TaskDeque *deque, const AVxTask *task) {
+  deque_lock(deque);
+  if (deque->size == deque->capacity) {
+    const int capacity =
+        deque->capacity ? 2 * deque->capacity : INITIAL_DEQUE_CAPACITY;
+    AVxTask *const tasks = (AVxTask *)aom_malloc(capacity * sizeof(*tasks));
+    if (tasks == NULL) {
+      deque_unlock(deque);
+      return 0;
+    }
+    for (int i = 0; i < deque->size; ++i)
+      tasks[i] = deque->tasks[(deque->head + i) % deque->capacity];
+    aom_free(deque->tasks);
+    deque->tasks = tasks;
+    deque->capacity = capacity;
+    deque->head = 0;
+  }
+  deque->tasks[(deque->head + deque->size) % deque->capacity] = *task;
+  ++deque->size;
+  deque_unlock(deque);
+  return 1;
+}
+
+static int deque_pop_back(TaskDeque *deque, AVxTask *task) {
+  int found = 0;
+  deque_lock(deque);
+  if (deque->size > 0) {
+    --deque->size;
+    *task = deque->tasks[(deque->head + deque->size) % deque->capacity];
+    found = 1;
+  }
+  deque_unlock(deque);
+  return found;
+}
+
+static int deque_pop_front(TaskDeque *deque, AVxTask *task) {
+  int found = 0;
+  deque_lock(deque);
+  if (deque->size > 0) {
+    *task = deque->tasks[deque->head];
+    deque->head = (deque->head + 1) % deque->capacity;
+    --deque->size;
+    found = 1;
+  }
+  deque_unlock(deque);
+  return found;
+}
+
+// Takes a task from the deque of thread_idx, or steals one from another
+// thread. Returns false if all deques are empty.
+static int take_task(AVxTaskPool *pool, int thread_idx, AVxTask *task) {
+  int found = deque_pop_back(&pool->deques[thread_idx], task);
+  for (int i = 1; !found && i < pool->num_threads; ++i) {
+    found = deque_pop_front(
+        &pool->deques[(thread_idx + i) % pool->num_threads], task);
+  }
+  if (found) {
+    pool_lock(pool);
+    --pool->num_queued;
+    pool_unlock(pool);
+  }
+  return found;
+}
+
+static void run_task(AVxTaskPool *pool, const AVxTask *task) {
+  const int ok = task->hook(task->data1, task->data2);
+  pool_lock(pool);
+  pool->had_error |= !ok;
+  if (--pool->num_pending == 0) {
+#if CONFIG_MULTITHREAD
+    pthread_cond_broadcast(&pool->cond);
+#endif
+  }
+  pool_unlock(pool);
+}
+
+#if CONFIG_MULTITHREAD
+// Hook of the worker threads: runs tasks until the pool shuts down.
+static int worker_loop(void *arg1, void *arg2) {
+  AVxTaskPool *const pool = (AVxTaskPool *)arg1;
+  const int thread_idx = (int)((TaskDeque *)arg2 - pool->deques);
+  AVxTask task;
+  for (;;) {
+    if (take_task(pool, thread_idx, &task)) {
+      run_task(pool, &task);
+      continue;
+    }
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->shutdown && pool->num_queued == 0)
+      pthread_cond_wait(&pool->cond, &pool->mutex);
+    const int done = pool->shutdown && pool->num_queued == 0;
+    pthread_mutex_unlock(&pool->mutex);
+    if (done) break;
+  }
+  return 1;
+}
+#endif  // CONFIG_MULTITHREAD
+
+AVxTaskPool *aom_task_pool_create(int num_threads, const char *thread_name) {
+#if !CONFIG_MULTITHREAD
+  num_threads = 1;
+#endif
+  if (num_threads < 1 || num_threads > MAX_NUM_THREADS) return NULL;
+
+  AVxTaskPool *const pool = (AVxTaskPool *)aom_calloc(1, sizeof(*pool));
+  if (pool == NULL) return NULL;
+  pool->deques = (TaskDeque *)aom_calloc(num_threads, sizeof(*pool->deques));
+  if (pool->deques == NULL) {
+    aom_free(pool);
+    return NULL;
+  }
+#if CONFIG_MULTITHREAD
+  if (pthread_mutex_init(&pool->mutex, NULL)) {
+    aom_free(pool->deques);
+    aom_free(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->cond, NULL)) {
+    pthread_mutex_destroy(&pool->mutex);
+    aom_free(pool->deques);
+    aom_free(pool);
+    return NULL;
+  }
+  for (; pool->num_threads < num_threads; ++pool->num_threads) {
+    if (pthread_mutex_init(&pool->deques[pool->num_threads].mutex, NULL)) {
+      aom_task_pool_destroy(pool);
+      return NULL;
+    }
+  }
+
+  if (num_threads > 1) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    pool->workers =
+        (AVxWorker *)aom_malloc((num_threads - 1) * sizeof(*pool->workers));
+    if (pool->workers == NULL) {
+      aom_task_pool_destroy(pool);
+      return NULL;
+    }
+    for (; pool->num_workers < num_threads - 1; ++pool->num_workers) {
+      AVxWorker *const worker = &pool->workers[pool->num_workers];
+      winterface->init(worker);
+      worker->thread_name = thread_name;
+      worker->hook = worker_loop;
+      worker->data1 = pool;
+      worker->data2 = &pool->deques[pool->num_workers + 1];
+      if (!winterface->reset(worker)) {
+        aom_task_pool_destroy(pool);
+        return NULL;
+      }
+      winterface->launch(worker);
+    }
+  }
+#else
+  (void)thread_name;
+  pool->num_threads = num_threads;
+#endif  // CONFIG_MULTITHREAD
+  return pool;
+}
+
+void aom_task_pool_destroy(AVxTaskPool *pool) {
+  if (pool == NULL) return;
+  assert(pool->num_pending == 0);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pool->mutex);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  // end() waits for worker_loop() to return.
+  for (int i = 0; i < pool->num_workers; ++i)
+    winterface->end(&pool->workers[i]);
+  aom_free(pool->workers);
+  for (int i = 0; i < pool->num_threads; ++i)
+    pthread_mutex_destroy(&pool->deques[i].mutex);
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->mutex);
+#endif  // CONFIG_MULTITHREAD
+  for (int i = 0; i < pool->num_threads; ++i) aom_free(pool->deques[i].tasks);
+  aom_free(pool->deques);
+  aom_free(pool);
+}
+
+int aom_task_pool_num_threads(const AVxTaskPool *pool) {
+  return pool->num_threads;
+}
+
+int aom_task_pool_submit(AVxTaskPool *pool, AVxWorkerHook hook, void *data1,
+                         void *data2) {
+  const AVxTask task = { hook, data1, data2 };
+  pool_lock(pool);
+  const int deque_idx = pool->next_deque;
+  pool->next_deque = (pool->next_deque + 1) % pool->num_threads;
+  // Count the task before it can be taken, so that the counters never drop
+  // below the number of tasks actually queued or pending.
+  ++pool->num_queued;
+  ++pool->num_pending;
+  pool_unlock(pool);
+
+  const int ok = deque_push_back(&pool->deques[deque_idx], &task);
+
+  pool_lock(pool);
+  if (!ok) {
+    --pool->num_queued;
+    --pool->num_pending;
+  }
+#if CONFIG_MULTITHREAD
+  if (ok) pthread_cond_signal(&pool->cond);
+#endif
+  pool_unlock(pool);
+  return ok;
+}
+
+int aom_task_pool_wait(AVxTaskPool *pool) {
+  AVxTask task;
+  for (;;) {
+    if (take_task(pool, 0, &task)) {
+      run_task(pool, &task);
+      continue;
+    }
+    pool_lock(pool);
+    const int done = pool->num_pending == 0;
+#if CONFIG_MULTITHREAD
+    if (!done && pool->num_queued == 0)
+      pthread_cond_wait(&pool->cond, &pool->mutex);
+#endif
+    pool_unlock(pool);
+    if (done) break;
+  }
+
+  pool_lock(pool);
+  const int ok = !pool->had_error;
+  pool->had_error = 0;
+  pool_unlock(pool);
+  return ok;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+//
+// Work-stealing task pool
+//
+// Tasks are queued round-robin on one deque per thread. A thread runs the
+// tasks of its own deque newest first, and steals the oldest task of another
+// deque once its own is empty. The worker threads of the pool stay in the
+// pool between batches of tasks, so submitting a batch costs no thread launch
+// and a straggling task does not keep the other threads idle while tasks are
+// still queued.
+//
+// The worker threads are AVxWorkers, so the pool also runs on top of an
+// interface installed with aom_set_worker_interface(). Each of them stays in
+// its hook until the pool is destroyed, so launch() must not run the hook on
+// the calling thread.
+
+#ifndef AOM_AOM_UTIL_AOM_TASK_POOL_H_
+#define AOM_AOM_UTIL_AOM_TASK_POOL_H_
+
+#include "aom_util/aom_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AVxTaskPool AVxTaskPool;
+
+// Creates a pool running tasks on num_threads threads: the thread calling
+// aom_task_pool_wait() and num_threads - 1 worker threads. Without
+// CONFIG_MULTITHREAD, all tasks run in aom_task_pool_wait(). thread_name is
+// passed to the worker threads and must outlive the pool. Returns NULL in case
+// of error.
+AVxTaskPool *aom_task_pool_create(int num_threads, const char *thread_name);
+
+// Stops the worker threads and frees the pool. All tasks must be finished.
+void aom_task_pool_destroy(AVxTaskPool *pool);
+
+// Returns the number of threads tasks run on.
+int aom_task_pool_num_threads(const AVxTaskPool *pool);
+
+// Queues a task calling hook(data1, data2). Tasks may be submitted from
+// running tasks. Returns false in case of error, in which case the task is not
+// queued.
+int aom_task_pool_submit(AVxTaskPool *pool, AVxWorkerHook hook, void *data1,
+                         void *data2);
+
+// Runs tasks on the calling thread until all submitted tasks are finished.
+// Returns false if the hook of any of these tasks returned false. Must not be
+// called from a task.
+int aom_task_pool_wait(AVxTaskPool *pool);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_UTIL_AOM_TASK_POOL_H_
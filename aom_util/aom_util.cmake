@@ -13,7 +13,11 @@ if(AOM_AOM_UTIL_AOM_UTIL_CMAKE_)
 endif() # AOM_AOM_UTIL_AOM_UTIL_CMAKE_
 set(AOM_AOM_UTIL_AOM_UTIL_CMAKE_ 1)
 
-list(APPEND AOM_UTIL_SOURCES "${AOM_ROOT}/aom_util/aom_thread.c"
+list(APPEND AOM_UTIL_SOURCES "${AOM_ROOT}/aom_util/aom_row_progress.c"
+            "${AOM_ROOT}/aom_util/aom_row_progress.h"
+            "${AOM_ROOT}/aom_util/aom_task_pool.c"
+            "${AOM_ROOT}/aom_util/aom_task_pool.h"
+            "${AOM_ROOT}/aom_util/aom_thread.c"
             "${AOM_ROOT}/aom_util/aom_thread.h"
             "${AOM_ROOT}/aom_util/endian_inl.h"
             "${AOM_ROOT}/aom_util/debug_util.c"
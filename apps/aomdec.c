@@ -84,6 +84,10 @@ static const arg_def_t threadsarg =
     ARG_DEF("t", "threads", 1, "Max threads to use");
 static const arg_def_t rowmtarg =
     ARG_DEF(NULL, "row-mt", 1, "Enable row based multi-threading, default: 0");
+static const arg_def_t postfilteroverlaparg =
+    ARG_DEF(NULL, "postfilter-overlap", 1,
+            "Overlap post-filtering with row based multi-threaded decoding, "
+            "default: 0");
 static const arg_def_t verbosearg =
     ARG_DEF("v", "verbose", 0, "Show version string");
 static const arg_def_t scalearg =
@@ -114,7 +118,7 @@ static const arg_def_t *all_args[] = {
   &threadsarg,     &rowmtarg, &verbosearg,    &scalearg,
   &fb_arg,         &md5arg,   &framestatsarg, &continuearg,
   &outbitdeptharg, &isannexb, &oppointarg,    &outallarg,
-  &skipfilmgrain,  NULL
+  &skipfilmgrain,  &postfilteroverlaparg, NULL
 };
 
 #if CONFIG_LIBYUV
@@ -458,6 +462,7 @@ static int main_loop(int argc, const char **argv_) {
   int output_all_layers = 0;
   int skip_film_grain = 0;
   int enable_row_mt = 0;
+  int enable_postfilter_overlap = 0;
   aom_image_t *scaled_img = NULL;
   aom_image_t *img_shifted = NULL;
   int frame_avail, got_data, flush_decoder = 0;
@@ -556,6 +561,8 @@ static int main_loop(int argc, const char **argv_) {
 #endif
     } else if (arg_match(&arg, &rowmtarg, argi)) {
       enable_row_mt = arg_parse_uint(&arg);
+    } else if (arg_match(&arg, &postfilteroverlaparg, argi)) {
+      enable_postfilter_overlap = arg_parse_uint(&arg);
     } else if (arg_match(&arg, &verbosearg, argi)) {
       quiet = 0;
     } else if (arg_match(&arg, &scalearg, argi)) {
@@ -719,6 +726,13 @@ static int main_loop(int argc, const char **argv_) {
     goto fail;
   }
 
+  if (AOM_CODEC_CONTROL_TYPECHECKED(&decoder, AV1D_SET_POSTFILTER_OVERLAP,
+                                    enable_postfilter_overlap)) {
+    fprintf(stderr, "Failed to set post-filter overlap mode: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
+
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
   while (arg_skip) {
     if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
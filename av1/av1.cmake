@@ -334,6 +334,7 @@ endif()
 
 list(APPEND AOM_AV1_COMMON_INTRIN_AVX2
             "${AOM_ROOT}/av1/common/cdef_block_avx2.c"
+            "${AOM_ROOT}/av1/common/x86/av1_convolve_horiz_rs_avx2.c"
             "${AOM_ROOT}/av1/common/x86/av1_inv_txfm_avx2.c"
             "${AOM_ROOT}/av1/common/x86/av1_inv_txfm_avx2.h"
             "${AOM_ROOT}/av1/common/x86/cfl_avx2.c"
@@ -393,13 +394,16 @@ list(APPEND AOM_AV1_ENCODER_INTRIN_SSE4_1
             "${AOM_ROOT}/av1/encoder/x86/av1_fwd_txfm2d_sse4.c"
             "${AOM_ROOT}/av1/encoder/x86/av1_highbd_quantize_sse4.c"
             "${AOM_ROOT}/av1/encoder/x86/corner_match_sse4.c"
+            "${AOM_ROOT}/av1/encoder/x86/disflow_sse4.c"
             "${AOM_ROOT}/av1/encoder/x86/encodetxb_sse4.c"
             "${AOM_ROOT}/av1/encoder/x86/highbd_fwd_txfm_sse4.c"
             "${AOM_ROOT}/av1/encoder/x86/rdopt_sse4.c"
-            "${AOM_ROOT}/av1/encoder/x86/pickrst_sse4.c")
+            "${AOM_ROOT}/av1/encoder/x86/pickrst_sse4.c"
+            "${AOM_ROOT}/av1/encoder/x86/ransac_sse4.c")
 
 if(CONFIG_REALTIME_ONLY)
   list(REMOVE_ITEM AOM_AV1_ENCODER_INTRIN_SSE4_1
+                   "${AOM_ROOT}/av1/encoder/x86/disflow_sse4.c"
                    "${AOM_ROOT}/av1/encoder/x86/pickrst_sse4.c")
 endif()
 
@@ -407,6 +411,8 @@ list(APPEND AOM_AV1_ENCODER_INTRIN_AVX2
             "${AOM_ROOT}/av1/encoder/x86/av1_quantize_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/av1_highbd_quantize_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/corner_match_avx2.c"
+            "${AOM_ROOT}/av1/encoder/x86/ransac_avx2.c"
+            "${AOM_ROOT}/av1/encoder/x86/disflow_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/error_intrin_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/highbd_block_error_intrin_avx2.c"
             "${AOM_ROOT}/av1/encoder/x86/av1_fwd_txfm_avx2.h"
@@ -429,6 +435,7 @@ endif()
 
 if(CONFIG_REALTIME_ONLY)
   list(REMOVE_ITEM AOM_AV1_ENCODER_INTRIN_AVX2
+                   "${AOM_ROOT}/av1/encoder/x86/disflow_avx2.c"
                    "${AOM_ROOT}/av1/encoder/x86/pickrst_avx2.c")
 endif()
 
@@ -449,6 +456,7 @@ list(APPEND AOM_AV1_ENCODER_INTRIN_MSA
             "${AOM_ROOT}/av1/encoder/mips/msa/temporal_filter_msa.c")
 
 list(APPEND AOM_AV1_COMMON_INTRIN_NEON
+            "${AOM_ROOT}/av1/common/arm/av1_convolve_horiz_rs_neon.c"
             "${AOM_ROOT}/av1/common/arm/av1_txfm_neon.c"
             "${AOM_ROOT}/av1/common/arm/cfl_neon.c"
             "${AOM_ROOT}/av1/common/arm/convolve_neon.c"
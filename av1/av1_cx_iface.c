@@ -310,6 +310,10 @@ struct aom_codec_alg_priv {
   // Number of stats buffers required for look ahead
   int num_lap_buffers;
   STATS_BUFFER_CTX stats_buf_context;
+  // Release callback of the input images used in place, if release_cb is set.
+  aom_zero_copy_input_t zero_copy_input;
+  // Allocations of the frame buffers of cpi and cpi_lap.
+  aom_frame_buffer_pool_t fb_pool;
 };
 
 static INLINE int gcd(int64_t a, int b) {
@@ -1947,7 +1951,8 @@ static aom_codec_err_t create_stats_buffer(FIRSTPASS_STATS **frame_stats_buffer,
 #endif
 
 static aom_codec_err_t create_context_and_bufferpool(
-    AV1_COMP **p_cpi, BufferPool **p_buffer_pool, AV1EncoderConfig *oxcf,
+    AV1_COMP **p_cpi, BufferPool **p_buffer_pool,
+    aom_frame_buffer_pool_t *fb_pool, AV1EncoderConfig *oxcf,
     struct aom_codec_pkt_list *pkt_list_head, FIRSTPASS_STATS *frame_stats_buf,
     COMPRESSOR_STAGE stage, int num_lap_buffers, int lap_lag_in_frames,
     STATS_BUFFER_CTX *stats_buf_context) {
@@ -1961,9 +1966,9 @@ static aom_codec_err_t create_context_and_bufferpool(
     return AOM_CODEC_MEM_ERROR;
   }
 #endif
-  *p_cpi = av1_create_compressor(oxcf, *p_buffer_pool, frame_stats_buf, stage,
-                                 num_lap_buffers, lap_lag_in_frames,
-                                 stats_buf_context);
+  *p_cpi = av1_create_compressor(oxcf, *p_buffer_pool, fb_pool,
+                                 frame_stats_buf, stage, num_lap_buffers,
+                                 lap_lag_in_frames, stats_buf_context);
   if (*p_cpi == NULL)
     res = AOM_CODEC_MEM_ERROR;
   else
@@ -1990,6 +1995,9 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx) {
 
     priv->extra_cfg = default_extra_cfg;
     aom_once(av1_initialize_enc);
+    // The tracker is part of priv, so the caller cannot set it up for init.
+    aom_mem_tracker_t *const prev_tracker =
+        aom_mem_set_tracker(&priv->base.mem_tracker);
 
     res = validate_config(priv, &priv->cfg, &priv->extra_cfg);
 
@@ -2022,23 +2030,27 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx) {
 #if !CONFIG_REALTIME_ONLY
       res = create_stats_buffer(&priv->frame_stats_buffer,
                                 &priv->stats_buf_context, *num_lap_buffers);
-      if (res != AOM_CODEC_OK) return AOM_CODEC_MEM_ERROR;
+      if (res != AOM_CODEC_OK) {
+        aom_mem_set_tracker(prev_tracker);
+        return AOM_CODEC_MEM_ERROR;
+      }
 #endif
 
       res = create_context_and_bufferpool(
-          &priv->cpi, &priv->buffer_pool, &priv->oxcf, &priv->pkt_list.head,
-          priv->frame_stats_buffer, ENCODE_STAGE, *num_lap_buffers, -1,
-          &priv->stats_buf_context);
+          &priv->cpi, &priv->buffer_pool, &priv->fb_pool, &priv->oxcf,
+          &priv->pkt_list.head, priv->frame_stats_buffer, ENCODE_STAGE,
+          *num_lap_buffers, -1, &priv->stats_buf_context);
 
       // Create another compressor if look ahead is enabled
       if (res == AOM_CODEC_OK && *num_lap_buffers) {
         res = create_context_and_bufferpool(
-            &priv->cpi_lap, &priv->buffer_pool_lap, &priv->oxcf, NULL,
-            priv->frame_stats_buffer, LAP_STAGE, *num_lap_buffers,
-            clamp(lap_lag_in_frames, 0, MAX_LAG_BUFFERS),
+            &priv->cpi_lap, &priv->buffer_pool_lap, &priv->fb_pool,
+            &priv->oxcf, NULL, priv->frame_stats_buffer, LAP_STAGE,
+            *num_lap_buffers, clamp(lap_lag_in_frames, 0, MAX_LAG_BUFFERS),
             &priv->stats_buf_context);
       }
     }
+    aom_mem_set_tracker(prev_tracker);
   }
 
   return res;
@@ -2070,6 +2082,7 @@ static aom_codec_err_t encoder_destroy(aom_codec_alg_priv_t *ctx) {
     ctx->cpi_lap->lookahead = NULL;
     destroy_context_and_bufferpool(ctx->cpi_lap, ctx->buffer_pool_lap);
   }
+  aom_free_frame_buffer_pool(&ctx->fb_pool);
   destroy_stats_buffer(&ctx->stats_buf_context, ctx->frame_stats_buffer);
   aom_free(ctx);
   return AOM_CODEC_OK;
@@ -2221,7 +2234,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
             cpi->oxcf.frm_dim_cfg.width, cpi->oxcf.frm_dim_cfg.height,
             subsampling_x, subsampling_y, use_highbitdepth, lag_in_frames,
             cpi->oxcf.border_in_pixels, cpi->common.features.byte_alignment,
-            ctx->num_lap_buffers);
+            ctx->num_lap_buffers, &ctx->fb_pool);
       }
       if (!cpi->lookahead)
         aom_internal_error(&cpi->common.error, AOM_CODEC_MEM_ERROR,
@@ -2235,10 +2248,20 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
                                 subsampling_y);
       }
 
+      struct lookahead_borrow borrow;
+      if (ctx->zero_copy_input.release_cb) {
+        borrow.buf_start = img->img_data;
+        borrow.buf_size = img->sz;
+        borrow.release = ctx->zero_copy_input;
+        borrow.user_priv = img->user_priv;
+      }
+
       // Store the original flags in to the frame buffer. Will extract the
       // key frame flag when we actually encode this frame.
-      if (av1_receive_raw_frame(cpi, flags | ctx->next_frame_flags, &sd,
-                                src_time_stamp, src_end_time_stamp)) {
+      if (av1_receive_raw_frame(
+              cpi, flags | ctx->next_frame_flags, &sd, src_time_stamp,
+              src_end_time_stamp,
+              ctx->zero_copy_input.release_cb ? &borrow : NULL)) {
         res = update_error_state(ctx, &cpi->common.error);
       }
       ctx->next_frame_flags = 0;
@@ -2289,6 +2312,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
       if (cpi_lap->mt_info.workers == NULL) {
         cpi_lap->mt_info.workers = cpi->mt_info.workers;
         cpi_lap->mt_info.tile_thr_data = cpi->mt_info.tile_thr_data;
+        cpi_lap->mt_info.task_pool = cpi->mt_info.task_pool;
       }
       cpi_lap->mt_info.num_workers = cpi->mt_info.num_workers;
       const int status = av1_get_compressed_data(
@@ -2526,6 +2550,19 @@ static aom_codec_err_t ctrl_copy_new_frame_image(aom_codec_alg_priv_t *ctx,
   }
 }
 
+static aom_codec_err_t ctrl_get_memory_usage(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  aom_memory_usage_t *const usage = va_arg(args, aom_memory_usage_t *);
+  if (usage == NULL) return AOM_CODEC_INVALID_PARAM;
+#if CONFIG_MEM_TRACKING
+  aom_mem_get_usage(&ctx->base.mem_tracker, usage);
+  return AOM_CODEC_OK;
+#else
+  (void)ctx;
+  return AOM_CODEC_INCAPABLE;
+#endif
+}
+
 static aom_image_t *encoder_get_preview(aom_codec_alg_priv_t *ctx) {
   YV12_BUFFER_CONFIG sd;
 
@@ -2680,6 +2717,41 @@ static aom_codec_err_t ctrl_set_svc_ref_frame_config(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_zero_copy_input(aom_codec_alg_priv_t *ctx,
+                                                va_list args) {
+  const aom_zero_copy_input_t *const data =
+      va_arg(args, aom_zero_copy_input_t *);
+  if (data && data->release_cb) {
+    ctx->zero_copy_input = *data;
+  } else {
+    memset(&ctx->zero_copy_input, 0, sizeof(ctx->zero_copy_input));
+  }
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_max_frame_buffer_memory(
+    aom_codec_alg_priv_t *ctx, va_list args) {
+  const unsigned int max_mib = CAST(AV1E_SET_MAX_FRAME_BUFFER_MEMORY, args);
+  const uint64_t max_bytes = (uint64_t)max_mib << 20;
+  if (max_bytes != (size_t)max_bytes) return AOM_CODEC_INVALID_PARAM;
+  aom_frame_buffer_pool_set_limit(&ctx->fb_pool, (size_t)max_bytes);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_frame_buffer_memory(aom_codec_alg_priv_t *ctx,
+                                                    va_list args) {
+  aom_frame_buffer_memory_t *const arg =
+      va_arg(args, aom_frame_buffer_memory_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  const aom_frame_buffer_pool_t *const pool = &ctx->fb_pool;
+  arg->current_bytes = pool->allocated_bytes;
+  arg->peak_bytes = pool->peak_bytes;
+  arg->unused_bytes = pool->allocated_bytes - pool->in_use_bytes;
+  arg->num_allocs = pool->num_allocs;
+  arg->num_reuses = pool->num_reuses;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_tune_content(aom_codec_alg_priv_t *ctx,
                                              va_list args) {
   struct av1_extracfg extra_cfg = ctx->extra_cfg;
@@ -2893,6 +2965,8 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_SET_SVC_PARAMS, ctrl_set_svc_params },
   { AV1E_SET_SVC_REF_FRAME_CONFIG, ctrl_set_svc_ref_frame_config },
   { AV1E_SET_VBR_CORPUS_COMPLEXITY_LAP, ctrl_set_vbr_corpus_complexity_lap },
+  { AV1E_SET_ZERO_COPY_INPUT, ctrl_set_zero_copy_input },
+  { AV1E_SET_MAX_FRAME_BUFFER_MEMORY, ctrl_set_max_frame_buffer_memory },
   { AV1E_ENABLE_SB_MULTIPASS_UNIT_TEST, ctrl_enable_sb_multipass_unit_test },
 
   // Getters
@@ -2902,10 +2976,12 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_GET_ACTIVEMAP, ctrl_get_active_map },
   { AV1_GET_NEW_FRAME_IMAGE, ctrl_get_new_frame_image },
   { AV1_COPY_NEW_FRAME_IMAGE, ctrl_copy_new_frame_image },
+  { AV1_GET_MEMORY_USAGE, ctrl_get_memory_usage },
   { AV1E_SET_CHROMA_SUBSAMPLING_X, ctrl_set_chroma_subsampling_x },
   { AV1E_SET_CHROMA_SUBSAMPLING_Y, ctrl_set_chroma_subsampling_y },
   { AV1E_GET_SEQ_LEVEL_IDX, ctrl_get_seq_level_idx },
   { AV1E_GET_BASELINE_GF_INTERVAL, ctrl_get_baseline_gf_interval },
+  { AV1E_GET_FRAME_BUFFER_MEMORY, ctrl_get_frame_buffer_memory },
 
   CTRL_MAP_END,
 };
@@ -52,6 +52,7 @@ struct aom_codec_alg_priv {
   unsigned int tile_mode;
   unsigned int ext_tile_debug;
   unsigned int row_mt;
+  unsigned int postfilter_overlap;
   EXTERNAL_REFERENCES ext_refs;
   unsigned int is_annexb;
   int operating_point;
@@ -469,6 +470,7 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   frame_worker_data->pbi->output_all_layers = ctx->output_all_layers;
   frame_worker_data->pbi->ext_tile_debug = ctx->ext_tile_debug;
   frame_worker_data->pbi->row_mt = ctx->row_mt;
+  frame_worker_data->pbi->postfilter_overlap = ctx->postfilter_overlap;
   frame_worker_data->pbi->is_fwd_kf_present = 0;
   frame_worker_data->pbi->is_arf_frame_present = 0;
   worker->hook = frame_worker_hook;
@@ -516,6 +518,7 @@ static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
   frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
   frame_worker_data->pbi->ext_tile_debug = ctx->ext_tile_debug;
   frame_worker_data->pbi->row_mt = ctx->row_mt;
+  frame_worker_data->pbi->postfilter_overlap = ctx->postfilter_overlap;
   frame_worker_data->pbi->ext_refs = ctx->ext_refs;
 
   frame_worker_data->pbi->is_annexb = ctx->is_annexb;
@@ -688,9 +691,10 @@ static void *AllocWithGetFrameBufferCb(void *priv, size_t size) {
 }
 
 // If grain_params->apply_grain is false, returns img. Otherwise, adds film
-// grain to img, saves the result in grain_img, and returns grain_img.
+// grain to img, saves the result in grain_img, and returns grain_img. The
+// grain is added on the tile workers of pbi, which are idle at this point.
 static aom_image_t *add_grain_if_needed(aom_codec_alg_priv_t *ctx,
-                                        aom_image_t *img,
+                                        AV1Decoder *pbi, aom_image_t *img,
                                         aom_image_t *grain_img,
                                         aom_film_grain_t *grain_params) {
   if (!grain_params->apply_grain) return img;
@@ -711,7 +715,8 @@ static aom_image_t *add_grain_if_needed(aom_codec_alg_priv_t *ctx,
 
   grain_img->user_priv = img->user_priv;
   grain_img->fb_priv = fb->priv;
-  if (av1_add_film_grain(grain_params, img, grain_img)) {
+  if (av1_add_film_grain_mt(grain_params, img, grain_img, pbi->tile_workers,
+                            pbi->num_workers)) {
     pool->release_fb_cb(pool->cb_priv, fb);
     return NULL;
   }
@@ -821,7 +826,8 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
         img->spatial_id = cm->spatial_layer_id;
         if (pbi->skip_film_grain) grain_params->apply_grain = 0;
         aom_image_t *res =
-            add_grain_if_needed(ctx, img, &ctx->image_with_grain, grain_params);
+            add_grain_if_needed(ctx, pbi, img, &ctx->image_with_grain,
+                                grain_params);
         if (!res) {
           aom_internal_error(&pbi->common.error, AOM_CODEC_CORRUPT_FRAME,
                              "Grain systhesis failed\n");
@@ -943,6 +949,19 @@ static aom_codec_err_t ctrl_copy_new_frame_image(aom_codec_alg_priv_t *ctx,
   }
 }
 
+static aom_codec_err_t ctrl_get_memory_usage(aom_codec_alg_priv_t *ctx,
+                                             va_list args) {
+  aom_memory_usage_t *const usage = va_arg(args, aom_memory_usage_t *);
+  if (usage == NULL) return AOM_CODEC_INVALID_PARAM;
+#if CONFIG_MEM_TRACKING
+  aom_mem_get_usage(&ctx->base.mem_tracker, usage);
+  return AOM_CODEC_OK;
+#else
+  (void)ctx;
+  return AOM_CODEC_INCAPABLE;
+#endif
+}
+
 static aom_codec_err_t ctrl_get_last_ref_updates(aom_codec_alg_priv_t *ctx,
                                                  va_list args) {
   int *const update_info = va_arg(args, int *);
@@ -1506,6 +1525,12 @@ static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_postfilter_overlap(aom_codec_alg_priv_t *ctx,
+                                                   va_list args) {
+  ctx->postfilter_overlap = va_arg(args, unsigned int);
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -1525,6 +1550,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1D_SET_ROW_MT, ctrl_set_row_mt },
   { AV1D_SET_EXT_REF_PTR, ctrl_set_ext_ref_ptr },
   { AV1D_SET_SKIP_FILM_GRAIN, ctrl_set_skip_film_grain },
+  { AV1D_SET_POSTFILTER_OVERLAP, ctrl_set_postfilter_overlap },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -1539,6 +1565,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_GET_ACCOUNTING, ctrl_get_accounting },
   { AV1_GET_NEW_FRAME_IMAGE, ctrl_get_new_frame_image },
   { AV1_COPY_NEW_FRAME_IMAGE, ctrl_copy_new_frame_image },
+  { AV1_GET_MEMORY_USAGE, ctrl_get_memory_usage },
   { AV1_GET_REFERENCE, ctrl_get_reference },
   { AV1D_GET_FRAME_HEADER_INFO, ctrl_get_frame_header_info },
   { AV1D_GET_TILE_DATA, ctrl_get_tile_data },
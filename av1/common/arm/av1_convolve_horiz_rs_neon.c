@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+#include <arm_neon.h>
+#include <assert.h>
+
+#include "av1/common/convolve.h"
+#include "av1/common/resize.h"
+#include "config/av1_rtcd.h"
+
+// Returns the 8-tap dot product of s and f, split across two 32-bit lanes.
+static INLINE int32x2_t dot_8tap(const int16x8_t s, const int16x8_t f) {
+  int32x4_t sum = vmull_s16(vget_low_s16(s), vget_low_s16(f));
+  sum = vmlal_s16(sum, vget_high_s16(s), vget_high_s16(f));
+  return vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+}
+
+// Filters 4 output pixels and returns the sums rounded by FILTER_BITS and
+// saturated to 16 bits.
+static INLINE uint16x4_t convolve_4(const int16x8_t s0, const int16x8_t s1,
+                                    const int16x8_t s2, const int16x8_t s3,
+                                    const int16x8_t *f) {
+  const int32x2_t sum01 = vpadd_s32(dot_8tap(s0, f[0]), dot_8tap(s1, f[1]));
+  const int32x2_t sum23 = vpadd_s32(dot_8tap(s2, f[2]), dot_8tap(s3, f[3]));
+  return vqrshrun_n_s32(vcombine_s32(sum01, sum23), FILTER_BITS);
+}
+
+static INLINE void load_filters_8(const int16_t *x_filters, int x_qn,
+                                  int x_step_qn, int16x8_t *f, int *src_x) {
+  for (int k = 0; k < 8; ++k, x_qn += x_step_qn) {
+    const int x_filter_idx =
+        (x_qn & RS_SCALE_SUBPEL_MASK) >> RS_SCALE_EXTRA_BITS;
+    assert(x_filter_idx <= RS_SUBPEL_MASK);
+    f[k] = vld1q_s16(&x_filters[x_filter_idx * UPSCALE_NORMATIVE_TAPS]);
+    src_x[k] = x_qn >> RS_SCALE_SUBPEL_BITS;
+  }
+}
+
+static INLINE int16x8_t load_u8_8tap(const uint8_t *s) {
+  return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(s)));
+}
+
+// The last (w % 8) pixels of each row are computed with the C filter, so this
+// function never writes past the crop width.
+void av1_convolve_horiz_rs_neon(const uint8_t *src, int src_stride,
+                                uint8_t *dst, int dst_stride, int w, int h,
+                                const int16_t *x_filters, int x0_qn,
+                                int x_step_qn) {
+  assert(UPSCALE_NORMATIVE_TAPS == 8);
+
+  const uint8_t *const src_in = src;
+  src -= UPSCALE_NORMATIVE_TAPS / 2 - 1;
+
+  int x_qn = x0_qn;
+  int x = 0;
+  for (; x + 8 <= w; x += 8, x_qn += 8 * x_step_qn) {
+    int16x8_t f[8];
+    int src_x[8];
+    load_filters_8(x_filters, x_qn, x_step_qn, f, src_x);
+
+    const uint8_t *src_y = src;
+    uint8_t *dst_y = dst;
+    for (int y = 0; y < h; y++, src_y += src_stride, dst_y += dst_stride) {
+      const uint16x4_t res_lo = convolve_4(
+          load_u8_8tap(&src_y[src_x[0]]), load_u8_8tap(&src_y[src_x[1]]),
+          load_u8_8tap(&src_y[src_x[2]]), load_u8_8tap(&src_y[src_x[3]]),
+          &f[0]);
+      const uint16x4_t res_hi = convolve_4(
+          load_u8_8tap(&src_y[src_x[4]]), load_u8_8tap(&src_y[src_x[5]]),
+          load_u8_8tap(&src_y[src_x[6]]), load_u8_8tap(&src_y[src_x[7]]),
+          &f[4]);
+      vst1_u8(&dst_y[x], vqmovn_u16(vcombine_u16(res_lo, res_hi)));
+    }
+  }
+
+  if (x < w) {
+    av1_convolve_horiz_rs_c(src_in, src_stride, dst + x, dst_stride, w - x, h,
+                            x_filters, x_qn, x_step_qn);
+  }
+}
+
+static INLINE int16x8_t load_u16_8tap(const uint16_t *s) {
+  return vreinterpretq_s16_u16(vld1q_u16(s));
+}
+
+// The last (w % 8) pixels of each row are computed with the C filter, so this
+// function never writes past the crop width.
+void av1_highbd_convolve_horiz_rs_neon(const uint16_t *src, int src_stride,
+                                       uint16_t *dst, int dst_stride, int w,
+                                       int h, const int16_t *x_filters,
+                                       int x0_qn, int x_step_qn, int bd) {
+  assert(UPSCALE_NORMATIVE_TAPS == 8);
+  assert(bd == 8 || bd == 10 || bd == 12);
+
+  const uint16_t *const src_in = src;
+  src -= UPSCALE_NORMATIVE_TAPS / 2 - 1;
+
+  const uint16x8_t clip_maximum = vdupq_n_u16((1 << bd) - 1);
+
+  int x_qn = x0_qn;
+  int x = 0;
+  for (; x + 8 <= w; x += 8, x_qn += 8 * x_step_qn) {
+    int16x8_t f[8];
+    int src_x[8];
+    load_filters_8(x_filters, x_qn, x_step_qn, f, src_x);
+
+    const uint16_t *src_y = src;
+    uint16_t *dst_y = dst;
+    for (int y = 0; y < h; y++, src_y += src_stride, dst_y += dst_stride) {
+      const uint16x4_t res_lo = convolve_4(
+          load_u16_8tap(&src_y[src_x[0]]), load_u16_8tap(&src_y[src_x[1]]),
+          load_u16_8tap(&src_y[src_x[2]]), load_u16_8tap(&src_y[src_x[3]]),
+          &f[0]);
+      const uint16x4_t res_hi = convolve_4(
+          load_u16_8tap(&src_y[src_x[4]]), load_u16_8tap(&src_y[src_x[5]]),
+          load_u16_8tap(&src_y[src_x[6]]), load_u16_8tap(&src_y[src_x[7]]),
+          &f[4]);
+      vst1q_u16(&dst_y[x],
+                vminq_u16(vcombine_u16(res_lo, res_hi), clip_maximum));
+    }
+  }
+
+  if (x < w) {
+    av1_highbd_convolve_horiz_rs_c(src_in, src_stride, dst + x, dst_stride,
+                                   w - x, h, x_filters, x_qn, x_step_qn, bd);
+  }
+}
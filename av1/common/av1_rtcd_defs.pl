@@ -88,11 +88,11 @@ if ($opts{arch} eq "x86_64") {
 }
 
 add_proto qw/void av1_convolve_horiz_rs/, "const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int w, int h, const int16_t *x_filters, int x0_qn, int x_step_qn";
-specialize qw/av1_convolve_horiz_rs sse4_1/;
+specialize qw/av1_convolve_horiz_rs sse4_1 avx2 neon/;
 
 if(aom_config("CONFIG_AV1_HIGHBITDEPTH") eq "yes") {
   add_proto qw/void av1_highbd_convolve_horiz_rs/, "const uint16_t *src, int src_stride, uint16_t *dst, int dst_stride, int w, int h, const int16_t *x_filters, int x0_qn, int x_step_qn, int bd";
-  specialize qw/av1_highbd_convolve_horiz_rs sse4_1/;
+  specialize qw/av1_highbd_convolve_horiz_rs sse4_1 avx2 neon/;
 
   add_proto qw/void av1_highbd_wiener_convolve_add_src/, "const uint8_t *src, ptrdiff_t src_stride, uint8_t *dst, ptrdiff_t dst_stride, const int16_t *filter_x, int x_step_q4, const int16_t *filter_y, int y_step_q4, int w, int h, const ConvolveParams *conv_params, int bd";
   specialize qw/av1_highbd_wiener_convolve_add_src ssse3 avx2/;
@@ -471,6 +471,21 @@ if (aom_config("CONFIG_REALTIME_ONLY") ne "yes") {
 if (aom_config("CONFIG_AV1_ENCODER") eq "yes") {
   add_proto qw/double av1_compute_cross_correlation/, "unsigned char *im1, int stride1, int x1, int y1, unsigned char *im2, int stride2, int x2, int y2";
   specialize qw/av1_compute_cross_correlation sse4_1 avx2/;
+
+  add_proto qw/int av1_ransac_find_inliers/, "const double *mat, const double *points1, const double *points2, int npoints, int min_inliers, int *inlier_indices, double *inlier_distances";
+  specialize qw/av1_ransac_find_inliers sse4_1 avx2/;
+}
+
+# DISFLOW functions
+if (aom_config("CONFIG_AV1_ENCODER") eq "yes" && aom_config("CONFIG_REALTIME_ONLY") ne "yes") {
+  add_proto qw/void av1_convolve_2d_sobel_y/, "const uint8_t *src, int src_stride, double *dst, int dst_stride, int w, int h, int dir, double norm";
+  specialize qw/av1_convolve_2d_sobel_y sse4_1/;
+
+  add_proto qw/double av1_compute_warp_and_error/, "const uint8_t *ref, const uint8_t *frm, int width, int height, int stride, int x, int y, double u, double v, int16_t *dt";
+  specialize qw/av1_compute_warp_and_error sse4_1 avx2/;
+
+  add_proto qw/void av1_compute_flow_system/, "const double *dx, int dx_stride, const double *dy, int dy_stride, const int16_t *dt, int dt_stride, double *M, double *b";
+  specialize qw/av1_compute_flow_system sse4_1 avx2/;
 }
 
 # LOOP_RESTORATION functions
@@ -87,7 +87,7 @@ void cdef_copy_rect8_16bit_to_16bit_c(uint16_t *dst, int dstride,
   }
 }
 
-static void copy_sb8_16(AV1_COMMON *cm, uint16_t *dst, int dstride,
+static void copy_sb8_16(const AV1_COMMON *cm, uint16_t *dst, int dstride,
                         const uint8_t *src, int src_voffset, int src_hoffset,
                         int sstride, int vsize, int hsize) {
   if (cm->seq_params.use_highbitdepth) {
@@ -118,16 +118,54 @@ static INLINE void copy_rect(uint16_t *dst, int dstride, const uint16_t *src,
   }
 }
 
-void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
-                    MACROBLOCKD *xd) {
+static INLINE int get_linebuf_stride(const AV1_COMMON *const cm) {
+  return (cm->mi_params.mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
+}
+
+uint16_t *av1_cdef_alloc_linebuf(const AV1_COMMON *const cm) {
+  const int nvfb = (cm->mi_params.mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  return aom_malloc(sizeof(uint16_t) * 2 * CDEF_VBORDER * nvfb *
+                    get_linebuf_stride(cm));
+}
+
+uint16_t *av1_cdef_alloc_colbuf(const AV1_COMMON *const cm, int plane) {
+  const int is_uv = plane > 0;
+  const int mi_high_l2 =
+      MI_SIZE_LOG2 - (is_uv ? cm->seq_params.subsampling_y : 0);
+  return aom_malloc(sizeof(uint16_t) *
+                    ((CDEF_BLOCKSIZE << mi_high_l2) + 2 * CDEF_VBORDER) *
+                    CDEF_HBORDER);
+}
+
+void av1_cdef_init_fb_row(const AV1_COMMON *const cm,
+                          const MACROBLOCKD *const xd, uint16_t **linebuf,
+                          int fbr) {
+  const CommonModeInfoParams *const mi_params = &cm->mi_params;
+  const int nvfb = (mi_params->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  const int stride = get_linebuf_stride(cm);
+  if (fbr == nvfb - 1) return;
+
+  for (int pli = 0; pli < av1_num_planes(cm); pli++) {
+    const int mi_wide_l2 = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
+    const int mi_high_l2 = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
+    // The last CDEF_VBORDER lines of this filter block row and the first
+    // CDEF_VBORDER lines of the next one. The row on the right of the frame
+    // may be read up to CDEF_HBORDER pixels past the last mi column.
+    copy_sb8_16(cm, &linebuf[pli][fbr * 2 * CDEF_VBORDER * stride], stride,
+                xd->plane[pli].dst.buf,
+                (MI_SIZE_64X64 << mi_high_l2) * (fbr + 1) - CDEF_VBORDER, 0,
+                xd->plane[pli].dst.stride, 2 * CDEF_VBORDER,
+                (mi_params->mi_cols << mi_wide_l2) + CDEF_HBORDER);
+  }
+}
+
+void av1_cdef_fb_row(const AV1_COMMON *const cm, MACROBLOCKD *xd,
+                     uint16_t **linebuf, uint16_t **colbuf, uint16_t *src,
+                     int fbr) {
   const CdefInfo *const cdef_info = &cm->cdef_info;
   const CommonModeInfoParams *const mi_params = &cm->mi_params;
   const int num_planes = av1_num_planes(cm);
-  DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-  uint16_t *linebuf[3];
-  uint16_t *colbuf[3];
   cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-  unsigned char *row_cdef, *prev_row_cdef, *curr_row_cdef;
   int cdef_count;
   int dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
   int var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
@@ -138,249 +176,238 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   int coeff_shift = AOMMAX(cm->seq_params.bit_depth - 8, 0);
   const int nvfb = (mi_params->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
   const int nhfb = (mi_params->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0,
-                       num_planes);
-  row_cdef = aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-  memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-  prev_row_cdef = row_cdef + 1;
-  curr_row_cdef = prev_row_cdef + nhfb + 2;
+  const int stride = get_linebuf_stride(cm);
+  uint16_t *top_linebuf[3] = { NULL, NULL, NULL };
+  uint16_t *bot_linebuf[3] = { NULL, NULL, NULL };
   for (int pli = 0; pli < num_planes; pli++) {
     xdec[pli] = xd->plane[pli].subsampling_x;
     ydec[pli] = xd->plane[pli].subsampling_y;
     mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
     mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
+    // Unfiltered lines above and below this filter block row, saved by
+    // av1_cdef_init_fb_row() before the neighbouring rows were filtered.
+    if (fbr > 0)
+      top_linebuf[pli] = &linebuf[pli][(fbr - 1) * 2 * CDEF_VBORDER * stride];
+    if (fbr < nvfb - 1)
+      bot_linebuf[pli] =
+          &linebuf[pli][(fbr * 2 + 1) * CDEF_VBORDER * stride];
   }
-  const int stride = (mi_params->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
   for (int pli = 0; pli < num_planes; pli++) {
-    linebuf[pli] = aom_malloc(sizeof(*linebuf) * CDEF_VBORDER * stride);
-    colbuf[pli] =
-        aom_malloc(sizeof(*colbuf) *
-                   ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) *
-                   CDEF_HBORDER);
+    const int block_height =
+        (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
+    fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
+              CDEF_VERY_LARGE);
   }
-  for (int fbr = 0; fbr < nvfb; fbr++) {
-    for (int pli = 0; pli < num_planes; pli++) {
-      const int block_height =
-          (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-      fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
-                CDEF_VERY_LARGE);
+  int cdef_left = 1;
+  for (int fbc = 0; fbc < nhfb; fbc++) {
+    int level, sec_strength;
+    int uv_level, uv_sec_strength;
+    int nhb, nvb;
+    int cstart = 0;
+    if (mi_params->mi_grid_base[MI_SIZE_64X64 * fbr * mi_params->mi_stride +
+                                MI_SIZE_64X64 * fbc] == NULL ||
+        mi_params
+                ->mi_grid_base[MI_SIZE_64X64 * fbr * mi_params->mi_stride +
+                               MI_SIZE_64X64 * fbc]
+                ->cdef_strength == -1) {
+      cdef_left = 0;
+      continue;
+    }
+    if (!cdef_left) cstart = -CDEF_HBORDER;
+    nhb = AOMMIN(MI_SIZE_64X64, mi_params->mi_cols - MI_SIZE_64X64 * fbc);
+    nvb = AOMMIN(MI_SIZE_64X64, mi_params->mi_rows - MI_SIZE_64X64 * fbr);
+    int frame_top, frame_left, frame_bottom, frame_right;
+
+    int mi_row = MI_SIZE_64X64 * fbr;
+    int mi_col = MI_SIZE_64X64 * fbc;
+    // for the current filter block, it's top left corner mi structure (mi_tl)
+    // is first accessed to check whether the top and left boundaries are
+    // frame boundaries. Then bottom-left and top-right mi structures are
+    // accessed to check whether the bottom and right boundaries
+    // (respectively) are frame boundaries.
+    //
+    // Note that we can't just check the bottom-right mi structure - eg. if
+    // we're at the right-hand edge of the frame but not the bottom, then
+    // the bottom-right mi is NULL but the bottom-left is not.
+    frame_top = (mi_row == 0) ? 1 : 0;
+    frame_left = (mi_col == 0) ? 1 : 0;
+
+    if (fbr != nvfb - 1)
+      frame_bottom = (mi_row + MI_SIZE_64X64 == mi_params->mi_rows) ? 1 : 0;
+    else
+      frame_bottom = 1;
+
+    if (fbc != nhfb - 1)
+      frame_right = (mi_col + MI_SIZE_64X64 == mi_params->mi_cols) ? 1 : 0;
+    else
+      frame_right = 1;
+
+    const int mbmi_cdef_strength =
+        mi_params
+            ->mi_grid_base[MI_SIZE_64X64 * fbr * mi_params->mi_stride +
+                           MI_SIZE_64X64 * fbc]
+            ->cdef_strength;
+    level = cdef_info->cdef_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+    sec_strength =
+        cdef_info->cdef_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+    sec_strength += sec_strength == 3;
+    uv_level =
+        cdef_info->cdef_uv_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+    uv_sec_strength =
+        cdef_info->cdef_uv_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+    uv_sec_strength += uv_sec_strength == 3;
+    if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
+         uv_sec_strength == 0) ||
+        (cdef_count = av1_cdef_compute_sb_list(mi_params, fbr * MI_SIZE_64X64,
+                                               fbc * MI_SIZE_64X64, dlist,
+                                               BLOCK_64X64)) == 0) {
+      cdef_left = 0;
+      continue;
     }
-    int cdef_left = 1;
-    for (int fbc = 0; fbc < nhfb; fbc++) {
-      int level, sec_strength;
-      int uv_level, uv_sec_strength;
-      int nhb, nvb;
-      int cstart = 0;
-      curr_row_cdef[fbc] = 0;
-      if (mi_params->mi_grid_base[MI_SIZE_64X64 * fbr * mi_params->mi_stride +
-                                  MI_SIZE_64X64 * fbc] == NULL ||
-          mi_params
-                  ->mi_grid_base[MI_SIZE_64X64 * fbr * mi_params->mi_stride +
-                                 MI_SIZE_64X64 * fbc]
-                  ->cdef_strength == -1) {
-        cdef_left = 0;
-        continue;
+
+    for (int pli = 0; pli < num_planes; pli++) {
+      int coffset;
+      int rend, cend;
+      int damping = cdef_info->cdef_damping;
+      int hsize = nhb << mi_wide_l2[pli];
+      int vsize = nvb << mi_high_l2[pli];
+
+      if (pli) {
+        level = uv_level;
+        sec_strength = uv_sec_strength;
       }
-      if (!cdef_left) cstart = -CDEF_HBORDER;
-      nhb = AOMMIN(MI_SIZE_64X64, mi_params->mi_cols - MI_SIZE_64X64 * fbc);
-      nvb = AOMMIN(MI_SIZE_64X64, mi_params->mi_rows - MI_SIZE_64X64 * fbr);
-      int frame_top, frame_left, frame_bottom, frame_right;
-
-      int mi_row = MI_SIZE_64X64 * fbr;
-      int mi_col = MI_SIZE_64X64 * fbc;
-      // for the current filter block, it's top left corner mi structure (mi_tl)
-      // is first accessed to check whether the top and left boundaries are
-      // frame boundaries. Then bottom-left and top-right mi structures are
-      // accessed to check whether the bottom and right boundaries
-      // (respectively) are frame boundaries.
-      //
-      // Note that we can't just check the bottom-right mi structure - eg. if
-      // we're at the right-hand edge of the frame but not the bottom, then
-      // the bottom-right mi is NULL but the bottom-left is not.
-      frame_top = (mi_row == 0) ? 1 : 0;
-      frame_left = (mi_col == 0) ? 1 : 0;
-
-      if (fbr != nvfb - 1)
-        frame_bottom = (mi_row + MI_SIZE_64X64 == mi_params->mi_rows) ? 1 : 0;
+
+      if (fbc == nhfb - 1)
+        cend = hsize;
       else
-        frame_bottom = 1;
+        cend = hsize + CDEF_HBORDER;
 
-      if (fbc != nhfb - 1)
-        frame_right = (mi_col + MI_SIZE_64X64 == mi_params->mi_cols) ? 1 : 0;
+      if (fbr == nvfb - 1)
+        rend = vsize;
       else
-        frame_right = 1;
-
-      const int mbmi_cdef_strength =
-          mi_params
-              ->mi_grid_base[MI_SIZE_64X64 * fbr * mi_params->mi_stride +
-                             MI_SIZE_64X64 * fbc]
-              ->cdef_strength;
-      level =
-          cdef_info->cdef_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-      sec_strength =
-          cdef_info->cdef_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-      sec_strength += sec_strength == 3;
-      uv_level =
-          cdef_info->cdef_uv_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-      uv_sec_strength =
-          cdef_info->cdef_uv_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-      uv_sec_strength += uv_sec_strength == 3;
-      if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
-           uv_sec_strength == 0) ||
-          (cdef_count = av1_cdef_compute_sb_list(mi_params, fbr * MI_SIZE_64X64,
-                                                 fbc * MI_SIZE_64X64, dlist,
-                                                 BLOCK_64X64)) == 0) {
-        cdef_left = 0;
-        continue;
-      }
+        rend = vsize + CDEF_VBORDER;
 
-      curr_row_cdef[fbc] = 1;
-      for (int pli = 0; pli < num_planes; pli++) {
-        int coffset;
-        int rend, cend;
-        int damping = cdef_info->cdef_damping;
-        int hsize = nhb << mi_wide_l2[pli];
-        int vsize = nvb << mi_high_l2[pli];
-
-        if (pli) {
-          level = uv_level;
-          sec_strength = uv_sec_strength;
-        }
-
-        if (fbc == nhfb - 1)
-          cend = hsize;
-        else
-          cend = hsize + CDEF_HBORDER;
-
-        if (fbr == nvfb - 1)
-          rend = vsize;
-        else
-          rend = vsize + CDEF_VBORDER;
-
-        coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-        if (fbc == nhfb - 1) {
-          /* On the last superblock column, fill in the right border with
-             CDEF_VERY_LARGE to avoid filtering with the outside. */
-          fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                    rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                    CDEF_VERY_LARGE);
-        }
-        if (fbr == nvfb - 1) {
-          /* On the last superblock row, fill in the bottom border with
-             CDEF_VERY_LARGE to avoid filtering with the outside. */
-          fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        /* Copy in the pixels we need from the current superblock for
-           deringing.*/
-        copy_sb8_16(cm,
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    xd->plane[pli].dst.stride, rend, cend - cstart);
-        if (!prev_row_cdef[fbc]) {
-          copy_sb8_16(cm, &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                      xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset, xd->plane[pli].dst.stride, CDEF_VBORDER, hsize);
-        } else if (fbr > 0) {
-          copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &linebuf[pli][coffset],
-                    stride, CDEF_VBORDER, hsize);
-        } else {
-          fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
-                    CDEF_VERY_LARGE);
-        }
-        if (!prev_row_cdef[fbc - 1]) {
-          copy_sb8_16(cm, src, CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset - CDEF_HBORDER, xd->plane[pli].dst.stride,
-                      CDEF_VBORDER, CDEF_HBORDER);
-        } else if (fbr > 0 && fbc > 0) {
-          copy_rect(src, CDEF_BSTRIDE, &linebuf[pli][coffset - CDEF_HBORDER],
-                    stride, CDEF_VBORDER, CDEF_HBORDER);
-        } else {
-          fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (!prev_row_cdef[fbc + 1]) {
-          copy_sb8_16(cm, &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                      CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset + hsize, xd->plane[pli].dst.stride, CDEF_VBORDER,
-                      CDEF_HBORDER);
-        } else if (fbr > 0 && fbc < nhfb - 1) {
-          copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                    &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                    CDEF_HBORDER);
-        } else {
-          fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
-                    CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        if (cdef_left) {
-          /* If we deringed the superblock on the left then we need to copy in
-             saved pixels. */
-          copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                    rend + CDEF_VBORDER, CDEF_HBORDER);
-        }
-        /* Saving pixels in case we need to dering the superblock on the
-            right. */
-        copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+      coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
+      if (fbc == nhfb - 1) {
+        /* On the last superblock column, fill in the right border with
+           CDEF_VERY_LARGE to avoid filtering with the outside. */
+        fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE, rend + CDEF_VBORDER,
+                  hsize + CDEF_HBORDER - cend, CDEF_VERY_LARGE);
+      }
+      if (fbr == nvfb - 1) {
+        /* On the last superblock row, fill in the bottom border with
+           CDEF_VERY_LARGE to avoid filtering with the outside. */
+        fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                  CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      /* Copy in the pixels we need from the current superblock for
+         deringing.*/
+      copy_sb8_16(cm, &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
+                  CDEF_BSTRIDE, xd->plane[pli].dst.buf,
+                  (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
+                  xd->plane[pli].dst.stride, vsize, cend - cstart);
+      if (fbr < nvfb - 1) {
+        copy_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE + CDEF_HBORDER +
+                       cstart],
+                  CDEF_BSTRIDE, &bot_linebuf[pli][coffset + cstart], stride,
+                  CDEF_VBORDER, cend - cstart);
+      }
+      if (fbr > 0) {
+        copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &top_linebuf[pli][coffset],
+                  stride, CDEF_VBORDER, hsize);
+      } else {
+        fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
+                  CDEF_VERY_LARGE);
+      }
+      if (fbr > 0 && fbc > 0) {
+        copy_rect(src, CDEF_BSTRIDE, &top_linebuf[pli][coffset - CDEF_HBORDER],
+                  stride, CDEF_VBORDER, CDEF_HBORDER);
+      } else {
+        fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (fbr > 0 && fbc < nhfb - 1) {
+        copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                  &top_linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
+                  CDEF_HBORDER);
+      } else {
+        fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
+                  CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      if (cdef_left) {
+        /* If we deringed the superblock on the left then we need to copy in
+           saved pixels. */
+        copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
                   rend + CDEF_VBORDER, CDEF_HBORDER);
-        copy_sb8_16(
-            cm, &linebuf[pli][coffset], stride, xd->plane[pli].dst.buf,
-            (MI_SIZE_64X64 << mi_high_l2[pli]) * (fbr + 1) - CDEF_VBORDER,
-            coffset, xd->plane[pli].dst.stride, CDEF_VBORDER, hsize);
-
-        if (frame_top) {
-          fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (frame_left) {
-          fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (frame_bottom) {
-          fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        if (frame_right) {
-          fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                    vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-
-        if (cm->seq_params.use_highbitdepth) {
-          av1_cdef_filter_fb(
-              NULL,
-              &CONVERT_TO_SHORTPTR(
-                  xd->plane[pli]
-                      .dst.buf)[xd->plane[pli].dst.stride *
-                                    (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                                (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-              xd->plane[pli].dst.stride,
-              &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-              ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-              sec_strength, damping, coeff_shift);
-        } else {
-          av1_cdef_filter_fb(
-              &xd->plane[pli]
-                   .dst.buf[xd->plane[pli].dst.stride *
-                                (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                            (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-              NULL, xd->plane[pli].dst.stride,
-              &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-              ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-              sec_strength, damping, coeff_shift);
-        }
       }
-      cdef_left = 1;
-    }
-    {
-      unsigned char *tmp = prev_row_cdef;
-      prev_row_cdef = curr_row_cdef;
-      curr_row_cdef = tmp;
+      /* Saving pixels in case we need to dering the superblock on the
+          right. */
+      copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+                rend + CDEF_VBORDER, CDEF_HBORDER);
+
+      if (frame_top) {
+        fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (frame_left) {
+        fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (frame_bottom) {
+        fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                  CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      if (frame_right) {
+        fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                  vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+
+      if (cm->seq_params.use_highbitdepth) {
+        av1_cdef_filter_fb(
+            NULL,
+            &CONVERT_TO_SHORTPTR(
+                xd->plane[pli]
+                    .dst.buf)[xd->plane[pli].dst.stride *
+                                  (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
+                              (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+            xd->plane[pli].dst.stride,
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+            ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
+            sec_strength, damping, coeff_shift);
+      } else {
+        av1_cdef_filter_fb(
+            &xd->plane[pli]
+                 .dst.buf[xd->plane[pli].dst.stride *
+                              (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
+                          (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+            NULL, xd->plane[pli].dst.stride,
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+            ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
+            sec_strength, damping, coeff_shift);
+      }
     }
+    cdef_left = 1;
+  }
+}
+
+void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                    MACROBLOCKD *xd) {
+  const int num_planes = av1_num_planes(cm);
+  const int nvfb = (cm->mi_params.mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
+  uint16_t *linebuf[3] = { NULL, NULL, NULL };
+  uint16_t *colbuf[3] = { NULL, NULL, NULL };
+
+  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0,
+                       num_planes);
+  for (int pli = 0; pli < num_planes; pli++) {
+    CHECK_MEM_ERROR(cm, linebuf[pli], av1_cdef_alloc_linebuf(cm));
+    CHECK_MEM_ERROR(cm, colbuf[pli], av1_cdef_alloc_colbuf(cm, pli));
+  }
+  for (int fbr = 0; fbr < nvfb; fbr++) {
+    av1_cdef_init_fb_row(cm, xd, linebuf, fbr);
+    av1_cdef_fb_row(cm, xd, linebuf, colbuf, src, fbr);
   }
-  aom_free(row_cdef);
   for (int pli = 0; pli < num_planes; pli++) {
     aom_free(linebuf[pli]);
     aom_free(colbuf[pli]);
@@ -41,6 +41,29 @@ int av1_cdef_compute_sb_list(const CommonModeInfoParams *const mi_params,
                              int mi_row, int mi_col, cdef_list *dlist,
                              BLOCK_SIZE bsize);
 
+/*!\cond */
+// Allocates the buffer holding, for every 64x64 filter block row of a plane,
+// the unfiltered CDEF_VBORDER lines on either side of its bottom edge.
+uint16_t *av1_cdef_alloc_linebuf(const AV1_COMMON *const cm);
+
+// Allocates the buffer holding the unfiltered columns to the right of the
+// previously filtered 64x64 block in a row.
+uint16_t *av1_cdef_alloc_colbuf(const AV1_COMMON *const cm, int plane);
+
+// Saves the unfiltered lines shared by filter block rows fbr and fbr + 1 into
+// linebuf. This must be done before either of the two rows is filtered.
+void av1_cdef_init_fb_row(const AV1_COMMON *const cm,
+                          const MACROBLOCKD *const xd, uint16_t **linebuf,
+                          int fbr);
+
+// Applies CDEF to filter block row fbr. The rows above and below may be
+// filtered concurrently once av1_cdef_init_fb_row() is done for fbr - 1 and
+// fbr. colbuf and src are scratch buffers private to the caller.
+void av1_cdef_fb_row(const AV1_COMMON *const cm, MACROBLOCKD *xd,
+                     uint16_t **linebuf, uint16_t **colbuf, uint16_t *src,
+                     int fbr);
+/*!\endcond */
+
 /*!\brief Function for applying CDEF to a frame
  *
  * \ingroup in_loop_cdef
@@ -1338,6 +1338,96 @@ void av1_upscale_normative_and_extend_frame(const AV1_COMMON *cm,
   aom_extend_frame_borders(dst, num_planes);
 }
 
+typedef struct {
+  const AV1_COMMON *cm;
+  const YV12_BUFFER_CONFIG *src;
+  YV12_BUFFER_CONFIG *dst;
+  int stripe;
+  int num_stripes;
+} UpscaleWorkerData;
+
+// Upscales one horizontal stripe of every plane. Rows are filtered
+// independently, so stripes can run concurrently; the tile columns of a stripe
+// are still processed left to right, as the SIMD kernels may write past the
+// right edge of a tile column.
+static int upscale_normative_worker(void *arg1, void *arg2) {
+  const UpscaleWorkerData *const data = (const UpscaleWorkerData *)arg1;
+  const AV1_COMMON *const cm = data->cm;
+  const YV12_BUFFER_CONFIG *const src = data->src;
+  YV12_BUFFER_CONFIG *const dst = data->dst;
+  (void)arg2;
+
+  for (int i = 0; i < av1_num_planes(cm); ++i) {
+    const int is_uv = (i > 0);
+    const int height = src->crop_heights[is_uv];
+    const int row_start = height * data->stripe / data->num_stripes;
+    const int row_end = height * (data->stripe + 1) / data->num_stripes;
+    if (row_end <= row_start) continue;
+
+    const int src_stride = src->strides[is_uv];
+    const int dst_stride = dst->strides[is_uv];
+    const uint8_t *src_ptr = src->buffers[i];
+    uint8_t *dst_ptr = dst->buffers[i];
+#if CONFIG_AV1_HIGHBITDEPTH
+    if (cm->seq_params.use_highbitdepth) {
+      src_ptr = CONVERT_TO_BYTEPTR(CONVERT_TO_SHORTPTR(src_ptr) +
+                                   row_start * src_stride);
+      dst_ptr = CONVERT_TO_BYTEPTR(CONVERT_TO_SHORTPTR(dst_ptr) +
+                                   row_start * dst_stride);
+    } else {
+      src_ptr += row_start * src_stride;
+      dst_ptr += row_start * dst_stride;
+    }
+#else
+    src_ptr += row_start * src_stride;
+    dst_ptr += row_start * dst_stride;
+#endif
+    av1_upscale_normative_rows(cm, src_ptr, src_stride, dst_ptr, dst_stride, i,
+                               row_end - row_start);
+  }
+  return 1;
+}
+
+void av1_upscale_normative_and_extend_frame_mt(const AV1_COMMON *cm,
+                                               const YV12_BUFFER_CONFIG *src,
+                                               YV12_BUFFER_CONFIG *dst,
+                                               AVxWorker *workers,
+                                               int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  UpscaleWorkerData upscale_data[MAX_NUM_THREADS];
+
+  num_workers = AOMMIN(num_workers, MAX_NUM_THREADS);
+  num_workers = AOMMIN(num_workers, src->y_crop_height);
+  if (num_workers <= 1) {
+    av1_upscale_normative_and_extend_frame(cm, src, dst);
+    return;
+  }
+
+  for (int i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    upscale_data[i].cm = cm;
+    upscale_data[i].src = src;
+    upscale_data[i].dst = dst;
+    upscale_data[i].stripe = i;
+    upscale_data[i].num_stripes = num_workers;
+    worker->hook = upscale_normative_worker;
+    worker->data1 = &upscale_data[i];
+    worker->data2 = NULL;
+
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  for (int i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+
+  aom_extend_frame_borders(dst, av1_num_planes(cm));
+}
+
 YV12_BUFFER_CONFIG *av1_scale_if_required(
     AV1_COMMON *cm, YV12_BUFFER_CONFIG *unscaled, YV12_BUFFER_CONFIG *scaled,
     const InterpFilter filter, const int phase, const bool use_optimized_scaler,
@@ -1429,7 +1519,8 @@ static void copy_buffer_config(const YV12_BUFFER_CONFIG *const src,
 // TODO(afergs): Look for in-place upscaling
 // TODO(afergs): aom_ vs av1_ functions? Which can I use?
 // Upscale decoded image.
-void av1_superres_upscale(AV1_COMMON *cm, BufferPool *const pool) {
+void av1_superres_upscale_mt(AV1_COMMON *cm, BufferPool *const pool,
+                             AVxWorker *workers, int num_workers) {
   const int num_planes = av1_num_planes(cm);
   if (!av1_superres_scaled(cm)) return;
   const SequenceHeader *const seq_params = &cm->seq_params;
@@ -1487,13 +1578,15 @@ void av1_superres_upscale(AV1_COMMON *cm, BufferPool *const pool) {
     // Make a copy of the config data for frame_to_show in copy_buffer
     copy_buffer_config(frame_to_show, &copy_buffer);
 
-    // Don't use callbacks on the encoder.
-    // aom_alloc_frame_buffer() clears the config data for frame_to_show
-    if (aom_alloc_frame_buffer(
+    // Don't use callbacks on the encoder, but keep the frame in its pool.
+    // aom_free_frame_buffer() clears the config data for frame_to_show
+    aom_frame_buffer_pool_t *const fb_pool = frame_to_show->pool;
+    aom_free_frame_buffer(frame_to_show);
+    if (aom_realloc_frame_buffer_from_pool(
             frame_to_show, cm->superres_upscaled_width,
             cm->superres_upscaled_height, seq_params->subsampling_x,
             seq_params->subsampling_y, seq_params->use_highbitdepth,
-            AOM_BORDER_IN_PIXELS, byte_alignment))
+            AOM_BORDER_IN_PIXELS, byte_alignment, fb_pool))
       aom_internal_error(
           &cm->error, AOM_CODEC_MEM_ERROR,
           "Failed to reallocate current frame buffer for superres upscaling");
@@ -1510,8 +1603,13 @@ void av1_superres_upscale(AV1_COMMON *cm, BufferPool *const pool) {
 
   // Scale up and back into frame_to_show.
   assert(frame_to_show->y_crop_width != cm->width);
-  av1_upscale_normative_and_extend_frame(cm, &copy_buffer, frame_to_show);
+  av1_upscale_normative_and_extend_frame_mt(cm, &copy_buffer, frame_to_show,
+                                            workers, num_workers);
 
   // Free the copy buffer
   aom_free_frame_buffer(&copy_buffer);
 }
+
+void av1_superres_upscale(AV1_COMMON *cm, BufferPool *const pool) {
+  av1_superres_upscale_mt(cm, pool, NULL, 0);
+}
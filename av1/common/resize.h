@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include "aom/aom_integer.h"
+#include "aom_util/aom_thread.h"
 #include "av1/common/av1_common_int.h"
 
 #ifdef __cplusplus
@@ -70,6 +71,13 @@ void av1_upscale_normative_rows(const AV1_COMMON *cm, const uint8_t *src,
 void av1_upscale_normative_and_extend_frame(const AV1_COMMON *cm,
                                             const YV12_BUFFER_CONFIG *src,
                                             YV12_BUFFER_CONFIG *dst);
+// Same as av1_upscale_normative_and_extend_frame(), with the rows of each plane
+// split into stripes that are upscaled on the given workers.
+void av1_upscale_normative_and_extend_frame_mt(const AV1_COMMON *cm,
+                                               const YV12_BUFFER_CONFIG *src,
+                                               YV12_BUFFER_CONFIG *dst,
+                                               AVxWorker *workers,
+                                               int num_workers);
 
 YV12_BUFFER_CONFIG *av1_scale_if_required(
     AV1_COMMON *cm, YV12_BUFFER_CONFIG *unscaled, YV12_BUFFER_CONFIG *scaled,
@@ -95,6 +103,9 @@ void av1_calculate_scaled_superres_size(int *width, int *height,
 void av1_calculate_unscaled_superres_size(int *width, int *height, int denom);
 
 void av1_superres_upscale(AV1_COMMON *cm, BufferPool *const pool);
+// Same as av1_superres_upscale(), using the given workers for the upscaling.
+void av1_superres_upscale_mt(AV1_COMMON *cm, BufferPool *const pool,
+                             AVxWorker *workers, int num_workers);
 
 // Returns 1 if a superres upscaled frame is scaled and 0 otherwise.
 static INLINE int av1_superres_scaled(const AV1_COMMON *cm) {
@@ -364,6 +364,11 @@ void av1_free_restoration_struct(RestorationInfo *rst_info);
 
 void av1_extend_frame(uint8_t *data, int width, int height, int stride,
                       int border_horz, int border_vert, int highbd);
+// Same as av1_extend_frame(), but only extends rows [row_start, row_end) and
+// the top or bottom border if the range contains the first or last row.
+void av1_extend_frame_rows(uint8_t *data, int width, int height, int stride,
+                           int border_horz, int border_vert, int row_start,
+                           int row_end, int highbd);
 void av1_decode_xq(const int *xqd, int *xq, const sgr_params_type *params);
 
 /*!\endcond */
@@ -459,10 +464,16 @@ int av1_loop_restoration_corners_in_sb(const struct AV1Common *cm, int plane,
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               struct AV1Common *cm,
                                               int after_cdef);
+// Same as av1_loop_restoration_save_boundary_lines() for a single plane, but
+// only saves the lines read from rows [row_start, row_end) of the plane.
+void av1_loop_restoration_save_boundary_lines_rows(
+    const YV12_BUFFER_CONFIG *frame, struct AV1Common *cm, int plane,
+    int after_cdef, int row_start, int row_end);
 void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
                                             YV12_BUFFER_CONFIG *frame,
                                             struct AV1Common *cm,
-                                            int optimized_lr, int num_planes);
+                                            int optimized_lr, int num_planes,
+                                            int extend_frame);
 void av1_loop_restoration_copy_planes(AV1LrStruct *loop_rest_ctxt,
                                       struct AV1Common *cm, int num_planes);
 void av1_foreach_rest_unit_in_row(
@@ -15,6 +15,7 @@
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
 #include "av1/common/av1_loopfilter.h"
+#include "av1/common/cdef.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/reconinter.h"
@@ -56,29 +57,10 @@ static INLINE int get_lr_sync_range(int width) {
 // Allocate memory for lf row synchronization
 static void loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
                               int width, int num_workers) {
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_ROW_MT);
   lf_sync->rows = rows;
 #if CONFIG_MULTITHREAD
   {
-    int i, j;
-
-    for (j = 0; j < MAX_MB_PLANE; j++) {
-      CHECK_MEM_ERROR(cm, lf_sync->mutex_[j],
-                      aom_malloc(sizeof(*(lf_sync->mutex_[j])) * rows));
-      if (lf_sync->mutex_[j]) {
-        for (i = 0; i < rows; ++i) {
-          pthread_mutex_init(&lf_sync->mutex_[j][i], NULL);
-        }
-      }
-
-      CHECK_MEM_ERROR(cm, lf_sync->cond_[j],
-                      aom_malloc(sizeof(*(lf_sync->cond_[j])) * rows));
-      if (lf_sync->cond_[j]) {
-        for (i = 0; i < rows; ++i) {
-          pthread_cond_init(&lf_sync->cond_[j][i], NULL);
-        }
-      }
-    }
-
     CHECK_MEM_ERROR(cm, lf_sync->job_mutex,
                     aom_malloc(sizeof(*(lf_sync->job_mutex))));
     if (lf_sync->job_mutex) {
@@ -91,14 +73,14 @@ static void loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
   lf_sync->num_workers = num_workers;
 
   for (int j = 0; j < MAX_MB_PLANE; j++) {
-    CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col[j],
-                    aom_malloc(sizeof(*(lf_sync->cur_sb_col[j])) * rows));
+    CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col[j], aom_row_progress_alloc(rows));
   }
   CHECK_MEM_ERROR(
       cm, lf_sync->job_queue,
       aom_malloc(sizeof(*(lf_sync->job_queue)) * rows * MAX_MB_PLANE * 2));
   // Set up nsync.
   lf_sync->sync_range = get_sync_range(width);
+  aom_mem_set_tag(prev_tag);
 }
 
 // Deallocate lf synchronization related mutex and data
@@ -106,21 +88,6 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
   if (lf_sync != NULL) {
     int j;
 #if CONFIG_MULTITHREAD
-    int i;
-    for (j = 0; j < MAX_MB_PLANE; j++) {
-      if (lf_sync->mutex_[j] != NULL) {
-        for (i = 0; i < lf_sync->rows; ++i) {
-          pthread_mutex_destroy(&lf_sync->mutex_[j][i]);
-        }
-        aom_free(lf_sync->mutex_[j]);
-      }
-      if (lf_sync->cond_[j] != NULL) {
-        for (i = 0; i < lf_sync->rows; ++i) {
-          pthread_cond_destroy(&lf_sync->cond_[j][i]);
-        }
-        aom_free(lf_sync->cond_[j]);
-      }
-    }
     if (lf_sync->job_mutex != NULL) {
       pthread_mutex_destroy(lf_sync->job_mutex);
       aom_free(lf_sync->job_mutex);
@@ -128,7 +95,7 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
 #endif  // CONFIG_MULTITHREAD
     aom_free(lf_sync->lfdata);
     for (j = 0; j < MAX_MB_PLANE; j++) {
-      aom_free(lf_sync->cur_sb_col[j]);
+      aom_row_progress_free(lf_sync->cur_sb_col[j], lf_sync->rows);
     }
 
     aom_free(lf_sync->job_queue);
@@ -158,13 +125,7 @@ static INLINE void sync_read(AV1LfSync *const lf_sync, int r, int c,
   const int nsync = lf_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &lf_sync->mutex_[plane][r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > lf_sync->cur_sb_col[plane][r - 1] - nsync) {
-      pthread_cond_wait(&lf_sync->cond_[plane][r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_row_progress_wait(&lf_sync->cur_sb_col[plane][r - 1], c + nsync);
   }
 #else
   (void)lf_sync;
@@ -190,12 +151,7 @@ static INLINE void sync_write(AV1LfSync *const lf_sync, int r, int c,
   }
 
   if (sig) {
-    pthread_mutex_lock(&lf_sync->mutex_[plane][r]);
-
-    lf_sync->cur_sb_col[plane][r] = cur;
-
-    pthread_cond_broadcast(&lf_sync->cond_[plane][r]);
-    pthread_mutex_unlock(&lf_sync->mutex_[plane][r]);
+    aom_row_progress_set(&lf_sync->cur_sb_col[plane][r], cur);
   }
 #else
   (void)lf_sync;
@@ -264,60 +220,61 @@ static AV1LfMTInfo *get_lf_job_info(AV1LfSync *lf_sync) {
   return cur_job_info;
 }
 
+// Loopfilter one superblock row of one plane in one direction.
+static INLINE void loop_filter_row(const YV12_BUFFER_CONFIG *const frame_buffer,
+                                   AV1_COMMON *const cm,
+                                   struct macroblockd_plane *planes,
+                                   MACROBLOCKD *xd, AV1LfSync *const lf_sync,
+                                   const AV1LfMTInfo *cur_job_info) {
+  const int sb_cols =
+      ALIGN_POWER_OF_TWO(cm->mi_params.mi_cols, MAX_MIB_SIZE_LOG2) >>
+      MAX_MIB_SIZE_LOG2;
+  const int mi_row = cur_job_info->mi_row;
+  const int plane = cur_job_info->plane;
+  const int dir = cur_job_info->dir;
+  const int r = mi_row >> MAX_MIB_SIZE_LOG2;
+  int mi_col, c;
+
+  if (dir == 0) {
+    for (mi_col = 0; mi_col < cm->mi_params.mi_cols; mi_col += MAX_MIB_SIZE) {
+      c = mi_col >> MAX_MIB_SIZE_LOG2;
+
+      av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer, mi_row,
+                           mi_col, plane, plane + 1);
+
+      av1_filter_block_plane_vert(cm, xd, plane, &planes[plane], mi_row,
+                                  mi_col);
+      sync_write(lf_sync, r, c, sb_cols, plane);
+    }
+  } else if (dir == 1) {
+    for (mi_col = 0; mi_col < cm->mi_params.mi_cols; mi_col += MAX_MIB_SIZE) {
+      c = mi_col >> MAX_MIB_SIZE_LOG2;
+
+      // Wait for vertical edge filtering of the top-right block to be
+      // completed
+      sync_read(lf_sync, r, c, plane);
+
+      // Wait for vertical edge filtering of the right block to be
+      // completed
+      sync_read(lf_sync, r + 1, c, plane);
+
+      av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer, mi_row,
+                           mi_col, plane, plane + 1);
+      av1_filter_block_plane_horz(cm, xd, plane, &planes[plane], mi_row,
+                                  mi_col);
+    }
+  }
+}
+
 // Implement row loopfiltering for each thread.
 static INLINE void thread_loop_filter_rows(
     const YV12_BUFFER_CONFIG *const frame_buffer, AV1_COMMON *const cm,
     struct macroblockd_plane *planes, MACROBLOCKD *xd,
     AV1LfSync *const lf_sync) {
-  const int sb_cols =
-      ALIGN_POWER_OF_TWO(cm->mi_params.mi_cols, MAX_MIB_SIZE_LOG2) >>
-      MAX_MIB_SIZE_LOG2;
-  int mi_row, mi_col, plane, dir;
-  int r, c;
-
-  while (1) {
-    AV1LfMTInfo *cur_job_info = get_lf_job_info(lf_sync);
-
-    if (cur_job_info != NULL) {
-      mi_row = cur_job_info->mi_row;
-      plane = cur_job_info->plane;
-      dir = cur_job_info->dir;
-      r = mi_row >> MAX_MIB_SIZE_LOG2;
-
-      if (dir == 0) {
-        for (mi_col = 0; mi_col < cm->mi_params.mi_cols;
-             mi_col += MAX_MIB_SIZE) {
-          c = mi_col >> MAX_MIB_SIZE_LOG2;
-
-          av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer,
-                               mi_row, mi_col, plane, plane + 1);
+  AV1LfMTInfo *cur_job_info;
 
-          av1_filter_block_plane_vert(cm, xd, plane, &planes[plane], mi_row,
-                                      mi_col);
-          sync_write(lf_sync, r, c, sb_cols, plane);
-        }
-      } else if (dir == 1) {
-        for (mi_col = 0; mi_col < cm->mi_params.mi_cols;
-             mi_col += MAX_MIB_SIZE) {
-          c = mi_col >> MAX_MIB_SIZE_LOG2;
-
-          // Wait for vertical edge filtering of the top-right block to be
-          // completed
-          sync_read(lf_sync, r, c, plane);
-
-          // Wait for vertical edge filtering of the right block to be
-          // completed
-          sync_read(lf_sync, r + 1, c, plane);
-
-          av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer,
-                               mi_row, mi_col, plane, plane + 1);
-          av1_filter_block_plane_horz(cm, xd, plane, &planes[plane], mi_row,
-                                      mi_col);
-        }
-      }
-    } else {
-      break;
-    }
+  while ((cur_job_info = get_lf_job_info(lf_sync)) != NULL) {
+    loop_filter_row(frame_buffer, cm, planes, xd, lf_sync, cur_job_info);
   }
 }
 
@@ -433,8 +390,7 @@ static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 
   // Initialize cur_sb_col to -1 for all SB rows.
   for (i = 0; i < MAX_MB_PLANE; i++) {
-    memset(lf_sync->cur_sb_col[i], -1,
-           sizeof(*(lf_sync->cur_sb_col[i])) * sb_rows);
+    aom_row_progress_reset(lf_sync->cur_sb_col[i], sb_rows, -1);
   }
 
   enqueue_lf_jobs(lf_sync, cm, start, stop,
@@ -530,6 +486,238 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
 #endif
 }
 
+// Allocate memory for cdef row synchronization
+static void cdef_alloc(AV1CdefRowSync *cdef_sync, AV1_COMMON *cm, int rows,
+                       int num_workers) {
+  cdef_sync->rows = rows;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, cdef_sync->mutex_,
+                    aom_malloc(sizeof(*(cdef_sync->mutex_)) * rows));
+    if (cdef_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&cdef_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, cdef_sync->cond_,
+                    aom_malloc(sizeof(*(cdef_sync->cond_)) * rows));
+    if (cdef_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&cdef_sync->cond_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, cdef_sync->job_mutex,
+                    aom_malloc(sizeof(*(cdef_sync->job_mutex))));
+    if (cdef_sync->job_mutex) {
+      pthread_mutex_init(cdef_sync->job_mutex, NULL);
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, cdef_sync->row_ready,
+                  aom_malloc(sizeof(*(cdef_sync->row_ready)) * rows));
+
+  cdef_sync->linebuf_stride =
+      (cm->mi_params.mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
+  for (int j = 0; j < MAX_MB_PLANE; j++) {
+    CHECK_MEM_ERROR(cm, cdef_sync->linebuf[j], av1_cdef_alloc_linebuf(cm));
+  }
+
+  CHECK_MEM_ERROR(
+      cm, cdef_sync->cdefworkerdata,
+      aom_calloc(num_workers, sizeof(*(cdef_sync->cdefworkerdata))));
+  cdef_sync->num_workers = num_workers;
+
+  for (int i = 0; i < num_workers; ++i) {
+    AV1CdefWorkerData *const cdef_data = &cdef_sync->cdefworkerdata[i];
+    CHECK_MEM_ERROR(
+        cm, cdef_data->srcbuf,
+        aom_memalign(16, sizeof(*(cdef_data->srcbuf)) * CDEF_INBUF_SIZE));
+    // The luma plane needs the largest column buffer, use it for all planes.
+    for (int j = 0; j < MAX_MB_PLANE; j++) {
+      CHECK_MEM_ERROR(cm, cdef_data->colbuf[j], av1_cdef_alloc_colbuf(cm, 0));
+    }
+  }
+}
+
+// Deallocate cdef synchronization related mutex and data
+void av1_cdef_dealloc(AV1CdefRowSync *cdef_sync) {
+  if (cdef_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+    if (cdef_sync->mutex_ != NULL) {
+      for (i = 0; i < cdef_sync->rows; ++i) {
+        pthread_mutex_destroy(&cdef_sync->mutex_[i]);
+      }
+      aom_free(cdef_sync->mutex_);
+    }
+    if (cdef_sync->cond_ != NULL) {
+      for (i = 0; i < cdef_sync->rows; ++i) {
+        pthread_cond_destroy(&cdef_sync->cond_[i]);
+      }
+      aom_free(cdef_sync->cond_);
+    }
+    if (cdef_sync->job_mutex != NULL) {
+      pthread_mutex_destroy(cdef_sync->job_mutex);
+      aom_free(cdef_sync->job_mutex);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(cdef_sync->row_ready);
+    for (int j = 0; j < MAX_MB_PLANE; j++) {
+      aom_free(cdef_sync->linebuf[j]);
+    }
+    if (cdef_sync->cdefworkerdata) {
+      for (int w = 0; w < cdef_sync->num_workers; ++w) {
+        AV1CdefWorkerData *const cdef_data = &cdef_sync->cdefworkerdata[w];
+        aom_free(cdef_data->srcbuf);
+        for (int j = 0; j < MAX_MB_PLANE; j++) {
+          aom_free(cdef_data->colbuf[j]);
+        }
+      }
+      aom_free(cdef_sync->cdefworkerdata);
+    }
+
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*cdef_sync);
+  }
+}
+
+// Waits until the boundary lines below filter block row r - 1 are saved, after
+// which row r can be filtered without racing with its neighbours.
+static INLINE void cdef_sync_read(AV1CdefRowSync *const cdef_sync, int r) {
+#if CONFIG_MULTITHREAD
+  if (r) {
+    pthread_mutex_t *const mutex = &cdef_sync->mutex_[r - 1];
+    pthread_mutex_lock(mutex);
+
+    while (!cdef_sync->row_ready[r - 1]) {
+      pthread_cond_wait(&cdef_sync->cond_[r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)cdef_sync;
+  (void)r;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE void cdef_sync_write(AV1CdefRowSync *const cdef_sync, int r) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&cdef_sync->mutex_[r]);
+
+  cdef_sync->row_ready[r] = 1;
+
+  pthread_cond_broadcast(&cdef_sync->cond_[r]);
+  pthread_mutex_unlock(&cdef_sync->mutex_[r]);
+#else
+  (void)cdef_sync;
+  (void)r;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Returns 1 and sets *fbr to the next filter block row to be processed, or
+// returns 0 when all rows have been dispatched.
+static int get_cdef_row_job(AV1CdefRowSync *cdef_sync, int *fbr) {
+  int has_job = 0;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(cdef_sync->job_mutex);
+#endif  // CONFIG_MULTITHREAD
+
+  if (cdef_sync->next_fbr < cdef_sync->rows) {
+    *fbr = cdef_sync->next_fbr;
+    cdef_sync->next_fbr++;
+    has_job = 1;
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(cdef_sync->job_mutex);
+#endif  // CONFIG_MULTITHREAD
+
+  return has_job;
+}
+
+// Apply CDEF to one filter block row.
+static INLINE void cdef_row(AV1CdefRowSync *const cdef_sync,
+                            AV1CdefWorkerData *const cdef_data, int fbr) {
+  av1_cdef_init_fb_row(cdef_data->cm, cdef_data->xd, cdef_sync->linebuf, fbr);
+  cdef_sync_write(cdef_sync, fbr);
+  cdef_sync_read(cdef_sync, fbr);
+  av1_cdef_fb_row(cdef_data->cm, cdef_data->xd, cdef_sync->linebuf,
+                  cdef_data->colbuf, cdef_data->srcbuf, fbr);
+}
+
+// Row-based multi-threaded cdef hook
+static int cdef_row_worker(void *arg1, void *arg2) {
+  AV1CdefRowSync *const cdef_sync = (AV1CdefRowSync *)arg1;
+  AV1CdefWorkerData *const cdef_data = (AV1CdefWorkerData *)arg2;
+  int fbr;
+
+  while (get_cdef_row_job(cdef_sync, &fbr)) {
+    cdef_row(cdef_sync, cdef_data, fbr);
+  }
+  return 1;
+}
+
+// Allocates the cdef row synchronization data if needed and resets it for a
+// new frame.
+static void cdef_mt_init(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                         MACROBLOCKD *xd, int num_workers,
+                         AV1CdefRowSync *cdef_sync) {
+  const int nvfb = (cm->mi_params.mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  const int linebuf_stride =
+      (cm->mi_params.mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
+
+  if (nvfb != cdef_sync->rows || linebuf_stride != cdef_sync->linebuf_stride ||
+      num_workers > cdef_sync->num_workers) {
+    av1_cdef_dealloc(cdef_sync);
+    cdef_alloc(cdef_sync, cm, nvfb, num_workers);
+  }
+
+  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0,
+                       av1_num_planes(cm));
+  memset(cdef_sync->row_ready, 0, sizeof(*(cdef_sync->row_ready)) * nvfb);
+  cdef_sync->next_fbr = 0;
+
+  for (int i = 0; i < num_workers; ++i) {
+    cdef_sync->cdefworkerdata[i].cm = cm;
+    cdef_sync->cdefworkerdata[i].xd = xd;
+  }
+}
+
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                       MACROBLOCKD *xd, AVxWorker *workers, int num_workers,
+                       AV1CdefRowSync *cdef_sync) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+
+  cdef_mt_init(frame, cm, xd, num_workers, cdef_sync);
+
+  // Set up cdef thread data.
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = cdef_row_worker;
+    worker->data1 = cdef_sync;
+    worker->data2 = &cdef_sync->cdefworkerdata[i];
+
+    // Start cdef
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+}
+
 #if !CONFIG_REALTIME_ONLY
 static INLINE void lr_sync_read(void *const lr_sync, int r, int c, int plane) {
 #if CONFIG_MULTITHREAD
@@ -537,13 +725,7 @@ static INLINE void lr_sync_read(void *const lr_sync, int r, int c, int plane) {
   const int nsync = loop_res_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &loop_res_sync->mutex_[plane][r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > loop_res_sync->cur_sb_col[plane][r - 1] - nsync) {
-      pthread_cond_wait(&loop_res_sync->cond_[plane][r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_row_progress_wait(&loop_res_sync->cur_sb_col[plane][r - 1], c + nsync);
   }
 #else
   (void)lr_sync;
@@ -570,12 +752,7 @@ static INLINE void lr_sync_write(void *const lr_sync, int r, int c,
   }
 
   if (sig) {
-    pthread_mutex_lock(&loop_res_sync->mutex_[plane][r]);
-
-    loop_res_sync->cur_sb_col[plane][r] = cur;
-
-    pthread_cond_broadcast(&loop_res_sync->cond_[plane][r]);
-    pthread_mutex_unlock(&loop_res_sync->mutex_[plane][r]);
+    aom_row_progress_set(&loop_res_sync->cur_sb_col[plane][r], cur);
   }
 #else
   (void)lr_sync;
@@ -590,30 +767,11 @@ static INLINE void lr_sync_write(void *const lr_sync, int r, int c,
 static void loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
                                    int num_workers, int num_rows_lr,
                                    int num_planes, int width) {
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_ROW_MT);
   lr_sync->rows = num_rows_lr;
   lr_sync->num_planes = num_planes;
 #if CONFIG_MULTITHREAD
   {
-    int i, j;
-
-    for (j = 0; j < num_planes; j++) {
-      CHECK_MEM_ERROR(cm, lr_sync->mutex_[j],
-                      aom_malloc(sizeof(*(lr_sync->mutex_[j])) * num_rows_lr));
-      if (lr_sync->mutex_[j]) {
-        for (i = 0; i < num_rows_lr; ++i) {
-          pthread_mutex_init(&lr_sync->mutex_[j][i], NULL);
-        }
-      }
-
-      CHECK_MEM_ERROR(cm, lr_sync->cond_[j],
-                      aom_malloc(sizeof(*(lr_sync->cond_[j])) * num_rows_lr));
-      if (lr_sync->cond_[j]) {
-        for (i = 0; i < num_rows_lr; ++i) {
-          pthread_cond_init(&lr_sync->cond_[j][i], NULL);
-        }
-      }
-    }
-
     CHECK_MEM_ERROR(cm, lr_sync->job_mutex,
                     aom_malloc(sizeof(*(lr_sync->job_mutex))));
     if (lr_sync->job_mutex) {
@@ -640,15 +798,15 @@ static void loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
   lr_sync->num_workers = num_workers;
 
   for (int j = 0; j < num_planes; j++) {
-    CHECK_MEM_ERROR(
-        cm, lr_sync->cur_sb_col[j],
-        aom_malloc(sizeof(*(lr_sync->cur_sb_col[j])) * num_rows_lr));
+    CHECK_MEM_ERROR(cm, lr_sync->cur_sb_col[j],
+                    aom_row_progress_alloc(num_rows_lr));
   }
   CHECK_MEM_ERROR(
       cm, lr_sync->job_queue,
       aom_malloc(sizeof(*(lr_sync->job_queue)) * num_rows_lr * num_planes));
   // Set up nsync.
   lr_sync->sync_range = get_lr_sync_range(width);
+  aom_mem_set_tag(prev_tag);
 }
 
 // Deallocate loop restoration synchronization related mutex and data
@@ -656,28 +814,13 @@ void av1_loop_restoration_dealloc(AV1LrSync *lr_sync, int num_workers) {
   if (lr_sync != NULL) {
     int j;
 #if CONFIG_MULTITHREAD
-    int i;
-    for (j = 0; j < MAX_MB_PLANE; j++) {
-      if (lr_sync->mutex_[j] != NULL) {
-        for (i = 0; i < lr_sync->rows; ++i) {
-          pthread_mutex_destroy(&lr_sync->mutex_[j][i]);
-        }
-        aom_free(lr_sync->mutex_[j]);
-      }
-      if (lr_sync->cond_[j] != NULL) {
-        for (i = 0; i < lr_sync->rows; ++i) {
-          pthread_cond_destroy(&lr_sync->cond_[j][i]);
-        }
-        aom_free(lr_sync->cond_[j]);
-      }
-    }
     if (lr_sync->job_mutex != NULL) {
       pthread_mutex_destroy(lr_sync->job_mutex);
       aom_free(lr_sync->job_mutex);
     }
 #endif  // CONFIG_MULTITHREAD
     for (j = 0; j < MAX_MB_PLANE; j++) {
-      aom_free(lr_sync->cur_sb_col[j]);
+      aom_row_progress_free(lr_sync->cur_sb_col[j], lr_sync->rows);
     }
 
     aom_free(lr_sync->job_queue);
@@ -796,14 +939,12 @@ static AV1LrMTInfo *get_lr_job_info(AV1LrSync *lr_sync) {
   return cur_job_info;
 }
 
-// Implement row loop restoration for each thread.
-static int loop_restoration_row_worker(void *arg1, void *arg2) {
-  AV1LrSync *const lr_sync = (AV1LrSync *)arg1;
-  LRWorkerData *lrworkerdata = (LRWorkerData *)arg2;
+// Loop restore one restoration unit row of one plane.
+static void loop_restoration_row(AV1LrSync *const lr_sync,
+                                 LRWorkerData *lrworkerdata,
+                                 const AV1LrMTInfo *cur_job_info) {
   AV1LrStruct *lr_ctxt = (AV1LrStruct *)lrworkerdata->lr_ctxt;
   FilterFrameCtxt *ctxt = lr_ctxt->ctxt;
-  int lr_unit_row;
-  int plane;
   const int tile_row = LR_TILE_ROW;
   const int tile_col = LR_TILE_COL;
   const int tile_cols = LR_TILE_COLS;
@@ -814,52 +955,55 @@ static int loop_restoration_row_worker(void *arg1, void *arg2) {
   static const copy_fun copy_funs[3] = { aom_yv12_partial_coloc_copy_y,
                                          aom_yv12_partial_coloc_copy_u,
                                          aom_yv12_partial_coloc_copy_v };
+  RestorationTileLimits limits;
+  sync_read_fn_t on_sync_read;
+  sync_write_fn_t on_sync_write;
+  limits.v_start = cur_job_info->v_start;
+  limits.v_end = cur_job_info->v_end;
+  const int lr_unit_row = cur_job_info->lr_unit_row;
+  const int plane = cur_job_info->plane;
+  const int unit_idx0 = tile_idx * ctxt[plane].rsi->units_per_tile;
+
+  // sync_mode == 1 implies only sync read is required in LR Multi-threading
+  // sync_mode == 0 implies only sync write is required.
+  on_sync_read =
+      cur_job_info->sync_mode == 1 ? lr_sync_read : av1_lr_sync_read_dummy;
+  on_sync_write =
+      cur_job_info->sync_mode == 0 ? lr_sync_write : av1_lr_sync_write_dummy;
+
+  av1_foreach_rest_unit_in_row(
+      &limits, &(ctxt[plane].tile_rect), lr_ctxt->on_rest_unit, lr_unit_row,
+      ctxt[plane].rsi->restoration_unit_size, unit_idx0,
+      ctxt[plane].rsi->horz_units_per_tile,
+      ctxt[plane].rsi->vert_units_per_tile, plane, &ctxt[plane],
+      lrworkerdata->rst_tmpbuf, lrworkerdata->rlbs, on_sync_read, on_sync_write,
+      lr_sync);
+
+  copy_funs[plane](lr_ctxt->dst, lr_ctxt->frame, ctxt[plane].tile_rect.left,
+                   ctxt[plane].tile_rect.right, cur_job_info->v_copy_start,
+                   cur_job_info->v_copy_end);
+}
 
-  while (1) {
-    AV1LrMTInfo *cur_job_info = get_lr_job_info(lr_sync);
-    if (cur_job_info != NULL) {
-      RestorationTileLimits limits;
-      sync_read_fn_t on_sync_read;
-      sync_write_fn_t on_sync_write;
-      limits.v_start = cur_job_info->v_start;
-      limits.v_end = cur_job_info->v_end;
-      lr_unit_row = cur_job_info->lr_unit_row;
-      plane = cur_job_info->plane;
-      const int unit_idx0 = tile_idx * ctxt[plane].rsi->units_per_tile;
-
-      // sync_mode == 1 implies only sync read is required in LR Multi-threading
-      // sync_mode == 0 implies only sync write is required.
-      on_sync_read =
-          cur_job_info->sync_mode == 1 ? lr_sync_read : av1_lr_sync_read_dummy;
-      on_sync_write = cur_job_info->sync_mode == 0 ? lr_sync_write
-                                                   : av1_lr_sync_write_dummy;
-
-      av1_foreach_rest_unit_in_row(
-          &limits, &(ctxt[plane].tile_rect), lr_ctxt->on_rest_unit, lr_unit_row,
-          ctxt[plane].rsi->restoration_unit_size, unit_idx0,
-          ctxt[plane].rsi->horz_units_per_tile,
-          ctxt[plane].rsi->vert_units_per_tile, plane, &ctxt[plane],
-          lrworkerdata->rst_tmpbuf, lrworkerdata->rlbs, on_sync_read,
-          on_sync_write, lr_sync);
-
-      copy_funs[plane](lr_ctxt->dst, lr_ctxt->frame, ctxt[plane].tile_rect.left,
-                       ctxt[plane].tile_rect.right, cur_job_info->v_copy_start,
-                       cur_job_info->v_copy_end);
-    } else {
-      break;
-    }
+// Implement row loop restoration for each thread.
+static int loop_restoration_row_worker(void *arg1, void *arg2) {
+  AV1LrSync *const lr_sync = (AV1LrSync *)arg1;
+  LRWorkerData *lrworkerdata = (LRWorkerData *)arg2;
+  AV1LrMTInfo *cur_job_info;
+
+  while ((cur_job_info = get_lr_job_info(lr_sync)) != NULL) {
+    loop_restoration_row(lr_sync, lrworkerdata, cur_job_info);
   }
   return 1;
 }
 
-static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
-                                           AVxWorker *workers, int nworkers,
-                                           AV1LrSync *lr_sync, AV1_COMMON *cm) {
+// Allocates the loop restoration row synchronization data if needed and
+// enqueues the restoration unit rows of all planes.
+static void loop_restoration_mt_init(AV1LrStruct *lr_ctxt, int num_workers,
+                                     AV1LrSync *lr_sync, AV1_COMMON *cm) {
   FilterFrameCtxt *ctxt = lr_ctxt->ctxt;
 
   const int num_planes = av1_num_planes(cm);
 
-  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
   int num_rows_lr = 0;
 
   for (int plane = 0; plane < num_planes; plane++) {
@@ -874,8 +1018,6 @@ static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
         AOMMAX(num_rows_lr, av1_lr_count_units_in_tile(unit_size, max_tile_h));
   }
 
-  const int num_workers = nworkers;
-  int i;
   assert(MAX_MB_PLANE == 3);
 
   if (!lr_sync->sync_range || num_rows_lr != lr_sync->rows ||
@@ -886,17 +1028,29 @@ static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
   }
 
   // Initialize cur_sb_col to -1 for all SB rows.
-  for (i = 0; i < num_planes; i++) {
-    memset(lr_sync->cur_sb_col[i], -1,
-           sizeof(*(lr_sync->cur_sb_col[i])) * num_rows_lr);
+  for (int i = 0; i < num_planes; i++) {
+    aom_row_progress_reset(lr_sync->cur_sb_col[i], num_rows_lr, -1);
   }
 
   enqueue_lr_jobs(lr_sync, lr_ctxt, cm);
 
+  for (int i = 0; i < num_workers; ++i) {
+    lr_sync->lrworkerdata[i].lr_ctxt = (void *)lr_ctxt;
+  }
+}
+
+static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
+                                           AVxWorker *workers, int nworkers,
+                                           AV1LrSync *lr_sync, AV1_COMMON *cm) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_workers = nworkers;
+  int i;
+
+  loop_restoration_mt_init(lr_ctxt, num_workers, lr_sync, cm);
+
   // Set up looprestoration thread data.
   for (i = 0; i < num_workers; ++i) {
     AVxWorker *const worker = &workers[i];
-    lr_sync->lrworkerdata[i].lr_ctxt = (void *)lr_ctxt;
     worker->hook = loop_restoration_row_worker;
     worker->data1 = lr_sync;
     worker->data2 = &lr_sync->lrworkerdata[i];
@@ -926,9 +1080,341 @@ void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
   AV1LrStruct *loop_rest_ctxt = (AV1LrStruct *)lr_ctxt;
 
   av1_loop_restoration_filter_frame_init(loop_rest_ctxt, frame, cm,
-                                         optimized_lr, num_planes);
+                                         optimized_lr, num_planes, 1);
 
   foreach_rest_unit_in_planes_mt(loop_rest_ctxt, workers, num_workers, lr_sync,
                                  cm);
 }
 #endif
+
+// Deallocate pipelined post-filter synchronization related mutex and data
+void av1_post_filter_dealloc(AV1PostFilterSync *pf_sync) {
+  if (pf_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    if (pf_sync->mutex_ != NULL) {
+      pthread_mutex_destroy(pf_sync->mutex_);
+      aom_free(pf_sync->mutex_);
+    }
+    if (pf_sync->cond_ != NULL) {
+      pthread_cond_destroy(pf_sync->cond_);
+      aom_free(pf_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(pf_sync->lf_planes_done);
+    aom_free(pf_sync->cdef_rows_done);
+    aom_free(pf_sync->pfworkerdata);
+
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*pf_sync);
+  }
+}
+
+#if !CONFIG_LPF_MASK
+// Allocate memory for pipelined post-filter synchronization
+static void post_filter_alloc(AV1PostFilterSync *pf_sync, AV1_COMMON *cm,
+                              int lf_rows, int cdef_rows, int num_workers) {
+  pf_sync->lf_rows = lf_rows;
+  pf_sync->cdef_rows = cdef_rows;
+#if CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, pf_sync->mutex_, aom_malloc(sizeof(*(pf_sync->mutex_))));
+  if (pf_sync->mutex_) pthread_mutex_init(pf_sync->mutex_, NULL);
+
+  CHECK_MEM_ERROR(cm, pf_sync->cond_, aom_malloc(sizeof(*(pf_sync->cond_))));
+  if (pf_sync->cond_) pthread_cond_init(pf_sync->cond_, NULL);
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(
+      cm, pf_sync->lf_planes_done,
+      aom_malloc(sizeof(*(pf_sync->lf_planes_done)) * lf_rows));
+  CHECK_MEM_ERROR(
+      cm, pf_sync->cdef_rows_done,
+      aom_malloc(sizeof(*(pf_sync->cdef_rows_done)) * cdef_rows));
+  CHECK_MEM_ERROR(
+      cm, pf_sync->pfworkerdata,
+      aom_malloc(num_workers * sizeof(*(pf_sync->pfworkerdata))));
+  pf_sync->num_workers = num_workers;
+}
+
+// Waits until progress[r] reaches target for all rows r in [start, end].
+static INLINE void post_filter_sync_read(AV1PostFilterSync *const pf_sync,
+                                         const int *progress, int start,
+                                         int end, int target) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+  for (int r = start; r <= end; ++r) {
+    while (progress[r] < target) {
+      pthread_cond_wait(pf_sync->cond_, pf_sync->mutex_);
+    }
+  }
+  pthread_mutex_unlock(pf_sync->mutex_);
+#else
+  (void)pf_sync;
+  (void)progress;
+  (void)start;
+  (void)end;
+  (void)target;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Waits until the first mi_rows rows of the frame are reconstructed.
+static INLINE void post_filter_wait_rows_ready(AV1PostFilterSync *const pf_sync,
+                                               int mi_rows) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+  while (pf_sync->mi_rows_ready < mi_rows) {
+    pthread_cond_wait(pf_sync->cond_, pf_sync->mutex_);
+  }
+  pthread_mutex_unlock(pf_sync->mutex_);
+#else
+  (void)pf_sync;
+  (void)mi_rows;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_post_filter_set_rows_ready(AV1PostFilterSync *pf_sync,
+                                    int mi_rows_ready) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+  pf_sync->mi_rows_ready = mi_rows_ready;
+  pthread_cond_broadcast(pf_sync->cond_);
+  pthread_mutex_unlock(pf_sync->mutex_);
+#else
+  pf_sync->mi_rows_ready = mi_rows_ready;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE void post_filter_sync_write(AV1PostFilterSync *const pf_sync,
+                                          int *progress, int r) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+  progress[r]++;
+  pthread_cond_broadcast(pf_sync->cond_);
+  pthread_mutex_unlock(pf_sync->mutex_);
+#else
+  progress[r]++;
+  (void)pf_sync;
+#endif  // CONFIG_MULTITHREAD
+}
+
+#if !CONFIG_REALTIME_ONLY
+// Saves the loop restoration boundary lines of filter block row fbr, before
+// (after_cdef == 0) or after (after_cdef == 1) it is filtered by cdef. After
+// cdef, the rows are also extended for loop restoration.
+static void post_filter_lr_rows(AV1PostFilterSync *const pf_sync, int fbr,
+                                int after_cdef) {
+  AV1_COMMON *const cm = pf_sync->cm;
+  YV12_BUFFER_CONFIG *const frame = pf_sync->frame;
+  const int num_planes = av1_num_planes(cm);
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    const int is_uv = plane > 0;
+    const int ss_y = is_uv && cm->seq_params.subsampling_y;
+    const int fb_height = (MI_SIZE_64X64 << MI_SIZE_LOG2) >> ss_y;
+    const int plane_height = frame->crop_heights[is_uv];
+    const int row_start = fbr * fb_height;
+    const int row_end = AOMMIN((fbr + 1) * fb_height, plane_height);
+
+    av1_loop_restoration_save_boundary_lines_rows(frame, cm, plane, after_cdef,
+                                                  row_start, row_end);
+    if (after_cdef &&
+        cm->rst_info[plane].frame_restoration_type != RESTORE_NONE) {
+      av1_extend_frame_rows(frame->buffers[plane], frame->crop_widths[is_uv],
+                            plane_height, frame->strides[is_uv],
+                            RESTORATION_BORDER, RESTORATION_BORDER, row_start,
+                            row_end, cm->seq_params.use_highbitdepth);
+    }
+  }
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
+// Pipelined post-filter hook. Each worker takes loopfilter jobs until there
+// are none left, then cdef jobs, then loop restoration jobs. A job only waits
+// for jobs that were dequeued before it, and for reconstructed rows, so the
+// pipeline cannot deadlock.
+int av1_post_filter_row_worker(void *arg1, void *arg2) {
+  AV1PostFilterSync *const pf_sync = (AV1PostFilterSync *)arg1;
+  AV1PostFilterWorkerData *const pf_data = (AV1PostFilterWorkerData *)arg2;
+  const int mi_rows = pf_sync->cm->mi_params.mi_rows;
+
+  if (pf_sync->lf_num_planes) {
+    LFWorkerData *const lf_data = pf_data->lf_data;
+    AV1LfMTInfo *cur_job_info;
+    while ((cur_job_info = get_lf_job_info(pf_sync->lf_sync)) != NULL) {
+      // The filtered superblock row must not change before the row below it,
+      // whose intra prediction reads it, is reconstructed.
+      post_filter_wait_rows_ready(
+          pf_sync, AOMMIN(mi_rows, cur_job_info->mi_row + 2 * MAX_MIB_SIZE));
+      loop_filter_row(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
+                      lf_data->xd, pf_sync->lf_sync, cur_job_info);
+      if (cur_job_info->dir == 1) {
+        post_filter_sync_write(pf_sync, pf_sync->lf_planes_done,
+                               cur_job_info->mi_row >> MAX_MIB_SIZE_LOG2);
+      }
+    }
+  }
+
+  int fbr;
+  while (get_cdef_row_job(pf_sync->cdef_sync, &fbr)) {
+    if (pf_sync->lf_num_planes) {
+      // Cdef reads up to CDEF_VBORDER lines below the filter block row, which
+      // are modified by the horizontal edges just below them.
+      const int last_pixel_row = (fbr + 1) * (MI_SIZE_64X64 << MI_SIZE_LOG2) +
+                                 2 * CDEF_VBORDER + 8;
+      const int lf_row_end =
+          AOMMIN(pf_sync->lf_rows - 1,
+                 last_pixel_row >> (MAX_MIB_SIZE_LOG2 + MI_SIZE_LOG2));
+      post_filter_sync_read(pf_sync, pf_sync->lf_planes_done, 0, lf_row_end,
+                            pf_sync->lf_num_planes);
+    } else {
+      post_filter_wait_rows_ready(
+          pf_sync,
+          AOMMIN(mi_rows, (fbr + 1) * MI_SIZE_64X64 + MAX_MIB_SIZE));
+    }
+#if !CONFIG_REALTIME_ONLY
+    if (pf_sync->do_loop_restoration) post_filter_lr_rows(pf_sync, fbr, 0);
+#endif  // !CONFIG_REALTIME_ONLY
+    cdef_row(pf_sync->cdef_sync, pf_data->cdef_data, fbr);
+#if !CONFIG_REALTIME_ONLY
+    if (pf_sync->do_loop_restoration) post_filter_lr_rows(pf_sync, fbr, 1);
+#endif  // !CONFIG_REALTIME_ONLY
+    post_filter_sync_write(pf_sync, pf_sync->cdef_rows_done, fbr);
+  }
+
+#if !CONFIG_REALTIME_ONLY
+  if (pf_sync->do_loop_restoration) {
+    AV1LrSync *const lr_sync = pf_sync->lr_sync;
+    const AV1LrStruct *const lr_ctxt =
+        (const AV1LrStruct *)pf_data->lr_data->lr_ctxt;
+    AV1LrMTInfo *cur_job_info;
+    while ((cur_job_info = get_lr_job_info(lr_sync)) != NULL) {
+      // Wait for the filter block rows covering the restoration unit row and
+      // the RESTORATION_BORDER lines around it.
+      const int ss_y = lr_ctxt->ctxt[cur_job_info->plane].ss_y;
+      const int fb_height = (MI_SIZE_64X64 << MI_SIZE_LOG2) >> ss_y;
+      const int fbr_start =
+          AOMMAX(0, cur_job_info->v_start - RESTORATION_BORDER) / fb_height;
+      const int fbr_end =
+          AOMMIN(pf_sync->cdef_rows - 1,
+                 (cur_job_info->v_end + RESTORATION_BORDER - 1) / fb_height);
+      post_filter_sync_read(pf_sync, pf_sync->cdef_rows_done, fbr_start,
+                            fbr_end, 1);
+      loop_restoration_row(lr_sync, pf_data->lr_data, cur_job_info);
+    }
+  }
+#endif  // !CONFIG_REALTIME_ONLY
+  return 1;
+}
+
+void av1_post_filter_frame_mt_init(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                   MACROBLOCKD *xd, void *lr_ctxt,
+                                   int num_workers, AV1LfSync *lf_sync,
+                                   AV1CdefRowSync *cdef_sync,
+                                   AV1LrSync *lr_sync,
+                                   AV1PostFilterSync *pf_sync,
+                                   int mi_rows_ready) {
+  const int num_planes = av1_num_planes(cm);
+  const int lf_rows =
+      ALIGN_POWER_OF_TWO(cm->mi_params.mi_rows, MAX_MIB_SIZE_LOG2) >>
+      MAX_MIB_SIZE_LOG2;
+  const int cdef_rows =
+      (cm->mi_params.mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  int i;
+
+  assert(!av1_superres_scaled(cm));
+
+  if (lf_rows != pf_sync->lf_rows || cdef_rows != pf_sync->cdef_rows ||
+      num_workers > pf_sync->num_workers) {
+    av1_post_filter_dealloc(pf_sync);
+    post_filter_alloc(pf_sync, cm, lf_rows, cdef_rows, num_workers);
+  }
+  memset(pf_sync->lf_planes_done, 0,
+         sizeof(*(pf_sync->lf_planes_done)) * lf_rows);
+  memset(pf_sync->cdef_rows_done, 0,
+         sizeof(*(pf_sync->cdef_rows_done)) * cdef_rows);
+  pf_sync->cm = cm;
+  pf_sync->frame = frame;
+  pf_sync->lf_sync = lf_sync;
+  pf_sync->cdef_sync = cdef_sync;
+  pf_sync->lr_sync = lr_sync;
+  pf_sync->mi_rows_ready = mi_rows_ready;
+
+  // Loopfilter jobs, same as av1_loop_filter_frame_mt() on the whole frame.
+  pf_sync->lf_num_planes = 0;
+  if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
+    av1_loop_filter_frame_init(cm, 0, num_planes);
+    if (!lf_sync->sync_range || lf_rows != lf_sync->rows ||
+        num_workers > lf_sync->num_workers) {
+      av1_loop_filter_dealloc(lf_sync);
+      loop_filter_alloc(lf_sync, cm, lf_rows, cm->width, num_workers);
+    }
+    for (i = 0; i < MAX_MB_PLANE; i++) {
+      aom_row_progress_reset(lf_sync->cur_sb_col[i], lf_rows, -1);
+    }
+    enqueue_lf_jobs(lf_sync, cm, 0, cm->mi_params.mi_rows, 0, num_planes);
+    for (i = 0; i < num_workers; ++i) {
+      loop_filter_data_reset(&lf_sync->lfdata[i], frame, cm, xd);
+    }
+    // Number of planes filtered per loopfilter row, as in enqueue_lf_jobs().
+    pf_sync->lf_num_planes = 1;
+    if (num_planes > 1 && cm->lf.filter_level_u) pf_sync->lf_num_planes++;
+    if (num_planes > 2 && cm->lf.filter_level_v) pf_sync->lf_num_planes++;
+  }
+
+  cdef_mt_init(frame, cm, xd, num_workers, cdef_sync);
+
+  pf_sync->do_loop_restoration = 0;
+#if !CONFIG_REALTIME_ONLY
+  if (lr_ctxt != NULL) {
+    AV1LrStruct *const loop_rest_ctxt = (AV1LrStruct *)lr_ctxt;
+    // The frame is extended for loop restoration row by row, after cdef.
+    av1_loop_restoration_filter_frame_init(loop_rest_ctxt, frame, cm, 0,
+                                           num_planes, 0);
+    loop_restoration_mt_init(loop_rest_ctxt, num_workers, lr_sync, cm);
+    pf_sync->do_loop_restoration = 1;
+  }
+#else
+  (void)lr_ctxt;
+#endif  // !CONFIG_REALTIME_ONLY
+
+  for (i = 0; i < num_workers; ++i) {
+    AV1PostFilterWorkerData *const pf_data = &pf_sync->pfworkerdata[i];
+
+    pf_data->lf_data = pf_sync->lf_num_planes ? &lf_sync->lfdata[i] : NULL;
+    pf_data->cdef_data = &cdef_sync->cdefworkerdata[i];
+    pf_data->lr_data =
+        pf_sync->do_loop_restoration ? &lr_sync->lrworkerdata[i] : NULL;
+  }
+}
+
+void av1_post_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                              MACROBLOCKD *xd, void *lr_ctxt,
+                              AVxWorker *workers, int num_workers,
+                              AV1LfSync *lf_sync, AV1CdefRowSync *cdef_sync,
+                              AV1LrSync *lr_sync, AV1PostFilterSync *pf_sync) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+
+  av1_post_filter_frame_mt_init(frame, cm, xd, lr_ctxt, num_workers, lf_sync,
+                                cdef_sync, lr_sync, pf_sync,
+                                cm->mi_params.mi_rows);
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = av1_post_filter_row_worker;
+    worker->data1 = pf_sync;
+    worker->data2 = &pf_sync->pfworkerdata[i];
+
+    // Start post-filtering
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+}
+#endif  // !CONFIG_LPF_MASK
@@ -15,6 +15,7 @@
 #include "config/aom_config.h"
 
 #include "av1/common/av1_loopfilter.h"
+#include "aom_util/aom_row_progress.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -31,12 +32,8 @@ typedef struct AV1LfMTInfo {
 
 // Loopfilter row synchronization
 typedef struct AV1LfSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_[MAX_MB_PLANE];
-  pthread_cond_t *cond_[MAX_MB_PLANE];
-#endif
   // Allocate memory to store the loop-filtered superblock index in each row.
-  int *cur_sb_col[MAX_MB_PLANE];
+  AVxRowProgress *cur_sb_col[MAX_MB_PLANE];
   // The optimal sync_range for different resolution and platform should be
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
   int sync_range;
@@ -72,12 +69,8 @@ typedef struct LoopRestorationWorkerData {
 
 // Looprestoration row synchronization
 typedef struct AV1LrSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_[MAX_MB_PLANE];
-  pthread_cond_t *cond_[MAX_MB_PLANE];
-#endif
   // Allocate memory to store the loop-restoration block index in each row.
-  int *cur_sb_col[MAX_MB_PLANE];
+  AVxRowProgress *cur_sb_col[MAX_MB_PLANE];
   // The optimal sync_range for different resolution and platform should be
   // determined by testing. Currently, it is chosen to be a power-of-2 number.
   int sync_range;
@@ -97,6 +90,69 @@ typedef struct AV1LrSyncData {
   int jobs_dequeued;
 } AV1LrSync;
 
+typedef struct AV1CdefWorkerData {
+  struct AV1Common *cm;
+  struct macroblockd *xd;
+  uint16_t *srcbuf;
+  uint16_t *colbuf[MAX_MB_PLANE];
+} AV1CdefWorkerData;
+
+// CDEF row synchronization
+typedef struct AV1CdefRowSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+  pthread_mutex_t *job_mutex;
+#endif
+  // Set once the boundary lines below a filter block row have been saved.
+  int *row_ready;
+  int rows;
+  int linebuf_stride;
+  uint16_t *linebuf[MAX_MB_PLANE];
+
+  AV1CdefWorkerData *cdefworkerdata;
+  int num_workers;
+
+  int next_fbr;
+} AV1CdefRowSync;
+
+typedef struct AV1PostFilterWorkerData {
+  LFWorkerData *lf_data;
+  AV1CdefWorkerData *cdef_data;
+  LRWorkerData *lr_data;
+} AV1PostFilterWorkerData;
+
+// Pipelined loopfilter, cdef and loop restoration synchronization
+typedef struct AV1PostFilterSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // Number of planes whose horizontal edges are loop filtered, per
+  // superblock row.
+  int *lf_planes_done;
+  int lf_rows;
+  // Number of planes loop filtered in the current frame.
+  int lf_num_planes;
+  // Set once cdef, and the loop restoration setup of the rows, is complete,
+  // per 64x64 filter block row.
+  int *cdef_rows_done;
+  int cdef_rows;
+  int do_loop_restoration;
+  // Number of rows of the frame, in mi units, that are reconstructed and may
+  // be filtered.
+  int mi_rows_ready;
+
+  struct AV1Common *cm;
+  YV12_BUFFER_CONFIG *frame;
+  AV1LfSync *lf_sync;
+  AV1CdefRowSync *cdef_sync;
+  AV1LrSync *lr_sync;
+
+  AV1PostFilterWorkerData *pfworkerdata;
+  int num_workers;
+} AV1PostFilterSync;
+
 // Deallocate loopfilter synchronization related mutex and data.
 void av1_loop_filter_dealloc(AV1LfSync *lf_sync);
 
@@ -109,6 +165,42 @@ void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
                               AVxWorker *workers, int num_workers,
                               AV1LfSync *lf_sync);
 
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                       struct macroblockd *xd, AVxWorker *workers,
+                       int num_workers, AV1CdefRowSync *cdef_sync);
+void av1_cdef_dealloc(AV1CdefRowSync *cdef_sync);
+
+#if !CONFIG_LPF_MASK
+// Applies the loop filter, cdef and, if lr_ctxt is not NULL, loop restoration
+// to a frame in a single pass over the workers. Cdef on a 64x64 filter block
+// row starts as soon as the loop filter has finished the rows it reads, and
+// loop restoration follows cdef in the same way. Cdef must be enabled and the
+// frame must not use superres.
+void av1_post_filter_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                              struct macroblockd *xd, void *lr_ctxt,
+                              AVxWorker *workers, int num_workers,
+                              AV1LfSync *lf_sync, AV1CdefRowSync *cdef_sync,
+                              AV1LrSync *lr_sync, AV1PostFilterSync *pf_sync);
+// Sets up pf_sync for av1_post_filter_row_worker() without running it. The
+// filters wait for the first mi_rows_ready rows of the frame, and later rows
+// as they are signaled with av1_post_filter_set_rows_ready(), so they can run
+// while the frame is still being reconstructed.
+void av1_post_filter_frame_mt_init(YV12_BUFFER_CONFIG *frame,
+                                   struct AV1Common *cm,
+                                   struct macroblockd *xd, void *lr_ctxt,
+                                   int num_workers, AV1LfSync *lf_sync,
+                                   AV1CdefRowSync *cdef_sync,
+                                   AV1LrSync *lr_sync,
+                                   AV1PostFilterSync *pf_sync,
+                                   int mi_rows_ready);
+// Post-filter worker hook, with pf_sync as arg1 and the worker's entry in
+// pf_sync->pfworkerdata as arg2.
+int av1_post_filter_row_worker(void *arg1, void *arg2);
+void av1_post_filter_set_rows_ready(AV1PostFilterSync *pf_sync,
+                                    int mi_rows_ready);
+#endif  // !CONFIG_LPF_MASK
+void av1_post_filter_dealloc(AV1PostFilterSync *pf_sync);
+
 #if !CONFIG_REALTIME_ONLY
 void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
                                           struct AV1Common *cm,
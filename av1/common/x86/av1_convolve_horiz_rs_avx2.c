@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "av1/common/convolve.h"
+#include "av1/common/resize.h"
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_dsp/x86/synonyms_avx2.h"
+
+// Loads the filters of output pixels x and x + 4 into the low and high lanes.
+static INLINE __m256i load_filter_pair(const int16_t *x_filters, int x_qn,
+                                       int x_step_qn) {
+  const int x_filter_idx0 =
+      (x_qn & RS_SCALE_SUBPEL_MASK) >> RS_SCALE_EXTRA_BITS;
+  const int x_filter_idx1 =
+      ((x_qn + 4 * x_step_qn) & RS_SCALE_SUBPEL_MASK) >> RS_SCALE_EXTRA_BITS;
+  assert(x_filter_idx0 <= RS_SUBPEL_MASK);
+  assert(x_filter_idx1 <= RS_SUBPEL_MASK);
+  return yy_loadu2_128(&x_filters[x_filter_idx1 * UPSCALE_NORMATIVE_TAPS],
+                       &x_filters[x_filter_idx0 * UPSCALE_NORMATIVE_TAPS]);
+}
+
+// Sums the partial products of 8 output pixels, where the low and high lanes of
+// conv{0,1,2,3} belong to pixels {0,1,2,3} and {4,5,6,7} respectively, and
+// returns the rounded 32-bit results in order.
+static INLINE __m256i reduce_and_round(__m256i conv0, __m256i conv1,
+                                       __m256i conv2, __m256i conv3) {
+  const __m256i round_add = _mm256_set1_epi32((1 << FILTER_BITS) >> 1);
+  // ([ 4 | 0 ], [ 5 | 1 ]) -> [ 5 5 4 4 | 1 1 0 0 ]
+  const __m256i conv01 = _mm256_hadd_epi32(conv0, conv1);
+  const __m256i conv23 = _mm256_hadd_epi32(conv2, conv3);
+  // -> [ 7 6 5 4 | 3 2 1 0 ]
+  const __m256i conv0123 = _mm256_hadd_epi32(conv01, conv23);
+  return _mm256_srai_epi32(_mm256_add_epi32(conv0123, round_add), FILTER_BITS);
+}
+
+// Unlike the SSE4.1 version, this function never writes past the crop width:
+// the last (w % 8) pixels of each row are computed with the C filter.
+void av1_convolve_horiz_rs_avx2(const uint8_t *src, int src_stride,
+                                uint8_t *dst, int dst_stride, int w, int h,
+                                const int16_t *x_filters, int x0_qn,
+                                int x_step_qn) {
+  assert(UPSCALE_NORMATIVE_TAPS == 8);
+
+  const uint8_t *const src_in = src;
+  src -= UPSCALE_NORMATIVE_TAPS / 2 - 1;
+
+  int x_qn = x0_qn;
+  int x = 0;
+  for (; x + 8 <= w; x += 8, x_qn += 8 * x_step_qn) {
+    const __m256i fil0 = load_filter_pair(x_filters, x_qn, x_step_qn);
+    const __m256i fil1 =
+        load_filter_pair(x_filters, x_qn + x_step_qn, x_step_qn);
+    const __m256i fil2 =
+        load_filter_pair(x_filters, x_qn + 2 * x_step_qn, x_step_qn);
+    const __m256i fil3 =
+        load_filter_pair(x_filters, x_qn + 3 * x_step_qn, x_step_qn);
+
+    int src_x[8];
+    for (int k = 0; k < 8; ++k)
+      src_x[k] = (x_qn + k * x_step_qn) >> RS_SCALE_SUBPEL_BITS;
+
+    const uint8_t *src_y = src;
+    uint8_t *dst_y = dst;
+    for (int y = 0; y < h; y++, src_y += src_stride, dst_y += dst_stride) {
+      // Load 8 source pixels per output pixel and zero-extend them to 16 bits,
+      // pairing output pixels k and k + 4 in one register.
+      const __m256i src0 = _mm256_cvtepu8_epi16(
+          _mm_unpacklo_epi64(xx_loadl_64(&src_y[src_x[0]]),
+                             xx_loadl_64(&src_y[src_x[4]])));
+      const __m256i src1 = _mm256_cvtepu8_epi16(
+          _mm_unpacklo_epi64(xx_loadl_64(&src_y[src_x[1]]),
+                             xx_loadl_64(&src_y[src_x[5]])));
+      const __m256i src2 = _mm256_cvtepu8_epi16(
+          _mm_unpacklo_epi64(xx_loadl_64(&src_y[src_x[2]]),
+                             xx_loadl_64(&src_y[src_x[6]])));
+      const __m256i src3 = _mm256_cvtepu8_epi16(
+          _mm_unpacklo_epi64(xx_loadl_64(&src_y[src_x[3]]),
+                             xx_loadl_64(&src_y[src_x[7]])));
+
+      const __m256i res_32 = reduce_and_round(
+          _mm256_madd_epi16(src0, fil0), _mm256_madd_epi16(src1, fil1),
+          _mm256_madd_epi16(src2, fil2), _mm256_madd_epi16(src3, fil3));
+
+      const __m128i res_16 =
+          _mm_packus_epi32(_mm256_castsi256_si128(res_32),
+                           _mm256_extracti128_si256(res_32, 1));
+      xx_storel_64(&dst_y[x], _mm_packus_epi16(res_16, res_16));
+    }
+  }
+
+  if (x < w) {
+    av1_convolve_horiz_rs_c(src_in, src_stride, dst + x, dst_stride, w - x, h,
+                            x_filters, x_qn, x_step_qn);
+  }
+}
+
+// Unlike the SSE4.1 version, this function never writes past the crop width:
+// the last (w % 8) pixels of each row are computed with the C filter.
+void av1_highbd_convolve_horiz_rs_avx2(const uint16_t *src, int src_stride,
+                                       uint16_t *dst, int dst_stride, int w,
+                                       int h, const int16_t *x_filters,
+                                       int x0_qn, int x_step_qn, int bd) {
+  assert(UPSCALE_NORMATIVE_TAPS == 8);
+  assert(bd == 8 || bd == 10 || bd == 12);
+
+  const uint16_t *const src_in = src;
+  src -= UPSCALE_NORMATIVE_TAPS / 2 - 1;
+
+  const __m128i clip_maximum = _mm_set1_epi16((1 << bd) - 1);
+
+  int x_qn = x0_qn;
+  int x = 0;
+  for (; x + 8 <= w; x += 8, x_qn += 8 * x_step_qn) {
+    const __m256i fil0 = load_filter_pair(x_filters, x_qn, x_step_qn);
+    const __m256i fil1 =
+        load_filter_pair(x_filters, x_qn + x_step_qn, x_step_qn);
+    const __m256i fil2 =
+        load_filter_pair(x_filters, x_qn + 2 * x_step_qn, x_step_qn);
+    const __m256i fil3 =
+        load_filter_pair(x_filters, x_qn + 3 * x_step_qn, x_step_qn);
+
+    int src_x[8];
+    for (int k = 0; k < 8; ++k)
+      src_x[k] = (x_qn + k * x_step_qn) >> RS_SCALE_SUBPEL_BITS;
+
+    const uint16_t *src_y = src;
+    uint16_t *dst_y = dst;
+    for (int y = 0; y < h; y++, src_y += src_stride, dst_y += dst_stride) {
+      // Load 8 source pixels per output pixel, pairing output pixels k and
+      // k + 4 in one register.
+      const __m256i src0 = yy_loadu2_128(&src_y[src_x[4]], &src_y[src_x[0]]);
+      const __m256i src1 = yy_loadu2_128(&src_y[src_x[5]], &src_y[src_x[1]]);
+      const __m256i src2 = yy_loadu2_128(&src_y[src_x[6]], &src_y[src_x[2]]);
+      const __m256i src3 = yy_loadu2_128(&src_y[src_x[7]], &src_y[src_x[3]]);
+
+      const __m256i res_32 = reduce_and_round(
+          _mm256_madd_epi16(src0, fil0), _mm256_madd_epi16(src1, fil1),
+          _mm256_madd_epi16(src2, fil2), _mm256_madd_epi16(src3, fil3));
+
+      const __m128i res_16 =
+          _mm_packus_epi32(_mm256_castsi256_si128(res_32),
+                           _mm256_extracti128_si256(res_32, 1));
+      xx_storeu_128(&dst_y[x], _mm_min_epi16(res_16, clip_maximum));
+    }
+  }
+
+  if (x < w) {
+    av1_highbd_convolve_horiz_rs_c(src_in, src_stride, dst + x, dst_stride,
+                                   w - x, h, x_filters, x_qn, x_step_qn, bd);
+  }
+}
@@ -2513,30 +2513,8 @@ static INLINE int get_sync_range(int width) {
 static AOM_INLINE void dec_row_mt_alloc(AV1DecRowMTSync *dec_row_mt_sync,
                                         AV1_COMMON *cm, int rows) {
   dec_row_mt_sync->allocated_sb_rows = rows;
-#if CONFIG_MULTITHREAD
-  {
-    int i;
-
-    CHECK_MEM_ERROR(cm, dec_row_mt_sync->mutex_,
-                    aom_malloc(sizeof(*(dec_row_mt_sync->mutex_)) * rows));
-    if (dec_row_mt_sync->mutex_) {
-      for (i = 0; i < rows; ++i) {
-        pthread_mutex_init(&dec_row_mt_sync->mutex_[i], NULL);
-      }
-    }
-
-    CHECK_MEM_ERROR(cm, dec_row_mt_sync->cond_,
-                    aom_malloc(sizeof(*(dec_row_mt_sync->cond_)) * rows));
-    if (dec_row_mt_sync->cond_) {
-      for (i = 0; i < rows; ++i) {
-        pthread_cond_init(&dec_row_mt_sync->cond_[i], NULL);
-      }
-    }
-  }
-#endif  // CONFIG_MULTITHREAD
-
   CHECK_MEM_ERROR(cm, dec_row_mt_sync->cur_sb_col,
-                  aom_malloc(sizeof(*(dec_row_mt_sync->cur_sb_col)) * rows));
+                  aom_row_progress_alloc(rows));
 
   // Set up nsync.
   dec_row_mt_sync->sync_range = get_sync_range(cm->width);
@@ -2545,22 +2523,8 @@ static AOM_INLINE void dec_row_mt_alloc(AV1DecRowMTSync *dec_row_mt_sync,
 // Deallocate decoder row synchronization related mutex and data
 void av1_dec_row_mt_dealloc(AV1DecRowMTSync *dec_row_mt_sync) {
   if (dec_row_mt_sync != NULL) {
-#if CONFIG_MULTITHREAD
-    int i;
-    if (dec_row_mt_sync->mutex_ != NULL) {
-      for (i = 0; i < dec_row_mt_sync->allocated_sb_rows; ++i) {
-        pthread_mutex_destroy(&dec_row_mt_sync->mutex_[i]);
-      }
-      aom_free(dec_row_mt_sync->mutex_);
-    }
-    if (dec_row_mt_sync->cond_ != NULL) {
-      for (i = 0; i < dec_row_mt_sync->allocated_sb_rows; ++i) {
-        pthread_cond_destroy(&dec_row_mt_sync->cond_[i]);
-      }
-      aom_free(dec_row_mt_sync->cond_);
-    }
-#endif  // CONFIG_MULTITHREAD
-    aom_free(dec_row_mt_sync->cur_sb_col);
+    aom_row_progress_free(dec_row_mt_sync->cur_sb_col,
+                          dec_row_mt_sync->allocated_sb_rows);
 
     // clear the structure as the source of this call may be a resize in which
     // case this call will be followed by an _alloc() which may fail.
@@ -2574,13 +2538,7 @@ static INLINE void sync_read(AV1DecRowMTSync *const dec_row_mt_sync, int r,
   const int nsync = dec_row_mt_sync->sync_range;
 
   if (r && !(c & (nsync - 1))) {
-    pthread_mutex_t *const mutex = &dec_row_mt_sync->mutex_[r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > dec_row_mt_sync->cur_sb_col[r - 1] - nsync) {
-      pthread_cond_wait(&dec_row_mt_sync->cond_[r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_row_progress_wait(&dec_row_mt_sync->cur_sb_col[r - 1], c + nsync);
   }
 #else
   (void)dec_row_mt_sync;
@@ -2604,12 +2562,7 @@ static INLINE void sync_write(AV1DecRowMTSync *const dec_row_mt_sync, int r,
   }
 
   if (sig) {
-    pthread_mutex_lock(&dec_row_mt_sync->mutex_[r]);
-
-    dec_row_mt_sync->cur_sb_col[r] = cur;
-
-    pthread_cond_signal(&dec_row_mt_sync->cond_[r]);
-    pthread_mutex_unlock(&dec_row_mt_sync->mutex_[r]);
+    aom_row_progress_set(&dec_row_mt_sync->cur_sb_col[r], cur);
   }
 #else
   (void)dec_row_mt_sync;
@@ -3171,6 +3124,59 @@ static AOM_INLINE void parse_tile_row_mt(AV1Decoder *pbi, ThreadData *const td,
   aom_merge_corrupted_flag(&dcb->corrupted, corrupted);
 }
 
+// Records that one tile has decoded the superblock row at mi_row, and lets the
+// post-filter start on the rows that are decoded in all tiles. The caller must
+// hold pbi->row_mt_mutex_.
+static AOM_INLINE void signal_decode_sb_row_done(AV1Decoder *const pbi,
+                                                 const int mi_row) {
+#if !CONFIG_LPF_MASK
+  AV1_COMMON *const cm = &pbi->common;
+  AV1DecRowMTInfo *frame_row_mt_info = &pbi->frame_row_mt_info;
+  const int tile_cols =
+      frame_row_mt_info->tile_cols_end - frame_row_mt_info->tile_cols_start;
+  const int sb_rows = frame_row_mt_info->alloc_sb_rows;
+  const int sb_rows_decoded = frame_row_mt_info->sb_rows_decoded;
+
+  frame_row_mt_info
+      ->sb_row_tiles_decoded[mi_row >> cm->seq_params.mib_size_log2]++;
+  while (frame_row_mt_info->sb_rows_decoded < sb_rows &&
+         frame_row_mt_info
+                 ->sb_row_tiles_decoded[frame_row_mt_info->sb_rows_decoded] ==
+             tile_cols) {
+    frame_row_mt_info->sb_rows_decoded++;
+  }
+  if (frame_row_mt_info->sb_rows_decoded != sb_rows_decoded) {
+    av1_post_filter_set_rows_ready(
+        &pbi->post_filter_sync,
+        AOMMIN(cm->mi_params.mi_rows, frame_row_mt_info->sb_rows_decoded
+                                          << cm->seq_params.mib_size_log2));
+  }
+#else
+  (void)pbi;
+  (void)mi_row;
+#endif  // !CONFIG_LPF_MASK
+}
+
+// Sets row_mt_exit to abort the decoding of the frame. The post-filter, if
+// overlapped with the decoding, no longer waits for rows to be decoded.
+static AOM_INLINE void signal_row_mt_exit(AV1Decoder *const pbi) {
+  AV1DecRowMTInfo *frame_row_mt_info = &pbi->frame_row_mt_info;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pbi->row_mt_mutex_);
+#endif
+  frame_row_mt_info->row_mt_exit = 1;
+#if !CONFIG_LPF_MASK
+  if (frame_row_mt_info->post_filter_overlap) {
+    av1_post_filter_set_rows_ready(&pbi->post_filter_sync,
+                                   pbi->common.mi_params.mi_rows);
+  }
+#endif  // !CONFIG_LPF_MASK
+#if CONFIG_MULTITHREAD
+  pthread_cond_broadcast(pbi->row_mt_cond_);
+  pthread_mutex_unlock(pbi->row_mt_mutex_);
+#endif
+}
+
 static int row_mt_worker_hook(void *arg1, void *arg2) {
   DecWorkerData *const thread_data = (DecWorkerData *)arg1;
   AV1Decoder *const pbi = (AV1Decoder *)arg2;
@@ -3186,14 +3192,7 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
   if (setjmp(thread_data->error_info.jmp)) {
     thread_data->error_info.setjmp = 0;
     thread_data->td->dcb.corrupted = 1;
-#if CONFIG_MULTITHREAD
-    pthread_mutex_lock(pbi->row_mt_mutex_);
-#endif
-    frame_row_mt_info->row_mt_exit = 1;
-#if CONFIG_MULTITHREAD
-    pthread_cond_broadcast(pbi->row_mt_cond_);
-    pthread_mutex_unlock(pbi->row_mt_mutex_);
-#endif
+    signal_row_mt_exit(pbi);
     return 0;
   }
   thread_data->error_info.setjmp = 1;
@@ -3235,14 +3234,7 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
 
   if (td->dcb.corrupted) {
     thread_data->error_info.setjmp = 0;
-#if CONFIG_MULTITHREAD
-    pthread_mutex_lock(pbi->row_mt_mutex_);
-#endif
-    frame_row_mt_info->row_mt_exit = 1;
-#if CONFIG_MULTITHREAD
-    pthread_cond_broadcast(pbi->row_mt_cond_);
-    pthread_mutex_unlock(pbi->row_mt_mutex_);
-#endif
+    signal_row_mt_exit(pbi);
     return 0;
   }
 
@@ -3285,11 +3277,22 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
     pthread_mutex_lock(pbi->row_mt_mutex_);
 #endif
     dec_row_mt_sync->num_threads_working--;
+    if (frame_row_mt_info->post_filter_overlap)
+      signal_decode_sb_row_done(pbi, mi_row);
 #if CONFIG_MULTITHREAD
     pthread_mutex_unlock(pbi->row_mt_mutex_);
 #endif
   }
   thread_data->error_info.setjmp = 0;
+
+#if !CONFIG_LPF_MASK
+  if (frame_row_mt_info->post_filter_overlap) {
+    // Post-filter the rows of the frame as the remaining decode jobs finish.
+    const int worker_idx = (int)(thread_data - pbi->thread_data);
+    av1_post_filter_row_worker(&pbi->post_filter_sync,
+                               &pbi->post_filter_sync.pfworkerdata[worker_idx]);
+  }
+#endif  // !CONFIG_LPF_MASK
   return !td->dcb.corrupted;
 }
 
@@ -3677,8 +3680,8 @@ static AOM_INLINE void row_mt_frame_init(AV1Decoder *pbi, int tile_rows_start,
           tile_data->dec_row_mt_sync.mi_rows;
 
       // Initialize cur_sb_col to -1 for all SB rows.
-      memset(tile_data->dec_row_mt_sync.cur_sb_col, -1,
-             sizeof(*tile_data->dec_row_mt_sync.cur_sb_col) * max_sb_rows);
+      aom_row_progress_reset(tile_data->dec_row_mt_sync.cur_sb_col,
+                             max_sb_rows, -1);
     }
   }
 
@@ -3701,6 +3704,53 @@ static AOM_INLINE void row_mt_frame_init(AV1Decoder *pbi, int tile_rows_start,
 #endif
 }
 
+#if !CONFIG_LPF_MASK
+// Returns the loop restoration context for the post-filter pipeline, or NULL
+// if loop restoration is off in the current frame.
+static void *post_filter_lr_ctxt(AV1Decoder *pbi) {
+#if !CONFIG_REALTIME_ONLY
+  const AV1_COMMON *const cm = &pbi->common;
+  if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[2].frame_restoration_type != RESTORE_NONE)
+    return &pbi->lr_ctxt;
+#else
+  (void)pbi;
+#endif  // !CONFIG_REALTIME_ONLY
+  return NULL;
+}
+
+// Sets up the post-filter pipeline to run on the tile workers after their
+// decode jobs, on the rows that are decoded in all tiles.
+static AOM_INLINE void post_filter_overlap_init(AV1Decoder *pbi,
+                                                int num_workers) {
+  AV1_COMMON *const cm = &pbi->common;
+  AV1DecRowMTInfo *frame_row_mt_info = &pbi->frame_row_mt_info;
+  const int mib_size_log2 = cm->seq_params.mib_size_log2;
+  const int sb_rows =
+      ALIGN_POWER_OF_TWO(cm->mi_params.mi_rows, mib_size_log2) >>
+      mib_size_log2;
+
+  if (frame_row_mt_info->alloc_sb_rows != sb_rows) {
+    aom_free(frame_row_mt_info->sb_row_tiles_decoded);
+    frame_row_mt_info->alloc_sb_rows = 0;
+    CHECK_MEM_ERROR(
+        cm, frame_row_mt_info->sb_row_tiles_decoded,
+        aom_malloc(sizeof(*frame_row_mt_info->sb_row_tiles_decoded) *
+                   sb_rows));
+    frame_row_mt_info->alloc_sb_rows = sb_rows;
+  }
+  memset(frame_row_mt_info->sb_row_tiles_decoded, 0,
+         sizeof(*frame_row_mt_info->sb_row_tiles_decoded) * sb_rows);
+  frame_row_mt_info->sb_rows_decoded = 0;
+
+  av1_post_filter_frame_mt_init(&cm->cur_frame->buf, cm, &pbi->dcb.xd,
+                                post_filter_lr_ctxt(pbi), num_workers,
+                                &pbi->lf_row_sync, &pbi->cdef_row_sync,
+                                &pbi->lr_row_sync, &pbi->post_filter_sync, 0);
+}
+#endif  // !CONFIG_LPF_MASK
+
 static const uint8_t *decode_tiles_row_mt(AV1Decoder *pbi, const uint8_t *data,
                                           const uint8_t *data_end,
                                           int start_tile, int end_tile) {
@@ -3805,6 +3855,15 @@ static const uint8_t *decode_tiles_row_mt(AV1Decoder *pbi, const uint8_t *data,
   row_mt_frame_init(pbi, tile_rows_start, tile_rows_end, tile_cols_start,
                     tile_cols_end, start_tile, end_tile, max_sb_rows);
 
+#if !CONFIG_LPF_MASK
+  if (pbi->frame_row_mt_info.post_filter_overlap) {
+    // Every worker takes part in the post-filter, even if there are fewer
+    // decode jobs.
+    num_workers = pbi->num_workers;
+    post_filter_overlap_init(pbi, num_workers);
+  }
+#endif  // !CONFIG_LPF_MASK
+
   reset_dec_workers(pbi, row_mt_worker_hook, num_workers);
   launch_dec_workers(pbi, data_end, num_workers);
   sync_dec_workers(pbi, num_workers);
@@ -5118,7 +5177,11 @@ static AOM_INLINE void superres_post_decode(AV1Decoder *pbi) {
   if (!av1_superres_scaled(cm)) return;
   assert(!cm->features.all_lossless);
 
-  av1_superres_upscale(cm, pool);
+  if (pbi->num_workers > 1) {
+    av1_superres_upscale_mt(cm, pool, pbi->tile_workers, pbi->num_workers);
+  } else {
+    av1_superres_upscale(cm, pool);
+  }
 }
 #endif
 
@@ -5231,6 +5294,24 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
 #if CONFIG_LPF_MASK
   av1_loop_filter_frame_init(cm, 0, num_planes);
 #endif
+  const int do_post_filter =
+      !cm->features.allow_intrabc && !tiles->single_tile_decoding;
+  const int do_cdef =
+      !pbi->skip_loop_filter && !cm->features.coded_lossless &&
+      (cm->cdef_info.cdef_bits || cm->cdef_info.cdef_strengths[0] ||
+       cm->cdef_info.cdef_uv_strengths[0]);
+  const int do_superres = av1_superres_scaled(cm);
+
+#if !CONFIG_LPF_MASK
+  // With row based multi-threading, the post-filter pipeline can start while
+  // the frame is decoded, if the frame is a single tile group.
+  pbi->frame_row_mt_info.post_filter_overlap =
+      pbi->postfilter_overlap && do_post_filter && do_cdef && !do_superres &&
+      pbi->max_threads > 1 && pbi->row_mt && !tiles->large_scale &&
+      start_tile == 0 && end_tile == tiles->rows * tiles->cols - 1;
+#else
+  pbi->frame_row_mt_info.post_filter_overlap = 0;
+#endif  // !CONFIG_LPF_MASK
 
   if (pbi->max_threads > 1 && !(tiles->large_scale && !pbi->ext_tile_debug) &&
       pbi->row_mt)
@@ -5251,84 +5332,110 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     return;
   }
 
-  if (!cm->features.allow_intrabc && !tiles->single_tile_decoding) {
-    if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
-      if (pbi->num_workers > 1) {
-        av1_loop_filter_frame_mt(
-            &cm->cur_frame->buf, cm, &pbi->dcb.xd, 0, num_planes, 0,
+  if (do_post_filter) {
+    // The tile workers have already filtered the frame if the post-filter
+    // overlapped the decoding.
+    int post_filter_done = pbi->frame_row_mt_info.post_filter_overlap;
+
+#if !CONFIG_LPF_MASK
+    if (!post_filter_done && pbi->num_workers > 1 && do_cdef && !do_superres) {
+      // Run the loop filter, cdef and loop restoration as one pipeline over
+      // 64x64 filter block rows.
+      av1_post_filter_frame_mt(&cm->cur_frame->buf, cm, &pbi->dcb.xd,
+                               post_filter_lr_ctxt(pbi), pbi->tile_workers,
+                               pbi->num_workers, &pbi->lf_row_sync,
+                               &pbi->cdef_row_sync, &pbi->lr_row_sync,
+                               &pbi->post_filter_sync);
+      post_filter_done = 1;
+    }
+#endif  // !CONFIG_LPF_MASK
+
+    if (!post_filter_done) {
+      if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
+        if (pbi->num_workers > 1) {
+          av1_loop_filter_frame_mt(
+              &cm->cur_frame->buf, cm, &pbi->dcb.xd, 0, num_planes, 0,
 #if CONFIG_LPF_MASK
-            1,
+              1,
 #endif
-            pbi->tile_workers, pbi->num_workers, &pbi->lf_row_sync);
-      } else {
-        av1_loop_filter_frame(&cm->cur_frame->buf, cm, &pbi->dcb.xd,
+              pbi->tile_workers, pbi->num_workers, &pbi->lf_row_sync);
+        } else {
+          av1_loop_filter_frame(&cm->cur_frame->buf, cm, &pbi->dcb.xd,
 #if CONFIG_LPF_MASK
-                              1,
+                                1,
 #endif
-                              0, num_planes, 0);
+                                0, num_planes, 0);
+        }
       }
-    }
 
-    const int do_cdef =
-        !pbi->skip_loop_filter && !cm->features.coded_lossless &&
-        (cm->cdef_info.cdef_bits || cm->cdef_info.cdef_strengths[0] ||
-         cm->cdef_info.cdef_uv_strengths[0]);
-    const int do_superres = av1_superres_scaled(cm);
-    const int optimized_loop_restoration = !do_cdef && !do_superres;
+      const int optimized_loop_restoration = !do_cdef && !do_superres;
 
 #if !CONFIG_REALTIME_ONLY
-    const int do_loop_restoration =
-        cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
-        cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
-        cm->rst_info[2].frame_restoration_type != RESTORE_NONE;
-    if (!optimized_loop_restoration) {
-      if (do_loop_restoration)
-        av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
-                                                 cm, 0);
-
-      if (do_cdef) {
-        av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd);
-      }
+      const int do_loop_restoration =
+          cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+          cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+          cm->rst_info[2].frame_restoration_type != RESTORE_NONE;
+      if (!optimized_loop_restoration) {
+        if (do_loop_restoration)
+          av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
+                                                   cm, 0);
+
+        if (do_cdef) {
+          if (pbi->num_workers > 1) {
+            av1_cdef_frame_mt(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd,
+                              pbi->tile_workers, pbi->num_workers,
+                              &pbi->cdef_row_sync);
+          } else {
+            av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd);
+          }
+        }
 
-      superres_post_decode(pbi);
+        superres_post_decode(pbi);
 
-      if (do_loop_restoration) {
-        av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
-                                                 cm, 1);
-        if (pbi->num_workers > 1) {
-          av1_loop_restoration_filter_frame_mt(
-              (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, optimized_loop_restoration,
-              pbi->tile_workers, pbi->num_workers, &pbi->lr_row_sync,
-              &pbi->lr_ctxt);
-        } else {
-          av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
-                                            cm, optimized_loop_restoration,
-                                            &pbi->lr_ctxt);
+        if (do_loop_restoration) {
+          av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
+                                                   cm, 1);
+          if (pbi->num_workers > 1) {
+            av1_loop_restoration_filter_frame_mt(
+                (YV12_BUFFER_CONFIG *)xd->cur_buf, cm,
+                optimized_loop_restoration, pbi->tile_workers,
+                pbi->num_workers, &pbi->lr_row_sync, &pbi->lr_ctxt);
+          } else {
+            av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
+                                              cm, optimized_loop_restoration,
+                                              &pbi->lr_ctxt);
+          }
         }
-      }
-    } else {
-      // In no cdef and no superres case. Provide an optimized version of
-      // loop_restoration_filter.
-      if (do_loop_restoration) {
-        if (pbi->num_workers > 1) {
-          av1_loop_restoration_filter_frame_mt(
-              (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, optimized_loop_restoration,
-              pbi->tile_workers, pbi->num_workers, &pbi->lr_row_sync,
-              &pbi->lr_ctxt);
-        } else {
-          av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
-                                            cm, optimized_loop_restoration,
-                                            &pbi->lr_ctxt);
+      } else {
+        // In no cdef and no superres case. Provide an optimized version of
+        // loop_restoration_filter.
+        if (do_loop_restoration) {
+          if (pbi->num_workers > 1) {
+            av1_loop_restoration_filter_frame_mt(
+                (YV12_BUFFER_CONFIG *)xd->cur_buf, cm,
+                optimized_loop_restoration, pbi->tile_workers,
+                pbi->num_workers, &pbi->lr_row_sync, &pbi->lr_ctxt);
+          } else {
+            av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
+                                              cm, optimized_loop_restoration,
+                                              &pbi->lr_ctxt);
+          }
         }
       }
-    }
 #else
-    if (!optimized_loop_restoration) {
-      if (do_cdef) {
-        av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd);
+      if (!optimized_loop_restoration) {
+        if (do_cdef) {
+          if (pbi->num_workers > 1) {
+            av1_cdef_frame_mt(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd,
+                              pbi->tile_workers, pbi->num_workers,
+                              &pbi->cdef_row_sync);
+          } else {
+            av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->dcb.xd);
+          }
+        }
       }
-    }
 #endif  // !CONFIG_REALTIME_ONLY
+    }
   }
 #if CONFIG_LPF_MASK
   av1_zero_array(cm->lf.lfm, cm->lf.lfm_num);
@@ -218,6 +218,9 @@ void av1_decoder_remove(AV1Decoder *pbi) {
 
   if (pbi->num_workers > 0) {
     av1_loop_filter_dealloc(&pbi->lf_row_sync);
+    av1_cdef_dealloc(&pbi->cdef_row_sync);
+    av1_post_filter_dealloc(&pbi->post_filter_sync);
+    aom_free(pbi->frame_row_mt_info.sb_row_tiles_decoded);
 #if !CONFIG_REALTIME_ONLY
     av1_loop_restoration_dealloc(&pbi->lr_row_sync, pbi->num_workers);
 #endif
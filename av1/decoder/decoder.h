@@ -17,6 +17,7 @@
 #include "aom/aom_codec.h"
 #include "aom_dsp/bitreader.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_row_progress.h"
 #include "aom_util/aom_thread.h"
 
 #include "av1/common/av1_common_int.h"
@@ -136,12 +137,8 @@ typedef struct AV1DecRowMTJobInfo {
 } AV1DecRowMTJobInfo;
 
 typedef struct AV1DecRowMTSyncData {
-#if CONFIG_MULTITHREAD
-  pthread_mutex_t *mutex_;
-  pthread_cond_t *cond_;
-#endif
   int allocated_sb_rows;
-  int *cur_sb_col;
+  AVxRowProgress *cur_sb_col;
   int sync_range;
   int mi_rows;
   int mi_cols;
@@ -178,6 +175,17 @@ typedef struct AV1DecRowMTInfo {
   // Boolean: Initialized to 0 (false). Set to 1 (true) on error to abort
   // decoding.
   int row_mt_exit;
+
+  // Boolean: Set to 1 (true) when the tile workers post-filter the frame once
+  // they run out of decode jobs.
+  int post_filter_overlap;
+  // Number of tiles that have finished decoding each superblock row of the
+  // frame. Only used when post_filter_overlap is set.
+  int *sb_row_tiles_decoded;
+  int alloc_sb_rows;
+  // Number of superblock rows, from the top of the frame, that are decoded in
+  // all tiles.
+  int sb_rows_decoded;
 } AV1DecRowMTInfo;
 
 typedef struct TileDataDec {
@@ -225,6 +233,8 @@ typedef struct AV1Decoder {
 
   AVxWorker lf_worker;
   AV1LfSync lf_row_sync;
+  AV1CdefRowSync cdef_row_sync;
+  AV1PostFilterSync post_filter_sync;
   AV1LrSync lr_row_sync;
   AV1LrStruct lr_ctxt;
   AVxWorker *tile_workers;
@@ -299,6 +309,9 @@ typedef struct AV1Decoder {
   // row_mt = 1 triggers mode (3) above, while row_mt = 0, will trigger mode (1)
   // or (2) depending on 'max_threads'.
   unsigned int row_mt;
+  // When set with row_mt, the post-filtering of a frame is overlapped with
+  // its tile decoding. See AV1D_SET_POSTFILTER_OVERLAP.
+  unsigned int postfilter_overlap;
 
   EXTERNAL_REFERENCES ext_refs;
   YV12_BUFFER_CONFIG tile_list_outbuf;
@@ -43,6 +43,15 @@ int av1_write_uleb_obu_size(size_t obu_header_size, size_t obu_payload_size,
 int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
                        int *const largest_tile_id);
 
+// Writes the modes and coefficients of one tile with the writer 'w', which
+// the caller starts and stops, using the MACROBLOCK of 'td'.
+void av1_pack_tile(AV1_COMP *const cpi, ThreadData *const td, int tile_row,
+                   int tile_col, aom_writer *const w);
+
+// Returns whether the tiles of the current frame are packed on the encoder
+// workers.
+int av1_pack_tiles_in_parallel(const AV1_COMP *const cpi);
+
 void av1_write_tx_type(const AV1_COMMON *const cm, const MACROBLOCKD *xd,
                        TX_TYPE tx_type, TX_SIZE tx_size, aom_writer *w);
 
@@ -482,6 +482,22 @@ typedef struct {
 #define MAX_NUM_64X64_TXBS ((MAX_MIB_SIZE >> 4) * (MAX_MIB_SIZE >> 4))
 /*!\endcond */
 
+/*! \brief Inter mode txfm hash records of the square tx blocks.
+ *
+ * These are only used by the RD search of inter modes, so they are allocated
+ * separately from \ref TxfmSearchInfo, on the first frame that needs them.
+ */
+typedef struct {
+  //! Inter mode txfm hash record for TX_8X8 blocks.
+  TXB_RD_RECORD txb_rd_record_8X8[MAX_NUM_8X8_TXBS];
+  //! Inter mode txfm hash record for TX_16X16 blocks.
+  TXB_RD_RECORD txb_rd_record_16X16[MAX_NUM_16X16_TXBS];
+  //! Inter mode txfm hash record for TX_32X32 blocks.
+  TXB_RD_RECORD txb_rd_record_32X32[MAX_NUM_32X32_TXBS];
+  //! Inter mode txfm hash record for TX_64X64 blocks.
+  TXB_RD_RECORD txb_rd_record_64X64[MAX_NUM_64X64_TXBS];
+} TxbRdRecords;
+
 /*! \brief Stores various encoding/search decisions related to txfm search.
  *
  * This struct contains a cache of previous txfm results, and some buffers for
@@ -525,14 +541,11 @@ typedef struct {
   //! Txfm hash record for the whole coding block.
   MB_RD_RECORD mb_rd_record;
 
-  //! Inter mode txfm hash record for TX_8X8 blocks.
-  TXB_RD_RECORD txb_rd_record_8X8[MAX_NUM_8X8_TXBS];
-  //! Inter mode txfm hash record for TX_16X16 blocks.
-  TXB_RD_RECORD txb_rd_record_16X16[MAX_NUM_16X16_TXBS];
-  //! Inter mode txfm hash record for TX_32X32 blocks.
-  TXB_RD_RECORD txb_rd_record_32X32[MAX_NUM_32X32_TXBS];
-  //! Inter mode txfm hash record for TX_64X64 blocks.
-  TXB_RD_RECORD txb_rd_record_64X64[MAX_NUM_64X64_TXBS];
+  /*! \brief Inter mode txfm hash records for the square tx blocks.
+   *
+   * Only allocated when sf.tx_sf.use_inter_txb_hash is enabled.
+   */
+  TxbRdRecords *txb_rd_records;
   //! Intra mode txfm hash record for square tx blocks.
   TXB_RD_RECORD txb_rd_record_intra;
   /**@}*/
@@ -43,6 +43,7 @@ void av1_copy_tree_context(PICK_MODE_CONTEXT *dst_ctx,
 
 void av1_setup_shared_coeff_buffer(AV1_COMMON *cm,
                                    PC_TREE_SHARED_BUFFERS *shared_bufs) {
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_CONTEXT_TREE);
   for (int i = 0; i < 3; i++) {
     const int max_num_pix = MAX_SB_SIZE * MAX_SB_SIZE;
     CHECK_MEM_ERROR(cm, shared_bufs->coeff_buf[i],
@@ -52,6 +53,7 @@ void av1_setup_shared_coeff_buffer(AV1_COMMON *cm,
     CHECK_MEM_ERROR(cm, shared_bufs->dqcoeff_buf[i],
                     aom_memalign(32, max_num_pix * sizeof(tran_low_t)));
   }
+  aom_mem_set_tag(prev_tag);
 }
 
 void av1_free_shared_coeff_buffer(PC_TREE_SHARED_BUFFERS *shared_bufs) {
@@ -69,6 +71,7 @@ PICK_MODE_CONTEXT *av1_alloc_pmc(const AV1_COMMON *cm, BLOCK_SIZE bsize,
                                  PC_TREE_SHARED_BUFFERS *shared_bufs) {
   PICK_MODE_CONTEXT *ctx = NULL;
   struct aom_internal_error_info error;
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_CONTEXT_TREE);
 
   AOM_CHECK_MEM_ERROR(&error, ctx, aom_calloc(1, sizeof(*ctx)));
   ctx->rd_mode_is_ready = 0;
@@ -103,6 +106,7 @@ PICK_MODE_CONTEXT *av1_alloc_pmc(const AV1_COMMON *cm, BLOCK_SIZE bsize,
   }
 
   av1_invalid_rd_stats(&ctx->rd_stats);
+  aom_mem_set_tag(prev_tag);
 
   return ctx;
 }
@@ -135,7 +139,9 @@ PC_TREE *av1_alloc_pc_tree_node(BLOCK_SIZE bsize) {
   PC_TREE *pc_tree = NULL;
   struct aom_internal_error_info error;
 
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_CONTEXT_TREE);
   AOM_CHECK_MEM_ERROR(&error, pc_tree, aom_calloc(1, sizeof(*pc_tree)));
+  aom_mem_set_tag(prev_tag);
 
   pc_tree->partitioning = PARTITION_NONE;
   pc_tree->block_size = bsize;
@@ -231,8 +237,10 @@ void av1_setup_sms_tree(AV1_COMP *const cpi, ThreadData *td) {
   int nodes;
 
   aom_free(td->sms_tree);
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_CONTEXT_TREE);
   CHECK_MEM_ERROR(cm, td->sms_tree,
                   aom_calloc(tree_nodes, sizeof(*td->sms_tree)));
+  aom_mem_set_tag(prev_tag);
   this_sms = &td->sms_tree[0];
 
   if (!stat_generation_stage) {
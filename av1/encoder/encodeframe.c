@@ -52,6 +52,7 @@
 #include "av1/encoder/encodeframe_utils.h"
 #include "av1/encoder/encodemb.h"
 #include "av1/encoder/encodemv.h"
+#include "av1/encoder/encoder_alloc.h"
 #include "av1/encoder/encodetxb.h"
 #include "av1/encoder/ethread.h"
 #include "av1/encoder/extend.h"
@@ -1414,6 +1415,16 @@ static AOM_INLINE void encode_frame_internal(AV1_COMP *cpi) {
   cm->current_frame.skip_mode_info.skip_mode_flag =
       check_skip_mode_enabled(cpi);
 
+  // The superblock size may have changed since the coefficient buffers were
+  // allocated.
+  if (cpi->coeff_buffer_pool.sb_size != cm->seq_params.sb_size) {
+    av1_alloc_txb_buf(cpi);
+  }
+  alloc_inter_rd_search_buffers(cpi, &x->inter_modes_info, &x->obmc_buffer,
+                                &x->comp_rd_buffer, x->tmp_pred_bufs,
+                                &x->txfm_search_info.txb_rd_records);
+  for (i = 0; i < 2; ++i) xd->tmp_obmc_bufs[i] = x->tmp_pred_bufs[i];
+
   enc_row_mt->sync_read_ptr = av1_row_mt_sync_read_dummy;
   enc_row_mt->sync_write_ptr = av1_row_mt_sync_write_dummy;
   mt_info->row_mt_enabled = 0;
@@ -693,24 +693,12 @@ void av1_change_config(struct AV1_COMP *cpi, const AV1EncoderConfig *oxcf) {
                     aom_memalign(16, sizeof(*x->palette_buffer)));
   }
 
-  if (x->comp_rd_buffer.pred0 == NULL) {
-    alloc_compound_type_rd_buffers(cm, &x->comp_rd_buffer);
-  }
-
   if (x->tmp_conv_dst == NULL) {
     CHECK_MEM_ERROR(
         cm, x->tmp_conv_dst,
         aom_memalign(32, MAX_SB_SIZE * MAX_SB_SIZE * sizeof(*x->tmp_conv_dst)));
     x->e_mbd.tmp_conv_dst = x->tmp_conv_dst;
   }
-  for (int i = 0; i < 2; ++i) {
-    if (x->tmp_pred_bufs[i] == NULL) {
-      CHECK_MEM_ERROR(cm, x->tmp_pred_bufs[i],
-                      aom_memalign(32, 2 * MAX_MB_PLANE * MAX_SB_SQUARE *
-                                           sizeof(*x->tmp_pred_bufs[i])));
-      x->e_mbd.tmp_obmc_bufs[i] = x->tmp_pred_bufs[i];
-    }
-  }
 
   av1_reset_segment_features(cm);
 
@@ -816,6 +804,7 @@ static INLINE void init_frame_info(FRAME_INFO *frame_info,
 }
 
 AV1_COMP *av1_create_compressor(AV1EncoderConfig *oxcf, BufferPool *const pool,
+                                aom_frame_buffer_pool_t *fb_pool,
                                 FIRSTPASS_STATS *frame_stats_buf,
                                 COMPRESSOR_STAGE stage, int num_lap_buffers,
                                 int lap_lag_in_frames,
@@ -858,6 +847,7 @@ AV1_COMP *av1_create_compressor(AV1EncoderConfig *oxcf, BufferPool *const pool,
   memset(cm->default_frame_context, 0, sizeof(*cm->default_frame_context));
 
   cpi->common.buffer_pool = pool;
+  cpi->fb_pool = fb_pool;
 
   init_config(cpi, oxcf);
   if (cpi->compressor_stage == LAP_STAGE) {
@@ -979,12 +969,6 @@ AV1_COMP *av1_create_compressor(AV1EncoderConfig *oxcf, BufferPool *const pool,
   }
 #endif
 
-  alloc_obmc_buffers(&cpi->td.mb.obmc_buffer, cm);
-
-  CHECK_MEM_ERROR(
-      cm, cpi->td.mb.inter_modes_info,
-      (InterModesInfo *)aom_malloc(sizeof(*cpi->td.mb.inter_modes_info)));
-
   for (int x = 0; x < 2; x++)
     for (int y = 0; y < 2; y++)
       CHECK_MEM_ERROR(
@@ -1051,7 +1035,8 @@ AV1_COMP *av1_create_compressor(AV1EncoderConfig *oxcf, BufferPool *const pool,
 #endif
 
   if (!is_stat_generation_stage(cpi)) {
-    setup_tpl_buffers(cm, &cpi->tpl_data, cpi->oxcf.gf_cfg.lag_in_frames);
+    setup_tpl_buffers(cm, &cpi->tpl_data, cpi->oxcf.gf_cfg.lag_in_frames,
+                      cpi->fb_pool);
   }
 
 #if CONFIG_COLLECT_PARTITION_STATS == 2
@@ -1332,6 +1317,8 @@ static AOM_INLINE void terminate_worker_data(AV1_COMP *cpi) {
     AVxWorker *const worker = &mt_info->workers[t];
     aom_get_worker_interface()->end(worker);
   }
+  aom_task_pool_destroy(mt_info->task_pool);
+  mt_info->task_pool = NULL;
 }
 
 // Deallocate allocated thread_data.
@@ -1352,6 +1339,7 @@ static AOM_INLINE void free_thread_data(AV1_COMP *cpi) {
     aom_free(thread_data->td->vt64x64);
 
     aom_free(thread_data->td->inter_modes_info);
+    aom_free(thread_data->td->txb_rd_records);
     for (int x = 0; x < 2; x++) {
       for (int y = 0; y < 2; y++) {
         aom_free(thread_data->td->hash_value_buffer[x][y]);
@@ -1542,6 +1530,9 @@ void av1_remove_compressor(AV1_COMP *cpi) {
   if (mt_info->num_workers > 1) {
     av1_loop_filter_dealloc(&mt_info->lf_row_sync);
     av1_cdef_mt_dealloc(&mt_info->cdef_sync);
+    av1_lpf_pick_mt_dealloc(&mt_info->lpf_pick_sync);
+    av1_pick_rst_mt_dealloc(&mt_info->pick_rst_sync);
+    av1_pack_bs_mt_dealloc(&mt_info->pack_bs_sync);
 #if !CONFIG_REALTIME_ONLY
     av1_loop_restoration_dealloc(&mt_info->lr_row_sync, mt_info->num_workers);
     av1_gm_dealloc(&mt_info->gm_sync);
@@ -1625,12 +1616,26 @@ int av1_set_reference_enc(AV1_COMP *cpi, int idx, YV12_BUFFER_CONFIG *sd) {
   YV12_BUFFER_CONFIG *cfg = get_ref_frame(cm, idx);
   if (cfg) {
     aom_yv12_copy_frame(sd, cfg, num_planes);
+    const int buf_idx =
+        (int)(cm->ref_frame_map[idx] - cm->buffer_pool->frame_bufs);
+    av1_invalidate_frame_features(&cpi->gm_info.ref_features[buf_idx]);
+    // The copy extends the borders.
+    cpi->frame_borders_stale[buf_idx] = 0;
     return 0;
   } else {
     return -1;
   }
 }
 
+void av1_extend_ref_frame_borders(AV1_COMP *cpi, RefCntBuffer *buf) {
+  AV1_COMMON *const cm = &cpi->common;
+  uint8_t *const stale =
+      &cpi->frame_borders_stale[buf - cm->buffer_pool->frame_bufs];
+  if (!*stale) return;
+  aom_extend_frame_borders(&buf->buf, av1_num_planes(cm));
+  *stale = 0;
+}
+
 #ifdef OUTPUT_YUV_REC
 void aom_write_one_yuv_frame(AV1_COMMON *cm, YV12_BUFFER_CONFIG *s) {
   uint8_t *src = s->y_buffer;
@@ -1815,7 +1820,7 @@ static void init_motion_estimation(AV1_COMP *cpi) {
                              cpi->oxcf.frm_dim_cfg.height != cm->height) ||
                             av1_superres_scaled(cm))
                                ? y_stride
-                               : cpi->lookahead->buf->img.y_stride;
+                               : cpi->lookahead->y_stride;
   int fpf_y_stride = cm->cur_frame != NULL ? cm->cur_frame->buf.y_stride
                                            : cpi->scaled_source.y_stride;
 
@@ -1984,11 +1989,11 @@ void av1_set_frame_size(AV1_COMP *cpi, int width, int height) {
   }
 
   // Reset the frame pointers to the current frame size.
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cm->cur_frame->buf, cm->width, cm->height, seq_params->subsampling_x,
           seq_params->subsampling_y, seq_params->use_highbitdepth,
-          cpi->oxcf.border_in_pixels, cm->features.byte_alignment, NULL, NULL,
-          NULL))
+          cpi->oxcf.border_in_pixels, cm->features.byte_alignment,
+          cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate frame buffer");
 
@@ -2001,7 +2006,7 @@ void av1_set_frame_size(AV1_COMP *cpi, int width, int height) {
     cm->rst_info[i].frame_restoration_type = RESTORE_NONE;
 
 #if !CONFIG_REALTIME_ONLY
-  av1_alloc_restoration_buffers(cm);
+  if (seq_params->enable_restoration) av1_alloc_restoration_buffers(cm);
 #endif
   if (!is_stat_generation_stage(cpi)) alloc_util_frame_buffers(cpi);
   init_motion_estimation(cpi);
@@ -2009,6 +2014,7 @@ void av1_set_frame_size(AV1_COMP *cpi, int width, int height) {
   for (ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ++ref_frame) {
     RefCntBuffer *const buf = get_ref_frame_buf(cm, ref_frame);
     if (buf != NULL) {
+      av1_extend_ref_frame_borders(cpi, buf);
       struct scale_factors *sf = get_ref_scale_factors(cm, ref_frame);
       av1_setup_scale_factors_for_frame(sf, buf->buf.y_crop_width,
                                         buf->buf.y_crop_height, cm->width,
@@ -2213,8 +2219,9 @@ static int encode_without_recode(AV1_COMP *cpi) {
 
   aom_clear_system_state();
 
-  cpi->source = av1_scale_if_required(cm, unscaled, &cpi->scaled_source,
-                                      filter_scaler, phase_scaler, true, false);
+  cpi->source =
+      av1_scale_source_if_required(cpi, unscaled, &cpi->scaled_source,
+                                   filter_scaler, phase_scaler, true);
   if (frame_is_intra_only(cm) || resize_pending != 0) {
     memset(cpi->consec_zero_mv, 0,
            ((cm->mi_params.mi_rows * cm->mi_params.mi_cols) >> 2) *
@@ -2222,9 +2229,9 @@ static int encode_without_recode(AV1_COMP *cpi) {
   }
 
   if (cpi->unscaled_last_source != NULL) {
-    cpi->last_source = av1_scale_if_required(
-        cm, cpi->unscaled_last_source, &cpi->scaled_last_source, filter_scaler,
-        phase_scaler, true, false);
+    cpi->last_source = av1_scale_source_if_required(
+        cpi, cpi->unscaled_last_source, &cpi->scaled_last_source,
+        filter_scaler, phase_scaler, true);
   }
 
   if (cpi->sf.rt_sf.use_temporal_noise_estimate) {
@@ -2398,6 +2405,10 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
 #if CONFIG_USE_VMAF_RC
   if (oxcf->tune_cfg.tuning == AOM_TUNE_VMAF_NEG_MAX_GAIN) {
     av1_vmaf_neg_preprocessing(cpi, cpi->unscaled_source);
+    // The source was modified, so its scaled copy is out of date.
+    struct lookahead_entry *const entry =
+        av1_lookahead_find_entry(cpi->lookahead, cpi->unscaled_source);
+    if (entry != NULL) entry->scaled.valid = 0;
   }
 #endif
 
@@ -2408,6 +2419,7 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
   int undershoot_seen = 0;
   int low_cr_seen = 0;
   int last_loop_allow_hp = 0;
+  RECODE_TRIAL last_trial = { -1, 0, 0 };
 
   do {
     loop = 0;
@@ -2421,14 +2433,14 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
         gm_info->search_done = 0;
       }
     }
-    cpi->source =
-        av1_scale_if_required(cm, cpi->unscaled_source, &cpi->scaled_source,
-                              EIGHTTAP_REGULAR, 0, false, false);
+    cpi->source = av1_scale_source_if_required(
+        cpi, cpi->unscaled_source, &cpi->scaled_source, EIGHTTAP_REGULAR, 0,
+        false);
 
     if (cpi->unscaled_last_source != NULL) {
-      cpi->last_source = av1_scale_if_required(
-          cm, cpi->unscaled_last_source, &cpi->scaled_last_source,
-          EIGHTTAP_REGULAR, 0, false, false);
+      cpi->last_source = av1_scale_source_if_required(
+          cpi, cpi->unscaled_last_source, &cpi->scaled_last_source,
+          EIGHTTAP_REGULAR, 0, false);
     }
 
     if (!frame_is_intra_only(cm)) {
@@ -2549,10 +2561,11 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
     }
 #endif
     if (allow_recode) {
+    fprintf(stderr, "DBG f%d t%d lc%d q%d size %d target %d\n", cm->current_frame.frame_number, cm->current_frame.frame_type, loop_count, q, rc->projected_frame_size, rc->this_frame_target);
       // Update q and decide whether to do a recode loop
       recode_loop_update_q(cpi, &loop, &q, &q_low, &q_high, top_index,
                            bottom_index, &undershoot_seen, &overshoot_seen,
-                           &low_cr_seen, loop_count);
+                           &low_cr_seen, loop_count, &last_trial);
 
       if (!loop && !cpi->sf.gm_sf.gm_disable_recode)
         loop = av1_recode_loop_test_global_motion(
@@ -2671,7 +2684,9 @@ static int encode_with_recode_loop_and_filter(AV1_COMP *cpi, size_t *size,
 
   // TODO(debargha): Fix mv search range on encoder side
   // aom_extend_frame_inner_borders(&cm->cur_frame->buf, av1_num_planes(cm));
-  aom_extend_frame_borders(&cm->cur_frame->buf, av1_num_planes(cm));
+  // The borders are extended by av1_extend_ref_frame_borders() when the frame
+  // is first used as a reference.
+  cpi->frame_borders_stale[cm->cur_frame - cm->buffer_pool->frame_bufs] = 1;
 
 #ifdef OUTPUT_YUV_REC
   aom_write_one_yuv_frame(cm, &cm->cur_frame->buf);
@@ -3274,7 +3289,8 @@ static int apply_denoise_2d(AV1_COMP *cpi, YV12_BUFFER_CONFIG *sd,
 
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time) {
+                          int64_t end_time,
+                          const struct lookahead_borrow *borrow) {
   AV1_COMMON *const cm = &cpi->common;
   const SequenceHeader *const seq_params = &cm->seq_params;
   int res = 0;
@@ -3305,7 +3321,7 @@ int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
 #endif  //  CONFIG_DENOISE
 
   if (av1_lookahead_push(cpi->lookahead, sd, time_stamp, end_time,
-                         use_highbitdepth, frame_flags))
+                         use_highbitdepth, frame_flags, borrow))
     res = -1;
 #if CONFIG_INTERNAL_STATS
   aom_usec_timer_mark(&timer);
@@ -3502,6 +3518,9 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
   cpi->no_show_fwd_kf = 0;
 
   if (assign_cur_frame_new_fb(cm) == NULL) return AOM_CODEC_ERROR;
+  // The new frame buffer may hold an old reference frame.
+  av1_invalidate_frame_features(
+      &cpi->gm_info.ref_features[cm->cur_frame - cm->buffer_pool->frame_bufs]);
 
 #if CONFIG_COLLECT_COMPONENT_TIMING
   // Only accumulate 2nd pass time.
@@ -62,6 +62,8 @@
 #endif
 
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_util/aom_row_progress.h"
+#include "aom_util/aom_task_pool.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -1195,21 +1197,12 @@ typedef struct {
  * \brief Encoder parameters for synchronization of row based multi-threading
  */
 typedef struct {
-#if CONFIG_MULTITHREAD
-  /**
-   * \name Synchronization objects for top-right dependency.
-   */
-  /**@{*/
-  pthread_mutex_t *mutex_; /*!< Mutex lock object */
-  pthread_cond_t *cond_;   /*!< Condition variable */
-  /**@}*/
-#endif  // CONFIG_MULTITHREAD
   /*!
-   * Buffer to store the superblock whose encoding is complete.
-   * cur_col[i] stores the number of superblocks which finished encoding in the
-   * ith superblock row.
+   * Progress counters for the top-right dependency.
+   * num_finished_cols[i] stores the number of superblocks which finished
+   * encoding in the ith superblock row.
    */
-  int *num_finished_cols;
+  AVxRowProgress *num_finished_cols;
   /*!
    * Number of extra superblocks of the top row to be complete for encoding
    * of the current superblock to start. A value of 1 indicates top-right
@@ -1268,6 +1261,7 @@ typedef struct ThreadData {
   CompoundTypeRdBuffers comp_rd_buffer;
   CONV_BUF_TYPE *tmp_conv_dst;
   uint8_t *tmp_pred_bufs[2];
+  TxbRdRecords *txb_rd_records;
   int intrabc_used;
   int deltaq_used;
   FRAME_CONTEXT *tctx;
@@ -1275,6 +1269,10 @@ typedef struct ThreadData {
   int32_t num_64x64_blocks;
   PICK_MODE_CONTEXT *firstpass_ctx;
   TemporalFilterData tf_data;
+  // Bytes of coefficients and largest motion vector component written while
+  // packing tiles, merged into cpi by av1_pack_bitstream().
+  int coefficient_size;
+  int max_mv_magnitude;
 } ThreadData;
 
 struct EncWorkerData;
@@ -1335,6 +1333,96 @@ typedef struct {
   /**@}*/
 } AV1EncRowMultiThreadInfo;
 
+/*!\cond */
+// One loop filter level tried on one plane during the filter level search.
+typedef struct {
+  int plane;
+  // Vertical and horizontal edge levels for luma. Chroma uses filter_level[0].
+  int filter_level[2];
+  // Sum of squared error of the filtered plane against the source.
+  int64_t sse;
+} LpfPickTrial;
+
+// Data of one worker in the multi-threaded loop filter level search.
+typedef struct {
+  // Shallow copy of the common state, so that each worker filters with its
+  // own loop filter levels and lf_info. The mode info it points to is shared
+  // and only read.
+  AV1_COMMON cm;
+  MACROBLOCKD xd;
+  // Scratch frame the unfiltered plane is copied to and filtered in.
+  YV12_BUFFER_CONFIG frame;
+} LpfPickWorkerData;
+
+typedef struct AV1LpfPickSyncData {
+#if CONFIG_MULTITHREAD
+  // Mutex lock used while dispatching jobs.
+  pthread_mutex_t *mutex_;
+#endif  // CONFIG_MULTITHREAD
+  // Trials to be evaluated, and the index of the next one to dispatch.
+  LpfPickTrial trials[2 * MAX_MB_PLANE];
+  int num_trials;
+  int next_trial;
+  // Source frame, and unfiltered frame the planes are copied from.
+  const YV12_BUFFER_CONFIG *src;
+  const YV12_BUFFER_CONFIG *unfiltered;
+  int partial_frame;
+  LpfPickWorkerData *workerdata;
+  int num_workerdata;
+} AV1LpfPickSync;
+
+// One restoration unit searched during the loop restoration search.
+typedef struct {
+  RestorationTileLimits limits;
+  int unit_idx;
+} PickRstJob;
+
+// Data of one worker in the multi-threaded loop restoration search.
+typedef struct {
+  // Private copy of the degraded plane, since filtering a unit temporarily
+  // overwrites the rows around its stripe boundaries. dgd_valid is cleared
+  // whenever a new plane is searched.
+  YV12_BUFFER_CONFIG dgd;
+  int dgd_valid;
+  // Scratch frame the unit under test is filtered into.
+  YV12_BUFFER_CONFIG dst;
+  int32_t *tmpbuf;
+} PickRstWorkerData;
+
+struct RestSearchCtxt;
+
+typedef struct AV1PickRstSyncData {
+#if CONFIG_MULTITHREAD
+  // Mutex lock used while dispatching jobs.
+  pthread_mutex_t *mutex_;
+#endif  // CONFIG_MULTITHREAD
+  // Units of the current plane, and the index of the next one to dispatch.
+  PickRstJob *jobs;
+  int jobs_alloc;
+  int num_jobs;
+  int next_job;
+  // Search context of the current plane, and restoration type searched.
+  const struct RestSearchCtxt *rsc;
+  RestorationType rtype;
+  PickRstWorkerData *workerdata;
+  int num_workerdata;
+} AV1PickRstSync;
+
+typedef struct AV1EncPackBSSync {
+#if CONFIG_MULTITHREAD
+  // Mutex lock used while dispatching jobs.
+  pthread_mutex_t *mutex_;
+#endif  // CONFIG_MULTITHREAD
+  // One writer per tile. Each is left started by the worker that packed the
+  // tile, and is stopped once its data is copied into the bitstream.
+  aom_writer *tile_writers;
+  int tile_writers_alloc;
+  int num_tiles;
+  // Index of the next tile to pack.
+  int next_tile;
+} AV1EncPackBSSync;
+/*!\endcond */
+
 /*!
  * \brief Encoder parameters related to multi-threading.
  */
@@ -1359,6 +1447,12 @@ typedef struct MultiThreadInfo {
    */
   AVxWorker *workers;
 
+  /*!
+   * Pool running the stages whose jobs do not wait on each other, on
+   * num_workers threads including the calling thread.
+   */
+  AVxTaskPool *task_pool;
+
   /*!
    * Data specific to each worker in encoder multi-threading.
    * tile_thr_data[i] stores the worker data of the ith thread.
@@ -1405,6 +1499,21 @@ typedef struct MultiThreadInfo {
    * CDEF search multi-threading object.
    */
   AV1CdefSync cdef_sync;
+
+  /*!
+   * Loop filter level search multi-threading object.
+   */
+  AV1LpfPickSync lpf_pick_sync;
+
+  /*!
+   * Loop restoration search multi-threading object.
+   */
+  AV1PickRstSync pick_rst_sync;
+
+  /*!
+   * Bitstream packing multi-threading object.
+   */
+  AV1EncPackBSSync pack_bs_sync;
 } MultiThreadInfo;
 
 /*!\cond */
@@ -1654,16 +1763,16 @@ typedef struct {
   /**@}*/
 
   /*!
-   * Holds the total number of corner points detected in the source frame.
+   * Features of the source frame, computed once per frame.
    */
-  int num_src_corners;
+  GmFrameFeatures src_features;
 
   /*!
-   * Holds the x and y co-ordinates of the corner points detected in the source
-   * frame. src_corners[i] holds the x co-ordinate and src_corners[i+1] holds
-   * the y co-ordinate of the ith corner point detected.
+   * Features of the frames in the buffer pool. ref_features[i] holds the
+   * features of frame_bufs[i]; they are computed the first time the frame is
+   * used as a reference and reused by all the frames which reference it.
    */
-  int src_corners[2 * MAX_CORNERS];
+  GmFrameFeatures ref_features[FRAME_BUFFERS];
 } GlobalMotionInfo;
 
 /*!
@@ -2019,6 +2128,10 @@ typedef struct {
    * Pointer to the entropy_ctx buffer.
    */
   uint8_t *entropy_ctx;
+  /*!
+   * Superblock size the buffers are allocated for.
+   */
+  BLOCK_SIZE sb_size;
 } CoeffBufferPool;
 
 /*!
@@ -2074,6 +2187,13 @@ typedef struct AV1_COMP {
    */
   struct lookahead_ctx *lookahead;
 
+  /*!
+   * Pool the frame buffers of the encoder are allocated from. It is shared
+   * with the compressor of the lookahead stage and owned by the codec
+   * context.
+   */
+  aom_frame_buffer_pool_t *fb_pool;
+
   /*!
    * When set, this flag indicates that the current frame is a forward keyframe.
    */
@@ -2151,6 +2271,14 @@ typedef struct AV1_COMP {
    */
   RefCntBuffer *scaled_ref_buf[INTER_REFS_PER_FRAME];
 
+  /*!
+   * The borders of a reconstructed frame are only extended when the frame is
+   * first used as a reference, so that the frames which are never referenced
+   * skip the extension. frame_borders_stale[i] is set until the borders of
+   * frame_bufs[i] are extended.
+   */
+  uint8_t frame_borders_stale[FRAME_BUFFERS];
+
   /*!
    * Pointer to the buffer holding the last show frame.
    */
@@ -2704,6 +2832,7 @@ void av1_initialize_enc(void);
 
 struct AV1_COMP *av1_create_compressor(AV1EncoderConfig *oxcf,
                                        BufferPool *const pool,
+                                       aom_frame_buffer_pool_t *fb_pool,
                                        FIRSTPASS_STATS *frame_stats_buf,
                                        COMPRESSOR_STAGE stage,
                                        int num_lap_buffers,
@@ -2731,15 +2860,19 @@ void av1_init_seq_coding_tools(SequenceHeader *seq, AV1_COMMON *cm,
  * \param[in]    sd             Contain raw frame data
  * \param[in]    time_stamp     Time stamp of the frame
  * \param[in]    end_time_stamp End time stamp
+ * \param[in]    borrow         Buffer of the frame data and how to release it
+ *                              if it may be used in place, or NULL
  *
  * \return Returns a value to indicate if the frame data is received
  * successfully.
- * \note The caller can assume that a copy of this frame is made and not just a
- * copy of the pointer.
+ * \note Unless borrow is non-NULL, the caller can assume that a copy of this
+ * frame is made and not just a copy of the pointer. Otherwise, the release
+ * callback of borrow is called once the frame data is not used anymore.
  */
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time_stamp);
+                          int64_t end_time_stamp,
+                          const struct lookahead_borrow *borrow);
 
 /*!\brief Encode a frame
  *
@@ -2796,6 +2929,10 @@ int av1_copy_reference_enc(AV1_COMP *cpi, int idx, YV12_BUFFER_CONFIG *sd);
 
 int av1_set_reference_enc(AV1_COMP *cpi, int idx, YV12_BUFFER_CONFIG *sd);
 
+// Extends the borders of buf unless they are up to date. This must be called
+// before a reconstructed frame is used as a reference.
+void av1_extend_ref_frame_borders(AV1_COMP *cpi, RefCntBuffer *buf);
+
 int av1_set_size_literal(AV1_COMP *cpi, int width, int height);
 
 void av1_set_frame_size(AV1_COMP *cpi, int width, int height);
@@ -111,7 +111,8 @@ static AOM_INLINE void set_tpl_stats_block_size(uint8_t *block_mis_log2,
 
 static AOM_INLINE void setup_tpl_buffers(AV1_COMMON *const cm,
                                          TplParams *const tpl_data,
-                                         int lag_in_frames) {
+                                         int lag_in_frames,
+                                         aom_frame_buffer_pool_t *fb_pool) {
   CommonModeInfoParams *const mi_params = &cm->mi_params;
   set_tpl_stats_block_size(&tpl_data->tpl_stats_block_mis_log2,
                            &tpl_data->tpl_bsize_1d);
@@ -139,6 +140,8 @@ static AOM_INLINE void setup_tpl_buffers(AV1_COMMON *const cm,
   // stats buffers are not allocated.
   if (lag_in_frames <= 1) return;
 
+  // The frame buffers are accounted to TPL as well.
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_TPL);
   // TODO(aomedia:2873): Explore the allocation of tpl buffers based on
   // lag_in_frames.
   for (int frame = 0; frame < MAX_LAG_BUFFERS; ++frame) {
@@ -147,14 +150,16 @@ static AOM_INLINE void setup_tpl_buffers(AV1_COMMON *const cm,
         aom_calloc(tpl_data->tpl_stats_buffer[frame].width *
                        tpl_data->tpl_stats_buffer[frame].height,
                    sizeof(*tpl_data->tpl_stats_buffer[frame].tpl_stats_ptr)));
-    if (aom_alloc_frame_buffer(
+    aom_free_frame_buffer(&tpl_data->tpl_rec_pool[frame]);
+    if (aom_realloc_frame_buffer_from_pool(
             &tpl_data->tpl_rec_pool[frame], cm->width, cm->height,
             cm->seq_params.subsampling_x, cm->seq_params.subsampling_y,
             cm->seq_params.use_highbitdepth, tpl_data->border_in_pixels,
-            cm->features.byte_alignment))
+            cm->features.byte_alignment, fb_pool))
       aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                          "Failed to allocate frame buffer");
   }
+  aom_mem_set_tag(prev_tag);
 }
 
 static AOM_INLINE void alloc_obmc_buffers(OBMCBuffer *obmc_buffer,
@@ -216,6 +221,38 @@ static AOM_INLINE void release_compound_type_rd_buffers(
   av1_zero(*bufs);  // Set all pointers to NULL for safety.
 }
 
+// Allocates the buffers of a thread that are only used by the RD search of
+// inter modes, if the current speed features need them and they are not
+// allocated yet. Encoders which only use the non-RD mode search never allocate
+// them.
+static AOM_INLINE void alloc_inter_rd_search_buffers(
+    AV1_COMP *cpi, InterModesInfo **inter_modes_info, OBMCBuffer *obmc_buffer,
+    CompoundTypeRdBuffers *comp_rd_buffer, uint8_t *tmp_pred_bufs[2],
+    TxbRdRecords **txb_rd_records) {
+  AV1_COMMON *const cm = &cpi->common;
+  if (cpi->sf.tx_sf.use_inter_txb_hash && *txb_rd_records == NULL) {
+    CHECK_MEM_ERROR(cm, *txb_rd_records,
+                    (TxbRdRecords *)aom_calloc(1, sizeof(**txb_rd_records)));
+  }
+  if (cpi->sf.rt_sf.use_nonrd_pick_mode) return;
+
+  if (obmc_buffer->wsrc == NULL) alloc_obmc_buffers(obmc_buffer, cm);
+  if (comp_rd_buffer->pred0 == NULL) {
+    alloc_compound_type_rd_buffers(cm, comp_rd_buffer);
+  }
+  for (int i = 0; i < 2; ++i) {
+    if (tmp_pred_bufs[i] == NULL) {
+      CHECK_MEM_ERROR(cm, tmp_pred_bufs[i],
+                      aom_memalign(32, 2 * MAX_MB_PLANE * MAX_SB_SQUARE *
+                                           sizeof(*tmp_pred_bufs[i])));
+    }
+  }
+  if (*inter_modes_info == NULL) {
+    CHECK_MEM_ERROR(cm, *inter_modes_info,
+                    (InterModesInfo *)aom_malloc(sizeof(**inter_modes_info)));
+  }
+}
+
 static AOM_INLINE void dealloc_compressor_data(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   TokenInfo *token_info = &cpi->token_info;
@@ -238,6 +275,10 @@ static AOM_INLINE void dealloc_compressor_data(AV1_COMP *cpi) {
   aom_free(cpi->ssim_rdmult_scaling_factors);
   cpi->ssim_rdmult_scaling_factors = NULL;
 
+  av1_free_frame_features(&cpi->gm_info.src_features);
+  for (int i = 0; i < FRAME_BUFFERS; ++i)
+    av1_free_frame_features(&cpi->gm_info.ref_features[i]);
+
   aom_free(cpi->tpl_rdmult_scaling_factors);
   cpi->tpl_rdmult_scaling_factors = NULL;
 
@@ -258,6 +299,9 @@ static AOM_INLINE void dealloc_compressor_data(AV1_COMP *cpi) {
   aom_free(cpi->td.mb.inter_modes_info);
   cpi->td.mb.inter_modes_info = NULL;
 
+  aom_free(cpi->td.mb.txfm_search_info.txb_rd_records);
+  cpi->td.mb.txfm_search_info.txb_rd_records = NULL;
+
   for (int i = 0; i < 2; i++)
     for (int j = 0; j < 2; j++) {
       aom_free(cpi->td.mb.intrabc_hash_info.hash_value_buffer[i][j]);
@@ -346,12 +390,12 @@ static AOM_INLINE void alloc_altref_frame_buffer(AV1_COMP *cpi) {
   const AV1EncoderConfig *oxcf = &cpi->oxcf;
 
   // TODO(agrange) Check if ARF is enabled and skip allocation if not.
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cpi->alt_ref_buffer, oxcf->frm_dim_cfg.width,
           oxcf->frm_dim_cfg.height, seq_params->subsampling_x,
           seq_params->subsampling_y, seq_params->use_highbitdepth,
-          cpi->oxcf.border_in_pixels, cm->features.byte_alignment, NULL, NULL,
-          NULL))
+          cpi->oxcf.border_in_pixels, cm->features.byte_alignment,
+          cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate altref buffer");
 }
@@ -360,33 +404,33 @@ static AOM_INLINE void alloc_util_frame_buffers(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   const SequenceHeader *const seq_params = &cm->seq_params;
   const int byte_alignment = cm->features.byte_alignment;
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cpi->last_frame_uf, cm->width, cm->height, seq_params->subsampling_x,
           seq_params->subsampling_y, seq_params->use_highbitdepth,
-          cpi->oxcf.border_in_pixels, byte_alignment, NULL, NULL, NULL))
+          cpi->oxcf.border_in_pixels, byte_alignment, cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate last frame buffer");
 
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cpi->trial_frame_rst, cm->superres_upscaled_width,
           cm->superres_upscaled_height, seq_params->subsampling_x,
           seq_params->subsampling_y, seq_params->use_highbitdepth,
-          AOM_RESTORATION_FRAME_BORDER, byte_alignment, NULL, NULL, NULL))
+          AOM_RESTORATION_FRAME_BORDER, byte_alignment, cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate trial restored frame buffer");
 
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cpi->scaled_source, cm->width, cm->height, seq_params->subsampling_x,
           seq_params->subsampling_y, seq_params->use_highbitdepth,
-          cpi->oxcf.border_in_pixels, byte_alignment, NULL, NULL, NULL))
+          cpi->oxcf.border_in_pixels, byte_alignment, cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate scaled source buffer");
 
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cpi->scaled_last_source, cm->width, cm->height,
           seq_params->subsampling_x, seq_params->subsampling_y,
           seq_params->use_highbitdepth, cpi->oxcf.border_in_pixels,
-          byte_alignment, NULL, NULL, NULL))
+          byte_alignment, cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate scaled last source buffer");
 }
@@ -401,11 +445,11 @@ static AOM_INLINE YV12_BUFFER_CONFIG *realloc_and_scale_source(
     return cpi->unscaled_source;
   }
 
-  if (aom_realloc_frame_buffer(
+  if (aom_realloc_frame_buffer_from_pool(
           &cpi->scaled_source, scaled_width, scaled_height,
           cm->seq_params.subsampling_x, cm->seq_params.subsampling_y,
           cm->seq_params.use_highbitdepth, AOM_BORDER_IN_PIXELS,
-          cm->features.byte_alignment, NULL, NULL, NULL))
+          cm->features.byte_alignment, cpi->fb_pool))
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to reallocate scaled source buffer");
   assert(cpi->scaled_source.y_crop_width == scaled_width);
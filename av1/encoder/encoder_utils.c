@@ -605,6 +605,46 @@ void av1_update_film_grain_parameters(struct AV1_COMP *cpi,
   }
 }
 
+YV12_BUFFER_CONFIG *av1_scale_source_if_required(
+    AV1_COMP *cpi, YV12_BUFFER_CONFIG *unscaled, YV12_BUFFER_CONFIG *scaled,
+    const InterpFilter filter, const int phase,
+    const bool use_optimized_scaler) {
+  AV1_COMMON *const cm = &cpi->common;
+  struct lookahead_entry *const entry =
+      av1_lookahead_find_entry(cpi->lookahead, unscaled);
+  if (entry == NULL ||
+      (cm->width == unscaled->y_crop_width &&
+       cm->height == unscaled->y_crop_height)) {
+    return av1_scale_if_required(cm, unscaled, scaled, filter, phase,
+                                 use_optimized_scaler, false);
+  }
+
+  struct lookahead_scaled_img *const cache = &entry->scaled;
+  if (cache->valid && cache->img.y_crop_width == cm->width &&
+      cache->img.y_crop_height == cm->height && cache->filter == filter &&
+      cache->phase == phase &&
+      cache->use_optimized_scaler == use_optimized_scaler) {
+    return &cache->img;
+  }
+
+  const SequenceHeader *const seq_params = &cm->seq_params;
+  cache->valid = 0;
+  if (aom_realloc_frame_buffer_from_pool(
+          &cache->img, cm->width, cm->height, seq_params->subsampling_x,
+          seq_params->subsampling_y, seq_params->use_highbitdepth,
+          cpi->oxcf.border_in_pixels, cm->features.byte_alignment,
+          cpi->fb_pool))
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate scaled lookahead buffer");
+  av1_scale_if_required(cm, unscaled, &cache->img, filter, phase,
+                        use_optimized_scaler, false);
+  cache->valid = 1;
+  cache->filter = filter;
+  cache->phase = phase;
+  cache->use_optimized_scaler = use_optimized_scaler;
+  return &cache->img;
+}
+
 void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
                           const int phase, const int use_optimized_scaler) {
   AV1_COMMON *cm = &cpi->common;
@@ -652,11 +692,11 @@ void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
 
         if (force_scaling || new_fb->buf.y_crop_width != cm->width ||
             new_fb->buf.y_crop_height != cm->height) {
-          if (aom_realloc_frame_buffer(
+          if (aom_realloc_frame_buffer_from_pool(
                   &new_fb->buf, cm->width, cm->height,
                   cm->seq_params.subsampling_x, cm->seq_params.subsampling_y,
                   cm->seq_params.use_highbitdepth, AOM_BORDER_IN_PIXELS,
-                  cm->features.byte_alignment, NULL, NULL, NULL)) {
+                  cm->features.byte_alignment, cpi->fb_pool)) {
             if (force_scaling) {
               // Release the reference acquired in the get_free_fb() call above.
               --new_fb->ref_count;
@@ -916,13 +956,13 @@ void av1_determine_sc_tools_with_encoding(AV1_COMP *cpi, const int q_orig) {
   // Setup necessary params for encoding, including frame source, etc.
   aom_clear_system_state();
 
-  cpi->source =
-      av1_scale_if_required(cm, cpi->unscaled_source, &cpi->scaled_source,
-                            cm->features.interp_filter, 0, false, false);
+  cpi->source = av1_scale_source_if_required(
+      cpi, cpi->unscaled_source, &cpi->scaled_source,
+      cm->features.interp_filter, 0, false);
   if (cpi->unscaled_last_source != NULL) {
-    cpi->last_source = av1_scale_if_required(
-        cm, cpi->unscaled_last_source, &cpi->scaled_last_source,
-        cm->features.interp_filter, 0, false, false);
+    cpi->last_source = av1_scale_source_if_required(
+        cpi, cpi->unscaled_last_source, &cpi->scaled_last_source,
+        cm->features.interp_filter, 0, false);
   }
 
   av1_setup_frame(cpi);
@@ -966,6 +966,14 @@ static AOM_INLINE void refresh_reference_frames(AV1_COMP *cpi) {
 void av1_update_film_grain_parameters(struct AV1_COMP *cpi,
                                       const AV1EncoderConfig *oxcf);
 
+// Same as av1_scale_if_required() to the coded frame size, except that the
+// scaled copy of a lookahead frame is kept with its lookahead entry, and
+// returned by the next calls with the same parameters instead of 'scaled'.
+YV12_BUFFER_CONFIG *av1_scale_source_if_required(
+    AV1_COMP *cpi, YV12_BUFFER_CONFIG *unscaled, YV12_BUFFER_CONFIG *scaled,
+    const InterpFilter filter, const int phase,
+    const bool use_optimized_scaler);
+
 void av1_scale_references(AV1_COMP *cpi, const InterpFilter filter,
                           const int phase, const int use_optimized_scaler);
 
@@ -11,6 +11,7 @@
 
 #include "av1/common/warped_motion.h"
 
+#include "av1/encoder/bitstream.h"
 #include "av1/encoder/encodeframe.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/encoder_alloc.h"
@@ -20,6 +21,8 @@
 #endif
 #include "av1/encoder/global_motion.h"
 #include "av1/encoder/global_motion_facade.h"
+#include "av1/encoder/picklpf.h"
+#include "av1/encoder/pickrst.h"
 #include "av1/encoder/rdopt.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "av1/encoder/temporal_filter.h"
@@ -112,13 +115,7 @@ void av1_row_mt_sync_read(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c) {
   const int nsync = row_mt_sync->sync_range;
 
   if (r) {
-    pthread_mutex_t *const mutex = &row_mt_sync->mutex_[r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > row_mt_sync->num_finished_cols[r - 1] - nsync) {
-      pthread_cond_wait(&row_mt_sync->cond_[r - 1], mutex);
-    }
-    pthread_mutex_unlock(mutex);
+    aom_row_progress_wait(&row_mt_sync->num_finished_cols[r - 1], c + nsync);
   }
 #else
   (void)row_mt_sync;
@@ -143,12 +140,7 @@ void av1_row_mt_sync_write(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c,
   }
 
   if (sig) {
-    pthread_mutex_lock(&row_mt_sync->mutex_[r]);
-
-    row_mt_sync->num_finished_cols[r] = cur;
-
-    pthread_cond_signal(&row_mt_sync->cond_[r]);
-    pthread_mutex_unlock(&row_mt_sync->mutex_[r]);
+    aom_row_progress_set(&row_mt_sync->num_finished_cols[r], cur);
   }
 #else
   (void)row_mt_sync;
@@ -161,28 +153,8 @@ void av1_row_mt_sync_write(AV1EncRowMultiThreadSync *row_mt_sync, int r, int c,
 // Allocate memory for row synchronization
 static void row_mt_sync_mem_alloc(AV1EncRowMultiThreadSync *row_mt_sync,
                                   AV1_COMMON *cm, int rows) {
-#if CONFIG_MULTITHREAD
-  int i;
-
-  CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
-                  aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
-  if (row_mt_sync->mutex_) {
-    for (i = 0; i < rows; ++i) {
-      pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
-    }
-  }
-
-  CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
-                  aom_malloc(sizeof(*row_mt_sync->cond_) * rows));
-  if (row_mt_sync->cond_) {
-    for (i = 0; i < rows; ++i) {
-      pthread_cond_init(&row_mt_sync->cond_[i], NULL);
-    }
-  }
-#endif  // CONFIG_MULTITHREAD
-
   CHECK_MEM_ERROR(cm, row_mt_sync->num_finished_cols,
-                  aom_malloc(sizeof(*row_mt_sync->num_finished_cols) * rows));
+                  aom_row_progress_alloc(rows));
 
   row_mt_sync->rows = rows;
   // Set up nsync.
@@ -192,23 +164,7 @@ static void row_mt_sync_mem_alloc(AV1EncRowMultiThreadSync *row_mt_sync,
 // Deallocate row based multi-threading synchronization related mutex and data
 static void row_mt_sync_mem_dealloc(AV1EncRowMultiThreadSync *row_mt_sync) {
   if (row_mt_sync != NULL) {
-#if CONFIG_MULTITHREAD
-    int i;
-
-    if (row_mt_sync->mutex_ != NULL) {
-      for (i = 0; i < row_mt_sync->rows; ++i) {
-        pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
-      }
-      aom_free(row_mt_sync->mutex_);
-    }
-    if (row_mt_sync->cond_ != NULL) {
-      for (i = 0; i < row_mt_sync->rows; ++i) {
-        pthread_cond_destroy(&row_mt_sync->cond_[i]);
-      }
-      aom_free(row_mt_sync->cond_);
-    }
-#endif  // CONFIG_MULTITHREAD
-    aom_free(row_mt_sync->num_finished_cols);
+    aom_row_progress_free(row_mt_sync->num_finished_cols, row_mt_sync->rows);
 
     // clear the structure as the source of this call may be dynamic change
     // in tiles in which case this call will be followed by an _alloc()
@@ -224,6 +180,7 @@ static void row_mt_mem_alloc(AV1_COMP *cpi, int max_rows, int max_cols,
   const int tile_cols = cm->tiles.cols;
   const int tile_rows = cm->tiles.rows;
   int tile_col, tile_row;
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_ROW_MT);
 
   // Allocate memory for row based multi-threading
   for (tile_row = 0; tile_row < tile_rows; tile_row++) {
@@ -247,6 +204,7 @@ static void row_mt_mem_alloc(AV1_COMP *cpi, int max_rows, int max_cols,
   enc_row_mt->allocated_tile_rows = tile_rows;
   enc_row_mt->allocated_rows = max_rows;
   enc_row_mt->allocated_cols = max_cols - 1;
+  aom_mem_set_tag(prev_tag);
 }
 
 void av1_row_mt_mem_dealloc(AV1_COMP *cpi) {
@@ -562,6 +520,24 @@ static AOM_INLINE void create_enc_workers(AV1_COMP *cpi, int num_workers) {
                     aom_malloc(sizeof(*(cdef_sync->mutex_))));
     if (cdef_sync->mutex_) pthread_mutex_init(cdef_sync->mutex_, NULL);
   }
+  AV1LpfPickSync *lpf_pick_sync = &mt_info->lpf_pick_sync;
+  if (lpf_pick_sync->mutex_ == NULL) {
+    CHECK_MEM_ERROR(cm, lpf_pick_sync->mutex_,
+                    aom_malloc(sizeof(*(lpf_pick_sync->mutex_))));
+    if (lpf_pick_sync->mutex_) pthread_mutex_init(lpf_pick_sync->mutex_, NULL);
+  }
+  AV1PickRstSync *pick_rst_sync = &mt_info->pick_rst_sync;
+  if (pick_rst_sync->mutex_ == NULL) {
+    CHECK_MEM_ERROR(cm, pick_rst_sync->mutex_,
+                    aom_malloc(sizeof(*(pick_rst_sync->mutex_))));
+    if (pick_rst_sync->mutex_) pthread_mutex_init(pick_rst_sync->mutex_, NULL);
+  }
+  AV1EncPackBSSync *pack_bs_sync = &mt_info->pack_bs_sync;
+  if (pack_bs_sync->mutex_ == NULL) {
+    CHECK_MEM_ERROR(cm, pack_bs_sync->mutex_,
+                    aom_malloc(sizeof(*(pack_bs_sync->mutex_))));
+    if (pack_bs_sync->mutex_) pthread_mutex_init(pack_bs_sync->mutex_, NULL);
+  }
 #endif
 
   for (int i = num_workers - 1; i >= 0; i--) {
@@ -579,12 +555,6 @@ static AOM_INLINE void create_enc_workers(AV1_COMP *cpi, int num_workers) {
       // Set up sms_tree.
       av1_setup_sms_tree(cpi, thread_data->td);
 
-      alloc_obmc_buffers(&thread_data->td->obmc_buffer, cm);
-
-      CHECK_MEM_ERROR(cm, thread_data->td->inter_modes_info,
-                      (InterModesInfo *)aom_malloc(
-                          sizeof(*thread_data->td->inter_modes_info)));
-
       for (int x = 0; x < 2; x++)
         for (int y = 0; y < 2; y++)
           CHECK_MEM_ERROR(
@@ -602,18 +572,10 @@ static AOM_INLINE void create_enc_workers(AV1_COMP *cpi, int num_workers) {
           cm, thread_data->td->palette_buffer,
           aom_memalign(16, sizeof(*thread_data->td->palette_buffer)));
 
-      alloc_compound_type_rd_buffers(cm, &thread_data->td->comp_rd_buffer);
-
       CHECK_MEM_ERROR(
           cm, thread_data->td->tmp_conv_dst,
           aom_memalign(32, MAX_SB_SIZE * MAX_SB_SIZE *
                                sizeof(*thread_data->td->tmp_conv_dst)));
-      for (int j = 0; j < 2; ++j) {
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->tmp_pred_bufs[j],
-            aom_memalign(32, 2 * MAX_MB_PLANE * MAX_SB_SQUARE *
-                                 sizeof(*thread_data->td->tmp_pred_bufs[j])));
-      }
 
       if (cpi->sf.part_sf.partition_search_type == VAR_BASED_PARTITION) {
         const int num_64x64_blocks =
@@ -668,6 +630,13 @@ void av1_create_workers(AV1_COMP *cpi, int num_workers) {
     }
     ++mt_info->num_workers;
   }
+
+  if (num_workers > 1) {
+    mt_info->task_pool = aom_task_pool_create(num_workers, "aom enc pool");
+    if (mt_info->task_pool == NULL)
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to create encoder task pool");
+  }
 }
 
 #if !CONFIG_REALTIME_ONLY
@@ -745,6 +714,35 @@ static AOM_INLINE void sync_enc_workers(MultiThreadInfo *const mt_info,
                        "Failed to encode tile data");
 }
 
+// Runs the hooks set on the first num_workers workers as tasks of the encoder
+// task pool, which saves launching and syncing the workers. Only for stages
+// whose jobs do not wait on each other, as the tasks may run one after the
+// other on the same thread.
+static AOM_INLINE void run_workers_on_task_pool(MultiThreadInfo *const mt_info,
+                                                AV1_COMMON *const cm,
+                                                int num_workers) {
+  AVxTaskPool *const task_pool = mt_info->task_pool;
+  if (task_pool == NULL) {
+    launch_workers(mt_info, num_workers);
+    sync_enc_workers(mt_info, cm, num_workers);
+    return;
+  }
+
+  int submitted = 1;
+  for (int i = 0; i < num_workers && submitted; i++) {
+    const AVxWorker *const worker = &mt_info->workers[i];
+    submitted = aom_task_pool_submit(task_pool, worker->hook, worker->data1,
+                                     worker->data2);
+  }
+  const int ok = aom_task_pool_wait(task_pool);
+  if (!submitted)
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to submit encoder tasks");
+  if (!ok)
+    aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                       "Failed to encode tile data");
+}
+
 static AOM_INLINE void accumulate_counters_enc_workers(AV1_COMP *cpi,
                                                        int num_workers) {
   for (int i = num_workers - 1; i >= 0; i--) {
@@ -788,11 +786,17 @@ static AOM_INLINE void prepare_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook,
 
     // Before encoding a frame, copy the thread data from cpi.
     if (thread_data->td != &cpi->td) {
+      alloc_inter_rd_search_buffers(
+          cpi, &thread_data->td->inter_modes_info,
+          &thread_data->td->obmc_buffer, &thread_data->td->comp_rd_buffer,
+          thread_data->td->tmp_pred_bufs, &thread_data->td->txb_rd_records);
       thread_data->td->mb = cpi->td.mb;
       thread_data->td->rd_counts = cpi->td.rd_counts;
       thread_data->td->mb.obmc_buffer = thread_data->td->obmc_buffer;
 
       thread_data->td->mb.inter_modes_info = thread_data->td->inter_modes_info;
+      thread_data->td->mb.txfm_search_info.txb_rd_records =
+          thread_data->td->txb_rd_records;
       for (int x = 0; x < 2; x++) {
         for (int y = 0; y < 2; y++) {
           memcpy(thread_data->td->hash_value_buffer[x][y],
@@ -906,8 +910,7 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
     num_workers = AOMMIN(num_workers, mt_info->num_enc_workers);
   }
   prepare_enc_workers(cpi, enc_worker_hook, num_workers);
-  launch_workers(&cpi->mt_info, num_workers);
-  sync_enc_workers(&cpi->mt_info, cm, num_workers);
+  run_workers_on_task_pool(&cpi->mt_info, cm, num_workers);
   accumulate_counters_enc_workers(cpi, num_workers);
 }
 
@@ -1034,8 +1037,7 @@ void av1_encode_tiles_row_mt(AV1_COMP *cpi) {
       AV1EncRowMultiThreadSync *const row_mt_sync = &this_tile->row_mt_sync;
 
       // Initialize num_finished_cols to -1 for all rows.
-      memset(row_mt_sync->num_finished_cols, -1,
-             sizeof(*row_mt_sync->num_finished_cols) * max_sb_rows);
+      aom_row_progress_reset(row_mt_sync->num_finished_cols, max_sb_rows, -1);
       row_mt_sync->next_mi_row = this_tile->tile_info.mi_row_start;
       row_mt_sync->num_threads_working = 0;
 
@@ -1108,8 +1110,7 @@ void av1_fp_encode_tiles_row_mt(AV1_COMP *cpi) {
       AV1EncRowMultiThreadSync *const row_mt_sync = &this_tile->row_mt_sync;
 
       // Initialize num_finished_cols to -1 for all rows.
-      memset(row_mt_sync->num_finished_cols, -1,
-             sizeof(*row_mt_sync->num_finished_cols) * max_mb_rows);
+      aom_row_progress_reset(row_mt_sync->num_finished_cols, max_mb_rows, -1);
       row_mt_sync->next_mi_row = this_tile->tile_info.mi_row_start;
       row_mt_sync->num_threads_working = 0;
     }
@@ -1148,12 +1149,8 @@ void av1_tpl_row_mt_sync_read(AV1TplRowMultiThreadSync *tpl_row_mt_sync, int r,
   int nsync = tpl_row_mt_sync->sync_range;
 
   if (r) {
-    pthread_mutex_t *const mutex = &tpl_row_mt_sync->mutex_[r - 1];
-    pthread_mutex_lock(mutex);
-
-    while (c > tpl_row_mt_sync->num_finished_cols[r - 1] - nsync)
-      pthread_cond_wait(&tpl_row_mt_sync->cond_[r - 1], mutex);
-    pthread_mutex_unlock(mutex);
+    aom_row_progress_wait(&tpl_row_mt_sync->num_finished_cols[r - 1],
+                          c + nsync);
   }
 #else
   (void)tpl_row_mt_sync;
@@ -1178,12 +1175,7 @@ void av1_tpl_row_mt_sync_write(AV1TplRowMultiThreadSync *tpl_row_mt_sync, int r,
   }
 
   if (sig) {
-    pthread_mutex_lock(&tpl_row_mt_sync->mutex_[r]);
-
-    tpl_row_mt_sync->num_finished_cols[r] = cur;
-
-    pthread_cond_signal(&tpl_row_mt_sync->cond_[r]);
-    pthread_mutex_unlock(&tpl_row_mt_sync->mutex_[r]);
+    aom_row_progress_set(&tpl_row_mt_sync->num_finished_cols[r], cur);
   }
 #else
   (void)tpl_row_mt_sync;
@@ -1223,20 +1215,7 @@ static int tpl_worker_hook(void *arg1, void *unused) {
 void av1_tpl_dealloc(AV1TplRowMultiThreadSync *tpl_sync) {
   assert(tpl_sync != NULL);
 
-#if CONFIG_MULTITHREAD
-  if (tpl_sync->mutex_ != NULL) {
-    for (int i = 0; i < tpl_sync->rows; ++i)
-      pthread_mutex_destroy(&tpl_sync->mutex_[i]);
-    aom_free(tpl_sync->mutex_);
-  }
-  if (tpl_sync->cond_ != NULL) {
-    for (int i = 0; i < tpl_sync->rows; ++i)
-      pthread_cond_destroy(&tpl_sync->cond_[i]);
-    aom_free(tpl_sync->cond_);
-  }
-#endif  // CONFIG_MULTITHREAD
-
-  aom_free(tpl_sync->num_finished_cols);
+  aom_row_progress_free(tpl_sync->num_finished_cols, tpl_sync->rows);
   // clear the structure as the source of this call may be a resize in which
   // case this call will be followed by an _alloc() which may fail.
   av1_zero(*tpl_sync);
@@ -1246,25 +1225,8 @@ void av1_tpl_dealloc(AV1TplRowMultiThreadSync *tpl_sync) {
 void av1_tpl_alloc(AV1TplRowMultiThreadSync *tpl_sync, AV1_COMMON *cm,
                    int mb_rows) {
   tpl_sync->rows = mb_rows;
-#if CONFIG_MULTITHREAD
-  {
-    CHECK_MEM_ERROR(cm, tpl_sync->mutex_,
-                    aom_malloc(sizeof(*tpl_sync->mutex_) * mb_rows));
-    if (tpl_sync->mutex_) {
-      for (int i = 0; i < mb_rows; ++i)
-        pthread_mutex_init(&tpl_sync->mutex_[i], NULL);
-    }
-
-    CHECK_MEM_ERROR(cm, tpl_sync->cond_,
-                    aom_malloc(sizeof(*tpl_sync->cond_) * mb_rows));
-    if (tpl_sync->cond_) {
-      for (int i = 0; i < mb_rows; ++i)
-        pthread_cond_init(&tpl_sync->cond_[i], NULL);
-    }
-  }
-#endif  // CONFIG_MULTITHREAD
   CHECK_MEM_ERROR(cm, tpl_sync->num_finished_cols,
-                  aom_malloc(sizeof(*tpl_sync->num_finished_cols) * mb_rows));
+                  aom_row_progress_alloc(mb_rows));
 
   // Set up nsync.
   tpl_sync->sync_range = 1;
@@ -1323,8 +1285,7 @@ void av1_mc_flow_dispenser_mt(AV1_COMP *cpi) {
   tpl_sync->num_threads_working = num_workers;
 
   // Initialize cur_mb_col to -1 for all MB rows.
-  memset(tpl_sync->num_finished_cols, -1,
-         sizeof(*tpl_sync->num_finished_cols) * mb_rows);
+  aom_row_progress_reset(tpl_sync->num_finished_cols, mb_rows, -1);
 
   prepare_tpl_workers(cpi, tpl_worker_hook, num_workers);
   launch_workers(&cpi->mt_info, num_workers);
@@ -1340,27 +1301,51 @@ void av1_tf_mt_dealloc(AV1TemporalFilterSync *tf_sync) {
     aom_free(tf_sync->mutex_);
   }
 #endif  // CONFIG_MULTITHREAD
-  tf_sync->next_tf_row = 0;
+  aom_free(tf_sync->motion);
+  tf_sync->motion = NULL;
+  aom_free(tf_sync->searched_mbs);
+  tf_sync->searched_mbs = NULL;
 }
 
-// Checks if a job is available. If job is available,
-// populates next_tf_row and returns 1, else returns 0.
+// Checks if a job is available. Filtering a block whose motion search is done
+// takes precedence over searching a new block. If a job is available,
+// populates mb_idx and is_filter_job and returns 1, else returns 0. The thread
+// does not wait for the blocks still being searched: the threads searching
+// them filter them afterwards.
 static AOM_INLINE int tf_get_next_job(AV1TemporalFilterSync *tf_mt_sync,
-                                      int *current_mb_row, int mb_rows) {
-  int do_next_row = 0;
+                                      int *mb_idx, int *is_filter_job,
+                                      int num_mbs) {
+  int has_job = 1;
 #if CONFIG_MULTITHREAD
   pthread_mutex_t *tf_mutex_ = tf_mt_sync->mutex_;
   pthread_mutex_lock(tf_mutex_);
 #endif
-  if (tf_mt_sync->next_tf_row < mb_rows) {
-    *current_mb_row = tf_mt_sync->next_tf_row;
-    tf_mt_sync->next_tf_row++;
-    do_next_row = 1;
+  if (tf_mt_sync->next_filter_mb < tf_mt_sync->num_searched_mbs) {
+    *mb_idx = tf_mt_sync->searched_mbs[tf_mt_sync->next_filter_mb++];
+    *is_filter_job = 1;
+  } else if (tf_mt_sync->next_search_mb < num_mbs) {
+    *mb_idx = tf_mt_sync->next_search_mb++;
+    *is_filter_job = 0;
+  } else {
+    has_job = 0;
   }
 #if CONFIG_MULTITHREAD
   pthread_mutex_unlock(tf_mutex_);
 #endif
-  return do_next_row;
+  return has_job;
+}
+
+// Queues the filtering of a block whose motion search is done.
+static AOM_INLINE void tf_set_searched(AV1TemporalFilterSync *tf_mt_sync,
+                                       int mb_idx) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *tf_mutex_ = tf_mt_sync->mutex_;
+  pthread_mutex_lock(tf_mutex_);
+#endif
+  tf_mt_sync->searched_mbs[tf_mt_sync->num_searched_mbs++] = mb_idx;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(tf_mutex_);
+#endif
 }
 
 // Hook function for each thread in temporal filter multi-threading.
@@ -1381,10 +1366,22 @@ static int tf_worker_hook(void *arg1, void *unused) {
   tf_save_state(mbd, &input_mb_mode_info, input_buffer, num_planes);
   tf_setup_macroblockd(mbd, &td->tf_data, scale);
 
-  int current_mb_row = -1;
-
-  while (tf_get_next_job(tf_sync, &current_mb_row, tf_ctx->mb_rows))
-    av1_tf_do_filtering_row(cpi, td, current_mb_row);
+  const int num_mbs = tf_ctx->mb_rows * tf_ctx->mb_cols;
+  int mb_idx = -1;
+  int is_filter_job = 0;
+
+  while (tf_get_next_job(tf_sync, &mb_idx, &is_filter_job, num_mbs)) {
+    const int mb_row = mb_idx / tf_ctx->mb_cols;
+    const int mb_col = mb_idx % tf_ctx->mb_cols;
+    TemporalFilterMotion *const motion =
+        tf_sync->motion + mb_idx * tf_ctx->num_frames;
+    if (is_filter_job) {
+      av1_tf_filter_mb(cpi, td, mb_row, mb_col, motion);
+    } else {
+      av1_tf_motion_search_mb(cpi, &td->mb, mb_row, mb_col, motion);
+      tf_set_searched(tf_sync, mb_idx);
+    }
+  }
 
   tf_restore_state(mbd, input_mb_mode_info, input_buffer, num_planes);
 
@@ -1395,7 +1392,9 @@ static int tf_worker_hook(void *arg1, void *unused) {
 static void prepare_tf_workers(AV1_COMP *cpi, AVxWorkerHook hook,
                                int num_workers, int is_highbitdepth) {
   MultiThreadInfo *mt_info = &cpi->mt_info;
-  mt_info->tf_sync.next_tf_row = 0;
+  mt_info->tf_sync.num_searched_mbs = 0;
+  mt_info->tf_sync.next_search_mb = 0;
+  mt_info->tf_sync.next_filter_mb = 0;
   for (int i = num_workers - 1; i >= 0; i--) {
     AVxWorker *worker = &mt_info->workers[i];
     EncWorkerData *thread_data = &mt_info->tile_thr_data[i];
@@ -1457,11 +1456,24 @@ void av1_tf_do_filtering_mt(AV1_COMP *cpi) {
   else
     num_workers = AOMMIN(num_workers, mt_info->num_enc_workers);
 
+  AV1TemporalFilterSync *const tf_sync = &mt_info->tf_sync;
+  const TemporalFilterCtx *const tf_ctx = &cpi->tf_ctx;
+  const int num_mbs = tf_ctx->mb_rows * tf_ctx->mb_cols;
+  CHECK_MEM_ERROR(cm, tf_sync->motion,
+                  aom_malloc(num_mbs * tf_ctx->num_frames *
+                             sizeof(*tf_sync->motion)));
+  CHECK_MEM_ERROR(cm, tf_sync->searched_mbs,
+                  aom_malloc(num_mbs * sizeof(*tf_sync->searched_mbs)));
+
   prepare_tf_workers(cpi, tf_worker_hook, num_workers, is_highbitdepth);
-  launch_workers(mt_info, num_workers);
-  sync_enc_workers(mt_info, cm, num_workers);
+  run_workers_on_task_pool(mt_info, cm, num_workers);
   tf_accumulate_frame_diff(cpi, num_workers);
   tf_dealloc_thread_data(cpi, num_workers, is_highbitdepth);
+
+  aom_free(tf_sync->motion);
+  tf_sync->motion = NULL;
+  aom_free(tf_sync->searched_mbs);
+  tf_sync->searched_mbs = NULL;
 }
 
 // Checks if a job is available in the current direction. If a job is available,
@@ -1553,10 +1565,10 @@ static int gm_mt_worker_hook(void *arg1, void *unused) {
 
     // Compute global motion for the given ref_buf_idx.
     av1_compute_gm_for_valid_ref_frames(
-        cpi, gm_info->ref_buf, ref_buf_idx, gm_info->num_src_corners,
-        gm_info->src_corners, gm_info->src_buffer,
-        gm_thread_data->params_by_motion, gm_thread_data->segment_map,
-        gm_info->segment_map_w, gm_info->segment_map_h);
+        cpi, gm_info->ref_buf, ref_buf_idx, &gm_info->src_features,
+        gm_info->src_buffer, gm_thread_data->params_by_motion,
+        gm_thread_data->segment_map, gm_info->segment_map_w,
+        gm_info->segment_map_h);
 
 #if CONFIG_MULTITHREAD
     pthread_mutex_lock(gm_mt_mutex_);
@@ -1680,8 +1692,7 @@ void av1_global_motion_estimation_mt(AV1_COMP *cpi) {
 
   assign_thread_to_dir(job_info->thread_id_to_dir, num_workers);
   prepare_gm_workers(cpi, gm_mt_worker_hook, num_workers);
-  launch_workers(&cpi->mt_info, num_workers);
-  sync_enc_workers(&cpi->mt_info, &cpi->common, num_workers);
+  run_workers_on_task_pool(&cpi->mt_info, &cpi->common, num_workers);
 }
 #endif  // !CONFIG_REALTIME_ONLY
 
@@ -1788,6 +1799,247 @@ void av1_cdef_mse_calc_frame_mt(AV1_COMMON *cm, MultiThreadInfo *mt_info,
   cdef_reset_job_info(cdef_sync);
   prepare_cdef_workers(mt_info, cdef_search_ctx, cdef_filter_block_worker_hook,
                        num_workers);
-  launch_workers(mt_info, num_workers);
-  sync_enc_workers(mt_info, cm, num_workers);
+  run_workers_on_task_pool(mt_info, cm, num_workers);
+}
+
+// Deallocate memory for loop filter level search multi-thread synchronization.
+void av1_lpf_pick_mt_dealloc(AV1LpfPickSync *lpf_pick_sync) {
+  assert(lpf_pick_sync != NULL);
+#if CONFIG_MULTITHREAD
+  if (lpf_pick_sync->mutex_ != NULL) {
+    pthread_mutex_destroy(lpf_pick_sync->mutex_);
+    aom_free(lpf_pick_sync->mutex_);
+  }
+#endif  // CONFIG_MULTITHREAD
+  if (lpf_pick_sync->workerdata != NULL) {
+    for (int i = 0; i < lpf_pick_sync->num_workerdata; ++i)
+      aom_free_frame_buffer(&lpf_pick_sync->workerdata[i].frame);
+    aom_free(lpf_pick_sync->workerdata);
+  }
+  av1_zero(*lpf_pick_sync);
+}
+
+// Returns the next loop filter level trial to be evaluated, or NULL when all
+// trials have been dispatched.
+static AOM_INLINE LpfPickTrial *lpf_pick_get_next_job(
+    AV1LpfPickSync *lpf_pick_sync) {
+  LpfPickTrial *trial = NULL;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(lpf_pick_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  if (lpf_pick_sync->next_trial < lpf_pick_sync->num_trials)
+    trial = &lpf_pick_sync->trials[lpf_pick_sync->next_trial++];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(lpf_pick_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  return trial;
+}
+
+// Hook function for each thread in loop filter level search multi-threading.
+static int lpf_pick_worker_hook(void *arg1, void *arg2) {
+  AV1LpfPickSync *const lpf_pick_sync = (AV1LpfPickSync *)arg1;
+  LpfPickWorkerData *const worker_data = (LpfPickWorkerData *)arg2;
+  LpfPickTrial *trial;
+  while ((trial = lpf_pick_get_next_job(lpf_pick_sync)) != NULL) {
+    av1_lpf_pick_try_trial(lpf_pick_sync, worker_data, trial);
+  }
+  return 1;
+}
+
+// Evaluates the trials in mt_info->lpf_pick_sync, each on a single worker.
+void av1_lpf_pick_trials_mt(AV1_COMMON *cm, MultiThreadInfo *mt_info,
+                            int num_workers) {
+  AV1LpfPickSync *const lpf_pick_sync = &mt_info->lpf_pick_sync;
+  assert(num_workers <= lpf_pick_sync->num_workerdata);
+
+  lpf_pick_sync->next_trial = 0;
+  for (int i = num_workers - 1; i >= 0; i--) {
+    AVxWorker *const worker = &mt_info->workers[i];
+    worker->hook = lpf_pick_worker_hook;
+    worker->data1 = lpf_pick_sync;
+    worker->data2 = &lpf_pick_sync->workerdata[i];
+  }
+  run_workers_on_task_pool(mt_info, cm, num_workers);
+}
+
+// Deallocate memory for loop restoration search multi-thread synchronization.
+void av1_pick_rst_mt_dealloc(AV1PickRstSync *pick_rst_sync) {
+  assert(pick_rst_sync != NULL);
+#if CONFIG_MULTITHREAD
+  if (pick_rst_sync->mutex_ != NULL) {
+    pthread_mutex_destroy(pick_rst_sync->mutex_);
+    aom_free(pick_rst_sync->mutex_);
+  }
+#endif  // CONFIG_MULTITHREAD
+  if (pick_rst_sync->workerdata != NULL) {
+    for (int i = 0; i < pick_rst_sync->num_workerdata; ++i) {
+      PickRstWorkerData *const worker_data = &pick_rst_sync->workerdata[i];
+      aom_free_frame_buffer(&worker_data->dgd);
+      aom_free_frame_buffer(&worker_data->dst);
+      aom_free(worker_data->tmpbuf);
+    }
+    aom_free(pick_rst_sync->workerdata);
+  }
+  aom_free(pick_rst_sync->jobs);
+  av1_zero(*pick_rst_sync);
+}
+
+#if !CONFIG_REALTIME_ONLY
+// Returns the next restoration unit to be searched, or NULL when all units
+// have been dispatched.
+static AOM_INLINE PickRstJob *pick_rst_get_next_job(
+    AV1PickRstSync *pick_rst_sync) {
+  PickRstJob *job = NULL;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pick_rst_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  if (pick_rst_sync->next_job < pick_rst_sync->num_jobs)
+    job = &pick_rst_sync->jobs[pick_rst_sync->next_job++];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(pick_rst_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  return job;
+}
+
+// Hook function for each thread in loop restoration search multi-threading.
+static int pick_rst_worker_hook(void *arg1, void *arg2) {
+  AV1PickRstSync *const pick_rst_sync = (AV1PickRstSync *)arg1;
+  PickRstWorkerData *const worker_data = (PickRstWorkerData *)arg2;
+  PickRstJob *job;
+  while ((job = pick_rst_get_next_job(pick_rst_sync)) != NULL) {
+    av1_pick_rst_search_unit(pick_rst_sync, worker_data, job);
+  }
+  return 1;
+}
+
+// Searches the units in mt_info->pick_rst_sync, each on a single worker.
+void av1_pick_rst_units_mt(AV1_COMMON *cm, MultiThreadInfo *mt_info,
+                           int num_workers) {
+  AV1PickRstSync *const pick_rst_sync = &mt_info->pick_rst_sync;
+  assert(num_workers <= pick_rst_sync->num_workerdata);
+
+  pick_rst_sync->next_job = 0;
+  for (int i = num_workers - 1; i >= 0; i--) {
+    AVxWorker *const worker = &mt_info->workers[i];
+    worker->hook = pick_rst_worker_hook;
+    worker->data1 = pick_rst_sync;
+    worker->data2 = &pick_rst_sync->workerdata[i];
+  }
+  run_workers_on_task_pool(mt_info, cm, num_workers);
+}
+#endif  // !CONFIG_REALTIME_ONLY
+
+// Deallocate memory for bitstream packing multi-thread synchronization.
+void av1_pack_bs_mt_dealloc(AV1EncPackBSSync *pack_bs_sync) {
+  assert(pack_bs_sync != NULL);
+#if CONFIG_MULTITHREAD
+  if (pack_bs_sync->mutex_ != NULL) {
+    pthread_mutex_destroy(pack_bs_sync->mutex_);
+    aom_free(pack_bs_sync->mutex_);
+  }
+#endif  // CONFIG_MULTITHREAD
+  aom_free(pack_bs_sync->tile_writers);
+  av1_zero(*pack_bs_sync);
+}
+
+// Returns the index of the next tile to be packed, or -1 when all tiles have
+// been dispatched.
+static AOM_INLINE int pack_bs_get_next_job(AV1EncPackBSSync *pack_bs_sync) {
+  int tile_idx = -1;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pack_bs_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  if (pack_bs_sync->next_tile < pack_bs_sync->num_tiles)
+    tile_idx = pack_bs_sync->next_tile++;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(pack_bs_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  return tile_idx;
+}
+
+// Hook function for each thread in bitstream packing multi-threading.
+static int pack_bs_worker_hook(void *arg1, void *unused) {
+  (void)unused;
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  AV1_COMP *const cpi = thread_data->cpi;
+  AV1EncPackBSSync *const pack_bs_sync = &cpi->mt_info.pack_bs_sync;
+  const int tile_cols = cpi->common.tiles.cols;
+  int tile_idx;
+  while ((tile_idx = pack_bs_get_next_job(pack_bs_sync)) >= 0) {
+    aom_writer *const w = &pack_bs_sync->tile_writers[tile_idx];
+    // The data stays in the writer's own buffer until the tile is stopped.
+    aom_start_encode(w, NULL);
+    av1_pack_tile(cpi, thread_data->td, tile_idx / tile_cols,
+                  tile_idx % tile_cols, w);
+  }
+  return 1;
+}
+
+// Assigns bitstream packing hook function and thread data to each worker.
+static void prepare_pack_bs_workers(AV1_COMP *cpi, AVxWorkerHook hook,
+                                    int num_workers) {
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  mt_info->pack_bs_sync.next_tile = 0;
+  for (int i = num_workers - 1; i >= 0; i--) {
+    AVxWorker *const worker = &mt_info->workers[i];
+    EncWorkerData *const thread_data = &mt_info->tile_thr_data[i];
+
+    worker->hook = hook;
+    worker->data1 = thread_data;
+    worker->data2 = NULL;
+
+    thread_data->cpi = cpi;
+    if (i == 0) {
+      thread_data->td = &cpi->td;
+    }
+
+    // Before packing, copy the thread data from cpi.
+    if (thread_data->td != &cpi->td) {
+      thread_data->td->mb = cpi->td.mb;
+      thread_data->td->coefficient_size = 0;
+      thread_data->td->max_mv_magnitude = -1;
+    }
+  }
+}
+
+// Accumulates the coefficient size and largest motion vector component of
+// the workers into the thread data of cpi.
+static void pack_bs_accumulate_stats(AV1_COMP *cpi, int num_workers) {
+  ThreadData *const main_td = &cpi->td;
+  for (int i = num_workers - 1; i >= 0; i--) {
+    ThreadData *const td = cpi->mt_info.tile_thr_data[i].td;
+    if (td != main_td) {
+      main_td->coefficient_size += td->coefficient_size;
+      main_td->max_mv_magnitude =
+          AOMMAX(main_td->max_mv_magnitude, td->max_mv_magnitude);
+    }
+  }
+}
+
+// Packs every tile of the frame into its own writer in
+// mt_info->pack_bs_sync.tile_writers. The writers are left started.
+void av1_pack_tiles_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  AV1EncPackBSSync *const pack_bs_sync = &mt_info->pack_bs_sync;
+  const int num_tiles = cm->tiles.rows * cm->tiles.cols;
+
+  int num_workers = AOMMIN(mt_info->num_workers, num_tiles);
+  if (mt_info->num_enc_workers == 0)
+    create_enc_workers(cpi, mt_info->num_workers);
+  num_workers = AOMMIN(num_workers, mt_info->num_enc_workers);
+
+  if (pack_bs_sync->tile_writers_alloc < num_tiles) {
+    aom_free(pack_bs_sync->tile_writers);
+    pack_bs_sync->tile_writers_alloc = 0;
+    CHECK_MEM_ERROR(
+        cm, pack_bs_sync->tile_writers,
+        aom_malloc(num_tiles * sizeof(*pack_bs_sync->tile_writers)));
+    pack_bs_sync->tile_writers_alloc = num_tiles;
+  }
+  pack_bs_sync->num_tiles = num_tiles;
+
+  prepare_pack_bs_workers(cpi, pack_bs_worker_hook, num_workers);
+  run_workers_on_task_pool(mt_info, cm, num_workers);
+  pack_bs_accumulate_stats(cpi, num_workers);
 }
@@ -83,6 +83,20 @@ void av1_cdef_mse_calc_frame_mt(AV1_COMMON *cm, MultiThreadInfo *mt_info,
 
 void av1_cdef_mt_dealloc(AV1CdefSync *cdef_sync);
 
+void av1_lpf_pick_trials_mt(AV1_COMMON *cm, MultiThreadInfo *mt_info,
+                            int num_workers);
+
+void av1_lpf_pick_mt_dealloc(AV1LpfPickSync *lpf_pick_sync);
+
+void av1_pick_rst_units_mt(AV1_COMMON *cm, MultiThreadInfo *mt_info,
+                           int num_workers);
+
+void av1_pick_rst_mt_dealloc(AV1PickRstSync *pick_rst_sync);
+
+void av1_pack_tiles_mt(AV1_COMP *cpi);
+
+void av1_pack_bs_mt_dealloc(AV1EncPackBSSync *pack_bs_sync);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
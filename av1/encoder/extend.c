@@ -30,7 +30,7 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
 
   for (i = 0; i < h; i++) {
     memset(dst_ptr1, src_ptr1[0], extend_left);
-    memcpy(dst_ptr1 + extend_left, src_ptr1, w);
+    if (dst != src) memcpy(dst_ptr1 + extend_left, src_ptr1, w);
     memset(dst_ptr2, src_ptr2[0], extend_right);
     src_ptr1 += src_pitch;
     src_ptr2 += src_pitch;
@@ -73,7 +73,9 @@ static void highbd_copy_and_extend_plane(const uint8_t *src8, int src_pitch,
 
   for (i = 0; i < h; i++) {
     aom_memset16(dst_ptr1, src_ptr1[0], extend_left);
-    memcpy(dst_ptr1 + extend_left, src_ptr1, w * sizeof(src_ptr1[0]));
+    if (dst != src) {
+      memcpy(dst_ptr1 + extend_left, src_ptr1, w * sizeof(src_ptr1[0]));
+    }
     aom_memset16(dst_ptr2, src_ptr2[0], extend_right);
     src_ptr1 += src_pitch;
     src_ptr2 += src_pitch;
@@ -100,17 +102,23 @@ static void highbd_copy_and_extend_plane(const uint8_t *src8, int src_pitch,
   }
 }
 
+void av1_get_frame_extension(const YV12_BUFFER_CONFIG *src, int border,
+                             int *extend_bottom, int *extend_right) {
+  *extend_right =
+      AOMMAX(src->y_width + border, ALIGN_POWER_OF_TWO(src->y_width, 6)) -
+      src->y_crop_width;
+  *extend_bottom =
+      AOMMAX(src->y_height + border, ALIGN_POWER_OF_TWO(src->y_height, 6)) -
+      src->y_crop_height;
+}
+
 void av1_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst) {
   // Extend src frame in buffer
   const int et_y = dst->border;
   const int el_y = dst->border;
-  const int er_y =
-      AOMMAX(src->y_width + dst->border, ALIGN_POWER_OF_TWO(src->y_width, 6)) -
-      src->y_crop_width;
-  const int eb_y = AOMMAX(src->y_height + dst->border,
-                          ALIGN_POWER_OF_TWO(src->y_height, 6)) -
-                   src->y_crop_height;
+  int eb_y, er_y;
+  av1_get_frame_extension(src, dst->border, &eb_y, &er_y);
   const int uv_width_subsampling = (src->uv_width != src->y_width);
   const int uv_height_subsampling = (src->uv_height != src->y_height);
   const int et_uv = et_y >> uv_height_subsampling;
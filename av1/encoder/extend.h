@@ -19,9 +19,16 @@
 extern "C" {
 #endif
 
+// Copies src to dst and extends it in the border of dst. If src and dst are
+// the same frame, only extends it.
 void av1_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst);
 
+// Gets the number of luma rows below and columns to the right of src which
+// av1_copy_and_extend_frame() writes to when extending it by border.
+void av1_get_frame_extension(const YV12_BUFFER_CONFIG *src, int border,
+                             int *extend_bottom, int *extend_right);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
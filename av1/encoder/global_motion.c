@@ -16,6 +16,7 @@
 #include <assert.h>
 
 #include "config/aom_dsp_rtcd.h"
+#include "config/av1_rtcd.h"
 
 #include "av1/encoder/global_motion.h"
 
@@ -37,10 +38,8 @@
 
 // Number of pyramid levels in disflow computation
 #define N_LEVELS 2
-// Size of square patches in the disflow dense grid
-#define PATCH_SIZE 8
 // Center point of square patch
-#define PATCH_CENTER ((PATCH_SIZE + 1) >> 1)
+#define PATCH_CENTER ((DISFLOW_PATCH_SIZE + 1) >> 1)
 // Step size between patches, lower value means greater patch overlap
 #define PATCH_STEP 1
 // Minimum size of border padding for disflow
@@ -51,7 +50,7 @@
 #define DISFLOW_MAX_ITR 10
 
 // Struct for an image pyramid
-typedef struct {
+typedef struct ImagePyramid {
   int n_levels;
   int pad_size;
   int has_gradient;
@@ -374,6 +373,14 @@ unsigned char *av1_downconvert_frame(YV12_BUFFER_CONFIG *frm, int bit_depth) {
   return buf_8bit;
 }
 
+// Returns the 8-bit luma plane of frm, downconverting it if needed.
+static unsigned char *get_frame_buffer_8bit(YV12_BUFFER_CONFIG *frm,
+                                            int bit_depth) {
+  if (frm->flags & YV12_FLAG_HIGHBITDEPTH)
+    return av1_downconvert_frame(frm, bit_depth);
+  return frm->y_buffer;
+}
+
 static void get_inliers_from_indices(MotionModel *params,
                                      int *correspondences) {
   int *inliers_tmp = (int *)aom_malloc(2 * MAX_CORNERS * sizeof(*inliers_tmp));
@@ -420,32 +427,25 @@ void av1_compute_feature_segmentation_map(uint8_t *segment_map, int width,
 
 static int compute_global_motion_feature_based(
     TransformationType type, unsigned char *src_buffer, int src_width,
-    int src_height, int src_stride, int *src_corners, int num_src_corners,
-    YV12_BUFFER_CONFIG *ref, int bit_depth, int *num_inliers_by_motion,
-    MotionModel *params_by_motion, int num_motions) {
+    int src_height, int src_stride, const GmFrameFeatures *src_features,
+    YV12_BUFFER_CONFIG *ref, const GmFrameFeatures *ref_features,
+    int bit_depth, int *num_inliers_by_motion, MotionModel *params_by_motion,
+    int num_motions) {
   int i;
-  int num_ref_corners;
   int num_correspondences;
   int *correspondences;
-  int ref_corners[2 * MAX_CORNERS];
-  unsigned char *ref_buffer = ref->y_buffer;
+  const int num_src_corners = src_features->num_corners;
+  unsigned char *ref_buffer = get_frame_buffer_8bit(ref, bit_depth);
   RansacFunc ransac = av1_get_ransac_type(type);
-
-  if (ref->flags & YV12_FLAG_HIGHBITDEPTH) {
-    ref_buffer = av1_downconvert_frame(ref, bit_depth);
-  }
-
-  num_ref_corners =
-      av1_fast_corner_detect(ref_buffer, ref->y_width, ref->y_height,
-                             ref->y_stride, ref_corners, MAX_CORNERS);
+  assert(src_features->corners_valid && ref_features->corners_valid);
 
   // find correspondences between the two images
   correspondences =
       (int *)malloc(num_src_corners * 4 * sizeof(*correspondences));
   num_correspondences = av1_determine_correspondence(
-      src_buffer, (int *)src_corners, num_src_corners, ref_buffer,
-      (int *)ref_corners, num_ref_corners, src_width, src_height, src_stride,
-      ref->y_stride, correspondences);
+      src_buffer, src_features->corners, num_src_corners, ref_buffer,
+      ref_features->corners, ref_features->num_corners, src_width, src_height,
+      src_stride, ref->y_stride, correspondences);
 
   ransac(correspondences, num_correspondences, num_inliers_by_motion,
          params_by_motion, num_motions);
@@ -471,10 +471,10 @@ static int compute_global_motion_feature_based(
 
 // Don't use points around the frame border since they are less reliable
 static INLINE int valid_point(int x, int y, int width, int height) {
-  return (x > (PATCH_SIZE + PATCH_CENTER)) &&
-         (x < (width - PATCH_SIZE - PATCH_CENTER)) &&
-         (y > (PATCH_SIZE + PATCH_CENTER)) &&
-         (y < (height - PATCH_SIZE - PATCH_CENTER));
+  return (x > (DISFLOW_PATCH_SIZE + PATCH_CENTER)) &&
+         (x < (width - DISFLOW_PATCH_SIZE - PATCH_CENTER)) &&
+         (y > (DISFLOW_PATCH_SIZE + PATCH_CENTER)) &&
+         (y < (height - DISFLOW_PATCH_SIZE - PATCH_CENTER));
 }
 
 static int determine_disflow_correspondence(int *frm_corners,
@@ -505,15 +505,16 @@ static double getCubicValue(double p[4], double x) {
                           x * (3.0 * (p[1] - p[2]) + p[3] - p[0])));
 }
 
-static void get_subcolumn(unsigned char *ref, double col[4], int stride, int x,
-                          int y_start) {
+static void get_subcolumn(const unsigned char *ref, double col[4], int stride,
+                          int x, int y_start) {
   int i;
   for (i = 0; i < 4; ++i) {
     col[i] = ref[(i + y_start) * stride + x];
   }
 }
 
-static double bicubic(unsigned char *ref, double x, double y, int stride) {
+static double bicubic(const unsigned char *ref, double x, double y,
+                      int stride) {
   double arr[4];
   int k;
   int i = (int)x;
@@ -527,7 +528,7 @@ static double bicubic(unsigned char *ref, double x, double y, int stride) {
 }
 
 // Interpolate a warped block using bicubic interpolation when possible
-static unsigned char interpolate(unsigned char *ref, double x, double y,
+static unsigned char interpolate(const unsigned char *ref, double x, double y,
                                  int width, int height, int stride) {
   if (x < 0 && y < 0)
     return ref[0];
@@ -599,25 +600,25 @@ static unsigned char interpolate(unsigned char *ref, double x, double y,
 }
 
 // Warps a block using flow vector [u, v] and computes the mse
-static double compute_warp_and_error(unsigned char *ref, unsigned char *frm,
-                                     int width, int height, int stride, int x,
-                                     int y, double u, double v, int16_t *dt) {
+double av1_compute_warp_and_error_c(const uint8_t *ref, const uint8_t *frm,
+                                    int width, int height, int stride, int x,
+                                    int y, double u, double v, int16_t *dt) {
   int i, j;
   unsigned char warped;
   double x_w, y_w;
   double mse = 0;
   int16_t err = 0;
-  for (i = y; i < y + PATCH_SIZE; ++i)
-    for (j = x; j < x + PATCH_SIZE; ++j) {
+  for (i = y; i < y + DISFLOW_PATCH_SIZE; ++i)
+    for (j = x; j < x + DISFLOW_PATCH_SIZE; ++j) {
       x_w = (double)j + u;
       y_w = (double)i + v;
       warped = interpolate(ref, x_w, y_w, width, height, stride);
       err = warped - frm[j + i * stride];
       mse += err * err;
-      dt[(i - y) * PATCH_SIZE + (j - x)] = err;
+      dt[(i - y) * DISFLOW_PATCH_SIZE + (j - x)] = err;
     }
 
-  mse /= (PATCH_SIZE * PATCH_SIZE);
+  mse /= (DISFLOW_PATCH_SIZE * DISFLOW_PATCH_SIZE);
   return mse;
 }
 
@@ -631,13 +632,13 @@ static double compute_warp_and_error(unsigned char *ref, unsigned char *frm,
 //
 // 2.)   b = |sum(dx * dt)|
 //           |sum(dy * dt)|
-// Where the sums are computed over a square window of PATCH_SIZE.
-static INLINE void compute_flow_system(const double *dx, int dx_stride,
-                                       const double *dy, int dy_stride,
-                                       const int16_t *dt, int dt_stride,
-                                       double *M, double *b) {
-  for (int i = 0; i < PATCH_SIZE; i++) {
-    for (int j = 0; j < PATCH_SIZE; j++) {
+// Where the sums are computed over a square window of DISFLOW_PATCH_SIZE.
+void av1_compute_flow_system_c(const double *dx, int dx_stride,
+                               const double *dy, int dy_stride,
+                               const int16_t *dt, int dt_stride, double *M,
+                               double *b) {
+  for (int i = 0; i < DISFLOW_PATCH_SIZE; i++) {
+    for (int j = 0; j < DISFLOW_PATCH_SIZE; j++) {
       M[0] += dx[i * dx_stride + j] * dx[i * dx_stride + j];
       M[1] += dx[i * dx_stride + j] * dy[i * dy_stride + j];
       M[3] += dy[i * dy_stride + j] * dy[i * dy_stride + j];
@@ -700,7 +701,7 @@ static INLINE void sobel_xy_image_gradient(const uint8_t *src, int src_stride,
   // Filter in 8x8 blocks to eventually make use of optimized convolve function
   for (int i = 0; i < height; i += block_unit) {
     for (int j = 0; j < width; j += block_unit) {
-      av1_convolve_2d_sobel_y_c(src + i * src_stride + j, src_stride,
+      av1_convolve_2d_sobel_y(src + i * src_stride + j, src_stride,
                                 dst + i * dst_stride + j, dst_stride,
                                 block_unit, block_unit, dir, norm);
     }
@@ -833,20 +834,22 @@ static INLINE void compute_flow_at_point(unsigned char *frm, unsigned char *ref,
   double b[2] = { 0 };
   double tmp_output_vec[2] = { 0 };
   double error = 0;
-  int16_t dt[PATCH_SIZE * PATCH_SIZE];
+  int16_t dt[DISFLOW_PATCH_SIZE * DISFLOW_PATCH_SIZE];
   double o_u = *u;
   double o_v = *v;
 
   for (int itr = 0; itr < DISFLOW_MAX_ITR; itr++) {
-    error = compute_warp_and_error(ref, frm, width, height, stride, x, y, *u,
-                                   *v, dt);
+    error = av1_compute_warp_and_error(ref, frm, width, height, stride, x, y,
+                                       *u, *v, dt);
     if (error <= DISFLOW_ERROR_TR) break;
-    compute_flow_system(dx, stride, dy, stride, dt, PATCH_SIZE, M, b);
+    av1_compute_flow_system(dx, stride, dy, stride, dt, DISFLOW_PATCH_SIZE, M,
+                            b);
     solve_2x2_system(M, b, tmp_output_vec);
     *u += tmp_output_vec[0];
     *v += tmp_output_vec[1];
   }
-  if (fabs(*u - o_u) > PATCH_SIZE || fabs(*v - o_u) > PATCH_SIZE) {
+  if (fabs(*u - o_u) > DISFLOW_PATCH_SIZE ||
+      fabs(*v - o_u) > DISFLOW_PATCH_SIZE) {
     *u = o_u;
     *v = o_v;
   }
@@ -870,8 +873,10 @@ static void compute_flow_field(ImagePyramid *frm_pyr, ImagePyramid *ref_pyr,
     cur_stride = frm_pyr->strides[level];
     cur_loc = frm_pyr->level_loc[level];
 
-    for (int i = PATCH_SIZE; i < cur_height - PATCH_SIZE; i += PATCH_STEP) {
-      for (int j = PATCH_SIZE; j < cur_width - PATCH_SIZE; j += PATCH_STEP) {
+    for (int i = DISFLOW_PATCH_SIZE; i < cur_height - DISFLOW_PATCH_SIZE;
+         i += PATCH_STEP) {
+      for (int j = DISFLOW_PATCH_SIZE; j < cur_width - DISFLOW_PATCH_SIZE;
+           j += PATCH_STEP) {
         patch_loc = i * cur_stride + j;
         patch_center = patch_loc + PATCH_CENTER * cur_stride + PATCH_CENTER;
         compute_flow_at_point(frm_pyr->level_buffer + cur_loc,
@@ -905,48 +910,73 @@ static void compute_flow_field(ImagePyramid *frm_pyr, ImagePyramid *ref_pyr,
   aom_free(v_upscale);
 }
 
+void av1_invalidate_frame_features(GmFrameFeatures *features) {
+  features->corners_valid = 0;
+  if (features->pyr != NULL) {
+    free_pyramid(features->pyr);
+    features->pyr = NULL;
+  }
+}
+
+void av1_free_frame_features(GmFrameFeatures *features) {
+  av1_invalidate_frame_features(features);
+  aom_free(features->corners);
+  features->corners = NULL;
+}
+
+int av1_compute_frame_corners(GmFrameFeatures *features,
+                              YV12_BUFFER_CONFIG *frm, int bit_depth) {
+  if (features->corners_valid) return 1;
+  if (features->corners == NULL) {
+    features->corners =
+        (int *)aom_malloc(2 * MAX_CORNERS * sizeof(*features->corners));
+    if (features->corners == NULL) return 0;
+  }
+  features->num_corners = av1_fast_corner_detect(
+      get_frame_buffer_8bit(frm, bit_depth), frm->y_width, frm->y_height,
+      frm->y_stride, features->corners, MAX_CORNERS);
+  features->corners_valid = 1;
+  return 1;
+}
+
+void av1_compute_frame_pyramid(GmFrameFeatures *features,
+                               YV12_BUFFER_CONFIG *frm, int bit_depth,
+                               int compute_gradient) {
+  if (features->pyr != NULL) {
+    assert(features->pyr->has_gradient == compute_gradient);
+    return;
+  }
+  const int width = frm->y_width;
+  const int height = frm->y_height;
+  const int pad_size = AOMMAX(DISFLOW_PATCH_SIZE, MIN_PAD);
+  // Ensure the number of pyramid levels will work with the frame resolution
+  const int msb = width < height ? get_msb(width) : get_msb(height);
+  const int n_levels = AOMMIN(msb, N_LEVELS);
+
+  features->pyr = alloc_pyramid(width, height, pad_size, compute_gradient);
+  compute_flow_pyramids(get_frame_buffer_8bit(frm, bit_depth), width, height,
+                        frm->y_stride, n_levels, pad_size, compute_gradient,
+                        features->pyr);
+}
+
 static int compute_global_motion_disflow_based(
-    TransformationType type, unsigned char *frm_buffer, int frm_width,
-    int frm_height, int frm_stride, int *frm_corners, int num_frm_corners,
-    YV12_BUFFER_CONFIG *ref, int bit_depth, int *num_inliers_by_motion,
+    TransformationType type, int frm_width, int frm_height,
+    const GmFrameFeatures *frm_features, YV12_BUFFER_CONFIG *ref,
+    const GmFrameFeatures *ref_features, int *num_inliers_by_motion,
     MotionModel *params_by_motion, int num_motions) {
-  unsigned char *ref_buffer = ref->y_buffer;
-  const int ref_width = ref->y_width;
-  const int ref_height = ref->y_height;
-  const int pad_size = AOMMAX(PATCH_SIZE, MIN_PAD);
+  int *frm_corners = frm_features->corners;
+  const int num_frm_corners = frm_features->num_corners;
+  ImagePyramid *frm_pyr = frm_features->pyr;
+  ImagePyramid *ref_pyr = ref_features->pyr;
   int num_correspondences;
   double *correspondences;
   RansacFuncDouble ransac = av1_get_ransac_double_prec_type(type);
-  assert(frm_width == ref_width);
-  assert(frm_height == ref_height);
-
-  // Ensure the number of pyramid levels will work with the frame resolution
-  const int msb =
-      frm_width < frm_height ? get_msb(frm_width) : get_msb(frm_height);
-  const int n_levels = AOMMIN(msb, N_LEVELS);
-
-  if (ref->flags & YV12_FLAG_HIGHBITDEPTH) {
-    ref_buffer = av1_downconvert_frame(ref, bit_depth);
-  }
-
-  // TODO(sarahparker) We will want to do the source pyramid computation
-  // outside of this function so it doesn't get recomputed for every
-  // reference. We also don't need to compute every pyramid level for the
-  // reference in advance, since lower levels can be overwritten once their
-  // flow field is computed and upscaled. I'll add these optimizations
-  // once the full implementation is working.
-  // Allocate frm image pyramids
-  int compute_gradient = 1;
-  ImagePyramid *frm_pyr =
-      alloc_pyramid(frm_width, frm_height, pad_size, compute_gradient);
-  compute_flow_pyramids(frm_buffer, frm_width, frm_height, frm_stride, n_levels,
-                        pad_size, compute_gradient, frm_pyr);
-  // Allocate ref image pyramids
-  compute_gradient = 0;
-  ImagePyramid *ref_pyr =
-      alloc_pyramid(ref_width, ref_height, pad_size, compute_gradient);
-  compute_flow_pyramids(ref_buffer, ref_width, ref_height, ref->y_stride,
-                        n_levels, pad_size, compute_gradient, ref_pyr);
+  assert(frm_width == ref->y_width);
+  assert(frm_height == ref->y_height);
+  (void)ref;
+  assert(frm_features->corners_valid);
+  assert(frm_pyr != NULL && frm_pyr->has_gradient);
+  assert(ref_pyr != NULL);
 
   double *flow_u =
       aom_malloc(frm_pyr->strides[0] * frm_pyr->heights[0] * sizeof(*flow_u));
@@ -968,8 +998,6 @@ static int compute_global_motion_disflow_based(
   ransac(correspondences, num_correspondences, num_inliers_by_motion,
          params_by_motion, num_motions);
 
-  free_pyramid(frm_pyr);
-  free_pyramid(ref_pyr);
   aom_free(correspondences);
   aom_free(flow_u);
   aom_free(flow_v);
@@ -987,25 +1015,23 @@ static int compute_global_motion_disflow_based(
   return 0;
 }
 
-int av1_compute_global_motion(TransformationType type,
-                              unsigned char *src_buffer, int src_width,
-                              int src_height, int src_stride, int *src_corners,
-                              int num_src_corners, YV12_BUFFER_CONFIG *ref,
-                              int bit_depth,
-                              GlobalMotionEstimationType gm_estimation_type,
-                              int *num_inliers_by_motion,
-                              MotionModel *params_by_motion, int num_motions) {
+int av1_compute_global_motion(
+    TransformationType type, unsigned char *src_buffer, int src_width,
+    int src_height, int src_stride, const GmFrameFeatures *src_features,
+    YV12_BUFFER_CONFIG *ref, const GmFrameFeatures *ref_features,
+    int bit_depth, GlobalMotionEstimationType gm_estimation_type,
+    int *num_inliers_by_motion, MotionModel *params_by_motion,
+    int num_motions) {
   switch (gm_estimation_type) {
     case GLOBAL_MOTION_FEATURE_BASED:
       return compute_global_motion_feature_based(
-          type, src_buffer, src_width, src_height, src_stride, src_corners,
-          num_src_corners, ref, bit_depth, num_inliers_by_motion,
+          type, src_buffer, src_width, src_height, src_stride, src_features,
+          ref, ref_features, bit_depth, num_inliers_by_motion,
           params_by_motion, num_motions);
     case GLOBAL_MOTION_DISFLOW_BASED:
       return compute_global_motion_disflow_based(
-          type, src_buffer, src_width, src_height, src_stride, src_corners,
-          num_src_corners, ref, bit_depth, num_inliers_by_motion,
-          params_by_motion, num_motions);
+          type, src_width, src_height, src_features, ref, ref_features,
+          num_inliers_by_motion, params_by_motion, num_motions);
     default: assert(0 && "Unknown global motion estimation type");
   }
   return 0;
@@ -28,6 +28,13 @@ extern "C" {
 #define GM_REFINEMENT_COUNT 5
 #define MAX_DIRECTIONS 2
 
+// Size of square patches in the disflow dense grid
+#define DISFLOW_PATCH_SIZE 8
+
+// Precision of the bicubic filter taps used by the SIMD versions of
+// av1_compute_warp_and_error().
+#define DISFLOW_INTERP_BITS 12
+
 typedef enum {
   GLOBAL_MOTION_FEATURE_BASED,
   GLOBAL_MOTION_DISFLOW_BASED,
@@ -35,6 +42,56 @@ typedef enum {
 
 unsigned char *av1_downconvert_frame(YV12_BUFFER_CONFIG *frm, int bit_depth);
 
+static INLINE int16_t disflow_round_tap(double tap) {
+  const double scaled = tap * (1 << DISFLOW_INTERP_BITS);
+  return (int16_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+// Computes the taps of the bicubic filter used by disflow to interpolate at
+// the fractional position x, in DISFLOW_INTERP_BITS precision. This matches the
+// Catmull-Rom spline evaluated by av1_compute_warp_and_error_c(). The taps sum
+// to 1 << DISFLOW_INTERP_BITS.
+static INLINE void av1_get_disflow_cubic_filter(double x, int16_t *filter) {
+  const double x2 = x * x;
+  const double x3 = x2 * x;
+  filter[0] = disflow_round_tap(0.5 * (-x + 2 * x2 - x3));
+  filter[2] = disflow_round_tap(0.5 * (x + 4 * x2 - 3 * x3));
+  filter[3] = disflow_round_tap(0.5 * (x3 - x2));
+  filter[1] = (1 << DISFLOW_INTERP_BITS) - filter[0] - filter[2] - filter[3];
+}
+
+struct ImagePyramid;
+
+// Features of a frame used for global motion estimation. They are computed on
+// first use and kept until the frame changes, so that the features of a
+// reference frame are shared by all the frames which use it.
+typedef struct {
+  // x and y co-ordinates of the FAST corners of the frame, valid if
+  // corners_valid is set.
+  int *corners;
+  int num_corners;
+  int corners_valid;
+
+  // Image pyramid used by the DISFlow-based estimation, NULL until computed.
+  struct ImagePyramid *pyr;
+} GmFrameFeatures;
+
+// Marks the features of a frame as out of date.
+void av1_invalidate_frame_features(GmFrameFeatures *features);
+
+void av1_free_frame_features(GmFrameFeatures *features);
+
+// Computes the corners of frm, unless they are already computed. Returns 0 in
+// case of memory allocation failure.
+int av1_compute_frame_corners(GmFrameFeatures *features,
+                              YV12_BUFFER_CONFIG *frm, int bit_depth);
+
+// Computes the image pyramid of frm, unless it is already computed. The
+// gradients are only needed for the source frame.
+void av1_compute_frame_pyramid(GmFrameFeatures *features,
+                               YV12_BUFFER_CONFIG *frm, int bit_depth,
+                               int compute_gradient);
+
 typedef struct {
   double params[MAX_PARAMDIM - 1];
   int *inliers;
@@ -143,15 +200,17 @@ int64_t av1_refine_integerized_param(
   "num_inliers" should be length "num_motions", and will be populated with the
   number of inlier feature points for each motion. Params for which the
   num_inliers entry is 0 should be ignored by the caller.
+
+  The corners of both frames must be computed, and so must their pyramids for
+  GLOBAL_MOTION_DISFLOW_BASED.
 */
-int av1_compute_global_motion(TransformationType type,
-                              unsigned char *src_buffer, int src_width,
-                              int src_height, int src_stride, int *src_corners,
-                              int num_src_corners, YV12_BUFFER_CONFIG *ref,
-                              int bit_depth,
-                              GlobalMotionEstimationType gm_estimation_type,
-                              int *num_inliers_by_motion,
-                              MotionModel *params_by_motion, int num_motions);
+int av1_compute_global_motion(
+    TransformationType type, unsigned char *src_buffer, int src_width,
+    int src_height, int src_stride, const GmFrameFeatures *src_features,
+    YV12_BUFFER_CONFIG *ref, const GmFrameFeatures *ref_features,
+    int bit_depth, GlobalMotionEstimationType gm_estimation_type,
+    int *num_inliers_by_motion, MotionModel *params_by_motion,
+    int num_motions);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -70,6 +70,30 @@ static int gm_get_params_cost(const WarpedMotionParams *gm,
   return (params_cost << AV1_PROB_COST_SHIFT);
 }
 
+// Returns the features of the reference frame of the given type.
+static AOM_INLINE GmFrameFeatures *get_ref_frame_features(AV1_COMP *cpi,
+                                                          int frame) {
+  AV1_COMMON *const cm = &cpi->common;
+  const RefCntBuffer *const buf = get_ref_frame_buf(cm, frame);
+  return &cpi->gm_info.ref_features[buf - cm->buffer_pool->frame_bufs];
+}
+
+// Returns the global motion estimation method used for the given reference
+// frame.
+static AOM_INLINE GlobalMotionEstimationType
+get_gm_estimation_type(const AV1_COMMON *cm, int frame) {
+  // TODO(sarahparker, debargha): Explore do_adaptive_gm_estimation = 1
+  const int do_adaptive_gm_estimation = 0;
+
+  const int ref_frame_dist = get_relative_dist(
+      &cm->seq_params.order_hint_info, cm->current_frame.order_hint,
+      cm->cur_frame->ref_order_hints[frame - LAST_FRAME]);
+  return cm->seq_params.order_hint_info.enable_order_hint &&
+                 abs(ref_frame_dist) <= 2 && do_adaptive_gm_estimation
+             ? GLOBAL_MOTION_DISFLOW_BASED
+             : GLOBAL_MOTION_FEATURE_BASED;
+}
+
 // Calculates the threshold to be used for warp error computation.
 static AOM_INLINE int64_t calc_erroradv_threshold(int64_t ref_frame_error) {
   return (int64_t)(ref_frame_error * erroradv_tr + 0.5);
@@ -79,7 +103,7 @@ static AOM_INLINE int64_t calc_erroradv_threshold(int64_t ref_frame_error) {
 // different motion models and finds the best.
 static AOM_INLINE void compute_global_motion_for_ref_frame(
     AV1_COMP *cpi, YV12_BUFFER_CONFIG *ref_buf[REF_FRAMES], int frame,
-    int num_src_corners, int *src_corners, unsigned char *src_buffer,
+    const GmFrameFeatures *src_features, unsigned char *src_buffer,
     MotionModel *params_by_motion, uint8_t *segment_map,
     const int segment_map_w, const int segment_map_h,
     const WarpedMotionParams *ref_params) {
@@ -102,19 +126,13 @@ static AOM_INLINE void compute_global_motion_for_ref_frame(
   assert(ref_buf[frame] != NULL);
   TransformationType model;
 
-  aom_clear_system_state();
+  const GmFrameFeatures *const ref_features =
+      get_ref_frame_features(cpi, frame);
 
-  // TODO(sarahparker, debargha): Explore do_adaptive_gm_estimation = 1
-  const int do_adaptive_gm_estimation = 0;
+  aom_clear_system_state();
 
-  const int ref_frame_dist = get_relative_dist(
-      &cm->seq_params.order_hint_info, cm->current_frame.order_hint,
-      cm->cur_frame->ref_order_hints[frame - LAST_FRAME]);
   const GlobalMotionEstimationType gm_estimation_type =
-      cm->seq_params.order_hint_info.enable_order_hint &&
-              abs(ref_frame_dist) <= 2 && do_adaptive_gm_estimation
-          ? GLOBAL_MOTION_DISFLOW_BASED
-          : GLOBAL_MOTION_FEATURE_BASED;
+      get_gm_estimation_type(cm, frame);
   for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES_ENC; ++model) {
     int64_t best_warp_error = INT64_MAX;
     // Initially set all params to identity.
@@ -125,8 +143,8 @@ static AOM_INLINE void compute_global_motion_for_ref_frame(
     }
 
     av1_compute_global_motion(model, src_buffer, src_width, src_height,
-                              src_stride, src_corners, num_src_corners,
-                              ref_buf[frame], cpi->common.seq_params.bit_depth,
+                              src_stride, src_features, ref_buf[frame],
+                              ref_features, cpi->common.seq_params.bit_depth,
                               gm_estimation_type, inliers_by_motion,
                               params_by_motion, RANSAC_NUM_MOTIONS);
     int64_t ref_frame_error = 0;
@@ -204,7 +222,7 @@ static AOM_INLINE void compute_global_motion_for_ref_frame(
 // Computes global motion for the given reference frame.
 void av1_compute_gm_for_valid_ref_frames(
     AV1_COMP *cpi, YV12_BUFFER_CONFIG *ref_buf[REF_FRAMES], int frame,
-    int num_src_corners, int *src_corners, unsigned char *src_buffer,
+    const GmFrameFeatures *src_features, unsigned char *src_buffer,
     MotionModel *params_by_motion, uint8_t *segment_map, int segment_map_w,
     int segment_map_h) {
   AV1_COMMON *const cm = &cpi->common;
@@ -214,8 +232,8 @@ void av1_compute_gm_for_valid_ref_frames(
                      : &default_warp_params;
 
   compute_global_motion_for_ref_frame(
-      cpi, ref_buf, frame, num_src_corners, src_corners, src_buffer,
-      params_by_motion, segment_map, segment_map_w, segment_map_h, ref_params);
+      cpi, ref_buf, frame, src_features, src_buffer, params_by_motion,
+      segment_map, segment_map_w, segment_map_h, ref_params);
 
   gm_info->params_cost[frame] =
       gm_get_params_cost(&cm->global_motion[frame], ref_params,
@@ -228,19 +246,19 @@ void av1_compute_gm_for_valid_ref_frames(
 static AOM_INLINE void compute_global_motion_for_references(
     AV1_COMP *cpi, YV12_BUFFER_CONFIG *ref_buf[REF_FRAMES],
     FrameDistPair reference_frame[REF_FRAMES - 1], int num_ref_frames,
-    int num_src_corners, int *src_corners, unsigned char *src_buffer,
+    const GmFrameFeatures *src_features, unsigned char *src_buffer,
     MotionModel *params_by_motion, uint8_t *segment_map,
     const int segment_map_w, const int segment_map_h) {
   // Computation of frame corners for the source frame will be done already.
-  assert(num_src_corners != -1);
+  assert(src_features->corners_valid);
   AV1_COMMON *const cm = &cpi->common;
   // Compute global motion w.r.t. reference frames starting from the nearest ref
   // frame in a given direction.
   for (int frame = 0; frame < num_ref_frames; frame++) {
     int ref_frame = reference_frame[frame].frame;
     av1_compute_gm_for_valid_ref_frames(
-        cpi, ref_buf, ref_frame, num_src_corners, src_corners, src_buffer,
-        params_by_motion, segment_map, segment_map_w, segment_map_h);
+        cpi, ref_buf, ref_frame, src_features, src_buffer, params_by_motion,
+        segment_map, segment_map_w, segment_map_h);
     // If global motion w.r.t. current ref frame is
     // INVALID/TRANSLATION/IDENTITY, skip the evaluation of global motion w.r.t
     // the remaining ref frames in that direction. The below exit is disabled
@@ -382,15 +400,16 @@ static AOM_INLINE void dealloc_global_motion_data(MotionModel *params_by_motion,
 
 // Initializes parameters used for computing global motion.
 static AOM_INLINE void setup_global_motion_info_params(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
   GlobalMotionInfo *const gm_info = &cpi->gm_info;
   YV12_BUFFER_CONFIG *source = cpi->source;
+  const int bit_depth = cm->seq_params.bit_depth;
 
   gm_info->src_buffer = source->y_buffer;
   if (source->flags & YV12_FLAG_HIGHBITDEPTH) {
     // The source buffer is 16-bit, so we need to convert to 8 bits for the
     // following code. We cache the result until the source frame is released.
-    gm_info->src_buffer =
-        av1_downconvert_frame(source, cpi->common.seq_params.bit_depth);
+    gm_info->src_buffer = av1_downconvert_frame(source, bit_depth);
   }
 
   gm_info->segment_map_w =
@@ -416,13 +435,37 @@ static AOM_INLINE void setup_global_motion_info_params(AV1_COMP *cpi) {
   qsort(gm_info->reference_frames[1], gm_info->num_ref_frames[1],
         sizeof(gm_info->reference_frames[1][0]), compare_distance);
 
-  gm_info->num_src_corners = -1;
+  av1_invalidate_frame_features(&gm_info->src_features);
   // If atleast one valid reference frame exists in past/future directions,
   // compute interest points of source frame using FAST features.
   if (gm_info->num_ref_frames[0] > 0 || gm_info->num_ref_frames[1] > 0) {
-    gm_info->num_src_corners = av1_fast_corner_detect(
-        gm_info->src_buffer, source->y_width, source->y_height,
-        source->y_stride, gm_info->src_corners, MAX_CORNERS);
+    if (!av1_compute_frame_corners(&gm_info->src_features, source,
+                                   bit_depth)) {
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate frame corners");
+    }
+  }
+
+  // Compute the features of the reference frames which were not used as
+  // references before. This is done here rather than in the search itself so
+  // that the workers of av1_global_motion_estimation_mt() only read them, even
+  // when several reference frame types share a frame buffer.
+  for (int dir = 0; dir < MAX_DIRECTIONS; dir++) {
+    for (int i = 0; i < gm_info->num_ref_frames[dir]; i++) {
+      const int frame = gm_info->reference_frames[dir][i].frame;
+      GmFrameFeatures *const ref_features = get_ref_frame_features(cpi, frame);
+      if (!av1_compute_frame_corners(ref_features, gm_info->ref_buf[frame],
+                                     bit_depth)) {
+        aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                           "Failed to allocate frame corners");
+      }
+      if (get_gm_estimation_type(cm, frame) == GLOBAL_MOTION_DISFLOW_BASED) {
+        av1_compute_frame_pyramid(&gm_info->src_features, source, bit_depth,
+                                  1);
+        av1_compute_frame_pyramid(ref_features, gm_info->ref_buf[frame],
+                                  bit_depth, 0);
+      }
+    }
   }
 }
 
@@ -441,9 +484,9 @@ static AOM_INLINE void global_motion_estimation(AV1_COMP *cpi) {
     if (gm_info->num_ref_frames[dir] > 0)
       compute_global_motion_for_references(
           cpi, gm_info->ref_buf, gm_info->reference_frames[dir],
-          gm_info->num_ref_frames[dir], gm_info->num_src_corners,
-          gm_info->src_corners, gm_info->src_buffer, params_by_motion,
-          segment_map, gm_info->segment_map_w, gm_info->segment_map_h);
+          gm_info->num_ref_frames[dir], &gm_info->src_features,
+          gm_info->src_buffer, params_by_motion, segment_map,
+          gm_info->segment_map_w, gm_info->segment_map_h);
   }
 
   dealloc_global_motion_data(params_by_motion, segment_map);
@@ -125,8 +125,10 @@ void av1_hash_table_create(hash_table *p_hash_table) {
     av1_hash_table_clear_all(p_hash_table);
     return;
   }
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_HASH);
   p_hash_table->p_lookup_table =
       (Vector **)aom_malloc(sizeof(p_hash_table->p_lookup_table[0]) * kMaxAddr);
+  aom_mem_set_tag(prev_tag);
   memset(p_hash_table->p_lookup_table, 0,
          sizeof(p_hash_table->p_lookup_table[0]) * kMaxAddr);
 }
@@ -323,6 +325,7 @@ void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
   add_value <<= kSrcBits;
   const int crc_mask = (1 << kSrcBits) - 1;
 
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_HASH);
   for (int x_pos = 0; x_pos < x_end; x_pos++) {
     for (int y_pos = 0; y_pos < y_end; y_pos++) {
       const int pos = y_pos * pic_width + x_pos;
@@ -339,6 +342,7 @@ void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
       }
     }
   }
+  aom_mem_set_tag(prev_tag);
 }
 
 int av1_hash_is_horizontal_perfect(const YV12_BUFFER_CONFIG *picture,
@@ -30,22 +30,146 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx, int *idx) {
   return buf;
 }
 
+static void release_input(const struct lookahead_borrow *borrow) {
+  if (borrow) borrow->release.release_cb(borrow->release.cb_priv,
+                                         borrow->user_priv);
+}
+
+// Gives a borrowed frame back to the application.
+static void release_borrowed_frame(struct lookahead_entry *buf) {
+  if (!buf->borrowed) return;
+  // Only the metadata of the frame belongs to the lookahead.
+  aom_remove_metadata_from_frame_buffer(&buf->img);
+  memset(&buf->img, 0, sizeof(buf->img));
+  buf->borrowed = 0;
+  release_input(&buf->borrow);
+}
+
+// Returns whether the given plane, extended by the given borders, lies within
+// [start, end), and sets first and last to the bounds of its extended area.
+static int plane_fits(const uint8_t *plane, int stride, int width, int height,
+                      int extend_top, int extend_left, int extend_bottom,
+                      int extend_right, int bytes_per_sample, uintptr_t start,
+                      uintptr_t end, uintptr_t *first, uintptr_t *last) {
+  const uintptr_t base = (uintptr_t)plane;
+  const uintptr_t before =
+      ((uintptr_t)extend_top * stride + extend_left) * bytes_per_sample;
+  const uintptr_t after = ((uintptr_t)(height + extend_bottom - 1) * stride +
+                           width + extend_right) *
+                          bytes_per_sample;
+  if (width + extend_left + extend_right > stride || base < start ||
+      base - start < before || end - base < after) {
+    return 0;
+  }
+  *first = base - before;
+  *last = base + after;
+  return 1;
+}
+
+// Sets img to a view of src with the layout of the lookahead frames, if the
+// buffer of src has room for their borders. Returns 0 otherwise.
+static int setup_borrowed_frame(const struct lookahead_ctx *ctx,
+                                const YV12_BUFFER_CONFIG *src,
+                                int use_highbitdepth,
+                                const struct lookahead_borrow *borrow,
+                                YV12_BUFFER_CONFIG *img) {
+  const int is_highbitdepth = (src->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  if (is_highbitdepth != use_highbitdepth || src->monochrome ||
+      src->y_stride != ctx->y_stride || src->uv_stride != ctx->uv_stride) {
+    return 0;
+  }
+
+  const int ss_x = src->subsampling_x;
+  const int ss_y = src->subsampling_y;
+  const int aligned_width = (src->y_crop_width + 7) & ~7;
+  const int aligned_height = (src->y_crop_height + 7) & ~7;
+  memset(img, 0, sizeof(*img));
+  img->y_crop_width = src->y_crop_width;
+  img->y_crop_height = src->y_crop_height;
+  img->uv_crop_width = src->uv_crop_width;
+  img->uv_crop_height = src->uv_crop_height;
+  img->y_width = aligned_width;
+  img->y_height = aligned_height;
+  img->uv_width = aligned_width >> ss_x;
+  img->uv_height = aligned_height >> ss_y;
+  img->y_stride = src->y_stride;
+  img->uv_stride = src->uv_stride;
+  img->y_buffer = src->y_buffer;
+  img->u_buffer = src->u_buffer;
+  img->v_buffer = src->v_buffer;
+  img->border = ctx->border_in_pixels;
+  img->subsampling_x = ss_x;
+  img->subsampling_y = ss_y;
+  img->flags = src->flags & YV12_FLAG_HIGHBITDEPTH;
+
+  int extend_bottom, extend_right;
+  av1_get_frame_extension(img, img->border, &extend_bottom, &extend_right);
+  const uintptr_t start = (uintptr_t)borrow->buf_start;
+  const uintptr_t end = start + borrow->buf_size;
+  const int bytes_per_sample = use_highbitdepth ? 2 : 1;
+  uintptr_t first[MAX_MB_PLANE], last[MAX_MB_PLANE];
+  for (int plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    const int is_uv = plane > 0;
+    const uint8_t *const buf =
+        use_highbitdepth
+            ? (const uint8_t *)CONVERT_TO_SHORTPTR(img->buffers[plane])
+            : img->buffers[plane];
+    if (ctx->byte_alignment &&
+        (uintptr_t)buf % (uintptr_t)ctx->byte_alignment != 0) {
+      return 0;
+    }
+    if (!plane_fits(buf, img->strides[is_uv], img->crop_widths[is_uv],
+                    img->crop_heights[is_uv], img->border >> (is_uv ? ss_y : 0),
+                    img->border >> (is_uv ? ss_x : 0),
+                    extend_bottom >> (is_uv ? ss_y : 0),
+                    extend_right >> (is_uv ? ss_x : 0), bytes_per_sample, start,
+                    end, &first[plane], &last[plane])) {
+      return 0;
+    }
+    // Extending a plane must not overwrite the others.
+    for (int i = 0; i < plane; ++i) {
+      if (first[plane] < last[i] && first[i] < last[plane]) return 0;
+    }
+  }
+  return 1;
+}
+
 void av1_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
     if (ctx->buf) {
       int i;
 
-      for (i = 0; i < ctx->max_sz; i++) aom_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        release_borrowed_frame(&ctx->buf[i]);
+        aom_free_frame_buffer(&ctx->buf[i].img);
+        aom_free_frame_buffer(&ctx->buf[i].scaled.img);
+      }
       free(ctx->buf);
     }
     free(ctx);
   }
 }
 
+// Same as aom_realloc_frame_buffer_from_pool(), with the memory accounted to
+// the lookahead.
+static int realloc_lookahead_frame(YV12_BUFFER_CONFIG *img, int width,
+                                   int height, int ss_x, int ss_y,
+                                   int use_highbitdepth, int border,
+                                   int byte_alignment,
+                                   aom_frame_buffer_pool_t *fb_pool) {
+  const aom_mem_tag_t prev_tag = aom_mem_set_tag(AOM_MEM_TAG_LOOKAHEAD);
+  const int ret = aom_realloc_frame_buffer_from_pool(
+      img, width, height, ss_x, ss_y, use_highbitdepth, border, byte_alignment,
+      fb_pool);
+  aom_mem_set_tag(prev_tag);
+  return ret;
+}
+
 struct lookahead_ctx *av1_lookahead_init(
     unsigned int width, unsigned int height, unsigned int subsampling_x,
     unsigned int subsampling_y, int use_highbitdepth, unsigned int depth,
-    const int border_in_pixels, int byte_alignment, int num_lap_buffers) {
+    const int border_in_pixels, int byte_alignment, int num_lap_buffers,
+    aom_frame_buffer_pool_t *fb_pool) {
   struct lookahead_ctx *ctx = NULL;
   int lag_in_frames = AOMMAX(1, depth);
 
@@ -71,12 +195,17 @@ struct lookahead_ctx *av1_lookahead_init(
     if (!ctx->buf) goto fail;
     for (i = 0; i < depth; i++) {
       aom_free_frame_buffer(&ctx->buf[i].img);
-      if (aom_realloc_frame_buffer(&ctx->buf[i].img, width, height,
-                                   subsampling_x, subsampling_y,
-                                   use_highbitdepth, border_in_pixels,
-                                   byte_alignment, NULL, NULL, NULL))
+      if (realloc_lookahead_frame(&ctx->buf[i].img, width, height,
+                                  subsampling_x, subsampling_y,
+                                  use_highbitdepth, border_in_pixels,
+                                  byte_alignment, fb_pool))
         goto fail;
     }
+    ctx->border_in_pixels = border_in_pixels;
+    ctx->byte_alignment = byte_alignment;
+    ctx->fb_pool = fb_pool;
+    ctx->y_stride = ctx->buf[0].img.y_stride;
+    ctx->uv_stride = ctx->buf[0].img.uv_stride;
   }
   return ctx;
 fail:
@@ -86,7 +215,8 @@ fail:
 
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       aom_enc_frame_flags_t flags) {
+                       aom_enc_frame_flags_t flags,
+                       const struct lookahead_borrow *borrow) {
   struct lookahead_entry *buf;
   int width = src->y_crop_width;
   int height = src->y_crop_height;
@@ -97,13 +227,46 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   int larger_dimensions, new_dimensions;
 
   assert(ctx->read_ctxs[ENCODE_STAGE].valid == 1);
-  if (ctx->read_ctxs[ENCODE_STAGE].sz + 1 + MAX_PRE_FRAMES > ctx->max_sz)
+  if (ctx->read_ctxs[ENCODE_STAGE].sz + 1 + MAX_PRE_FRAMES > ctx->max_sz) {
+    release_input(borrow);
     return 1;
+  }
   ctx->read_ctxs[ENCODE_STAGE].sz++;
   if (ctx->read_ctxs[LAP_STAGE].valid) {
     ctx->read_ctxs[LAP_STAGE].sz++;
   }
   buf = pop(ctx, &ctx->write_idx);
+  // The previous frame of the entry is not used anymore.
+  release_borrowed_frame(buf);
+  // The scaled copy of the previous frame of the entry is released, so that
+  // only the frames being encoded hold one.
+  aom_free_frame_buffer(&buf->scaled.img);
+  buf->scaled.valid = 0;
+
+  YV12_BUFFER_CONFIG borrowed_img;
+  if (borrow &&
+      setup_borrowed_frame(ctx, src, use_highbitdepth, borrow, &borrowed_img)) {
+    // The frame is used in place, so the buffer of the entry is not needed.
+    aom_free_frame_buffer(&buf->img);
+    buf->img = borrowed_img;
+    buf->borrowed = 1;
+    buf->borrow = *borrow;
+    av1_copy_and_extend_frame(&buf->img, &buf->img);
+    buf->ts_start = ts_start;
+    buf->ts_end = ts_end;
+    buf->flags = flags;
+    aom_copy_metadata_to_frame_buffer(&buf->img, src->metadata);
+    return 0;
+  }
+
+  if (buf->img.buffer_alloc == NULL &&
+      realloc_lookahead_frame(&buf->img, width, height, subsampling_x,
+                              subsampling_y, use_highbitdepth,
+                              ctx->border_in_pixels, ctx->byte_alignment,
+                              ctx->fb_pool)) {
+    release_input(borrow);
+    return 1;
+  }
 
   new_dimensions = width != buf->img.y_crop_width ||
                    height != buf->img.y_crop_height ||
@@ -117,10 +280,12 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   if (larger_dimensions) {
     YV12_BUFFER_CONFIG new_img;
     memset(&new_img, 0, sizeof(new_img));
-    if (aom_alloc_frame_buffer(&new_img, width, height, subsampling_x,
-                               subsampling_y, use_highbitdepth,
-                               AOM_BORDER_IN_PIXELS, 0))
+    if (realloc_lookahead_frame(&new_img, width, height, subsampling_x,
+                                subsampling_y, use_highbitdepth,
+                                AOM_BORDER_IN_PIXELS, 0, ctx->fb_pool)) {
+      release_input(borrow);
       return 1;
+    }
     aom_free_frame_buffer(&buf->img);
     buf->img = new_img;
   } else if (new_dimensions) {
@@ -133,6 +298,7 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
   }
   // Partial copy not implemented yet
   av1_copy_and_extend_frame(src, &buf->img);
+  release_input(borrow);
 
   buf->ts_start = ts_start;
   buf->ts_end = ts_end;
@@ -185,6 +351,15 @@ struct lookahead_entry *av1_lookahead_peek(struct lookahead_ctx *ctx, int index,
   return buf;
 }
 
+struct lookahead_entry *av1_lookahead_find_entry(
+    struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *img) {
+  if (ctx == NULL) return NULL;
+  for (int i = 0; i < ctx->max_sz; i++) {
+    if (&ctx->buf[i].img == img) return &ctx->buf[i];
+  }
+  return NULL;
+}
+
 unsigned int av1_lookahead_depth(struct lookahead_ctx *ctx,
                                  COMPRESSOR_STAGE stage) {
   struct read_ctx *read_ctx = NULL;
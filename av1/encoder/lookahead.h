@@ -17,6 +17,8 @@
 
 #include "aom_scale/yv12config.h"
 #include "aom/aom_integer.h"
+#include "aom/aomcx.h"
+#include "av1/common/filter.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,11 +30,39 @@ extern "C" {
 #define MAX_TOTAL_BUFFERS (MAX_LAG_BUFFERS + MAX_LAP_BUFFERS)
 #define LAP_LAG_IN_FRAMES 17
 
+// Copy of the frame of a lookahead entry scaled to the coded frame size. It
+// is made on first use and reused by all the encodings of the frame, including
+// when it is the last source of the next frame, until the entry is overwritten.
+struct lookahead_scaled_img {
+  YV12_BUFFER_CONFIG img;
+  // The scaling parameters img was made with, if valid is set.
+  int valid;
+  InterpFilter filter;
+  int phase;
+  int use_optimized_scaler;
+};
+
+// Source frame of the application which the lookahead may use instead of a
+// copy of it.
+struct lookahead_borrow {
+  // Allocation the planes of the frame are in. The borders of the lookahead
+  // frames must fit in it.
+  const uint8_t *buf_start;
+  size_t buf_size;
+  // Called with user_priv once the frame is not used anymore.
+  aom_zero_copy_input_t release;
+  void *user_priv;
+};
+
 struct lookahead_entry {
   YV12_BUFFER_CONFIG img;
+  struct lookahead_scaled_img scaled;
   int64_t ts_start;
   int64_t ts_end;
   aom_enc_frame_flags_t flags;
+  // Set if img is a borrowed frame of the application rather than a copy.
+  int borrowed;
+  struct lookahead_borrow borrow;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -52,6 +82,11 @@ struct lookahead_ctx {
   int write_idx;                         /* Write index */
   struct read_ctx read_ctxs[MAX_STAGES]; /* Read context */
   struct lookahead_entry *buf;           /* Buffer list */
+  int border_in_pixels;                  /* Border of the frames */
+  int byte_alignment;                    /* Alignment of the frames */
+  aom_frame_buffer_pool_t *fb_pool;      /* Pool of the frames */
+  int y_stride;  /* Luma stride a borrowed frame must have */
+  int uv_stride; /* Chroma stride a borrowed frame must have */
 };
 /*!\endcond */
 
@@ -63,7 +98,8 @@ struct lookahead_ctx {
 struct lookahead_ctx *av1_lookahead_init(
     unsigned int width, unsigned int height, unsigned int subsampling_x,
     unsigned int subsampling_y, int use_highbitdepth, unsigned int depth,
-    const int border_in_pixels, int byte_alignment, int num_lap_buffers);
+    const int border_in_pixels, int byte_alignment, int num_lap_buffers,
+    aom_frame_buffer_pool_t *fb_pool);
 
 /**\brief Destroys the lookahead stage
  */
@@ -72,7 +108,10 @@ void av1_lookahead_destroy(struct lookahead_ctx *ctx);
 /**\brief Enqueue a source buffer
  *
  * This function will copy the source image into a new framebuffer with
- * the expected stride/border.
+ * the expected stride/border. If borrow is not NULL and the source image
+ * already has the expected stride and room for the border, it is used in
+ * place instead, and released once the entry is overwritten or destroyed.
+ * Otherwise, it is released once copied.
  *
  * If active_map is non-NULL and there is only one frame in the queue, then copy
  * only active macroblocks.
@@ -83,10 +122,12 @@ void av1_lookahead_destroy(struct lookahead_ctx *ctx);
  * \param[in] ts_end      Timestamp for the end of this frame
  * \param[in] use_highbitdepth Tell if HBD is used
  * \param[in] flags       Flags set on this frame
+ * \param[in] borrow      Buffer of the image to use in place, or NULL
  */
 int av1_lookahead_push(struct lookahead_ctx *ctx, const YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       aom_enc_frame_flags_t flags);
+                       aom_enc_frame_flags_t flags,
+                       const struct lookahead_borrow *borrow);
 
 /**\brief Get the next source buffer to encode
  *
@@ -112,6 +153,16 @@ struct lookahead_entry *av1_lookahead_pop(struct lookahead_ctx *ctx, int drain,
 struct lookahead_entry *av1_lookahead_peek(struct lookahead_ctx *ctx, int index,
                                            COMPRESSOR_STAGE stage);
 
+/**\brief Get the lookahead entry of a frame buffer
+ *
+ * \param[in] ctx       Pointer to the lookahead context
+ * \param[in] img       Frame buffer to look for
+ *
+ * \retval Return NULL, if img is not the frame of a lookahead entry
+ */
+struct lookahead_entry *av1_lookahead_find_entry(struct lookahead_ctx *ctx,
+                                                 const YV12_BUFFER_CONFIG *img);
+
 /**\brief Get the number of frames currently in the lookahead queue
  */
 unsigned int av1_lookahead_depth(struct lookahead_ctx *ctx,
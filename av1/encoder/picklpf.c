@@ -25,6 +25,7 @@
 
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/picklpf.h"
 
 static void yv12_copy_plane(const YV12_BUFFER_CONFIG *src_bc,
@@ -95,17 +96,32 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   return filt_err;
 }
 
-static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
-                               int partial_frame,
-                               const int *last_frame_filter_level,
-                               double *best_cost_ret, int plane, int dir) {
-  const AV1_COMMON *const cm = &cpi->common;
+// State of the filter level search of one plane and direction. The search is
+// advanced one step at a time, so that the levels tried by several searches
+// can be evaluated together.
+typedef struct {
+  int plane;
+  int dir;
+  int filt_mid;
+  int filter_step;
+  int filt_direction;
+  int filt_best;
+  int64_t best_err;
+  // The search is terminated when filter_step equals min_filter_step_thresh.
+  int min_filter_step_thresh;
+  int done;
+  // Sum squared error at each filter level, -1 if not evaluated yet.
+  int64_t ss_err[MAX_LOOP_FILTER + 1];
+} LpfSearch;
+
+static void lpf_search_init(const AV1_COMP *cpi, LpfSearch *search,
+                            const int *last_frame_filter_level, int plane,
+                            int dir) {
   const int min_filter_level = 0;
   const int max_filter_level = av1_get_max_filter_level(cpi);
-  int filt_direction = 0;
-  int64_t best_err;
-  int filt_best;
-  MACROBLOCK *x = &cpi->td.mb;
+
+  search->plane = plane;
+  search->dir = dir;
 
   // Start the search at the previous frame filter level unless it is now out of
   // range.
@@ -119,38 +135,77 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
           break;
         case 0:
         case 1: lvl = last_frame_filter_level[dir]; break;
-        default: assert(dir >= 0 && dir <= 2); return 0;
+        default: assert(dir >= 0 && dir <= 2); lvl = 0; break;
       }
       break;
     case 1: lvl = last_frame_filter_level[2]; break;
     case 2: lvl = last_frame_filter_level[3]; break;
-    default: assert(plane >= 0 && plane <= 2); return 0;
+    default: assert(plane >= 0 && plane <= 2); lvl = 0; break;
   }
-  int filt_mid = clamp(lvl, min_filter_level, max_filter_level);
-  int filter_step = filt_mid < 16 ? 4 : filt_mid / 4;
-  // Sum squared error at each filter level
-  int64_t ss_err[MAX_LOOP_FILTER + 1];
+  search->filt_mid = clamp(lvl, min_filter_level, max_filter_level);
+  search->filter_step = search->filt_mid < 16 ? 4 : search->filt_mid / 4;
+  search->filt_direction = 0;
+  search->filt_best = search->filt_mid;
+  search->best_err = -1;
 
   const int use_coarse_search = cpi->sf.lpf_sf.use_coarse_filter_level_search;
   assert(use_coarse_search <= 1);
   static const int min_filter_step_lookup[2] = { 0, 2 };
-  // min_filter_step_thesh determines the stopping criteria for the search.
-  // The search is terminated when filter_step equals min_filter_step_thesh.
-  const int min_filter_step_thesh = min_filter_step_lookup[use_coarse_search];
+  search->min_filter_step_thresh = min_filter_step_lookup[use_coarse_search];
+  search->done = 0;
 
   // Set each entry to -1
-  memset(ss_err, 0xFF, sizeof(ss_err));
-  yv12_copy_plane(&cm->cur_frame->buf, &cpi->last_frame_uf, plane);
-  best_err = try_filter_frame(sd, cpi, filt_mid, partial_frame, plane, dir);
-  filt_best = filt_mid;
-  ss_err[filt_mid] = best_err;
+  memset(search->ss_err, 0xFF, sizeof(search->ss_err));
+}
+
+// Returns the number of filter levels that must be evaluated before the next
+// call to lpf_search_step(), and stores them in levels.
+static int lpf_search_get_levels(const AV1_COMP *cpi, const LpfSearch *search,
+                                 int *levels) {
+  const int min_filter_level = 0;
+  const int max_filter_level = av1_get_max_filter_level(cpi);
+  const int filt_mid = search->filt_mid;
+  int num_levels = 0;
+
+  if (search->done) return 0;
+  if (search->best_err < 0) {
+    levels[num_levels++] = filt_mid;
+    return num_levels;
+  }
 
-  while (filter_step > min_filter_step_thesh) {
-    const int filt_high = AOMMIN(filt_mid + filter_step, max_filter_level);
-    const int filt_low = AOMMAX(filt_mid - filter_step, min_filter_level);
+  const int filt_high =
+      AOMMIN(filt_mid + search->filter_step, max_filter_level);
+  const int filt_low = AOMMAX(filt_mid - search->filter_step, min_filter_level);
+  if (search->filt_direction <= 0 && filt_low != filt_mid &&
+      search->ss_err[filt_low] < 0)
+    levels[num_levels++] = filt_low;
+  if (search->filt_direction >= 0 && filt_high != filt_mid &&
+      search->ss_err[filt_high] < 0)
+    levels[num_levels++] = filt_high;
+  return num_levels;
+}
+
+// Advances the search by one step. The levels returned by
+// lpf_search_get_levels() must have been evaluated.
+static void lpf_search_step(const AV1_COMP *cpi, LpfSearch *search) {
+  const AV1_COMMON *const cm = &cpi->common;
+  const int min_filter_level = 0;
+  const int max_filter_level = av1_get_max_filter_level(cpi);
+  const int64_t *const ss_err = search->ss_err;
+  const int filt_mid = search->filt_mid;
+
+  if (search->best_err < 0) {
+    search->best_err = ss_err[filt_mid];
+    search->filt_best = filt_mid;
+  } else {
+    const int filt_high =
+        AOMMIN(filt_mid + search->filter_step, max_filter_level);
+    const int filt_low =
+        AOMMAX(filt_mid - search->filter_step, min_filter_level);
 
     // Bias against raising loop filter in favor of lowering it.
-    int64_t bias = (best_err >> (15 - (filt_mid / 8))) * filter_step;
+    int64_t bias =
+        (search->best_err >> (15 - (filt_mid / 8))) * search->filter_step;
 
     if ((is_stat_consumption_stage_twopass(cpi)) &&
         (cpi->twopass.section_intra_rating < 20))
@@ -159,54 +214,231 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
     // yx, bias less for large block size
     if (cm->features.tx_mode != ONLY_4X4) bias >>= 1;
 
-    if (filt_direction <= 0 && filt_low != filt_mid) {
-      // Get Low filter error score
-      if (ss_err[filt_low] < 0) {
-        ss_err[filt_low] =
-            try_filter_frame(sd, cpi, filt_low, partial_frame, plane, dir);
-      }
+    if (search->filt_direction <= 0 && filt_low != filt_mid) {
+      assert(ss_err[filt_low] >= 0);
       // If value is close to the best so far then bias towards a lower loop
       // filter value.
-      if (ss_err[filt_low] < (best_err + bias)) {
+      if (ss_err[filt_low] < (search->best_err + bias)) {
         // Was it actually better than the previous best?
-        if (ss_err[filt_low] < best_err) {
-          best_err = ss_err[filt_low];
+        if (ss_err[filt_low] < search->best_err) {
+          search->best_err = ss_err[filt_low];
         }
-        filt_best = filt_low;
+        search->filt_best = filt_low;
       }
     }
 
     // Now look at filt_high
-    if (filt_direction >= 0 && filt_high != filt_mid) {
-      if (ss_err[filt_high] < 0) {
-        ss_err[filt_high] =
-            try_filter_frame(sd, cpi, filt_high, partial_frame, plane, dir);
-      }
+    if (search->filt_direction >= 0 && filt_high != filt_mid) {
+      assert(ss_err[filt_high] >= 0);
       // If value is significantly better than previous best, bias added against
       // raising filter value
-      if (ss_err[filt_high] < (best_err - bias)) {
-        best_err = ss_err[filt_high];
-        filt_best = filt_high;
+      if (ss_err[filt_high] < (search->best_err - bias)) {
+        search->best_err = ss_err[filt_high];
+        search->filt_best = filt_high;
       }
     }
 
     // Half the step distance if the best filter value was the same as last time
-    if (filt_best == filt_mid) {
-      filter_step /= 2;
-      filt_direction = 0;
+    if (search->filt_best == filt_mid) {
+      search->filter_step /= 2;
+      search->filt_direction = 0;
     } else {
-      filt_direction = (filt_best < filt_mid) ? -1 : 1;
-      filt_mid = filt_best;
+      search->filt_direction = (search->filt_best < filt_mid) ? -1 : 1;
+      search->filt_mid = search->filt_best;
     }
   }
 
-  // Update best error
-  best_err = ss_err[filt_best];
+  if (search->filter_step <= search->min_filter_step_thresh) {
+    // Update best error
+    search->best_err = ss_err[search->filt_best];
+    search->done = 1;
+  }
+}
+
+static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
+                               int partial_frame,
+                               const int *last_frame_filter_level,
+                               double *best_cost_ret, int plane, int dir) {
+  const AV1_COMMON *const cm = &cpi->common;
+  MACROBLOCK *x = &cpi->td.mb;
+  LpfSearch search;
+
+  lpf_search_init(cpi, &search, last_frame_filter_level, plane, dir);
+  yv12_copy_plane(&cm->cur_frame->buf, &cpi->last_frame_uf, plane);
+  while (!search.done) {
+    int levels[2];
+    const int num_levels = lpf_search_get_levels(cpi, &search, levels);
+    for (int i = 0; i < num_levels; ++i) {
+      search.ss_err[levels[i]] =
+          try_filter_frame(sd, cpi, levels[i], partial_frame, plane, dir);
+    }
+    lpf_search_step(cpi, &search);
+  }
 
   if (best_cost_ret)
     *best_cost_ret = RDCOST_DBL_WITH_NATIVE_BD_DIST(
-        x->rdmult, 0, (best_err << 4), cm->seq_params.bit_depth);
-  return filt_best;
+        x->rdmult, 0, (search.best_err << 4), cm->seq_params.bit_depth);
+  return search.filt_best;
+}
+
+void av1_lpf_pick_try_trial(const AV1LpfPickSync *lpf_pick_sync,
+                            LpfPickWorkerData *worker_data,
+                            LpfPickTrial *trial) {
+  AV1_COMMON *const cm = &worker_data->cm;
+  const int plane = trial->plane;
+
+  switch (plane) {
+    case 0:
+      cm->lf.filter_level[0] = trial->filter_level[0];
+      cm->lf.filter_level[1] = trial->filter_level[1];
+      break;
+    case 1: cm->lf.filter_level_u = trial->filter_level[0]; break;
+    case 2: cm->lf.filter_level_v = trial->filter_level[0]; break;
+    default: assert(plane >= 0 && plane <= 2); break;
+  }
+
+  yv12_copy_plane(lpf_pick_sync->unfiltered, &worker_data->frame, plane);
+  av1_loop_filter_frame(&worker_data->frame, cm, &worker_data->xd,
+#if CONFIG_LPF_MASK
+                        0,
+#endif
+                        plane, plane + 1, lpf_pick_sync->partial_frame);
+  trial->sse = aom_get_sse_plane(lpf_pick_sync->src, &worker_data->frame,
+                                 plane, cm->seq_params.use_highbitdepth);
+}
+
+// Allocates the per worker data of the multi-threaded search if needed, and
+// copies the current common state to it.
+static void lpf_pick_mt_init(AV1_COMP *cpi, const YV12_BUFFER_CONFIG *sd,
+                             int partial_frame, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  const SequenceHeader *const seq_params = &cm->seq_params;
+  AV1LpfPickSync *const lpf_pick_sync = &cpi->mt_info.lpf_pick_sync;
+
+  if (lpf_pick_sync->num_workerdata < num_workers) {
+    if (lpf_pick_sync->workerdata != NULL) {
+      for (int i = 0; i < lpf_pick_sync->num_workerdata; ++i)
+        aom_free_frame_buffer(&lpf_pick_sync->workerdata[i].frame);
+      aom_free(lpf_pick_sync->workerdata);
+      lpf_pick_sync->workerdata = NULL;
+      lpf_pick_sync->num_workerdata = 0;
+    }
+    CHECK_MEM_ERROR(
+        cm, lpf_pick_sync->workerdata,
+        aom_memalign(32, num_workers * sizeof(*lpf_pick_sync->workerdata)));
+    memset(lpf_pick_sync->workerdata, 0,
+           num_workers * sizeof(*lpf_pick_sync->workerdata));
+    lpf_pick_sync->num_workerdata = num_workers;
+  }
+
+  for (int i = 0; i < num_workers; ++i) {
+    LpfPickWorkerData *const worker_data = &lpf_pick_sync->workerdata[i];
+    if (aom_realloc_frame_buffer_from_pool(
+            &worker_data->frame, cm->width, cm->height,
+            seq_params->subsampling_x, seq_params->subsampling_y,
+            seq_params->use_highbitdepth, cpi->oxcf.border_in_pixels,
+            cm->features.byte_alignment, cpi->fb_pool))
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate loop filter search buffer");
+    worker_data->cm = *cm;
+    worker_data->xd = cpi->td.mb.e_mbd;
+  }
+
+  lpf_pick_sync->src = sd;
+  lpf_pick_sync->unfiltered = &cpi->last_frame_uf;
+  lpf_pick_sync->partial_frame = partial_frame;
+}
+
+// Multi-threaded version of the filter level search in av1_pick_filter_level().
+// The luma search and the two chroma searches run side by side, and the
+// levels each of them needs for its next step are evaluated concurrently on
+// separate workers. The decisions are the same as those of the serial search.
+static void search_filter_levels_mt(const YV12_BUFFER_CONFIG *sd,
+                                    AV1_COMP *cpi, int partial_frame,
+                                    const int *last_frame_filter_level,
+                                    int dual_search) {
+  AV1_COMMON *const cm = &cpi->common;
+  MultiThreadInfo *const mt_info = &cpi->mt_info;
+  AV1LpfPickSync *const lpf_pick_sync = &mt_info->lpf_pick_sync;
+  struct loopfilter *const lf = &cm->lf;
+  const int num_planes = av1_num_planes(cm);
+  // Directions searched in order for luma. Each one starts from the levels
+  // picked by the previous ones.
+  const int luma_dirs[3] = { 2, 0, 1 };
+  const int num_luma_dirs = dual_search ? 3 : 1;
+  int luma_dir_idx = 0;
+  LpfSearch searches[MAX_MB_PLANE];
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    lpf_search_init(cpi, &searches[plane], last_frame_filter_level, plane,
+                    plane == 0 ? luma_dirs[0] : 0);
+    yv12_copy_plane(&cm->cur_frame->buf, &cpi->last_frame_uf, plane);
+  }
+  lpf_pick_mt_init(cpi, sd, partial_frame,
+                   AOMMIN(mt_info->num_workers, 2 * MAX_MB_PLANE));
+
+  int searching = 1;
+  while (searching) {
+    // Collect the levels every search needs for its next step.
+    LpfPickTrial *const trials = lpf_pick_sync->trials;
+    int num_trials = 0;
+    for (int plane = 0; plane < num_planes; ++plane) {
+      const LpfSearch *const search = &searches[plane];
+      int levels[2];
+      const int num_levels = lpf_search_get_levels(cpi, search, levels);
+      for (int i = 0; i < num_levels; ++i) {
+        LpfPickTrial *const trial = &trials[num_trials++];
+        trial->plane = plane;
+        trial->filter_level[0] = levels[i];
+        trial->filter_level[1] = levels[i];
+        if (plane == 0 && search->dir == 0)
+          trial->filter_level[1] = lf->filter_level[1];
+        if (plane == 0 && search->dir == 1)
+          trial->filter_level[0] = lf->filter_level[0];
+      }
+    }
+
+    if (num_trials == 1) {
+      // A single trial is faster with the multi-threaded loop filter.
+      const LpfSearch *const search = &searches[trials[0].plane];
+      trials[0].sse =
+          try_filter_frame(sd, cpi, trials[0].filter_level[search->dir == 1],
+                           partial_frame, trials[0].plane, search->dir);
+    } else if (num_trials > 1) {
+      const int num_workers =
+          AOMMIN(num_trials, lpf_pick_sync->num_workerdata);
+      lpf_pick_sync->num_trials = num_trials;
+      av1_lpf_pick_trials_mt(cm, mt_info, num_workers);
+    }
+
+    for (int i = 0; i < num_trials; ++i) {
+      LpfSearch *const search = &searches[trials[i].plane];
+      search->ss_err[trials[i].filter_level[search->dir == 1]] = trials[i].sse;
+    }
+
+    searching = 0;
+    for (int plane = 0; plane < num_planes; ++plane) {
+      LpfSearch *const search = &searches[plane];
+      if (search->done) continue;
+      lpf_search_step(cpi, search);
+      if (search->done && plane == 0) {
+        if (search->dir == 2) {
+          lf->filter_level[0] = lf->filter_level[1] = search->filt_best;
+        } else {
+          lf->filter_level[search->dir] = search->filt_best;
+        }
+        if (++luma_dir_idx < num_luma_dirs)
+          lpf_search_init(cpi, search, last_frame_filter_level, 0,
+                          luma_dirs[luma_dir_idx]);
+      }
+      searching |= !search->done;
+    }
+  }
+
+  if (num_planes > 1) {
+    lf->filter_level_u = searches[1].filt_best;
+    lf->filter_level_v = searches[2].filt_best;
+  }
 }
 
 void av1_pick_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
@@ -277,6 +509,13 @@ void av1_pick_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
                                              lf->filter_level_u,
                                              lf->filter_level_v };
 
+    if (cpi->mt_info.num_workers > 1) {
+      search_filter_levels_mt(sd, cpi, method == LPF_PICK_FROM_SUBIMAGE,
+                              last_frame_filter_level,
+                              method != LPF_PICK_FROM_FULL_IMAGE_NON_DUAL);
+      return;
+    }
+
     lf->filter_level[0] = lf->filter_level[1] =
         search_filter_level(sd, cpi, method == LPF_PICK_FROM_SUBIMAGE,
                             last_frame_filter_level, NULL, 0, 2);
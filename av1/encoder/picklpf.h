@@ -22,6 +22,12 @@ struct yv12_buffer_config;
 struct AV1_COMP;
 int av1_get_max_filter_level(const AV1_COMP *cpi);
 
+// Filters one plane of lpf_pick_sync->unfiltered into worker_data->frame with
+// the levels of trial, and stores the error against the source in trial->sse.
+void av1_lpf_pick_try_trial(const AV1LpfPickSync *lpf_pick_sync,
+                            LpfPickWorkerData *worker_data,
+                            LpfPickTrial *trial);
+
 /*!\brief Algorithm for AV1 loop filter level selection.
  *
  * \ingroup in_loop_filter
@@ -29,6 +29,7 @@
 
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/mathutils.h"
 #include "av1/encoder/picklpf.h"
 #include "av1/encoder/pickrst.h"
@@ -121,7 +122,7 @@ typedef struct {
   uint8_t skip_sgr_eval;
 } RestUnitSearchInfo;
 
-typedef struct {
+typedef struct RestSearchCtxt {
   const YV12_BUFFER_CONFIG *src;
   YV12_BUFFER_CONFIG *dst;
 
@@ -139,6 +140,7 @@ typedef struct {
   int dgd_stride;
   const uint8_t *src_buffer;
   int src_stride;
+  int32_t *tmpbuf;
 
   // sse and bits are initialised by reset_rsc in search_rest_type
   int64_t sse;
@@ -185,6 +187,7 @@ static AOM_INLINE void init_rsc(const YV12_BUFFER_CONFIG *src,
   rsc->src_stride = src->strides[is_uv];
   rsc->dgd_buffer = dgd->buffers[plane];
   rsc->dgd_stride = dgd->strides[is_uv];
+  rsc->tmpbuf = cm->rst_tmpbuf;
   rsc->tile_rect = av1_whole_frame_rect(cm, is_uv);
   assert(src->crop_widths[is_uv] == dgd->crop_widths[is_uv]);
   assert(src->crop_heights[is_uv] == dgd->crop_heights[is_uv]);
@@ -202,7 +205,6 @@ static int64_t try_restoration_unit(const RestSearchCtxt *rsc,
   const int bit_depth = cm->seq_params.bit_depth;
   const int highbd = cm->seq_params.use_highbitdepth;
 
-  const YV12_BUFFER_CONFIG *fts = &cm->cur_frame->buf;
   // TODO(yunqing): For now, only use optimized LR filter in decoder. Can be
   // also used in encoder.
   const int optimized_lr = 0;
@@ -211,8 +213,8 @@ static int64_t try_restoration_unit(const RestSearchCtxt *rsc,
       limits, rui, &rsi->boundaries, &rlbs, tile_rect, rsc->tile_stripe0,
       is_uv && cm->seq_params.subsampling_x,
       is_uv && cm->seq_params.subsampling_y, highbd, bit_depth,
-      fts->buffers[plane], fts->strides[is_uv], rsc->dst->buffers[plane],
-      rsc->dst->strides[is_uv], cm->rst_tmpbuf, optimized_lr);
+      rsc->dgd_buffer, rsc->dgd_stride, rsc->dst->buffers[plane],
+      rsc->dst->strides[is_uv], rsc->tmpbuf, optimized_lr);
 
   return sse_restoration_unit(limits, rsc->src, rsc->dst, plane, highbd);
 }
@@ -875,25 +877,18 @@ static int count_sgrproj_bits(SgrprojInfo *sgrproj_info,
   return bits;
 }
 
-static AOM_INLINE void search_sgrproj(const RestorationTileLimits *limits,
-                                      const AV1PixelRect *tile,
-                                      int rest_unit_idx, void *priv,
-                                      int32_t *tmpbuf,
-                                      RestorationLineBuffers *rlbs) {
-  (void)rlbs;
-  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
-
-  const MACROBLOCK *const x = rsc->x;
+// Searches the self-guided parameters of one unit. This does not depend on the
+// other units of the plane, so units may be searched in any order.
+static AOM_INLINE void search_sgrproj_unit(const RestSearchCtxt *rsc,
+                                           const RestorationTileLimits *limits,
+                                           const AV1PixelRect *tile,
+                                           RestUnitSearchInfo *rusi) {
   const AV1_COMMON *const cm = rsc->cm;
   const int highbd = cm->seq_params.use_highbitdepth;
   const int bit_depth = cm->seq_params.bit_depth;
 
-  const int64_t bits_none = x->mode_costs.sgrproj_restore_cost[0];
   // Prune evaluation of RESTORE_SGRPROJ if 'skip_sgr_eval' is set
   if (rusi->skip_sgr_eval) {
-    rsc->bits += bits_none;
-    rsc->sse += rusi->sse[RESTORE_NONE];
     rusi->best_rtype[RESTORE_SGRPROJ - 1] = RESTORE_NONE;
     rusi->sse[RESTORE_SGRPROJ] = INT64_MAX;
     return;
@@ -914,13 +909,39 @@ static AOM_INLINE void search_sgrproj(const RestorationTileLimits *limits,
       dgd_start, limits->h_end - limits->h_start,
       limits->v_end - limits->v_start, rsc->dgd_stride, src_start,
       rsc->src_stride, highbd, bit_depth, procunit_width, procunit_height,
-      tmpbuf, rsc->lpf_sf->enable_sgr_ep_pruning);
+      rsc->tmpbuf, rsc->lpf_sf->enable_sgr_ep_pruning);
 
   RestorationUnitInfo rui;
   rui.restoration_type = RESTORE_SGRPROJ;
   rui.sgrproj_info = rusi->sgrproj;
 
   rusi->sse[RESTORE_SGRPROJ] = try_restoration_unit(rsc, limits, tile, &rui);
+}
+
+// Decides between RESTORE_SGRPROJ and RESTORE_NONE for one unit searched by
+// search_sgrproj_unit(). The cost of the parameters is coded relative to those
+// of the previous unit, so units must be visited in coding order.
+static AOM_INLINE void pick_sgrproj(const RestorationTileLimits *limits,
+                                    const AV1PixelRect *tile,
+                                    int rest_unit_idx, void *priv,
+                                    int32_t *tmpbuf,
+                                    RestorationLineBuffers *rlbs) {
+  (void)limits;
+  (void)tile;
+  (void)tmpbuf;
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+
+  const MACROBLOCK *const x = rsc->x;
+  const int bit_depth = rsc->cm->seq_params.bit_depth;
+
+  const int64_t bits_none = x->mode_costs.sgrproj_restore_cost[0];
+  if (rusi->skip_sgr_eval) {
+    rsc->bits += bits_none;
+    rsc->sse += rusi->sse[RESTORE_NONE];
+    return;
+  }
 
   const int64_t bits_sgr = x->mode_costs.sgrproj_restore_cost[1] +
                            (count_sgrproj_bits(&rusi->sgrproj, &rsc->sgrproj)
@@ -942,6 +963,16 @@ static AOM_INLINE void search_sgrproj(const RestorationTileLimits *limits,
   if (cost_sgr < cost_none) rsc->sgrproj = rusi->sgrproj;
 }
 
+static AOM_INLINE void search_sgrproj(const RestorationTileLimits *limits,
+                                      const AV1PixelRect *tile,
+                                      int rest_unit_idx, void *priv,
+                                      int32_t *tmpbuf,
+                                      RestorationLineBuffers *rlbs) {
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  search_sgrproj_unit(rsc, limits, tile, &rsc->rusi[rest_unit_idx]);
+  pick_sgrproj(limits, tile, rest_unit_idx, priv, tmpbuf, rlbs);
+}
+
 void av1_compute_stats_c(int wiener_win, const uint8_t *dgd, const uint8_t *src,
                          int h_start, int h_end, int v_start, int v_end,
                          int dgd_stride, int src_stride, int64_t *M,
@@ -1456,19 +1487,21 @@ static int64_t finer_tile_search_wiener(const RestSearchCtxt *rsc,
   return err;
 }
 
-static AOM_INLINE void search_wiener(const RestorationTileLimits *limits,
-                                     const AV1PixelRect *tile_rect,
-                                     int rest_unit_idx, void *priv,
-                                     int32_t *tmpbuf,
-                                     RestorationLineBuffers *rlbs) {
-  (void)tmpbuf;
-  (void)rlbs;
-  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
-
-  const MACROBLOCK *const x = rsc->x;
-  const int64_t bits_none = x->mode_costs.wiener_restore_cost[0];
+// Marks the Wiener filter of one unit as not worth signaling.
+static AOM_INLINE void prune_wiener_unit(const RestSearchCtxt *rsc,
+                                         RestUnitSearchInfo *rusi) {
+  rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
+  rusi->sse[RESTORE_WIENER] = INT64_MAX;
+  if (rsc->lpf_sf->prune_sgr_based_on_wiener == 2) rusi->skip_sgr_eval = 1;
+}
 
+// Searches the Wiener filter of one unit. This does not depend on the other
+// units of the plane, so units may be searched in any order. A pruned unit is
+// left with an error of INT64_MAX.
+static AOM_INLINE void search_wiener_unit(const RestSearchCtxt *rsc,
+                                          const RestorationTileLimits *limits,
+                                          const AV1PixelRect *tile_rect,
+                                          RestUnitSearchInfo *rusi) {
   // Skip Wiener search for low variance contents
   if (rsc->lpf_sf->prune_wiener_based_on_src_var) {
     const int scale[3] = { 0, 1, 2 };
@@ -1486,11 +1519,7 @@ static AOM_INLINE void search_wiener(const RestorationTileLimits *limits,
     // or if the reconstruction error is zero
     int prune_wiener = (src_var < thresh) || (rusi->sse[RESTORE_NONE] == 0);
     if (prune_wiener) {
-      rsc->bits += bits_none;
-      rsc->sse += rusi->sse[RESTORE_NONE];
-      rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
-      rusi->sse[RESTORE_WIENER] = INT64_MAX;
-      if (rsc->lpf_sf->prune_sgr_based_on_wiener == 2) rusi->skip_sgr_eval = 1;
+      prune_wiener_unit(rsc, rusi);
       return;
     }
   }
@@ -1539,11 +1568,7 @@ static AOM_INLINE void search_wiener(const RestorationTileLimits *limits,
   // reduction in the function, the filter is reverted back to identity
   if (compute_score(reduced_wiener_win, M, H, rui.wiener_info.vfilter,
                     rui.wiener_info.hfilter) > 0) {
-    rsc->bits += bits_none;
-    rsc->sse += rusi->sse[RESTORE_NONE];
-    rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
-    rusi->sse[RESTORE_WIENER] = INT64_MAX;
-    if (rsc->lpf_sf->prune_sgr_based_on_wiener == 2) rusi->skip_sgr_eval = 1;
+    prune_wiener_unit(rsc, rusi);
     return;
   }
 
@@ -1559,7 +1584,33 @@ static AOM_INLINE void search_wiener(const RestorationTileLimits *limits,
     assert(rui.wiener_info.hfilter[0] == 0 &&
            rui.wiener_info.hfilter[WIENER_WIN - 1] == 0);
   }
+}
+
+// Decides between RESTORE_WIENER and RESTORE_NONE for one unit searched by
+// search_wiener_unit(). The filter is coded relative to that of the previous
+// unit, so units must be visited in coding order.
+static AOM_INLINE void pick_wiener(const RestorationTileLimits *limits,
+                                   const AV1PixelRect *tile_rect,
+                                   int rest_unit_idx, void *priv,
+                                   int32_t *tmpbuf,
+                                   RestorationLineBuffers *rlbs) {
+  (void)limits;
+  (void)tile_rect;
+  (void)tmpbuf;
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+
+  const MACROBLOCK *const x = rsc->x;
+  const int64_t bits_none = x->mode_costs.wiener_restore_cost[0];
+  if (rusi->sse[RESTORE_WIENER] == INT64_MAX) {
+    rsc->bits += bits_none;
+    rsc->sse += rusi->sse[RESTORE_NONE];
+    return;
+  }
 
+  const int wiener_win =
+      (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN : WIENER_WIN_CHROMA;
   const int64_t bits_wiener =
       x->mode_costs.wiener_restore_cost[1] +
       (count_wiener_bits(wiener_win, &rusi->wiener, &rsc->wiener)
@@ -1589,23 +1640,45 @@ static AOM_INLINE void search_wiener(const RestorationTileLimits *limits,
   if (cost_wiener < cost_none) rsc->wiener = rusi->wiener;
 }
 
-static AOM_INLINE void search_norestore(const RestorationTileLimits *limits,
-                                        const AV1PixelRect *tile_rect,
-                                        int rest_unit_idx, void *priv,
-                                        int32_t *tmpbuf,
-                                        RestorationLineBuffers *rlbs) {
-  (void)tile_rect;
-  (void)tmpbuf;
-  (void)rlbs;
-
+static AOM_INLINE void search_wiener(const RestorationTileLimits *limits,
+                                     const AV1PixelRect *tile_rect,
+                                     int rest_unit_idx, void *priv,
+                                     int32_t *tmpbuf,
+                                     RestorationLineBuffers *rlbs) {
   RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+  search_wiener_unit(rsc, limits, tile_rect, &rsc->rusi[rest_unit_idx]);
+  pick_wiener(limits, tile_rect, rest_unit_idx, priv, tmpbuf, rlbs);
+}
 
+static AOM_INLINE void search_norestore_unit(
+    const RestSearchCtxt *rsc, const RestorationTileLimits *limits,
+    RestUnitSearchInfo *rusi) {
   const int highbd = rsc->cm->seq_params.use_highbitdepth;
   rusi->sse[RESTORE_NONE] = sse_restoration_unit(
       limits, rsc->src, &rsc->cm->cur_frame->buf, rsc->plane, highbd);
+}
+
+static AOM_INLINE void pick_norestore(const RestorationTileLimits *limits,
+                                      const AV1PixelRect *tile_rect,
+                                      int rest_unit_idx, void *priv,
+                                      int32_t *tmpbuf,
+                                      RestorationLineBuffers *rlbs) {
+  (void)limits;
+  (void)tile_rect;
+  (void)tmpbuf;
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  rsc->sse += rsc->rusi[rest_unit_idx].sse[RESTORE_NONE];
+}
 
-  rsc->sse += rusi->sse[RESTORE_NONE];
+static AOM_INLINE void search_norestore(const RestorationTileLimits *limits,
+                                        const AV1PixelRect *tile_rect,
+                                        int rest_unit_idx, void *priv,
+                                        int32_t *tmpbuf,
+                                        RestorationLineBuffers *rlbs) {
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  search_norestore_unit(rsc, limits, &rsc->rusi[rest_unit_idx]);
+  pick_norestore(limits, tile_rect, rest_unit_idx, priv, tmpbuf, rlbs);
 }
 
 static AOM_INLINE void search_switchable(const RestorationTileLimits *limits,
@@ -1683,16 +1756,176 @@ static AOM_INLINE void copy_unit_info(RestorationType frame_rtype,
     rui->sgrproj_info = rusi->sgrproj;
 }
 
-static double search_rest_type(RestSearchCtxt *rsc, RestorationType rtype) {
+// Copies the degraded plane of rsc, including its border, to the private copy
+// of a worker.
+static void copy_dgd_plane(const RestSearchCtxt *rsc, YV12_BUFFER_CONFIG *dgd) {
+  const AV1_COMMON *const cm = rsc->cm;
+  const YV12_BUFFER_CONFIG *const src = &cm->cur_frame->buf;
+  const int is_uv = rsc->plane != AOM_PLANE_Y;
+  const int ss_x = is_uv && cm->seq_params.subsampling_x;
+  const int ss_y = is_uv && cm->seq_params.subsampling_y;
+  const int border = AOMMIN(src->border, dgd->border);
+  const int border_x = border >> ss_x;
+  const int border_y = border >> ss_y;
+  const int width = rsc->plane_width + 2 * border_x;
+  const int src_stride = src->strides[is_uv];
+  const int dst_stride = dgd->strides[is_uv];
+  if (cm->seq_params.use_highbitdepth) {
+    const uint16_t *src_row = CONVERT_TO_SHORTPTR(src->buffers[rsc->plane]) -
+                              border_y * src_stride - border_x;
+    uint16_t *dst_row = CONVERT_TO_SHORTPTR(dgd->buffers[rsc->plane]) -
+                        border_y * dst_stride - border_x;
+    for (int i = 0; i < rsc->plane_height + 2 * border_y; ++i) {
+      memcpy(dst_row, src_row, width * sizeof(*dst_row));
+      src_row += src_stride;
+      dst_row += dst_stride;
+    }
+  } else {
+    const uint8_t *src_row =
+        src->buffers[rsc->plane] - border_y * src_stride - border_x;
+    uint8_t *dst_row =
+        dgd->buffers[rsc->plane] - border_y * dst_stride - border_x;
+    for (int i = 0; i < rsc->plane_height + 2 * border_y; ++i) {
+      memcpy(dst_row, src_row, width);
+      src_row += src_stride;
+      dst_row += dst_stride;
+    }
+  }
+}
+
+void av1_pick_rst_search_unit(const AV1PickRstSync *pick_rst_sync,
+                              PickRstWorkerData *worker_data,
+                              const PickRstJob *job) {
+  const RestSearchCtxt *const frame_rsc = pick_rst_sync->rsc;
+  RestUnitSearchInfo *const rusi = &frame_rsc->rusi[job->unit_idx];
+  if (pick_rst_sync->rtype == RESTORE_NONE) {
+    search_norestore_unit(frame_rsc, &job->limits, rusi);
+    return;
+  }
+
+  if (!worker_data->dgd_valid) {
+    copy_dgd_plane(frame_rsc, &worker_data->dgd);
+    worker_data->dgd_valid = 1;
+  }
+  const int is_uv = frame_rsc->plane != AOM_PLANE_Y;
+  RestSearchCtxt rsc = *frame_rsc;
+  rsc.dgd_buffer = worker_data->dgd.buffers[rsc.plane];
+  rsc.dgd_stride = worker_data->dgd.strides[is_uv];
+  rsc.dst = &worker_data->dst;
+  rsc.tmpbuf = worker_data->tmpbuf;
+  if (pick_rst_sync->rtype == RESTORE_WIENER) {
+    search_wiener_unit(&rsc, &job->limits, &rsc.tile_rect, rusi);
+  } else {
+    assert(pick_rst_sync->rtype == RESTORE_SGRPROJ);
+    search_sgrproj_unit(&rsc, &job->limits, &rsc.tile_rect, rusi);
+  }
+}
+
+static AOM_INLINE void add_pick_rst_job(const RestorationTileLimits *limits,
+                                        const AV1PixelRect *tile_rect,
+                                        int rest_unit_idx, void *priv,
+                                        int32_t *tmpbuf,
+                                        RestorationLineBuffers *rlbs) {
+  (void)tile_rect;
+  (void)tmpbuf;
+  (void)rlbs;
+  AV1PickRstSync *const pick_rst_sync = (AV1PickRstSync *)priv;
+  assert(pick_rst_sync->num_jobs < pick_rst_sync->jobs_alloc);
+  PickRstJob *const job = &pick_rst_sync->jobs[pick_rst_sync->num_jobs++];
+  job->limits = *limits;
+  job->unit_idx = rest_unit_idx;
+}
+
+// Prepares the multi-threaded search of the plane of rsc on num_workers
+// workers: allocates their scratch buffers and lists the units of the plane.
+static void pick_rst_mt_init(AV1_COMP *cpi, RestSearchCtxt *rsc,
+                             int num_units, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  const SequenceHeader *const seq_params = &cm->seq_params;
+  AV1PickRstSync *const pick_rst_sync = &cpi->mt_info.pick_rst_sync;
+
+  if (pick_rst_sync->num_workerdata < num_workers) {
+    if (pick_rst_sync->workerdata != NULL) {
+      for (int i = 0; i < pick_rst_sync->num_workerdata; ++i) {
+        PickRstWorkerData *const worker_data = &pick_rst_sync->workerdata[i];
+        aom_free_frame_buffer(&worker_data->dgd);
+        aom_free_frame_buffer(&worker_data->dst);
+        aom_free(worker_data->tmpbuf);
+      }
+      aom_free(pick_rst_sync->workerdata);
+      pick_rst_sync->workerdata = NULL;
+      pick_rst_sync->num_workerdata = 0;
+    }
+    CHECK_MEM_ERROR(
+        cm, pick_rst_sync->workerdata,
+        aom_memalign(32, num_workers * sizeof(*pick_rst_sync->workerdata)));
+    memset(pick_rst_sync->workerdata, 0,
+           num_workers * sizeof(*pick_rst_sync->workerdata));
+    pick_rst_sync->num_workerdata = num_workers;
+  }
+
+  for (int i = 0; i < num_workers; ++i) {
+    PickRstWorkerData *const worker_data = &pick_rst_sync->workerdata[i];
+    if (aom_realloc_frame_buffer_from_pool(
+            &worker_data->dgd, cm->superres_upscaled_width,
+            cm->superres_upscaled_height, seq_params->subsampling_x,
+            seq_params->subsampling_y, seq_params->use_highbitdepth,
+            AOM_RESTORATION_FRAME_BORDER, cm->features.byte_alignment,
+            cpi->fb_pool) ||
+        aom_realloc_frame_buffer_from_pool(
+            &worker_data->dst, cm->superres_upscaled_width,
+            cm->superres_upscaled_height, seq_params->subsampling_x,
+            seq_params->subsampling_y, seq_params->use_highbitdepth,
+            AOM_RESTORATION_FRAME_BORDER, cm->features.byte_alignment,
+            cpi->fb_pool))
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate restoration search buffers");
+    if (worker_data->tmpbuf == NULL) {
+      CHECK_MEM_ERROR(cm, worker_data->tmpbuf,
+                      (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+    }
+    worker_data->dgd_valid = 0;
+  }
+
+  if (pick_rst_sync->jobs_alloc < num_units) {
+    aom_free(pick_rst_sync->jobs);
+    pick_rst_sync->jobs = NULL;
+    pick_rst_sync->jobs_alloc = 0;
+    CHECK_MEM_ERROR(cm, pick_rst_sync->jobs,
+                    aom_malloc(num_units * sizeof(*pick_rst_sync->jobs)));
+    pick_rst_sync->jobs_alloc = num_units;
+  }
+  pick_rst_sync->num_jobs = 0;
+  av1_foreach_rest_unit_in_plane(cm, rsc->plane, add_pick_rst_job,
+                                 pick_rst_sync, &rsc->tile_rect, NULL, NULL);
+  pick_rst_sync->rsc = rsc;
+}
+
+// Searches one restoration type for the plane of rsc and returns its RD cost.
+// With num_workers > 1, the units are searched on separate workers and only
+// the decisions, which depend on the previous unit, are made serially, so the
+// result is the same as that of the serial search.
+static double search_rest_type(RestSearchCtxt *rsc, RestorationType rtype,
+                               AV1_COMP *cpi, int num_workers) {
   static const rest_unit_visitor_t funs[RESTORE_TYPES] = {
     search_norestore, search_wiener, search_sgrproj, search_switchable
   };
+  static const rest_unit_visitor_t pick_funs[RESTORE_SWITCHABLE] = {
+    pick_norestore, pick_wiener, pick_sgrproj
+  };
 
   reset_rsc(rsc);
   rsc_on_tile(rsc);
 
-  av1_foreach_rest_unit_in_plane(rsc->cm, rsc->plane, funs[rtype], rsc,
-                                 &rsc->tile_rect, rsc->cm->rst_tmpbuf, NULL);
+  if (num_workers > 1 && rtype != RESTORE_SWITCHABLE) {
+    cpi->mt_info.pick_rst_sync.rtype = rtype;
+    av1_pick_rst_units_mt(&cpi->common, &cpi->mt_info, num_workers);
+    av1_foreach_rest_unit_in_plane(rsc->cm, rsc->plane, pick_funs[rtype], rsc,
+                                   &rsc->tile_rect, rsc->tmpbuf, NULL);
+  } else {
+    av1_foreach_rest_unit_in_plane(rsc->cm, rsc->plane, funs[rtype], rsc,
+                                   &rsc->tile_rect, rsc->tmpbuf, NULL);
+  }
   return RDCOST_DBL_WITH_NATIVE_BD_DIST(
       rsc->x->rdmult, rsc->bits >> 4, rsc->sse, rsc->cm->seq_params.bit_depth);
 }
@@ -1746,12 +1979,16 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
                        rsc.dgd_stride, RESTORATION_BORDER, RESTORATION_BORDER,
                        highbd);
 
+      const int num_workers = AOMMIN(cpi->mt_info.num_workers, plane_ntiles);
+      if (num_workers > 1)
+        pick_rst_mt_init(cpi, &rsc, plane_ntiles, num_workers);
+
       for (RestorationType r = 0; r < num_rtypes; ++r) {
         if ((force_restore_type != RESTORE_TYPES) && (r != RESTORE_NONE) &&
             (r != force_restore_type))
           continue;
 
-        double cost = search_rest_type(&rsc, r);
+        double cost = search_rest_type(&rsc, r, cpi, num_workers);
 
         if (r == 0 || cost < best_cost) {
           best_cost = cost;
@@ -92,6 +92,15 @@ static INLINE uint16_t find_average_highbd(const uint16_t *src, int h_start,
  */
 void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi);
 
+/*!\cond */
+// Runs the part of the search of one restoration type that does not depend on
+// the other units for the unit of job, using the scratch buffers of
+// worker_data. The results are stored in the unit's search info.
+void av1_pick_rst_search_unit(const AV1PickRstSync *pick_rst_sync,
+                              PickRstWorkerData *worker_data,
+                              const PickRstJob *job);
+/*!\endcond */
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -15,6 +15,9 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include "config/av1_rtcd.h"
+
+#include "aom_dsp/aom_dsp_common.h"
 #include "av1/encoder/ransac.h"
 #include "av1/encoder/mathutils.h"
 #include "av1/encoder/random.h"
@@ -23,7 +26,6 @@
 #define MAX_DEGENERATE_ITER 10
 #define MINPTS_MULTIPLIER 5
 
-#define INLIER_THRESHOLD 1.25
 #define MIN_TRIALS 20
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,48 +35,51 @@ typedef void (*NormalizeFunc)(double *p, int np, double *T);
 typedef void (*DenormalizeFunc)(double *params, double *T1, double *T2);
 typedef int (*FindTransformationFunc)(int points, double *points1,
                                       double *points2, double *params);
-typedef void (*ProjectPointsDoubleFunc)(double *mat, double *points,
-                                        double *proj, int n, int stride_points,
-                                        int stride_proj);
-
-static void project_points_double_translation(double *mat, double *points,
-                                              double *proj, int n,
-                                              int stride_points,
-                                              int stride_proj) {
-  int i;
-  for (i = 0; i < n; ++i) {
-    const double x = *(points++), y = *(points++);
-    *(proj++) = x + mat[0];
-    *(proj++) = y + mat[1];
-    points += stride_points - 2;
-    proj += stride_proj - 2;
-  }
+typedef void (*ToAffineFunc)(const double *mat, double *affine);
+
+// The inliers of all the models are found with an affine projection. The
+// products by 0 and 1 it adds for the translation and rotzoom models are
+// exact, so the projected points do not depend on the model used.
+static void translation_to_affine(const double *mat, double *affine) {
+  affine[0] = mat[0];
+  affine[1] = mat[1];
+  affine[2] = 1.0;
+  affine[3] = 0.0;
+  affine[4] = 0.0;
+  affine[5] = 1.0;
 }
 
-static void project_points_double_rotzoom(double *mat, double *points,
-                                          double *proj, int n,
-                                          int stride_points, int stride_proj) {
-  int i;
-  for (i = 0; i < n; ++i) {
-    const double x = *(points++), y = *(points++);
-    *(proj++) = mat[2] * x + mat[3] * y + mat[0];
-    *(proj++) = -mat[3] * x + mat[2] * y + mat[1];
-    points += stride_points - 2;
-    proj += stride_proj - 2;
-  }
+static void rotzoom_to_affine(const double *mat, double *affine) {
+  affine[0] = mat[0];
+  affine[1] = mat[1];
+  affine[2] = mat[2];
+  affine[3] = mat[3];
+  affine[4] = -mat[3];
+  affine[5] = mat[2];
 }
 
-static void project_points_double_affine(double *mat, double *points,
-                                         double *proj, int n, int stride_points,
-                                         int stride_proj) {
-  int i;
-  for (i = 0; i < n; ++i) {
-    const double x = *(points++), y = *(points++);
-    *(proj++) = mat[2] * x + mat[3] * y + mat[0];
-    *(proj++) = mat[4] * x + mat[5] * y + mat[1];
-    points += stride_points - 2;
-    proj += stride_proj - 2;
+static void affine_to_affine(const double *mat, double *affine) {
+  memcpy(affine, mat, sizeof(*affine) * 6);
+}
+
+int av1_ransac_find_inliers_c(const double *mat, const double *points1,
+                              const double *points2, int npoints,
+                              int min_inliers, int *inlier_indices,
+                              double *inlier_distances) {
+  int num_inliers = 0;
+  for (int i = 0; i < npoints; ++i) {
+    if (num_inliers + npoints - i < min_inliers) break;
+    const double x = points1[2 * i], y = points1[2 * i + 1];
+    const double dx = mat[2] * x + mat[3] * y + mat[0] - points2[2 * i];
+    const double dy = mat[4] * x + mat[5] * y + mat[1] - points2[2 * i + 1];
+    const double distance = sqrt(dx * dx + dy * dy);
+
+    if (distance < RANSAC_INLIER_THRESHOLD) {
+      inlier_indices[num_inliers] = i;
+      inlier_distances[num_inliers++] = distance;
+    }
   }
+  return num_inliers;
 }
 
 static void normalize_homography(double *pts, int n, double *T) {
@@ -374,7 +379,7 @@ static int ransac(const int *matched_points, int npoints,
                   int num_desired_motions, int minpts,
                   IsDegenerateFunc is_degenerate,
                   FindTransformationFunc find_transformation,
-                  ProjectPointsDoubleFunc projectpoints) {
+                  ToAffineFunc to_affine) {
   int trial_count = 0;
   int i = 0;
   int ret_val = 0;
@@ -385,7 +390,7 @@ static int ransac(const int *matched_points, int npoints,
 
   double *points1, *points2;
   double *corners1, *corners2;
-  double *image1_coord;
+  double *inlier_distances;
 
   // Store information for the num_desired_motions best transformations found
   // and the worst motion among them, as well as the motion currently under
@@ -396,6 +401,7 @@ static int ransac(const int *matched_points, int npoints,
   // Store the parameters and the indices of the inlier points for the motion
   // currently under consideration.
   double params_this_motion[MAX_PARAMDIM];
+  double affine_this_motion[6];
 
   double *cnp1, *cnp2;
 
@@ -410,7 +416,8 @@ static int ransac(const int *matched_points, int npoints,
   points2 = (double *)aom_malloc(sizeof(*points2) * npoints * 2);
   corners1 = (double *)aom_malloc(sizeof(*corners1) * npoints * 2);
   corners2 = (double *)aom_malloc(sizeof(*corners2) * npoints * 2);
-  image1_coord = (double *)aom_malloc(sizeof(*image1_coord) * npoints * 2);
+  inlier_distances =
+      (double *)aom_malloc(sizeof(*inlier_distances) * npoints);
 
   motions =
       (RANSAC_MOTION *)aom_malloc(sizeof(RANSAC_MOTION) * num_desired_motions);
@@ -425,8 +432,8 @@ static int ransac(const int *matched_points, int npoints,
 
   worst_kept_motion = motions;
 
-  if (!(points1 && points2 && corners1 && corners2 && image1_coord && motions &&
-        current_motion.inlier_indices)) {
+  if (!(points1 && points2 && corners1 && corners2 && inlier_distances &&
+        motions && current_motion.inlier_indices)) {
     ret_val = 1;
     goto finish_ransac;
   }
@@ -471,18 +478,17 @@ static int ransac(const int *matched_points, int npoints,
       continue;
     }
 
-    projectpoints(params_this_motion, corners1, image1_coord, npoints, 2, 2);
-
-    for (i = 0; i < npoints; ++i) {
-      double dx = image1_coord[i * 2] - corners2[i * 2];
-      double dy = image1_coord[i * 2 + 1] - corners2[i * 2 + 1];
-      double distance = sqrt(dx * dx + dy * dy);
-
-      if (distance < INLIER_THRESHOLD) {
-        current_motion.inlier_indices[current_motion.num_inliers++] = i;
-        sum_distance += distance;
-        sum_distance_squared += distance * distance;
-      }
+    to_affine(params_this_motion, affine_this_motion);
+    // The motion is only kept if it has more than one inlier and at least as
+    // many as the worst kept motion.
+    current_motion.num_inliers = av1_ransac_find_inliers(
+        affine_this_motion, corners1, corners2, npoints,
+        AOMMAX(worst_kept_motion->num_inliers, 2),
+        current_motion.inlier_indices, inlier_distances);
+
+    for (i = 0; i < current_motion.num_inliers; ++i) {
+      sum_distance += inlier_distances[i];
+      sum_distance_squared += inlier_distances[i] * inlier_distances[i];
     }
 
     if (current_motion.num_inliers >= worst_kept_motion->num_inliers &&
@@ -539,7 +545,7 @@ finish_ransac:
   aom_free(points2);
   aom_free(corners1);
   aom_free(corners2);
-  aom_free(image1_coord);
+  aom_free(inlier_distances);
   aom_free(current_motion.inlier_indices);
   for (i = 0; i < num_desired_motions; ++i) {
     aom_free(motions[i].inlier_indices);
@@ -555,7 +561,7 @@ static int ransac_double_prec(const double *matched_points, int npoints,
                               int num_desired_motions, int minpts,
                               IsDegenerateFunc is_degenerate,
                               FindTransformationFunc find_transformation,
-                              ProjectPointsDoubleFunc projectpoints) {
+                              ToAffineFunc to_affine) {
   int trial_count = 0;
   int i = 0;
   int ret_val = 0;
@@ -566,7 +572,7 @@ static int ransac_double_prec(const double *matched_points, int npoints,
 
   double *points1, *points2;
   double *corners1, *corners2;
-  double *image1_coord;
+  double *inlier_distances;
 
   // Store information for the num_desired_motions best transformations found
   // and the worst motion among them, as well as the motion currently under
@@ -577,6 +583,7 @@ static int ransac_double_prec(const double *matched_points, int npoints,
   // Store the parameters and the indices of the inlier points for the motion
   // currently under consideration.
   double params_this_motion[MAX_PARAMDIM];
+  double affine_this_motion[6];
 
   double *cnp1, *cnp2;
 
@@ -591,7 +598,8 @@ static int ransac_double_prec(const double *matched_points, int npoints,
   points2 = (double *)aom_malloc(sizeof(*points2) * npoints * 2);
   corners1 = (double *)aom_malloc(sizeof(*corners1) * npoints * 2);
   corners2 = (double *)aom_malloc(sizeof(*corners2) * npoints * 2);
-  image1_coord = (double *)aom_malloc(sizeof(*image1_coord) * npoints * 2);
+  inlier_distances =
+      (double *)aom_malloc(sizeof(*inlier_distances) * npoints);
 
   motions =
       (RANSAC_MOTION *)aom_malloc(sizeof(RANSAC_MOTION) * num_desired_motions);
@@ -606,8 +614,8 @@ static int ransac_double_prec(const double *matched_points, int npoints,
 
   worst_kept_motion = motions;
 
-  if (!(points1 && points2 && corners1 && corners2 && image1_coord && motions &&
-        current_motion.inlier_indices)) {
+  if (!(points1 && points2 && corners1 && corners2 && inlier_distances &&
+        motions && current_motion.inlier_indices)) {
     ret_val = 1;
     goto finish_ransac;
   }
@@ -652,18 +660,17 @@ static int ransac_double_prec(const double *matched_points, int npoints,
       continue;
     }
 
-    projectpoints(params_this_motion, corners1, image1_coord, npoints, 2, 2);
-
-    for (i = 0; i < npoints; ++i) {
-      double dx = image1_coord[i * 2] - corners2[i * 2];
-      double dy = image1_coord[i * 2 + 1] - corners2[i * 2 + 1];
-      double distance = sqrt(dx * dx + dy * dy);
-
-      if (distance < INLIER_THRESHOLD) {
-        current_motion.inlier_indices[current_motion.num_inliers++] = i;
-        sum_distance += distance;
-        sum_distance_squared += distance * distance;
-      }
+    to_affine(params_this_motion, affine_this_motion);
+    // The motion is only kept if it has more than one inlier and at least as
+    // many as the worst kept motion.
+    current_motion.num_inliers = av1_ransac_find_inliers(
+        affine_this_motion, corners1, corners2, npoints,
+        AOMMAX(worst_kept_motion->num_inliers, 2),
+        current_motion.inlier_indices, inlier_distances);
+
+    for (i = 0; i < current_motion.num_inliers; ++i) {
+      sum_distance += inlier_distances[i];
+      sum_distance_squared += inlier_distances[i] * inlier_distances[i];
     }
 
     if (current_motion.num_inliers >= worst_kept_motion->num_inliers &&
@@ -718,7 +725,7 @@ finish_ransac:
   aom_free(points2);
   aom_free(corners1);
   aom_free(corners2);
-  aom_free(image1_coord);
+  aom_free(inlier_distances);
   aom_free(current_motion.inlier_indices);
   for (i = 0; i < num_desired_motions; ++i) {
     aom_free(motions[i].inlier_indices);
@@ -750,7 +757,7 @@ static int ransac_translation(int *matched_points, int npoints,
   return ransac(matched_points, npoints, num_inliers_by_motion,
                 params_by_motion, num_desired_motions, 3,
                 is_degenerate_translation, find_translation,
-                project_points_double_translation);
+                translation_to_affine);
 }
 
 static int ransac_rotzoom(int *matched_points, int npoints,
@@ -759,7 +766,7 @@ static int ransac_rotzoom(int *matched_points, int npoints,
                           int num_desired_motions) {
   return ransac(matched_points, npoints, num_inliers_by_motion,
                 params_by_motion, num_desired_motions, 3, is_degenerate_affine,
-                find_rotzoom, project_points_double_rotzoom);
+                find_rotzoom, rotzoom_to_affine);
 }
 
 static int ransac_affine(int *matched_points, int npoints,
@@ -768,7 +775,7 @@ static int ransac_affine(int *matched_points, int npoints,
                          int num_desired_motions) {
   return ransac(matched_points, npoints, num_inliers_by_motion,
                 params_by_motion, num_desired_motions, 3, is_degenerate_affine,
-                find_affine, project_points_double_affine);
+                find_affine, affine_to_affine);
 }
 
 RansacFunc av1_get_ransac_type(TransformationType type) {
@@ -787,7 +794,7 @@ static int ransac_translation_double_prec(double *matched_points, int npoints,
   return ransac_double_prec(matched_points, npoints, num_inliers_by_motion,
                             params_by_motion, num_desired_motions, 3,
                             is_degenerate_translation, find_translation,
-                            project_points_double_translation);
+                            translation_to_affine);
 }
 
 static int ransac_rotzoom_double_prec(double *matched_points, int npoints,
@@ -797,7 +804,7 @@ static int ransac_rotzoom_double_prec(double *matched_points, int npoints,
   return ransac_double_prec(matched_points, npoints, num_inliers_by_motion,
                             params_by_motion, num_desired_motions, 3,
                             is_degenerate_affine, find_rotzoom,
-                            project_points_double_rotzoom);
+                            rotzoom_to_affine);
 }
 
 static int ransac_affine_double_prec(double *matched_points, int npoints,
@@ -807,7 +814,7 @@ static int ransac_affine_double_prec(double *matched_points, int npoints,
   return ransac_double_prec(matched_points, npoints, num_inliers_by_motion,
                             params_by_motion, num_desired_motions, 3,
                             is_degenerate_affine, find_affine,
-                            project_points_double_affine);
+                            affine_to_affine);
 }
 
 RansacFuncDouble av1_get_ransac_double_prec_type(TransformationType type) {
@@ -20,6 +20,10 @@
 #include "av1/common/warped_motion.h"
 #include "av1/encoder/global_motion.h"
 
+// A match is an inlier of a motion if the distance between its first point
+// projected by the motion and its second point is below this threshold.
+#define RANSAC_INLIER_THRESHOLD 1.25
+
 typedef int (*RansacFunc)(int *matched_points, int npoints,
                           int *num_inliers_by_motion,
                           MotionModel *params_by_motion, int num_motions);
@@ -197,6 +197,48 @@ static AOM_INLINE int get_regulated_q_undershoot(AV1_COMP *const cpi,
   return q_regulated;
 }
 
+/*!\cond */
+// Outcome of one encoding of the frame in the recode loop.
+typedef struct {
+  // Q index of the encoding, or -1 if there was none.
+  int q;
+  // Projected frame size in bits.
+  int frame_size;
+  // Luma SSE of a forced key frame, or 0 if it was not measured.
+  int64_t kf_err;
+} RECODE_TRIAL;
+/*!\endcond */
+
+// Fits val = a * qstep^e through two encodings of the same frame at different
+// q indices and returns the q index predicted to bring val to target, or -1
+// if the two encodings do not give a usable model. rising tells whether val
+// is expected to grow with q (distortion) or to fall (frame size). Once the
+// two encodings bracket the target the caller's bisection takes over, as it
+// is guaranteed to converge.
+static AOM_INLINE int get_q_from_recode_trials(const AV1_COMP *const cpi,
+                                               int prev_q, int64_t prev_val,
+                                               int q, int64_t val,
+                                               int64_t target, int rising) {
+  const RATE_CONTROL *const rc = &cpi->rc;
+  const aom_bit_depth_t bit_depth = cpi->common.seq_params.bit_depth;
+  if (!cpi->sf.hl_sf.recode_q_from_trials || prev_q < 0 || prev_q == q ||
+      prev_val <= 0 || val <= 0 || prev_val == val || target <= 0 ||
+      (target >= AOMMIN(prev_val, val) && target <= AOMMAX(prev_val, val)))
+    return -1;
+
+  aom_clear_system_state();
+  const double prev_qstep = av1_convert_qindex_to_q(prev_q, bit_depth);
+  const double qstep = av1_convert_qindex_to_q(q, bit_depth);
+  const double e = log((double)val / prev_val) / log(qstep / prev_qstep);
+  // Outside of this range the difference between the two encodings is
+  // dominated by noise rather than by the change of q.
+  if ((e > 0) != rising || fabs(e) < 0.25 || fabs(e) > 4.0) return -1;
+
+  const double target_qstep = qstep * pow((double)target / val, 1.0 / e);
+  return av1_find_qindex(target_qstep, bit_depth, rc->best_quality,
+                         rc->worst_quality);
+}
+
 /*!\brief Called after encode_with_recode_loop() has just encoded a frame.
  * This function works out whether we undershot or overshot our bitrate
  *  target and adjusts q as appropriate. It also decides whether or not
@@ -217,16 +259,23 @@ static AOM_INLINE int get_regulated_q_undershoot(AV1_COMP *const cpi,
  *                                because the compression ration was less
  *                                than a given minimum threshold.
  * \param[in]     loop_count      Loop itterations so far.
+ * \param[in,out] last_trial      Outcome of the previous loop iteration,
+ *                                updated to the outcome of this one.
  *
  */
 static AOM_INLINE void recode_loop_update_q(
     AV1_COMP *const cpi, int *const loop, int *const q, int *const q_low,
     int *const q_high, const int top_index, const int bottom_index,
     int *const undershoot_seen, int *const overshoot_seen,
-    int *const low_cr_seen, const int loop_count) {
+    int *const low_cr_seen, const int loop_count,
+    RECODE_TRIAL *const last_trial) {
   AV1_COMMON *const cm = &cpi->common;
   RATE_CONTROL *const rc = &cpi->rc;
   const RateControlCfg *const rc_cfg = &cpi->oxcf.rc_cfg;
+  const RECODE_TRIAL prev_trial = *last_trial;
+  last_trial->q = *q;
+  last_trial->frame_size = rc->projected_frame_size;
+  last_trial->kf_err = 0;
   *loop = 0;
 
   // Special case for overlay frame.
@@ -268,6 +317,8 @@ static AOM_INLINE void recode_loop_update_q(
     int64_t kf_err;
     const int64_t high_err_target = cpi->ambient_err;
     const int64_t low_err_target = cpi->ambient_err >> 1;
+    // Aim model based q estimates at the middle of the accepted error range.
+    const int64_t mid_err_target = (high_err_target + low_err_target) >> 1;
 
 #if CONFIG_AV1_HIGHBITDEPTH
     if (cm->seq_params.use_highbitdepth) {
@@ -280,6 +331,7 @@ static AOM_INLINE void recode_loop_update_q(
 #endif
     // Prevent possible divide by zero error below for perfect KF
     kf_err += !kf_err;
+    last_trial->kf_err = kf_err;
 
     // The key frame is not good enough or we can afford
     // to make it better without undue risk of popping.
@@ -291,8 +343,30 @@ static AOM_INLINE void recode_loop_update_q(
       *q_high = AOMMAX(*q - 1, *q_low);
 
       // Adjust Q
-      *q = (int)((*q * high_err_target) / kf_err);
-      *q = AOMMIN(*q, (*q_high + *q_low) >> 1);
+      int q_from_trials;
+      if (kf_err > high_err_target) {
+        q_from_trials =
+            get_q_from_recode_trials(cpi, prev_trial.q, prev_trial.kf_err, *q,
+                                     kf_err, mid_err_target, 1);
+      } else {
+        // The frame undershoots: spend the bits, but do not lower q so far
+        // that the error drops below low_err_target.
+        const int q_for_size = get_q_from_recode_trials(
+            cpi, prev_trial.q, prev_trial.frame_size, *q,
+            rc->projected_frame_size, rc->this_frame_target, 0);
+        const int q_for_err =
+            get_q_from_recode_trials(cpi, prev_trial.q, prev_trial.kf_err, *q,
+                                     kf_err, low_err_target, 1);
+        q_from_trials = (q_for_size >= 0 && q_for_err >= 0)
+                            ? AOMMAX(q_for_size, q_for_err)
+                            : -1;
+      }
+      if (q_from_trials >= 0) {
+        *q = q_from_trials;
+      } else {
+        *q = (int)((*q * high_err_target) / kf_err);
+        *q = AOMMIN(*q, (*q_high + *q_low) >> 1);
+      }
     } else if (kf_err < low_err_target &&
                rc->projected_frame_size >= frame_under_shoot_limit) {
       // The key frame is much better than the previous frame
@@ -300,8 +374,15 @@ static AOM_INLINE void recode_loop_update_q(
       *q_low = AOMMIN(*q + 1, *q_high);
 
       // Adjust Q
-      *q = (int)((*q * low_err_target) / kf_err);
-      *q = AOMMIN(*q, (*q_high + *q_low + 1) >> 1);
+      const int q_from_trials =
+          get_q_from_recode_trials(cpi, prev_trial.q, prev_trial.kf_err, *q,
+                                   kf_err, mid_err_target, 1);
+      if (q_from_trials >= 0) {
+        *q = q_from_trials;
+      } else {
+        *q = (int)((*q * low_err_target) / kf_err);
+        *q = AOMMIN(*q, (*q_high + *q_low + 1) >> 1);
+      }
     }
 
     // Clamp Q to upper and lower limits:
@@ -317,6 +398,9 @@ static AOM_INLINE void recode_loop_update_q(
 
     // Frame size out of permitted range:
     // Update correction factor & compute new Q to try...
+    const int q_from_trials = get_q_from_recode_trials(
+        cpi, prev_trial.q, prev_trial.frame_size, *q,
+        rc->projected_frame_size, rc->this_frame_target, 0);
     // Frame is too large
     if (rc->projected_frame_size > rc->this_frame_target) {
       // Special case if the projected size is > the max allowed.
@@ -334,7 +418,10 @@ static AOM_INLINE void recode_loop_update_q(
       // Raise Qlow as to at least the current value
       *q_low = AOMMIN(*q + 1, *q_high);
 
-      if (*undershoot_seen || loop_count > 2 ||
+      if (q_from_trials >= 0) {
+        av1_rc_update_rate_correction_factors(cpi, cm->width, cm->height);
+        *q = q_from_trials;
+      } else if (*undershoot_seen || loop_count > 2 ||
           (loop_count == 2 && !frame_is_intra_only(cm))) {
         av1_rc_update_rate_correction_factors(cpi, cm->width, cm->height);
 
@@ -356,7 +443,10 @@ static AOM_INLINE void recode_loop_update_q(
       // Frame is too small
       *q_high = AOMMAX(*q - 1, *q_low);
 
-      if (*overshoot_seen || loop_count > 2 ||
+      if (q_from_trials >= 0) {
+        av1_rc_update_rate_correction_factors(cpi, cm->width, cm->height);
+        *q = q_from_trials;
+      } else if (*overshoot_seen || loop_count > 2 ||
           (loop_count == 2 && !frame_is_intra_only(cm))) {
         av1_rc_update_rate_correction_factors(cpi, cm->width, cm->height);
         *q = (*q_high + *q_low) / 2;
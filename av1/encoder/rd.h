@@ -315,22 +315,24 @@ static INLINE void reset_hash_records(TxfmSearchInfo *const txfm_info,
 
   // Reset the state for use_inter_txb_hash
   if (use_inter_txb_hash) {
+    TxbRdRecords *const records = txfm_info->txb_rd_records;
+    assert(records != NULL);
     for (record_idx = 0;
          record_idx < ((MAX_MIB_SIZE >> 1) * (MAX_MIB_SIZE >> 1)); record_idx++)
-      txfm_info->txb_rd_record_8X8[record_idx].num =
-          txfm_info->txb_rd_record_8X8[record_idx].index_start = 0;
+      records->txb_rd_record_8X8[record_idx].num =
+          records->txb_rd_record_8X8[record_idx].index_start = 0;
     for (record_idx = 0;
          record_idx < ((MAX_MIB_SIZE >> 2) * (MAX_MIB_SIZE >> 2)); record_idx++)
-      txfm_info->txb_rd_record_16X16[record_idx].num =
-          txfm_info->txb_rd_record_16X16[record_idx].index_start = 0;
+      records->txb_rd_record_16X16[record_idx].num =
+          records->txb_rd_record_16X16[record_idx].index_start = 0;
     for (record_idx = 0;
          record_idx < ((MAX_MIB_SIZE >> 3) * (MAX_MIB_SIZE >> 3)); record_idx++)
-      txfm_info->txb_rd_record_32X32[record_idx].num =
-          txfm_info->txb_rd_record_32X32[record_idx].index_start = 0;
+      records->txb_rd_record_32X32[record_idx].num =
+          records->txb_rd_record_32X32[record_idx].index_start = 0;
     for (record_idx = 0;
          record_idx < ((MAX_MIB_SIZE >> 4) * (MAX_MIB_SIZE >> 4)); record_idx++)
-      txfm_info->txb_rd_record_64X64[record_idx].num =
-          txfm_info->txb_rd_record_64X64[record_idx].index_start = 0;
+      records->txb_rd_record_64X64[record_idx].num =
+          records->txb_rd_record_64X64[record_idx].index_start = 0;
   }
 
   // Reset the state for use_intra_txb_hash
@@ -1044,6 +1044,7 @@ static AOM_INLINE void init_hl_sf(HIGH_LEVEL_SPEED_FEATURES *hl_sf) {
   hl_sf->recode_loop = ALLOW_RECODE;
   // Recode loop tolerance %.
   hl_sf->recode_tolerance = 25;
+  hl_sf->recode_q_from_trials = getenv("RQ") != NULL;
   hl_sf->high_precision_mv_usage = CURRENT_Q;
   hl_sf->superres_auto_search_type = SUPERRES_AUTO_ALL;
   hl_sf->disable_extra_sc_testing = 0;
@@ -306,6 +306,13 @@ typedef struct HIGH_LEVEL_SPEED_FEATURES {
    */
   int recode_tolerance;
 
+  /*!
+   * Pick the q of a recode iteration by interpolating the frame sizes
+   * measured in the previous two iterations, instead of from the rate
+   * correction factor and bisection. Needs fewer iterations to converge.
+   */
+  int recode_q_from_trials;
+
   /*!\cond */
   // Determine how motion vector precision is chosen. The possibilities are:
   // LAST_MV_DATA: use the mv data from the last coded frame
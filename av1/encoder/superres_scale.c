@@ -404,7 +404,12 @@ void av1_superres_post_encode(AV1_COMP *cpi) {
   assert(!is_lossless_requested(&cpi->oxcf.rc_cfg));
   assert(!cm->features.all_lossless);
 
-  av1_superres_upscale(cm, NULL);
+  if (cpi->mt_info.num_workers > 1) {
+    av1_superres_upscale_mt(cm, NULL, cpi->mt_info.workers,
+                            cpi->mt_info.num_workers);
+  } else {
+    av1_superres_upscale(cm, NULL);
+  }
 
   // If regular resizing is occurring the source will need to be downscaled to
   // match the upscaled superres resolution. Otherwise the original source is
@@ -752,7 +752,47 @@ int av1_get_q(const AV1_COMP *cpi) {
   return q;
 }
 
-void av1_tf_do_filtering_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
+void av1_tf_motion_search_mb(AV1_COMP *cpi, MACROBLOCK *mb, int mb_row,
+                             int mb_col, TemporalFilterMotion *motion) {
+  const TemporalFilterCtx *tf_ctx = &cpi->tf_ctx;
+  YV12_BUFFER_CONFIG *const *frames = tf_ctx->frames;
+  const int num_frames = tf_ctx->num_frames;
+  const int filter_frame_idx = tf_ctx->filter_frame_idx;
+  const BLOCK_SIZE block_size = TF_BLOCK_SIZE;
+  const YV12_BUFFER_CONFIG *const frame_to_filter = frames[filter_frame_idx];
+  const int mb_height = block_size_high[block_size];
+  const int mb_width = block_size_wide[block_size];
+  const int mi_h = mi_size_high_log2[block_size];
+  const int mi_w = mi_size_wide_log2[block_size];
+
+  av1_set_mv_row_limits(&cpi->common.mi_params, &mb->mv_limits,
+                        (mb_row << mi_h), (mb_height >> MI_SIZE_LOG2),
+                        cpi->oxcf.border_in_pixels);
+  av1_set_mv_col_limits(&cpi->common.mi_params, &mb->mv_limits,
+                        (mb_col << mi_w), (mb_width >> MI_SIZE_LOG2),
+                        cpi->oxcf.border_in_pixels);
+  MV ref_mv = kZeroMv;  // Reference motion vector passed down along frames.
+  for (int frame = 0; frame < num_frames; frame++) {
+    for (int i = 0; i < 4; ++i) {
+      motion[frame].subblock_mvs[i] = kZeroMv;
+      motion[frame].subblock_mses[i] = INT_MAX;
+    }
+    if (frames[frame] == NULL) continue;
+
+    if (frame == filter_frame_idx) {  // Frame to be filtered.
+      // Change ref_mv sign for following frames.
+      ref_mv.row *= -1;
+      ref_mv.col *= -1;
+    } else {  // Other reference frames.
+      tf_motion_search(cpi, mb, frame_to_filter, frames[frame], block_size,
+                       mb_row, mb_col, &ref_mv, motion[frame].subblock_mvs,
+                       motion[frame].subblock_mses);
+    }
+  }
+}
+
+void av1_tf_filter_mb(AV1_COMP *cpi, ThreadData *td, int mb_row, int mb_col,
+                      const TemporalFilterMotion *motion) {
   TemporalFilterCtx *tf_ctx = &cpi->tf_ctx;
   YV12_BUFFER_CONFIG **frames = tf_ctx->frames;
   const int num_frames = tf_ctx->num_frames;
@@ -769,8 +809,6 @@ void av1_tf_do_filtering_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
   TemporalFilterData *const tf_data = &td->tf_data;
   const int mb_height = block_size_high[block_size];
   const int mb_width = block_size_wide[block_size];
-  const int mi_h = mi_size_high_log2[block_size];
-  const int mi_w = mi_size_wide_log2[block_size];
   const int num_planes = av1_num_planes(&cpi->common);
   uint32_t *accum = tf_data->accum;
   uint16_t *count = tf_data->count;
@@ -781,98 +819,87 @@ void av1_tf_do_filtering_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
 
   // Do filtering.
   FRAME_DIFF *diff = &td->tf_data.diff;
-  av1_set_mv_row_limits(&cpi->common.mi_params, &mb->mv_limits,
-                        (mb_row << mi_h), (mb_height >> MI_SIZE_LOG2),
-                        cpi->oxcf.border_in_pixels);
-  for (int mb_col = 0; mb_col < tf_ctx->mb_cols; mb_col++) {
-    av1_set_mv_col_limits(&cpi->common.mi_params, &mb->mv_limits,
-                          (mb_col << mi_w), (mb_width >> MI_SIZE_LOG2),
-                          cpi->oxcf.border_in_pixels);
-    memset(accum, 0, num_pels * sizeof(accum[0]));
-    memset(count, 0, num_pels * sizeof(count[0]));
-    MV ref_mv = kZeroMv;  // Reference motion vector passed down along frames.
-                          // Perform temporal filtering frame by frame.
-    for (int frame = 0; frame < num_frames; frame++) {
-      if (frames[frame] == NULL) continue;
-
-      // Motion search.
-      MV subblock_mvs[4] = { kZeroMv, kZeroMv, kZeroMv, kZeroMv };
-      int subblock_mses[4] = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
-      if (frame ==
-          filter_frame_idx) {  // Frame to be filtered.
-                               // Change ref_mv sign for following frames.
-        ref_mv.row *= -1;
-        ref_mv.col *= -1;
-      } else {  // Other reference frames.
-        tf_motion_search(cpi, mb, frame_to_filter, frames[frame], block_size,
-                         mb_row, mb_col, &ref_mv, subblock_mvs, subblock_mses);
-      }
-
-      // Perform weighted averaging.
-      if (frame == filter_frame_idx) {  // Frame to be filtered.
-        tf_apply_temporal_filter_self(frames[frame], mbd, block_size, mb_row,
-                                      mb_col, num_planes, accum, count);
-      } else {  // Other reference frames.
-        tf_build_predictor(frames[frame], mbd, block_size, mb_row, mb_col,
-                           num_planes, scale, subblock_mvs, pred);
-
-        // All variants of av1_apply_temporal_filter() contain floating point
-        // operations. Hence, clear the system state.
-        aom_clear_system_state();
-
-        // TODO(any): avx2/sse2 version should be changed to align with C
-        // function before using. In particular, current avx2/sse2 function
-        // only supports 32x32 block size and 5x5 filtering window.
-        if (is_frame_high_bitdepth(frame_to_filter)) {  // for high bit-depth
+  memset(accum, 0, num_pels * sizeof(accum[0]));
+  memset(count, 0, num_pels * sizeof(count[0]));
+  // Perform temporal filtering frame by frame.
+  for (int frame = 0; frame < num_frames; frame++) {
+    if (frames[frame] == NULL) continue;
+
+    const MV *const subblock_mvs = motion[frame].subblock_mvs;
+    const int *const subblock_mses = motion[frame].subblock_mses;
+
+    // Perform weighted averaging.
+    if (frame == filter_frame_idx) {  // Frame to be filtered.
+      tf_apply_temporal_filter_self(frames[frame], mbd, block_size, mb_row,
+                                    mb_col, num_planes, accum, count);
+    } else {  // Other reference frames.
+      tf_build_predictor(frames[frame], mbd, block_size, mb_row, mb_col,
+                         num_planes, scale, subblock_mvs, pred);
+
+      // All variants of av1_apply_temporal_filter() contain floating point
+      // operations. Hence, clear the system state.
+      aom_clear_system_state();
+
+      // TODO(any): avx2/sse2 version should be changed to align with C
+      // function before using. In particular, current avx2/sse2 function
+      // only supports 32x32 block size and 5x5 filtering window.
+      if (is_frame_high_bitdepth(frame_to_filter)) {  // for high bit-depth
 #if CONFIG_AV1_HIGHBITDEPTH
-          if (TF_BLOCK_SIZE == BLOCK_32X32 && TF_WINDOW_LENGTH == 5) {
-            av1_highbd_apply_temporal_filter(
-                frame_to_filter, mbd, block_size, mb_row, mb_col, num_planes,
-                noise_levels, subblock_mvs, subblock_mses, q_factor,
-                filter_strength, pred, accum, count);
-          } else {
+        if (TF_BLOCK_SIZE == BLOCK_32X32 && TF_WINDOW_LENGTH == 5) {
+          av1_highbd_apply_temporal_filter(
+              frame_to_filter, mbd, block_size, mb_row, mb_col, num_planes,
+              noise_levels, subblock_mvs, subblock_mses, q_factor,
+              filter_strength, pred, accum, count);
+        } else {
 #endif  // CONFIG_AV1_HIGHBITDEPTH
-            av1_apply_temporal_filter_c(
-                frame_to_filter, mbd, block_size, mb_row, mb_col, num_planes,
-                noise_levels, subblock_mvs, subblock_mses, q_factor,
-                filter_strength, pred, accum, count);
+          av1_apply_temporal_filter_c(
+              frame_to_filter, mbd, block_size, mb_row, mb_col, num_planes,
+              noise_levels, subblock_mvs, subblock_mses, q_factor,
+              filter_strength, pred, accum, count);
 #if CONFIG_AV1_HIGHBITDEPTH
-          }
-#endif            // CONFIG_AV1_HIGHBITDEPTH
-        } else {  // for 8-bit
-          if (TF_BLOCK_SIZE == BLOCK_32X32 && TF_WINDOW_LENGTH == 5) {
-            av1_apply_temporal_filter(frame_to_filter, mbd, block_size, mb_row,
-                                      mb_col, num_planes, noise_levels,
-                                      subblock_mvs, subblock_mses, q_factor,
-                                      filter_strength, pred, accum, count);
-          } else {
-            av1_apply_temporal_filter_c(
-                frame_to_filter, mbd, block_size, mb_row, mb_col, num_planes,
-                noise_levels, subblock_mvs, subblock_mses, q_factor,
-                filter_strength, pred, accum, count);
-          }
+        }
+#endif          // CONFIG_AV1_HIGHBITDEPTH
+      } else {  // for 8-bit
+        if (TF_BLOCK_SIZE == BLOCK_32X32 && TF_WINDOW_LENGTH == 5) {
+          av1_apply_temporal_filter(frame_to_filter, mbd, block_size, mb_row,
+                                    mb_col, num_planes, noise_levels,
+                                    subblock_mvs, subblock_mses, q_factor,
+                                    filter_strength, pred, accum, count);
+        } else {
+          av1_apply_temporal_filter_c(
+              frame_to_filter, mbd, block_size, mb_row, mb_col, num_planes,
+              noise_levels, subblock_mvs, subblock_mses, q_factor,
+              filter_strength, pred, accum, count);
         }
       }
     }
-    tf_normalize_filtered_frame(mbd, block_size, mb_row, mb_col, num_planes,
-                                accum, count, &cpi->alt_ref_buffer);
-
-    if (check_show_existing) {
-      const int y_height = mb_height >> mbd->plane[0].subsampling_y;
-      const int y_width = mb_width >> mbd->plane[0].subsampling_x;
-      const int source_y_stride = frame_to_filter->y_stride;
-      const int filter_y_stride = cpi->alt_ref_buffer.y_stride;
-      const int source_offset =
-          mb_row * y_height * source_y_stride + mb_col * y_width;
-      const int filter_offset =
-          mb_row * y_height * filter_y_stride + mb_col * y_width;
-      unsigned int sse = 0;
-      cpi->fn_ptr[block_size].vf(
-          frame_to_filter->y_buffer + source_offset, source_y_stride,
-          cpi->alt_ref_buffer.y_buffer + filter_offset, filter_y_stride, &sse);
-      diff->sum += sse;
-      diff->sse += sse * sse;
-    }
+  }
+  tf_normalize_filtered_frame(mbd, block_size, mb_row, mb_col, num_planes,
+                              accum, count, &cpi->alt_ref_buffer);
+
+  if (check_show_existing) {
+    const int y_height = mb_height >> mbd->plane[0].subsampling_y;
+    const int y_width = mb_width >> mbd->plane[0].subsampling_x;
+    const int source_y_stride = frame_to_filter->y_stride;
+    const int filter_y_stride = cpi->alt_ref_buffer.y_stride;
+    const int source_offset =
+        mb_row * y_height * source_y_stride + mb_col * y_width;
+    const int filter_offset =
+        mb_row * y_height * filter_y_stride + mb_col * y_width;
+    unsigned int sse = 0;
+    cpi->fn_ptr[block_size].vf(
+        frame_to_filter->y_buffer + source_offset, source_y_stride,
+        cpi->alt_ref_buffer.y_buffer + filter_offset, filter_y_stride, &sse);
+    diff->sum += sse;
+    diff->sse += sse * sse;
+  }
+}
+
+void av1_tf_do_filtering_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
+  TemporalFilterMotion motion[MAX_LAG_BUFFERS];
+  for (int mb_col = 0; mb_col < cpi->tf_ctx.mb_cols; mb_col++) {
+    av1_tf_motion_search_mb(cpi, &td->mb, mb_row, mb_col, motion);
+    av1_tf_filter_mb(cpi, td, mb_row, mb_col, motion);
   }
 }
 
@@ -143,14 +143,33 @@ typedef struct {
   uint8_t *pred;
 } TemporalFilterData;
 
+// Motion search results of a temporal filtering block w.r.t. one frame.
+typedef struct {
+  // Motion vectors for the 4 sub-blocks.
+  MV subblock_mvs[4];
+  // Search errors (MSE) for the 4 sub-blocks.
+  int subblock_mses[4];
+} TemporalFilterMotion;
+
 // Data related to temporal filter multi-thread synchronization.
+// The motion search and the filtering of each block are separate jobs, so the
+// filtering of the blocks already searched overlaps with the motion search of
+// the others.
 typedef struct {
 #if CONFIG_MULTITHREAD
   // Mutex lock used for dispatching jobs.
   pthread_mutex_t *mutex_;
 #endif  // CONFIG_MULTITHREAD
-  // Next temporal filter block row to be filtered.
-  int next_tf_row;
+  // Motion search results of all the blocks, num_frames entries per block.
+  TemporalFilterMotion *motion;
+  // Blocks whose motion search is done, in the order they were finished.
+  int *searched_mbs;
+  // Number of entries in searched_mbs.
+  int num_searched_mbs;
+  // Next block to run the motion search on.
+  int next_search_mb;
+  // Index in searched_mbs of the next block to be filtered.
+  int next_filter_mb;
 } AV1TemporalFilterSync;
 
 // Estimates noise level from a given frame using a single plane (Y, U, or V).
@@ -174,6 +193,38 @@ double av1_estimate_noise_from_single_plane(const YV12_BUFFER_CONFIG *frame,
 
 /*!\endcond */
 
+/*!\brief Does motion search for a given block w.r.t. all the frames used to
+ * filter it. This is the first step of temporal filtering.
+ *
+ * \ingroup src_frame_proc
+ * \param[in]   cpi                   Top level encoder instance structure
+ * \param[in]   mb                    Pointer to macroblock
+ * \param[in]   mb_row                Row index of the block in the frame
+ * \param[in]   mb_col                Column index of the block in the frame
+ * \param[out]  motion                Search results, one per frame in
+ *                                    cpi->tf_ctx.frames
+ *
+ * \return Nothing will be returned. Results are saved in motion.
+ */
+void av1_tf_motion_search_mb(struct AV1_COMP *cpi, MACROBLOCK *mb, int mb_row,
+                             int mb_col, TemporalFilterMotion *motion);
+
+/*!\brief Filters a given block with the results of av1_tf_motion_search_mb().
+ *
+ * \ingroup src_frame_proc
+ * \param[in]   cpi                   Top level encoder instance structure
+ * \param[in]   td                    Pointer to thread data
+ * \param[in]   mb_row                Row index of the block in the frame
+ * \param[in]   mb_col                Column index of the block in the frame
+ * \param[in]   motion                Search results, one per frame in
+ *                                    cpi->tf_ctx.frames
+ *
+ * \return Nothing will be returned, but the filtered block is written to
+ *         cpi->alt_ref_buffer and the contents of td->diff will be modified.
+ */
+void av1_tf_filter_mb(struct AV1_COMP *cpi, struct ThreadData *td, int mb_row,
+                      int mb_col, const TemporalFilterMotion *motion);
+
 /*!\brief Does temporal filter for a given macroblock row.
 *
 * \ingroup src_frame_proc
@@ -12,6 +12,8 @@
 #ifndef AOM_AV1_ENCODER_TPL_MODEL_H_
 #define AOM_AV1_ENCODER_TPL_MODEL_H_
 
+#include "aom_util/aom_row_progress.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -38,15 +40,10 @@ static INLINE BLOCK_SIZE convert_length_to_bsize(int length) {
 }
 
 typedef struct AV1TplRowMultiThreadSync {
-#if CONFIG_MULTITHREAD
-  // Synchronization objects for top-right dependency.
-  pthread_mutex_t *mutex_;
-  pthread_cond_t *cond_;
-#endif
-  // Buffer to store the macroblock whose encoding is complete.
+  // Progress counters for the top-right dependency.
   // num_finished_cols[i] stores the number of macroblocks which finished
   // encoding in the ith macroblock row.
-  int *num_finished_cols;
+  AVxRowProgress *num_finished_cols;
   // Number of extra macroblocks of the top row to be complete for encoding
   // of the current macroblock to start. A value of 1 indicates top-right
   // dependency.
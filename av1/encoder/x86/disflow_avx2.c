@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "av1/encoder/global_motion.h"
+
+#if DISFLOW_PATCH_SIZE != 8
+#error "Need to change disflow_avx2.c if DISFLOW_PATCH_SIZE != 8"
+#endif
+
+// Rounding of the vertical pass of the bicubic interpolation. Its output keeps
+// 6 fractional bits so that it fits in 16 bits.
+#define VERT_BITS (DISFLOW_INTERP_BITS - 6)
+#define HORIZ_BITS (DISFLOW_INTERP_BITS + 6)
+
+static INLINE __m256i pack_taps(int16_t a, int16_t b) {
+  return _mm256_set1_epi32((int)((uint16_t)a | ((uint32_t)(uint16_t)b << 16)));
+}
+
+// Loads 16 pixels of row i in the low lane and of row i + 1 in the high lane.
+static INLINE __m256i load_2_rows(const uint8_t *src, int stride) {
+  return _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)),
+      _mm_loadu_si128((const __m128i *)(src + stride)), 1);
+}
+
+// Interpolates 8 pixels in each of 2 rows. Each 128-bit lane is processed like
+// in av1_compute_warp_and_error_sse4_1(): the vertical pass filters the 12
+// columns needed by the horizontal pass.
+static INLINE __m256i warp_2_rows(const uint8_t *src, int stride,
+                                  __m256i kx01, __m256i kx23, __m256i ky01,
+                                  __m256i ky23) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i r0 = load_2_rows(src, stride);
+  const __m256i r1 = load_2_rows(src + stride, stride);
+  const __m256i r2 = load_2_rows(src + 2 * stride, stride);
+  const __m256i r3 = load_2_rows(src + 3 * stride, stride);
+  const __m256i r01_lo = _mm256_unpacklo_epi8(r0, r1);
+  const __m256i r01_hi = _mm256_unpackhi_epi8(r0, r1);
+  const __m256i r23_lo = _mm256_unpacklo_epi8(r2, r3);
+  const __m256i r23_hi = _mm256_unpackhi_epi8(r2, r3);
+
+  const __m256i vert_round = _mm256_set1_epi32(1 << (VERT_BITS - 1));
+  __m256i sum[3];
+  sum[0] = _mm256_add_epi32(
+      _mm256_madd_epi16(_mm256_unpacklo_epi8(r01_lo, zero), ky01),
+      _mm256_madd_epi16(_mm256_unpacklo_epi8(r23_lo, zero), ky23));
+  sum[1] = _mm256_add_epi32(
+      _mm256_madd_epi16(_mm256_unpackhi_epi8(r01_lo, zero), ky01),
+      _mm256_madd_epi16(_mm256_unpackhi_epi8(r23_lo, zero), ky23));
+  sum[2] = _mm256_add_epi32(
+      _mm256_madd_epi16(_mm256_unpacklo_epi8(r01_hi, zero), ky01),
+      _mm256_madd_epi16(_mm256_unpacklo_epi8(r23_hi, zero), ky23));
+  for (int k = 0; k < 3; ++k) {
+    sum[k] =
+        _mm256_srai_epi32(_mm256_add_epi32(sum[k], vert_round), VERT_BITS);
+  }
+  const __m256i lo = _mm256_packs_epi32(sum[0], sum[1]);
+  const __m256i hi = _mm256_packs_epi32(sum[2], sum[2]);
+
+  const __m256i horiz_round = _mm256_set1_epi32(1 << (HORIZ_BITS - 1));
+  const __m256i v1 = _mm256_alignr_epi8(hi, lo, 2);
+  const __m256i v2 = _mm256_alignr_epi8(hi, lo, 4);
+  const __m256i v3 = _mm256_alignr_epi8(hi, lo, 6);
+  __m256i res_lo =
+      _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(lo, v1), kx01),
+                       _mm256_madd_epi16(_mm256_unpacklo_epi16(v2, v3), kx23));
+  __m256i res_hi =
+      _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(lo, v1), kx01),
+                       _mm256_madd_epi16(_mm256_unpackhi_epi16(v2, v3), kx23));
+  res_lo = _mm256_srai_epi32(_mm256_add_epi32(res_lo, horiz_round), HORIZ_BITS);
+  res_hi = _mm256_srai_epi32(_mm256_add_epi32(res_hi, horiz_round), HORIZ_BITS);
+  const __m256i res = _mm256_packs_epi32(res_lo, res_hi);
+  // Clamp to [0, 255].
+  return _mm256_min_epi16(_mm256_max_epi16(res, zero), _mm256_set1_epi16(255));
+}
+
+double av1_compute_warp_and_error_avx2(const uint8_t *ref, const uint8_t *frm,
+                                       int width, int height, int stride, int x,
+                                       int y, double u, double v, int16_t *dt) {
+  const double x_w = x + u;
+  const double y_w = y + v;
+  // The whole patch must be interpolated with the bicubic filter, see
+  // interpolate() in global_motion.c.
+  if (!(x_w > 1 && y_w > 1 && x_w + DISFLOW_PATCH_SIZE - 1 < width - 2 &&
+        y_w + DISFLOW_PATCH_SIZE - 1 < height - 2)) {
+    return av1_compute_warp_and_error_c(ref, frm, width, height, stride, x, y,
+                                        u, v, dt);
+  }
+  const int x0 = (int)x_w;
+  const int y0 = (int)y_w;
+  int16_t kx[4], ky[4];
+  av1_get_disflow_cubic_filter(x_w - x0, kx);
+  av1_get_disflow_cubic_filter(y_w - y0, ky);
+  const __m256i kx01 = pack_taps(kx[0], kx[1]);
+  const __m256i kx23 = pack_taps(kx[2], kx[3]);
+  const __m256i ky01 = pack_taps(ky[0], ky[1]);
+  const __m256i ky23 = pack_taps(ky[2], ky[3]);
+
+  const uint8_t *src = ref + (y0 - 1) * stride + (x0 - 1);
+  frm += y * stride + x;
+  __m256i sse = _mm256_setzero_si256();
+  for (int i = 0; i < DISFLOW_PATCH_SIZE; i += 2) {
+    const __m256i warped =
+        warp_2_rows(src + i * stride, stride, kx01, kx23, ky01, ky23);
+    const __m128i f = _mm_unpacklo_epi64(
+        _mm_loadl_epi64((const __m128i *)(frm + i * stride)),
+        _mm_loadl_epi64((const __m128i *)(frm + (i + 1) * stride)));
+    const __m256i err = _mm256_sub_epi16(warped, _mm256_cvtepu8_epi16(f));
+    _mm256_storeu_si256((__m256i *)(dt + i * DISFLOW_PATCH_SIZE), err);
+    sse = _mm256_add_epi32(sse, _mm256_madd_epi16(err, err));
+  }
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sse),
+                              _mm256_extracti128_si256(sse, 1));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+  return (double)_mm_cvtsi128_si32(sum) /
+         (DISFLOW_PATCH_SIZE * DISFLOW_PATCH_SIZE);
+}
+
+// The gradients and errors are integers, so the sums are exact whatever the
+// order of the additions, and match av1_compute_flow_system_c().
+void av1_compute_flow_system_avx2(const double *dx, int dx_stride,
+                                  const double *dy, int dy_stride,
+                                  const int16_t *dt, int dt_stride, double *M,
+                                  double *b) {
+  __m256d dxdx = _mm256_setzero_pd();
+  __m256d dxdy = _mm256_setzero_pd();
+  __m256d dydy = _mm256_setzero_pd();
+  __m256d dxdt = _mm256_setzero_pd();
+  __m256d dydt = _mm256_setzero_pd();
+  for (int i = 0; i < DISFLOW_PATCH_SIZE; i++) {
+    const __m128i t16 = _mm_loadu_si128((const __m128i *)(dt + i * dt_stride));
+    const __m256d t[2] = {
+      _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(t16)),
+      _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_srli_si128(t16, 8)))
+    };
+    for (int j = 0; j < 2; j++) {
+      const __m256d x = _mm256_loadu_pd(dx + i * dx_stride + 4 * j);
+      const __m256d y = _mm256_loadu_pd(dy + i * dy_stride + 4 * j);
+      dxdx = _mm256_add_pd(dxdx, _mm256_mul_pd(x, x));
+      dxdy = _mm256_add_pd(dxdy, _mm256_mul_pd(x, y));
+      dydy = _mm256_add_pd(dydy, _mm256_mul_pd(y, y));
+      dxdt = _mm256_add_pd(dxdt, _mm256_mul_pd(x, t[j]));
+      dydt = _mm256_add_pd(dydt, _mm256_mul_pd(y, t[j]));
+    }
+  }
+  // hadd gives { dxdx[0] + dxdx[1], dxdy[0] + dxdy[1], dxdx[2] + dxdx[3],
+  // dxdy[2] + dxdy[3] }, and the two lanes are then added.
+  const __m256d m01 = _mm256_hadd_pd(dxdx, dxdy);
+  const __m256d m33 = _mm256_hadd_pd(dydy, dydy);
+  const __m256d b01 = _mm256_hadd_pd(dxdt, dydt);
+  const __m128d m01_sum = _mm_add_pd(_mm256_castpd256_pd128(m01),
+                                     _mm256_extractf128_pd(m01, 1));
+  const __m128d m33_sum = _mm_add_pd(_mm256_castpd256_pd128(m33),
+                                     _mm256_extractf128_pd(m33, 1));
+  const __m128d b01_sum = _mm_add_pd(_mm256_castpd256_pd128(b01),
+                                     _mm256_extractf128_pd(b01, 1));
+  _mm_storeu_pd(M, _mm_add_pd(_mm_loadu_pd(M), m01_sum));
+  M[3] += _mm_cvtsd_f64(m33_sum);
+  _mm_storeu_pd(b, _mm_add_pd(_mm_loadu_pd(b), b01_sum));
+  M[2] = M[1];
+}
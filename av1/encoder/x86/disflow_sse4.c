@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "av1/encoder/global_motion.h"
+
+#if DISFLOW_PATCH_SIZE != 8
+#error "Need to change disflow_sse4.c if DISFLOW_PATCH_SIZE != 8"
+#endif
+
+// Rounding of the vertical pass of the bicubic interpolation. Its output keeps
+// 6 fractional bits so that it fits in 16 bits.
+#define VERT_BITS (DISFLOW_INTERP_BITS - 6)
+#define HORIZ_BITS (DISFLOW_INTERP_BITS + 6)
+
+static INLINE __m128i pack_taps(int16_t a, int16_t b) {
+  return _mm_set1_epi32((int)((uint16_t)a | ((uint32_t)(uint16_t)b << 16)));
+}
+
+static INLINE __m128i load_8_pixels(const uint8_t *src) {
+  return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)src));
+}
+
+// Computes 8 sobel filter outputs of a row from the 8-bit pixels at
+// src[-1..8]. With dir == 1, the filter is [1 0 -1], otherwise it is [1 2 1].
+static INLINE __m128i sobel_row(const uint8_t *src, int dir) {
+  const __m128i l = load_8_pixels(src - 1);
+  const __m128i c = load_8_pixels(src);
+  const __m128i r = load_8_pixels(src + 1);
+  if (dir) return _mm_sub_epi16(l, r);
+  return _mm_add_epi16(_mm_add_epi16(l, r), _mm_add_epi16(c, c));
+}
+
+static INLINE void store_row_double(double *dst, __m128i row, __m128d norm) {
+  const __m128i lo = _mm_cvtepi16_epi32(row);
+  const __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(row, 8));
+  _mm_storeu_pd(dst, _mm_mul_pd(_mm_cvtepi32_pd(lo), norm));
+  _mm_storeu_pd(dst + 2,
+                _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(lo, 8)), norm));
+  _mm_storeu_pd(dst + 4, _mm_mul_pd(_mm_cvtepi32_pd(hi), norm));
+  _mm_storeu_pd(dst + 6,
+                _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(hi, 8)), norm));
+}
+
+void av1_convolve_2d_sobel_y_sse4_1(const uint8_t *src, int src_stride,
+                                    double *dst, int dst_stride, int w, int h,
+                                    int dir, double norm) {
+  if (w & 7) {
+    av1_convolve_2d_sobel_y_c(src, src_stride, dst, dst_stride, w, h, dir,
+                              norm);
+    return;
+  }
+  const __m128d norm_vec = _mm_set1_pd(norm);
+  for (int j = 0; j < w; j += 8) {
+    const uint8_t *s = src + j;
+    __m128i above = sobel_row(s - src_stride, dir);
+    __m128i cur = sobel_row(s, dir);
+    for (int i = 0; i < h; ++i) {
+      const __m128i below = sobel_row(s + (i + 1) * src_stride, dir);
+      // The vertical filter is [1 2 1] for the x gradient and [1 0 -1] for
+      // the y gradient.
+      const __m128i res =
+          dir ? _mm_add_epi16(_mm_add_epi16(above, below),
+                              _mm_add_epi16(cur, cur))
+              : _mm_sub_epi16(above, below);
+      store_row_double(dst + i * dst_stride + j, res, norm_vec);
+      above = cur;
+      cur = below;
+    }
+  }
+}
+
+// Applies the vertical pass of the bicubic filter to 16 columns starting at
+// src, and returns the result of the first 12 columns in lo (columns 0-7) and
+// hi (columns 8-11).
+static INLINE void vert_filter_row(const uint8_t *src, int stride,
+                                   __m128i ky01, __m128i ky23, __m128i *lo,
+                                   __m128i *hi) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (VERT_BITS - 1));
+  const __m128i r0 = _mm_loadu_si128((const __m128i *)src);
+  const __m128i r1 = _mm_loadu_si128((const __m128i *)(src + stride));
+  const __m128i r2 = _mm_loadu_si128((const __m128i *)(src + 2 * stride));
+  const __m128i r3 = _mm_loadu_si128((const __m128i *)(src + 3 * stride));
+  const __m128i r01_lo = _mm_unpacklo_epi8(r0, r1);
+  const __m128i r01_hi = _mm_unpackhi_epi8(r0, r1);
+  const __m128i r23_lo = _mm_unpacklo_epi8(r2, r3);
+  const __m128i r23_hi = _mm_unpackhi_epi8(r2, r3);
+
+  __m128i sum[3];
+  sum[0] = _mm_add_epi32(
+      _mm_madd_epi16(_mm_unpacklo_epi8(r01_lo, zero), ky01),
+      _mm_madd_epi16(_mm_unpacklo_epi8(r23_lo, zero), ky23));
+  sum[1] = _mm_add_epi32(
+      _mm_madd_epi16(_mm_unpackhi_epi8(r01_lo, zero), ky01),
+      _mm_madd_epi16(_mm_unpackhi_epi8(r23_lo, zero), ky23));
+  sum[2] = _mm_add_epi32(
+      _mm_madd_epi16(_mm_unpacklo_epi8(r01_hi, zero), ky01),
+      _mm_madd_epi16(_mm_unpacklo_epi8(r23_hi, zero), ky23));
+  for (int k = 0; k < 3; ++k)
+    sum[k] = _mm_srai_epi32(_mm_add_epi32(sum[k], round), VERT_BITS);
+  *lo = _mm_packs_epi32(sum[0], sum[1]);
+  *hi = _mm_packs_epi32(sum[2], sum[2]);
+}
+
+// Applies the horizontal pass of the bicubic filter to the output of
+// vert_filter_row(), and returns the 8 interpolated pixels.
+static INLINE __m128i horiz_filter_row(__m128i lo, __m128i hi, __m128i kx01,
+                                       __m128i kx23) {
+  const __m128i round = _mm_set1_epi32(1 << (HORIZ_BITS - 1));
+  const __m128i v1 = _mm_alignr_epi8(hi, lo, 2);
+  const __m128i v2 = _mm_alignr_epi8(hi, lo, 4);
+  const __m128i v3 = _mm_alignr_epi8(hi, lo, 6);
+  __m128i res_lo =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(lo, v1), kx01),
+                    _mm_madd_epi16(_mm_unpacklo_epi16(v2, v3), kx23));
+  __m128i res_hi =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(lo, v1), kx01),
+                    _mm_madd_epi16(_mm_unpackhi_epi16(v2, v3), kx23));
+  res_lo = _mm_srai_epi32(_mm_add_epi32(res_lo, round), HORIZ_BITS);
+  res_hi = _mm_srai_epi32(_mm_add_epi32(res_hi, round), HORIZ_BITS);
+  const __m128i res = _mm_packs_epi32(res_lo, res_hi);
+  // Clamp to [0, 255].
+  return _mm_cvtepu8_epi16(_mm_packus_epi16(res, res));
+}
+
+double av1_compute_warp_and_error_sse4_1(const uint8_t *ref,
+                                         const uint8_t *frm, int width,
+                                         int height, int stride, int x, int y,
+                                         double u, double v, int16_t *dt) {
+  const double x_w = x + u;
+  const double y_w = y + v;
+  // The whole patch must be interpolated with the bicubic filter, see
+  // interpolate() in global_motion.c.
+  if (!(x_w > 1 && y_w > 1 && x_w + DISFLOW_PATCH_SIZE - 1 < width - 2 &&
+        y_w + DISFLOW_PATCH_SIZE - 1 < height - 2)) {
+    return av1_compute_warp_and_error_c(ref, frm, width, height, stride, x, y,
+                                        u, v, dt);
+  }
+  const int x0 = (int)x_w;
+  const int y0 = (int)y_w;
+  int16_t kx[4], ky[4];
+  av1_get_disflow_cubic_filter(x_w - x0, kx);
+  av1_get_disflow_cubic_filter(y_w - y0, ky);
+  const __m128i kx01 = pack_taps(kx[0], kx[1]);
+  const __m128i kx23 = pack_taps(kx[2], kx[3]);
+  const __m128i ky01 = pack_taps(ky[0], ky[1]);
+  const __m128i ky23 = pack_taps(ky[2], ky[3]);
+
+  const uint8_t *src = ref + (y0 - 1) * stride + (x0 - 1);
+  frm += y * stride + x;
+  __m128i sse = _mm_setzero_si128();
+  for (int i = 0; i < DISFLOW_PATCH_SIZE; ++i) {
+    __m128i lo, hi;
+    vert_filter_row(src + i * stride, stride, ky01, ky23, &lo, &hi);
+    const __m128i warped = horiz_filter_row(lo, hi, kx01, kx23);
+    const __m128i err = _mm_sub_epi16(warped, load_8_pixels(frm + i * stride));
+    _mm_storeu_si128((__m128i *)(dt + i * DISFLOW_PATCH_SIZE), err);
+    sse = _mm_add_epi32(sse, _mm_madd_epi16(err, err));
+  }
+  sse = _mm_add_epi32(sse, _mm_srli_si128(sse, 8));
+  sse = _mm_add_epi32(sse, _mm_srli_si128(sse, 4));
+  return (double)_mm_cvtsi128_si32(sse) /
+         (DISFLOW_PATCH_SIZE * DISFLOW_PATCH_SIZE);
+}
+
+// The gradients and errors are integers, so the sums are exact whatever the
+// order of the additions, and match av1_compute_flow_system_c().
+void av1_compute_flow_system_sse4_1(const double *dx, int dx_stride,
+                                    const double *dy, int dy_stride,
+                                    const int16_t *dt, int dt_stride,
+                                    double *M, double *b) {
+  __m128d dxdx = _mm_setzero_pd();
+  __m128d dxdy = _mm_setzero_pd();
+  __m128d dydy = _mm_setzero_pd();
+  __m128d dxdt = _mm_setzero_pd();
+  __m128d dydt = _mm_setzero_pd();
+  for (int i = 0; i < DISFLOW_PATCH_SIZE; i++) {
+    const __m128i t16 = _mm_loadu_si128((const __m128i *)(dt + i * dt_stride));
+    const __m128i t32_lo = _mm_cvtepi16_epi32(t16);
+    const __m128i t32_hi = _mm_cvtepi16_epi32(_mm_srli_si128(t16, 8));
+    const __m128d t[4] = { _mm_cvtepi32_pd(t32_lo),
+                           _mm_cvtepi32_pd(_mm_srli_si128(t32_lo, 8)),
+                           _mm_cvtepi32_pd(t32_hi),
+                           _mm_cvtepi32_pd(_mm_srli_si128(t32_hi, 8)) };
+    for (int j = 0; j < 4; j++) {
+      const __m128d x = _mm_loadu_pd(dx + i * dx_stride + 2 * j);
+      const __m128d y = _mm_loadu_pd(dy + i * dy_stride + 2 * j);
+      dxdx = _mm_add_pd(dxdx, _mm_mul_pd(x, x));
+      dxdy = _mm_add_pd(dxdy, _mm_mul_pd(x, y));
+      dydy = _mm_add_pd(dydy, _mm_mul_pd(y, y));
+      dxdt = _mm_add_pd(dxdt, _mm_mul_pd(x, t[j]));
+      dydt = _mm_add_pd(dydt, _mm_mul_pd(y, t[j]));
+    }
+  }
+  // Add the two halves of each sum.
+  const __m128d m01 = _mm_hadd_pd(dxdx, dxdy);
+  const __m128d m33 = _mm_hadd_pd(dydy, dydy);
+  const __m128d b01 = _mm_hadd_pd(dxdt, dydt);
+  _mm_storeu_pd(M, _mm_add_pd(_mm_loadu_pd(M), m01));
+  M[3] += _mm_cvtsd_f64(m33);
+  _mm_storeu_pd(b, _mm_add_pd(_mm_loadu_pd(b), b01));
+  M[2] = M[1];
+}
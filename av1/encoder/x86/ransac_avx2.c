@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "av1/encoder/ransac.h"
+
+// Projects and scores 4 points per iteration. The operations are the ones of
+// av1_ransac_find_inliers_c(), in the same order, so the distances match.
+int av1_ransac_find_inliers_avx2(const double *mat, const double *points1,
+                                 const double *points2, int npoints,
+                                 int min_inliers, int *inlier_indices,
+                                 double *inlier_distances) {
+  const __m256d m0 = _mm256_set1_pd(mat[0]);
+  const __m256d m1 = _mm256_set1_pd(mat[1]);
+  const __m256d m2 = _mm256_set1_pd(mat[2]);
+  const __m256d m3 = _mm256_set1_pd(mat[3]);
+  const __m256d m4 = _mm256_set1_pd(mat[4]);
+  const __m256d m5 = _mm256_set1_pd(mat[5]);
+  const __m256d threshold = _mm256_set1_pd(RANSAC_INLIER_THRESHOLD);
+  int num_inliers = 0;
+  int i;
+  for (i = 0; i + 4 <= npoints; i += 4) {
+    if (num_inliers + npoints - i < min_inliers) return num_inliers;
+    const __m256d p01 = _mm256_loadu_pd(points1 + 2 * i);
+    const __m256d p23 = _mm256_loadu_pd(points1 + 2 * i + 4);
+    const __m256d q01 = _mm256_loadu_pd(points2 + 2 * i);
+    const __m256d q23 = _mm256_loadu_pd(points2 + 2 * i + 4);
+    // The coordinates are deinterleaved within each lane, so the vectors hold
+    // the points in the order 0, 2, 1, 3.
+    const __m256d x = _mm256_unpacklo_pd(p01, p23);
+    const __m256d y = _mm256_unpackhi_pd(p01, p23);
+    const __m256d proj_x = _mm256_add_pd(
+        _mm256_add_pd(_mm256_mul_pd(m2, x), _mm256_mul_pd(m3, y)), m0);
+    const __m256d proj_y = _mm256_add_pd(
+        _mm256_add_pd(_mm256_mul_pd(m4, x), _mm256_mul_pd(m5, y)), m1);
+    const __m256d dx = _mm256_sub_pd(proj_x, _mm256_unpacklo_pd(q01, q23));
+    const __m256d dy = _mm256_sub_pd(proj_y, _mm256_unpackhi_pd(q01, q23));
+    const __m256d dist = _mm256_permute4x64_pd(
+        _mm256_sqrt_pd(
+            _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))),
+        0xd8);
+    const int mask =
+        _mm256_movemask_pd(_mm256_cmp_pd(dist, threshold, _CMP_LT_OQ));
+    if (mask) {
+      double d[4];
+      _mm256_storeu_pd(d, dist);
+      for (int k = 0; k < 4; ++k) {
+        if (mask & (1 << k)) {
+          inlier_indices[num_inliers] = i + k;
+          inlier_distances[num_inliers++] = d[k];
+        }
+      }
+    }
+  }
+  if (i < npoints) {
+    const int num_tail_inliers = av1_ransac_find_inliers_c(
+        mat, points1 + 2 * i, points2 + 2 * i, npoints - i,
+        min_inliers - num_inliers, inlier_indices + num_inliers,
+        inlier_distances + num_inliers);
+    // The indices of the tail are relative to its first point.
+    for (int j = 0; j < num_tail_inliers; ++j) {
+      inlier_indices[num_inliers++] += i;
+    }
+  }
+  return num_inliers;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "av1/encoder/ransac.h"
+
+// Projects and scores 2 points per iteration. The operations are the ones of
+// av1_ransac_find_inliers_c(), in the same order, so the distances match.
+int av1_ransac_find_inliers_sse4_1(const double *mat, const double *points1,
+                                   const double *points2, int npoints,
+                                   int min_inliers, int *inlier_indices,
+                                   double *inlier_distances) {
+  const __m128d m0 = _mm_set1_pd(mat[0]);
+  const __m128d m1 = _mm_set1_pd(mat[1]);
+  const __m128d m2 = _mm_set1_pd(mat[2]);
+  const __m128d m3 = _mm_set1_pd(mat[3]);
+  const __m128d m4 = _mm_set1_pd(mat[4]);
+  const __m128d m5 = _mm_set1_pd(mat[5]);
+  const __m128d threshold = _mm_set1_pd(RANSAC_INLIER_THRESHOLD);
+  int num_inliers = 0;
+  int i;
+  for (i = 0; i + 2 <= npoints; i += 2) {
+    if (num_inliers + npoints - i < min_inliers) return num_inliers;
+    const __m128d p0 = _mm_loadu_pd(points1 + 2 * i);
+    const __m128d p1 = _mm_loadu_pd(points1 + 2 * i + 2);
+    const __m128d q0 = _mm_loadu_pd(points2 + 2 * i);
+    const __m128d q1 = _mm_loadu_pd(points2 + 2 * i + 2);
+    const __m128d x = _mm_unpacklo_pd(p0, p1);
+    const __m128d y = _mm_unpackhi_pd(p0, p1);
+    const __m128d proj_x =
+        _mm_add_pd(_mm_add_pd(_mm_mul_pd(m2, x), _mm_mul_pd(m3, y)), m0);
+    const __m128d proj_y =
+        _mm_add_pd(_mm_add_pd(_mm_mul_pd(m4, x), _mm_mul_pd(m5, y)), m1);
+    const __m128d dx = _mm_sub_pd(proj_x, _mm_unpacklo_pd(q0, q1));
+    const __m128d dy = _mm_sub_pd(proj_y, _mm_unpackhi_pd(q0, q1));
+    const __m128d dist =
+        _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)));
+    const int mask = _mm_movemask_pd(_mm_cmplt_pd(dist, threshold));
+    if (mask & 1) {
+      inlier_indices[num_inliers] = i;
+      _mm_storel_pd(&inlier_distances[num_inliers++], dist);
+    }
+    if (mask & 2) {
+      inlier_indices[num_inliers] = i + 1;
+      _mm_storeh_pd(&inlier_distances[num_inliers++], dist);
+    }
+  }
+  if (i < npoints) {
+    const int num_tail_inliers = av1_ransac_find_inliers_c(
+        mat, points1 + 2 * i, points2 + 2 * i, npoints - i,
+        min_inliers - num_inliers, inlier_indices + num_inliers,
+        inlier_distances + num_inliers);
+    // The indices of the tail are relative to its first point.
+    for (int j = 0; j < num_tail_inliers; ++j) {
+      inlier_indices[num_inliers++] += i;
+    }
+  }
+  return num_inliers;
+}
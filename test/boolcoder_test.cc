@@ -10,20 +10,41 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <vector>
+
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "test/acm_random.h"
 #include "aom/aom_integer.h"
 #include "aom_dsp/bitreader.h"
 #include "aom_dsp/bitwriter.h"
+#include "aom_dsp/prob.h"
+#include "aom_ports/aom_timer.h"
 
 using libaom_test::ACMRandom;
 
 namespace {
 const int num_tests = 10;
+
+// Fills cdf with a random, strictly increasing distribution of nsymbs
+// symbols followed by a random adaptation counter.
+void RandomCdf(ACMRandom *rnd, aom_cdf_prob *cdf, int nsymbs) {
+  std::vector<int> v(nsymbs);
+  v[0] = 0;
+  for (int i = 1; i < nsymbs; ++i) v[i] = v[i - 1] + 1 + rnd->Rand8();
+  const int scale = CDF_PROB_TOP - 1 - v[nsymbs - 1];
+  int acc = 0;
+  for (int i = 1; i < nsymbs; ++i) {
+    acc += rnd->Rand8() * scale / (255 * nsymbs);
+    cdf[i - 1] = AOM_ICDF(v[i] + acc);
+  }
+  cdf[nsymbs - 1] = AOM_ICDF(CDF_PROB_TOP);
+  cdf[nsymbs] = rnd->PseudoUniform(33);
+}
 }  // namespace
 
 TEST(AV1, TestBitIO) {
@@ -171,3 +192,178 @@ TEST(AV1, TestHasOverflowed) {
     ASSERT_TRUE(aom_reader_has_overflowed(&br));
   }
 }
+
+TEST(AV1, TestUpdateCdf) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int nsymbs = 2; nsymbs <= 16; ++nsymbs) {
+    for (int i = 0; i < 10000; ++i) {
+      aom_cdf_prob ref[CDF_SIZE(16)];
+      aom_cdf_prob cdf[CDF_SIZE(16)];
+      RandomCdf(&rnd, ref, nsymbs);
+      memcpy(cdf, ref, sizeof(ref));
+      const int val = rnd.PseudoUniform(nsymbs);
+      update_cdf_c(ref, val, nsymbs);
+      update_cdf(cdf, val, nsymbs);
+      for (int j = 0; j <= nsymbs; ++j) {
+        GTEST_ASSERT_EQ(cdf[j], ref[j])
+            << "nsymbs: " << nsymbs << " val: " << val << " j: " << j;
+      }
+    }
+  }
+}
+
+TEST(AV1, TestSymbolIO) {
+  const int kSymbols = 100000;
+  const int kBufferSize = kSymbols * 2;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  aom_cdf_prob enc_cdfs[17][CDF_SIZE(16)];
+  aom_cdf_prob dec_cdfs[17][CDF_SIZE(16)];
+  for (int nsymbs = 2; nsymbs <= 16; ++nsymbs) {
+    RandomCdf(&rnd, enc_cdfs[nsymbs], nsymbs);
+    memcpy(dec_cdfs[nsymbs], enc_cdfs[nsymbs], sizeof(enc_cdfs[nsymbs]));
+  }
+  std::vector<uint8_t> nsyms(kSymbols);
+  std::vector<uint8_t> symbols(kSymbols);
+  for (int i = 0; i < kSymbols; ++i) {
+    nsyms[i] = 2 + rnd.PseudoUniform(15);
+    // Skew towards symbol 0 so that the adapted CDFs become lopsided.
+    symbols[i] = rnd.Rand8() < 128 ? 0 : rnd.PseudoUniform(nsyms[i]);
+  }
+  std::vector<uint8_t> buffer(kBufferSize);
+  aom_writer bw;
+  bw.allow_update_cdf = 1;
+  aom_start_encode(&bw, &buffer[0]);
+  for (int i = 0; i < kSymbols; ++i)
+    aom_write_symbol(&bw, symbols[i], enc_cdfs[nsyms[i]], nsyms[i]);
+  GTEST_ASSERT_GE(aom_stop_encode(&bw), 0);
+
+  aom_reader br;
+  aom_reader_init(&br, &buffer[0], bw.pos);
+  br.allow_update_cdf = 1;
+  for (int i = 0; i < kSymbols; ++i) {
+    GTEST_ASSERT_EQ(aom_read_symbol(&br, dec_cdfs[nsyms[i]], nsyms[i], NULL),
+                    symbols[i])
+        << "pos: " << i << " nsymbs: " << static_cast<int>(nsyms[i]);
+  }
+  for (int nsymbs = 2; nsymbs <= 16; ++nsymbs) {
+    EXPECT_EQ(memcmp(enc_cdfs[nsymbs], dec_cdfs[nsymbs],
+                     sizeof(enc_cdfs[nsymbs])),
+              0);
+  }
+}
+
+TEST(AV1, DISABLED_BitIOSpeed) {
+  const int kSymbols = 1 << 20;
+  const int kRuns = 20;
+  // A skewed 8 symbol distribution, similar to the mode and token CDFs.
+  const aom_cdf_prob cdf[] = { AOM_CDF8(12000, 20000, 25000, 28000, 30000,
+                                        31500, 32300) };
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  std::vector<uint8_t> symbols(kSymbols);
+  for (int i = 0; i < kSymbols; ++i) {
+    const int v = rnd(CDF_PROB_TOP);
+    int symb = 0;
+    while (symb < 7 && v >= AOM_ICDF(cdf[symb])) ++symb;
+    symbols[i] = symb;
+  }
+  // At most 3 bits per symbol.
+  std::vector<uint8_t> buffer(kSymbols);
+
+  aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  aom_writer bw;
+  for (int run = 0; run < kRuns; ++run) {
+    aom_start_encode(&bw, &buffer[0]);
+    for (int i = 0; i < kSymbols; ++i) aom_write_cdf(&bw, symbols[i], cdf, 8);
+    aom_stop_encode(&bw);
+  }
+  aom_usec_timer_mark(&timer);
+  const int64_t enc_time = aom_usec_timer_elapsed(&timer);
+
+  int mismatches = 0;
+  aom_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    aom_reader br;
+    aom_reader_init(&br, &buffer[0], bw.pos);
+    for (int i = 0; i < kSymbols; ++i)
+      mismatches += aom_read_cdf(&br, cdf, 8, NULL) != symbols[i];
+  }
+  aom_usec_timer_mark(&timer);
+  const int64_t dec_time = aom_usec_timer_elapsed(&timer);
+  EXPECT_EQ(mismatches, 0);
+
+  const double total = static_cast<double>(kSymbols) * kRuns;
+  printf("%d-bit window: %u bytes, encode %.1f Msymbols/s, decode %.1f "
+         "Msymbols/s\n",
+         OD_EC_WINDOW_SIZE, bw.pos, total / enc_time, total / dec_time);
+}
+
+TEST(AV1, DISABLED_SymbolIOSpeed) {
+  const int kSymbols = 1 << 20;
+  const int kRuns = 10;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  aom_cdf_prob init_cdfs[17][CDF_SIZE(16)];
+  for (int nsymbs = 2; nsymbs <= 16; ++nsymbs)
+    RandomCdf(&rnd, init_cdfs[nsymbs], nsymbs);
+  std::vector<uint8_t> nsyms(kSymbols);
+  std::vector<uint8_t> symbols(kSymbols);
+  for (int i = 0; i < kSymbols; ++i) {
+    nsyms[i] = 3 + rnd.PseudoUniform(14);
+    symbols[i] = rnd.Rand8() < 128 ? 0 : rnd.PseudoUniform(nsyms[i]);
+  }
+
+  aom_cdf_prob cdfs[17][CDF_SIZE(16)];
+  aom_usec_timer timer;
+  int64_t update_time[2];
+  for (int simd = 0; simd < 2; ++simd) {
+    memcpy(cdfs, init_cdfs, sizeof(cdfs));
+    aom_usec_timer_start(&timer);
+    for (int run = 0; run < kRuns; ++run) {
+      for (int i = 0; i < kSymbols; ++i) {
+        if (simd)
+          update_cdf(cdfs[nsyms[i]], symbols[i], nsyms[i]);
+        else
+          update_cdf_c(cdfs[nsyms[i]], symbols[i], nsyms[i]);
+      }
+    }
+    aom_usec_timer_mark(&timer);
+    update_time[simd] = aom_usec_timer_elapsed(&timer);
+  }
+
+  std::vector<uint8_t> buffer(kSymbols * 2);
+  aom_writer bw;
+  bw.allow_update_cdf = 1;
+  aom_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    memcpy(cdfs, init_cdfs, sizeof(cdfs));
+    aom_start_encode(&bw, &buffer[0]);
+    for (int i = 0; i < kSymbols; ++i)
+      aom_write_symbol(&bw, symbols[i], cdfs[nsyms[i]], nsyms[i]);
+    aom_stop_encode(&bw);
+  }
+  aom_usec_timer_mark(&timer);
+  const int64_t enc_time = aom_usec_timer_elapsed(&timer);
+
+  int mismatches = 0;
+  aom_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    memcpy(cdfs, init_cdfs, sizeof(cdfs));
+    aom_reader br;
+    aom_reader_init(&br, &buffer[0], bw.pos);
+    br.allow_update_cdf = 1;
+    for (int i = 0; i < kSymbols; ++i) {
+      mismatches +=
+          aom_read_symbol(&br, cdfs[nsyms[i]], nsyms[i], NULL) != symbols[i];
+    }
+  }
+  aom_usec_timer_mark(&timer);
+  const int64_t dec_time = aom_usec_timer_elapsed(&timer);
+  EXPECT_EQ(mismatches, 0);
+
+  const double total = static_cast<double>(kSymbols) * kRuns;
+  printf("update_cdf_c %.1f Mupdates/s, update_cdf %.1f Mupdates/s\n",
+         total / update_time[0], total / update_time[1]);
+  printf("adaptive symbols: encode %.1f Msymbols/s, decode %.1f "
+         "Msymbols/s\n",
+         total / enc_time, total / dec_time);
+}
@@ -146,6 +146,18 @@ TEST_P(AV1DecodeMultiThreadedTest, MD5Match) {
   DoTest();
 }
 
+// Same as above, with the post-filter overlapping the tile decoding in the
+// multi-threaded decoders.
+TEST_P(AV1DecodeMultiThreadedTest, PostFilterOverlapMD5Match) {
+  cfg_.large_scale_tile = 0;
+  single_thread_dec_->Control(AV1_SET_TILE_MODE, 0);
+  for (int i = 0; i < kNumMultiThreadDecoders; ++i) {
+    multi_thread_dec_[i]->Control(AV1_SET_TILE_MODE, 0);
+    multi_thread_dec_[i]->Control(AV1D_SET_POSTFILTER_OVERLAP, 1);
+  }
+  DoTest();
+}
+
 class AV1DecodeMultiThreadedTestLarge : public AV1DecodeMultiThreadedTest {};
 
 TEST_P(AV1DecodeMultiThreadedTestLarge, MD5Match) {
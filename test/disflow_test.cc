@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config/av1_rtcd.h"
+
+#include "aom_ports/aom_timer.h"
+#include "av1/encoder/global_motion.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/util.h"
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+
+// Dimensions of the test images, and of the padding around them. The padding
+// matches the one of the disflow image pyramids.
+const int kWidth = 64;
+const int kHeight = 48;
+const int kPad = 16;
+const int kStride = kWidth + 2 * kPad;
+const int kBufSize = kStride * (kHeight + 2 * kPad);
+const int kPatchPixels = DISFLOW_PATCH_SIZE * DISFLOW_PATCH_SIZE;
+
+class DisflowTestBase {
+ public:
+  DisflowTestBase() { rnd_.Reset(ACMRandom::DeterministicSeed()); }
+
+ protected:
+  void FillRandom(uint8_t *buf) {
+    for (int i = 0; i < kBufSize; ++i) buf[i] = rnd_.Rand8();
+  }
+
+  // Random flow component in [-range, range], with 1/64 pel precision.
+  double RandomFlow(int range) {
+    return (static_cast<int>(rnd_.PseudoUniform(2 * range * 64 + 1)) -
+            range * 64) /
+           64.0;
+  }
+
+  ACMRandom rnd_;
+};
+
+typedef double (*WarpAndErrorFunc)(const uint8_t *ref, const uint8_t *frm,
+                                   int width, int height, int stride, int x,
+                                   int y, double u, double v, int16_t *dt);
+
+class AV1DisflowWarpTest : public ::testing::TestWithParam<WarpAndErrorFunc>,
+                           public DisflowTestBase {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput(int run_times);
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(AV1DisflowWarpTest);
+
+void AV1DisflowWarpTest::RunCheckOutput(int run_times) {
+  const WarpAndErrorFunc target_func = GetParam();
+  uint8_t ref_buf[kBufSize], frm_buf[kBufSize];
+  const uint8_t *const ref = ref_buf + kPad * kStride + kPad;
+  const uint8_t *const frm = frm_buf + kPad * kStride + kPad;
+  int16_t dt_c[kPatchPixels], dt_simd[kPatchPixels];
+  const int num_iters = run_times > 1 ? 16 : 10000;
+
+  for (int iter = 0; iter < num_iters; ++iter) {
+    if (iter % 100 == 0) {
+      FillRandom(ref_buf);
+      FillRandom(frm_buf);
+    }
+    // Cover patches which are warped partly outside of the image too.
+    const int x = rnd_.PseudoUniform(kWidth - DISFLOW_PATCH_SIZE + 1);
+    const int y = rnd_.PseudoUniform(kHeight - DISFLOW_PATCH_SIZE + 1);
+    const double u = RandomFlow(4);
+    const double v = RandomFlow(4);
+
+    const double mse_c = av1_compute_warp_and_error_c(
+        ref, frm, kWidth, kHeight, kStride, x, y, u, v, dt_c);
+    const double mse_simd = target_func(ref, frm, kWidth, kHeight, kStride, x,
+                                        y, u, v, dt_simd);
+
+    if (run_times > 1) {
+      aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
+      for (int i = 0; i < run_times; ++i) {
+        av1_compute_warp_and_error_c(ref, frm, kWidth, kHeight, kStride, x, y,
+                                     u, v, dt_c);
+      }
+      aom_usec_timer_mark(&timer);
+      const int elapsed_time_c =
+          static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+      aom_usec_timer_start(&timer);
+      for (int i = 0; i < run_times; ++i) {
+        target_func(ref, frm, kWidth, kHeight, kStride, x, y, u, v, dt_simd);
+      }
+      aom_usec_timer_mark(&timer);
+      const int elapsed_time_simd =
+          static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+      printf("c_time=%d \t simd_time=%d \t gain=%f\n", elapsed_time_c,
+             elapsed_time_simd,
+             static_cast<double>(elapsed_time_c) / elapsed_time_simd);
+    } else {
+      // The SIMD versions interpolate in fixed point, so each warped pixel may
+      // be off by one.
+      double max_mse_diff = 0;
+      for (int i = 0; i < kPatchPixels; ++i) {
+        ASSERT_LE(abs(dt_c[i] - dt_simd[i]), 1)
+            << "x=" << x << " y=" << y << " u=" << u << " v=" << v;
+        max_mse_diff += 2 * abs(dt_c[i]) + 1;
+      }
+      ASSERT_LE(fabs(mse_c - mse_simd), max_mse_diff / kPatchPixels);
+    }
+  }
+}
+
+TEST_P(AV1DisflowWarpTest, CheckOutput) { RunCheckOutput(1); }
+TEST_P(AV1DisflowWarpTest, DISABLED_Speed) { RunCheckOutput(100000); }
+
+typedef void (*FlowSystemFunc)(const double *dx, int dx_stride,
+                               const double *dy, int dy_stride,
+                               const int16_t *dt, int dt_stride, double *M,
+                               double *b);
+
+class AV1DisflowFlowSystemTest
+    : public ::testing::TestWithParam<FlowSystemFunc>,
+      public DisflowTestBase {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput(int run_times);
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(AV1DisflowFlowSystemTest);
+
+void AV1DisflowFlowSystemTest::RunCheckOutput(int run_times) {
+  const FlowSystemFunc target_func = GetParam();
+  const int stride = 2 * DISFLOW_PATCH_SIZE;
+  double dx[DISFLOW_PATCH_SIZE * stride], dy[DISFLOW_PATCH_SIZE * stride];
+  int16_t dt[kPatchPixels];
+  const int num_iters = run_times > 1 ? 16 : 1000;
+
+  for (int iter = 0; iter < num_iters; ++iter) {
+    // Sobel gradients of 8-bit images are in [-1020, 1020], and warp errors
+    // in [-255, 255].
+    for (int i = 0; i < DISFLOW_PATCH_SIZE * stride; ++i) {
+      dx[i] = static_cast<int>(rnd_.PseudoUniform(2041)) - 1020;
+      dy[i] = static_cast<int>(rnd_.PseudoUniform(2041)) - 1020;
+    }
+    for (int i = 0; i < kPatchPixels; ++i)
+      dt[i] = static_cast<int>(rnd_.PseudoUniform(511)) - 255;
+    // The system is accumulated over the iterations of the flow search.
+    double M_c[4] = { 0 }, b_c[2] = { 0 };
+    double M_simd[4] = { 0 }, b_simd[2] = { 0 };
+    for (int k = 0; k < 3; ++k) {
+      av1_compute_flow_system_c(dx, stride, dy, stride, dt, DISFLOW_PATCH_SIZE,
+                                M_c, b_c);
+      target_func(dx, stride, dy, stride, dt, DISFLOW_PATCH_SIZE, M_simd,
+                  b_simd);
+    }
+
+    if (run_times > 1) {
+      aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
+      for (int i = 0; i < run_times; ++i) {
+        av1_compute_flow_system_c(dx, stride, dy, stride, dt,
+                                  DISFLOW_PATCH_SIZE, M_c, b_c);
+      }
+      aom_usec_timer_mark(&timer);
+      const int elapsed_time_c =
+          static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+      aom_usec_timer_start(&timer);
+      for (int i = 0; i < run_times; ++i) {
+        target_func(dx, stride, dy, stride, dt, DISFLOW_PATCH_SIZE, M_simd,
+                    b_simd);
+      }
+      aom_usec_timer_mark(&timer);
+      const int elapsed_time_simd =
+          static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+      printf("c_time=%d \t simd_time=%d \t gain=%f\n", elapsed_time_c,
+             elapsed_time_simd,
+             static_cast<double>(elapsed_time_c) / elapsed_time_simd);
+    } else {
+      // The sums are computed exactly.
+      for (int i = 0; i < 4; ++i) ASSERT_EQ(M_c[i], M_simd[i]);
+      for (int i = 0; i < 2; ++i) ASSERT_EQ(b_c[i], b_simd[i]);
+    }
+  }
+}
+
+TEST_P(AV1DisflowFlowSystemTest, CheckOutput) { RunCheckOutput(1); }
+TEST_P(AV1DisflowFlowSystemTest, DISABLED_Speed) { RunCheckOutput(1000000); }
+
+typedef void (*SobelFunc)(const uint8_t *src, int src_stride, double *dst,
+                          int dst_stride, int w, int h, int dir, double norm);
+
+class AV1DisflowSobelTest : public ::testing::TestWithParam<SobelFunc>,
+                            public DisflowTestBase {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(AV1DisflowSobelTest);
+
+TEST_P(AV1DisflowSobelTest, CheckOutput) {
+  const SobelFunc target_func = GetParam();
+  uint8_t src_buf[kBufSize];
+  const uint8_t *const src = src_buf + kPad * kStride + kPad;
+  double dst_c[kWidth * kHeight], dst_simd[kWidth * kHeight];
+
+  for (int iter = 0; iter < 100; ++iter) {
+    FillRandom(src_buf);
+    const int dir = iter & 1;
+    // The encoder filters 8x8 blocks.
+    const int w = (iter & 2) ? 8 : kWidth;
+    const int h = (iter & 2) ? 8 : kHeight;
+    av1_convolve_2d_sobel_y_c(src, kStride, dst_c, kWidth, w, h, dir, 1.0);
+    target_func(src, kStride, dst_simd, kWidth, w, h, dir, 1.0);
+    for (int i = 0; i < h; ++i) {
+      for (int j = 0; j < w; ++j) {
+        ASSERT_EQ(dst_c[i * kWidth + j], dst_simd[i * kWidth + j])
+            << "dir=" << dir << " i=" << i << " j=" << j;
+      }
+    }
+  }
+}
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE4_1, AV1DisflowWarpTest,
+                         ::testing::Values(av1_compute_warp_and_error_sse4_1));
+INSTANTIATE_TEST_SUITE_P(SSE4_1, AV1DisflowFlowSystemTest,
+                         ::testing::Values(av1_compute_flow_system_sse4_1));
+INSTANTIATE_TEST_SUITE_P(SSE4_1, AV1DisflowSobelTest,
+                         ::testing::Values(av1_convolve_2d_sobel_y_sse4_1));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AV1DisflowWarpTest,
+                         ::testing::Values(av1_compute_warp_and_error_avx2));
+INSTANTIATE_TEST_SUITE_P(AVX2, AV1DisflowFlowSystemTest,
+                         ::testing::Values(av1_compute_flow_system_avx2));
+#endif
+
+}  // namespace
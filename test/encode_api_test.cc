@@ -9,14 +9,20 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
 
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "config/aom_config.h"
 
 #include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "aom/aom_decoder.h"
 #include "aom/aom_encoder.h"
+#include "aom_scale/yv12config.h"
 
 namespace {
 
@@ -70,4 +76,293 @@ TEST(EncodeAPI, InvalidControlId) {
   EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
 }
 
+const int kZeroCopyWidth = 128;
+const int kZeroCopyHeight = 96;
+const int kZeroCopyFrames = 10;
+
+void ReleaseInputImage(void *cb_priv, void *user_priv) {
+  std::vector<int> *released = static_cast<std::vector<int> *>(cb_priv);
+  released->push_back(static_cast<int>(reinterpret_cast<intptr_t>(user_priv)));
+}
+
+void FillZeroCopyFrame(aom_image_t *img, int frame) {
+  unsigned int seed = 12345 + frame;
+  for (unsigned int y = 0; y < img->d_h; ++y) {
+    uint8_t *row = img->planes[AOM_PLANE_Y] + y * img->stride[AOM_PLANE_Y];
+    for (unsigned int x = 0; x < img->d_w; ++x) {
+      seed = seed * 1103515245 + 12345;
+      row[x] = static_cast<uint8_t>(((x + 2 * frame) * 3 + y * 5) +
+                                    ((seed >> 16) & 15));
+    }
+  }
+  for (int plane = AOM_PLANE_U; plane <= AOM_PLANE_V; ++plane) {
+    for (unsigned int y = 0; y < (img->d_h + 1) / 2; ++y) {
+      memset(img->planes[plane] + y * img->stride[plane], 64 * plane,
+             (img->d_w + 1) / 2);
+    }
+  }
+}
+
+// Encodes kZeroCopyFrames frames, allocated with a border if border is
+// non-negative, and returns the compressed data. The indices of the released
+// frames are appended to released, and the number of frames released when each
+// call to aom_codec_encode() returns to released_count.
+std::vector<uint8_t> EncodeZeroCopy(bool zero_copy, int border,
+                                    std::vector<int> *released,
+                                    std::vector<int> *released_count) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  cfg.g_lag_in_frames = 5;
+  cfg.rc_end_usage = AOM_Q;
+  aom_codec_ctx_t enc;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED, 6));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CQ_LEVEL, 40));
+  if (zero_copy) {
+    aom_zero_copy_input_t zero_copy_input = { ReleaseInputImage, released };
+    EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AV1E_SET_ZERO_COPY_INPUT,
+                                              &zero_copy_input));
+  }
+
+  std::vector<aom_image_t> images(kZeroCopyFrames);
+  std::vector<uint8_t> data;
+  for (int i = 0; i <= kZeroCopyFrames; ++i) {
+    aom_image_t *img = NULL;
+    if (i < kZeroCopyFrames) {
+      img = border >= 0 ? aom_img_alloc_with_border(
+                              &images[i], AOM_IMG_FMT_I420, kZeroCopyWidth,
+                              kZeroCopyHeight, 32, 8, border)
+                        : aom_img_alloc(&images[i], AOM_IMG_FMT_I420,
+                                        kZeroCopyWidth, kZeroCopyHeight, 1);
+      EXPECT_NE(img, nullptr);
+      FillZeroCopyFrame(img, i);
+      img->user_priv = reinterpret_cast<void *>(static_cast<intptr_t>(i));
+    }
+    // Flush the encoder after the last frame.
+    int flushing = 1;
+    while (flushing) {
+      EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, img, i, 1, 0));
+      if (img) released_count->push_back(static_cast<int>(released->size()));
+      flushing = 0;
+      aom_codec_iter_t iter = NULL;
+      const aom_codec_cx_pkt_t *pkt;
+      while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != NULL) {
+        if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+        const uint8_t *buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+        data.insert(data.end(), buf, buf + pkt->data.frame.sz);
+        flushing = !img;
+      }
+    }
+  }
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  for (aom_image_t &img : images) aom_img_free(&img);
+  return data;
+}
+
+TEST(EncodeAPI, ZeroCopyInput) {
+  std::vector<int> released, released_count;
+  const std::vector<uint8_t> ref_data =
+      EncodeZeroCopy(false, -1, &released, &released_count);
+  EXPECT_TRUE(released.empty());
+
+  // The images have the border of the encoder frames, so they are borrowed.
+  released_count.clear();
+  const std::vector<uint8_t> data = EncodeZeroCopy(
+      true, AOM_ENC_NO_SCALE_BORDER, &released, &released_count);
+  EXPECT_EQ(ref_data, data);
+  ASSERT_EQ(static_cast<size_t>(kZeroCopyFrames), released.size());
+  std::vector<int> sorted_released = released;
+  std::sort(sorted_released.begin(), sorted_released.end());
+  for (int i = 0; i < kZeroCopyFrames; ++i) EXPECT_EQ(i, sorted_released[i]);
+  EXPECT_EQ(0, released_count[0]);
+
+  // Images without a border are copied and released right away.
+  released.clear();
+  released_count.clear();
+  const std::vector<uint8_t> copied_data =
+      EncodeZeroCopy(true, -1, &released, &released_count);
+  EXPECT_EQ(ref_data, copied_data);
+  for (int i = 0; i < kZeroCopyFrames; ++i) {
+    EXPECT_EQ(i + 1, released_count[i]);
+    EXPECT_EQ(i, released[i]);
+  }
+}
+
+// Encodes kZeroCopyFrames frames with the given limit of frame buffer memory
+// and returns the result of the first failing call to aom_codec_encode(), or
+// AOM_CODEC_OK. memory is set to the memory usage after the last frame.
+aom_codec_err_t EncodeWithFrameBufferLimit(unsigned int max_mib,
+                                           aom_frame_buffer_memory_t *memory) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  cfg.g_lag_in_frames = 5;
+  aom_codec_ctx_t enc;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED, 6));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(
+                              &enc, AV1E_SET_MAX_FRAME_BUFFER_MEMORY, max_mib));
+
+  aom_image_t img;
+  EXPECT_NE(aom_img_alloc(&img, AOM_IMG_FMT_I420, kZeroCopyWidth,
+                          kZeroCopyHeight, 1),
+            nullptr);
+  aom_codec_err_t res = AOM_CODEC_OK;
+  for (int i = 0; i < kZeroCopyFrames && res == AOM_CODEC_OK; ++i) {
+    FillZeroCopyFrame(&img, i);
+    res = aom_codec_encode(&enc, &img, i, 1, 0);
+    aom_codec_iter_t iter = NULL;
+    while (aom_codec_get_cx_data(&enc, &iter) != NULL) {
+    }
+  }
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_control(&enc, AV1E_GET_FRAME_BUFFER_MEMORY, memory));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  aom_img_free(&img);
+  return res;
+}
+
+TEST(EncodeAPI, FrameBufferMemory) {
+  aom_frame_buffer_memory_t memory;
+  ASSERT_EQ(AOM_CODEC_OK, EncodeWithFrameBufferLimit(0, &memory));
+  EXPECT_GT(memory.current_bytes, 0u);
+  EXPECT_GE(memory.peak_bytes, memory.current_bytes);
+  EXPECT_LE(memory.unused_bytes, memory.current_bytes);
+  EXPECT_GT(memory.num_allocs, 0u);
+
+  // The encoding fits in the peak memory of the unlimited one.
+  const unsigned int peak_mib =
+      static_cast<unsigned int>((memory.peak_bytes + (1 << 20) - 1) >> 20);
+  aom_frame_buffer_memory_t limited_memory;
+  ASSERT_EQ(AOM_CODEC_OK,
+            EncodeWithFrameBufferLimit(peak_mib, &limited_memory));
+  EXPECT_LE(limited_memory.peak_bytes, static_cast<uint64_t>(peak_mib) << 20);
+
+  // The lookahead frames alone do not fit in 1 MiB.
+  ASSERT_GT(peak_mib, 1u);
+  EXPECT_EQ(AOM_CODEC_MEM_ERROR, EncodeWithFrameBufferLimit(1, &memory));
+}
+
+TEST(EncodeAPI, MemoryUsage) {
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  cfg.g_lag_in_frames = 5;
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED, 6));
+  aom_codec_ctx_t dec;
+  ASSERT_EQ(AOM_CODEC_OK,
+            aom_codec_dec_init(&dec, aom_codec_av1_dx(), NULL, 0));
+
+  aom_image_t img;
+  ASSERT_NE(aom_img_alloc(&img, AOM_IMG_FMT_I420, kZeroCopyWidth,
+                          kZeroCopyHeight, 1),
+            nullptr);
+  for (int i = 0; i < kZeroCopyFrames; ++i) {
+    FillZeroCopyFrame(&img, i);
+    ASSERT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, &img, i, 1, 0));
+    aom_codec_iter_t iter = NULL;
+    const aom_codec_cx_pkt_t *pkt;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+      const uint8_t *const data =
+          static_cast<const uint8_t *>(pkt->data.frame.buf);
+      ASSERT_EQ(AOM_CODEC_OK,
+                aom_codec_decode(&dec, data, pkt->data.frame.sz, NULL));
+    }
+  }
+  aom_img_free(&img);
+
+  aom_memory_usage_t enc_usage;
+  aom_memory_usage_t dec_usage;
+  const aom_codec_err_t enc_res =
+      aom_codec_control(&enc, AV1_GET_MEMORY_USAGE, &enc_usage);
+  const aom_codec_err_t dec_res =
+      aom_codec_control(&dec, AV1_GET_MEMORY_USAGE, &dec_usage);
+#if CONFIG_MEM_TRACKING
+  ASSERT_EQ(AOM_CODEC_OK, enc_res);
+  ASSERT_EQ(AOM_CODEC_OK, dec_res);
+  for (int tag : { AOM_MEM_TAG_OTHER, AOM_MEM_TAG_FRAME_BUFFERS,
+                   AOM_MEM_TAG_LOOKAHEAD, AOM_MEM_TAG_TPL,
+                   AOM_MEM_TAG_CONTEXT_TREE }) {
+    EXPECT_GT(enc_usage.current_bytes[tag], 0u) << "tag " << tag;
+  }
+  EXPECT_GT(dec_usage.current_bytes[AOM_MEM_TAG_OTHER], 0u);
+  EXPECT_GT(dec_usage.current_bytes[AOM_MEM_TAG_FRAME_BUFFERS], 0u);
+  EXPECT_EQ(dec_usage.current_bytes[AOM_MEM_TAG_LOOKAHEAD], 0u);
+  for (int tag = 0; tag < AOM_MEM_TAGS; ++tag) {
+    EXPECT_GE(enc_usage.peak_bytes[tag], enc_usage.current_bytes[tag]);
+    EXPECT_GE(dec_usage.peak_bytes[tag], dec_usage.current_bytes[tag]);
+  }
+#else
+  EXPECT_EQ(AOM_CODEC_INCAPABLE, enc_res);
+  EXPECT_EQ(AOM_CODEC_INCAPABLE, dec_res);
+#endif
+  EXPECT_EQ(AOM_CODEC_INVALID_PARAM,
+            aom_codec_control(&enc, AV1_GET_MEMORY_USAGE, NULL));
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&dec));
+}
+
+#if CONFIG_MEM_TRACKING
+// Encodes a few 320x240 frames and returns the sum over all subsystems of the
+// peak number of bytes allocated by the encoder instance.
+uint64_t EncodeAndGetPeakMemory(unsigned int usage, int speed) {
+  const int kWidth = 320;
+  const int kHeight = 240;
+  aom_codec_iface_t *iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, usage));
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  cfg.g_lag_in_frames = 0;
+  cfg.rc_end_usage = AOM_CBR;
+  cfg.rc_target_bitrate = 300;
+  aom_codec_ctx_t enc;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED, speed));
+
+  aom_image_t img;
+  EXPECT_NE(aom_img_alloc(&img, AOM_IMG_FMT_I420, kWidth, kHeight, 1),
+            nullptr);
+  for (int i = 0; i < kZeroCopyFrames; ++i) {
+    FillZeroCopyFrame(&img, i);
+    EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, &img, i, 1, 0));
+    aom_codec_iter_t iter = NULL;
+    while (aom_codec_get_cx_data(&enc, &iter) != NULL) {
+    }
+  }
+  aom_img_free(&img);
+
+  aom_memory_usage_t usage_stats;
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_control(&enc, AV1_GET_MEMORY_USAGE, &usage_stats));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  uint64_t peak = 0;
+  for (int tag = 0; tag < AOM_MEM_TAGS; ++tag) {
+    peak += usage_stats.peak_bytes[tag];
+  }
+  return peak;
+}
+
+// Realtime instances without lag that use the non-RD mode search should only
+// allocate what that configuration needs, so that many low resolution streams
+// can be encoded concurrently.
+TEST(EncodeAPI, LowMemoryRealtime) {
+  const uint64_t rt_peak = EncodeAndGetPeakMemory(AOM_USAGE_REALTIME, 8);
+  const uint64_t good_peak = EncodeAndGetPeakMemory(AOM_USAGE_GOOD_QUALITY, 6);
+  EXPECT_LT(rt_peak, 18u << 20);
+  EXPECT_LT(rt_peak, good_peak);
+}
+#endif  // CONFIG_MEM_TRACKING
+
 }  // namespace
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2020, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+#include "test/acm_random.h"
+#include "test/function_equivalence_test.h"
+#include "test/register_state_check.h"
+
+#include "config/aom_config.h"
+#include "config/aom_dsp_rtcd.h"
+
+#include "aom/aom_image.h"
+#include "aom_dsp/grain_synthesis.h"
+#include "aom_util/aom_thread.h"
+#include "av1/encoder/grain_test_vectors.h"
+
+using libaom_test::ACMRandom;
+using libaom_test::FunctionEquivalenceTest;
+
+namespace {
+
+const int kIterations = 10000;
+const int kMaxWidth = 32;
+
+//////////////////////////////////////////////////////////////////////////////
+// Noise application to a row of samples
+//////////////////////////////////////////////////////////////////////////////
+
+typedef void (*AddNoiseRowFunc)(uint8_t *dst, const int *scale,
+                                const int *grain, int width,
+                                int scaling_shift, int min_val, int max_val);
+typedef libaom_test::FuncParam<AddNoiseRowFunc> AddNoiseRowParam;
+
+class AddNoiseRowTest : public FunctionEquivalenceTest<AddNoiseRowFunc> {};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(AddNoiseRowTest);
+
+TEST_P(AddNoiseRowTest, RandomValues) {
+  uint8_t dst_ref[kMaxWidth];
+  uint8_t dst_tst[kMaxWidth];
+  int scale[kMaxWidth];
+  int grain[kMaxWidth];
+
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    const int width = 1 + rng_(kMaxWidth);
+    const int scaling_shift = 8 + rng_(4);
+    const int restricted = rng_(2);
+    const int min_val = restricted ? 16 : 0;
+    const int max_val = restricted ? 235 : 255;
+    for (int j = 0; j < kMaxWidth; ++j) {
+      dst_ref[j] = dst_tst[j] = rng_.Rand8();
+      scale[j] = rng_.Rand8();
+      grain[j] = static_cast<int>(rng_(256)) - 128;
+    }
+
+    params_.ref_func(dst_ref, scale, grain, width, scaling_shift, min_val,
+                     max_val);
+    ASM_REGISTER_STATE_CHECK(params_.tst_func(dst_tst, scale, grain, width,
+                                              scaling_shift, min_val,
+                                              max_val));
+    for (int j = 0; j < kMaxWidth; ++j) ASSERT_EQ(dst_ref[j], dst_tst[j]);
+  }
+}
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE4_1, AddNoiseRowTest,
+                         ::testing::Values(AddNoiseRowParam(
+                             aom_film_grain_add_noise_row_c,
+                             aom_film_grain_add_noise_row_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AddNoiseRowTest,
+                         ::testing::Values(AddNoiseRowParam(
+                             aom_film_grain_add_noise_row_c,
+                             aom_film_grain_add_noise_row_avx2)));
+#endif  // HAVE_AVX2
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, AddNoiseRowTest,
+                         ::testing::Values(AddNoiseRowParam(
+                             aom_film_grain_add_noise_row_c,
+                             aom_film_grain_add_noise_row_neon)));
+#endif  // HAVE_NEON
+
+typedef void (*HighbdAddNoiseRowFunc)(uint16_t *dst, const int *scale,
+                                      const int *grain, int width,
+                                      int scaling_shift, int min_val,
+                                      int max_val);
+typedef libaom_test::FuncParam<HighbdAddNoiseRowFunc> HighbdAddNoiseRowParam;
+
+class HighbdAddNoiseRowTest
+    : public FunctionEquivalenceTest<HighbdAddNoiseRowFunc> {};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(HighbdAddNoiseRowTest);
+
+TEST_P(HighbdAddNoiseRowTest, RandomValues) {
+  const int bd = params_.bit_depth;
+  uint16_t dst_ref[kMaxWidth];
+  uint16_t dst_tst[kMaxWidth];
+  int scale[kMaxWidth];
+  int grain[kMaxWidth];
+
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    const int width = 1 + rng_(kMaxWidth);
+    const int scaling_shift = 8 + rng_(4);
+    const int restricted = rng_(2);
+    const int min_val = restricted ? 16 << (bd - 8) : 0;
+    const int max_val = restricted ? 235 << (bd - 8) : (1 << bd) - 1;
+    const int grain_center = 128 << (bd - 8);
+    for (int j = 0; j < kMaxWidth; ++j) {
+      dst_ref[j] = dst_tst[j] = rng_(1 << bd);
+      scale[j] = rng_.Rand8();
+      grain[j] = static_cast<int>(rng_(2 * grain_center)) - grain_center;
+    }
+
+    params_.ref_func(dst_ref, scale, grain, width, scaling_shift, min_val,
+                     max_val);
+    ASM_REGISTER_STATE_CHECK(params_.tst_func(dst_tst, scale, grain, width,
+                                              scaling_shift, min_val,
+                                              max_val));
+    for (int j = 0; j < kMaxWidth; ++j) ASSERT_EQ(dst_ref[j], dst_tst[j]);
+  }
+}
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(
+    SSE4_1, HighbdAddNoiseRowTest,
+    ::testing::Values(
+        HighbdAddNoiseRowParam(aom_highbd_film_grain_add_noise_row_c,
+                               aom_highbd_film_grain_add_noise_row_sse4_1, 10),
+        HighbdAddNoiseRowParam(aom_highbd_film_grain_add_noise_row_c,
+                               aom_highbd_film_grain_add_noise_row_sse4_1,
+                               12)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(
+    AVX2, HighbdAddNoiseRowTest,
+    ::testing::Values(
+        HighbdAddNoiseRowParam(aom_highbd_film_grain_add_noise_row_c,
+                               aom_highbd_film_grain_add_noise_row_avx2, 10),
+        HighbdAddNoiseRowParam(aom_highbd_film_grain_add_noise_row_c,
+                               aom_highbd_film_grain_add_noise_row_avx2, 12)));
+#endif  // HAVE_AVX2
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(
+    NEON, HighbdAddNoiseRowTest,
+    ::testing::Values(
+        HighbdAddNoiseRowParam(aom_highbd_film_grain_add_noise_row_c,
+                               aom_highbd_film_grain_add_noise_row_neon, 10),
+        HighbdAddNoiseRowParam(aom_highbd_film_grain_add_noise_row_c,
+                               aom_highbd_film_grain_add_noise_row_neon, 12)));
+#endif  // HAVE_NEON
+
+//////////////////////////////////////////////////////////////////////////////
+// Blending of the grain of overlapping blocks
+//////////////////////////////////////////////////////////////////////////////
+
+typedef void (*BlendRowFunc)(const int *a, const int *b, int *dst, int width,
+                             int weight_a, int weight_b, int min_val,
+                             int max_val);
+typedef libaom_test::FuncParam<BlendRowFunc> BlendRowParam;
+
+class BlendRowTest : public FunctionEquivalenceTest<BlendRowFunc> {};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(BlendRowTest);
+
+TEST_P(BlendRowTest, RandomValues) {
+  static const int kWeights[3][2] = { { 23, 22 }, { 27, 17 }, { 17, 27 } };
+  int a[kMaxWidth];
+  int b[kMaxWidth];
+  int dst_ref[kMaxWidth];
+  int dst_tst[kMaxWidth];
+
+  for (int iter = 0; iter < kIterations && !HasFatalFailure(); ++iter) {
+    const int bd = 8 + 2 * rng_(3);
+    const int grain_center = 128 << (bd - 8);
+    const int width = 1 + rng_(kMaxWidth);
+    const int *weights = kWeights[rng_(3)];
+    for (int j = 0; j < kMaxWidth; ++j) {
+      a[j] = static_cast<int>(rng_(2 * grain_center)) - grain_center;
+      b[j] = static_cast<int>(rng_(2 * grain_center)) - grain_center;
+      dst_ref[j] = dst_tst[j] = rng_.Rand16();
+    }
+
+    params_.ref_func(a, b, dst_ref, width, weights[0], weights[1],
+                     -grain_center, grain_center - 1);
+    ASM_REGISTER_STATE_CHECK(params_.tst_func(a, b, dst_tst, width,
+                                              weights[0], weights[1],
+                                              -grain_center,
+                                              grain_center - 1));
+    for (int j = 0; j < kMaxWidth; ++j) ASSERT_EQ(dst_ref[j], dst_tst[j]);
+  }
+}
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE4_1, BlendRowTest,
+                         ::testing::Values(BlendRowParam(
+                             aom_film_grain_blend_row_c,
+                             aom_film_grain_blend_row_sse4_1)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, BlendRowTest,
+                         ::testing::Values(BlendRowParam(
+                             aom_film_grain_blend_row_c,
+                             aom_film_grain_blend_row_avx2)));
+#endif  // HAVE_AVX2
+
+#if HAVE_NEON
+INSTANTIATE_TEST_SUITE_P(NEON, BlendRowTest,
+                         ::testing::Values(BlendRowParam(
+                             aom_film_grain_blend_row_c,
+                             aom_film_grain_blend_row_neon)));
+#endif  // HAVE_NEON
+
+//////////////////////////////////////////////////////////////////////////////
+// Multi-threaded film grain synthesis
+//////////////////////////////////////////////////////////////////////////////
+
+const int kNumWorkers = 4;
+
+// Params: image format, bit depth, width, height.
+class AddFilmGrainMTTest
+    : public ::testing::TestWithParam<
+          ::testing::tuple<aom_img_fmt_t, int, int, int> > {
+ protected:
+  virtual void SetUp() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) {
+      winterface->init(&workers_[i]);
+      // The last worker runs on the calling thread.
+      if (i < kNumWorkers - 1) ASSERT_TRUE(winterface->reset(&workers_[i]));
+    }
+  }
+
+  virtual void TearDown() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kNumWorkers; ++i) winterface->end(&workers_[i]);
+    libaom_test::ClearSystemState();
+  }
+
+  AVxWorker workers_[kNumWorkers];
+};
+
+TEST_P(AddFilmGrainMTTest, MatchesSingleThread) {
+  const aom_img_fmt_t fmt = ::testing::get<0>(GetParam());
+  const int bit_depth = ::testing::get<1>(GetParam());
+  const unsigned int w = ::testing::get<2>(GetParam());
+  const unsigned int h = ::testing::get<3>(GetParam());
+  const int sample_size = (fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 2 : 1;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  aom_image_t src;
+  ASSERT_NE(aom_img_alloc(&src, fmt, w, h, 32), nullptr);
+  src.bit_depth = bit_depth;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int plane_h =
+        plane ? (h + src.y_chroma_shift) >> src.y_chroma_shift : h;
+    for (int i = 0; i < plane_h; ++i) {
+      uint8_t *row = src.planes[plane] + i * src.stride[plane];
+      for (int j = 0; j < src.stride[plane] / sample_size; ++j) {
+        if (sample_size == 2)
+          reinterpret_cast<uint16_t *>(row)[j] = rnd(1 << bit_depth);
+        else
+          row[j] = rnd.Rand8();
+      }
+    }
+  }
+
+  const int w_even = (w + 1) & ~1;
+  const int h_even = (h + 1) & ~1;
+  for (int t = 0; t < 16; ++t) {
+    aom_film_grain_t params = film_grain_test_vectors[t];
+    params.bit_depth = bit_depth;
+    params.random_seed = rnd.Rand16();
+
+    aom_image_t ref;
+    aom_image_t tst;
+    ASSERT_NE(aom_img_alloc(&ref, fmt, w_even, h_even, 32), nullptr);
+    ASSERT_NE(aom_img_alloc(&tst, fmt, w_even, h_even, 32), nullptr);
+    ASSERT_EQ(av1_add_film_grain(&params, &src, &ref), 0);
+    for (int num_workers = 1; num_workers <= kNumWorkers; ++num_workers) {
+      ASSERT_EQ(av1_add_film_grain_mt(&params, &src, &tst, workers_,
+                                      num_workers),
+                0);
+      for (int plane = 0; plane < 3; ++plane) {
+        const int plane_w =
+            plane ? (w_even >> ref.x_chroma_shift) : w_even;
+        const int plane_h =
+            plane ? (h_even >> ref.y_chroma_shift) : h_even;
+        for (int i = 0; i < plane_h; ++i) {
+          ASSERT_EQ(memcmp(ref.planes[plane] + i * ref.stride[plane],
+                           tst.planes[plane] + i * tst.stride[plane],
+                           plane_w * sample_size),
+                    0)
+              << "vector " << t << " workers " << num_workers << " plane "
+              << plane << " row " << i;
+        }
+      }
+    }
+    aom_img_free(&ref);
+    aom_img_free(&tst);
+  }
+  aom_img_free(&src);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    C, AddFilmGrainMTTest,
+    ::testing::Values(::testing::make_tuple(AOM_IMG_FMT_I420, 8, 352, 288),
+                      ::testing::make_tuple(AOM_IMG_FMT_I420, 8, 181, 97),
+                      ::testing::make_tuple(AOM_IMG_FMT_I444, 8, 100, 130),
+                      ::testing::make_tuple(AOM_IMG_FMT_I422, 8, 64, 200),
+                      ::testing::make_tuple(AOM_IMG_FMT_I42016, 10, 352, 288),
+                      ::testing::make_tuple(AOM_IMG_FMT_I42016, 12, 181,
+                                            97)));
+
+}  // namespace
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+
+#include "config/av1_rtcd.h"
+
+#include "aom_ports/aom_timer.h"
+#include "av1/encoder/ransac.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/util.h"
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+
+const int kMaxPoints = 512;
+
+typedef int (*FindInliersFunc)(const double *mat, const double *points1,
+                               const double *points2, int npoints,
+                               int min_inliers, int *inlier_indices,
+                               double *inlier_distances);
+
+class AV1RansacFindInliersTest
+    : public ::testing::TestWithParam<FindInliersFunc> {
+ public:
+  virtual void SetUp() { rnd_.Reset(ACMRandom::DeterministicSeed()); }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput(int run_times);
+
+  // Random value in [-range, range], with 1/256 precision.
+  double RandomValue(int range) {
+    return (static_cast<int>(rnd_.PseudoUniform(2 * range * 256 + 1)) -
+            range * 256) /
+           256.0;
+  }
+
+  ACMRandom rnd_;
+};
+GTEST_ALLOW_UNINSTANTIATED_PARAMETERIZED_TEST(AV1RansacFindInliersTest);
+
+void AV1RansacFindInliersTest::RunCheckOutput(int run_times) {
+  const FindInliersFunc target_func = GetParam();
+  double points1[2 * kMaxPoints], points2[2 * kMaxPoints];
+  int indices_c[kMaxPoints], indices_simd[kMaxPoints];
+  double distances_c[kMaxPoints], distances_simd[kMaxPoints];
+  const int num_iters = run_times > 1 ? 16 : 1000;
+
+  for (int iter = 0; iter < num_iters; ++iter) {
+    const int npoints = run_times > 1 ? kMaxPoints
+                                      : 1 + rnd_.PseudoUniform(kMaxPoints);
+    // A motion close to the identity, and matches of which about half are
+    // inliers.
+    const double mat[6] = { RandomValue(8),        RandomValue(8),
+                            1 + RandomValue(1) / 8, RandomValue(1) / 8,
+                            RandomValue(1) / 8,     1 + RandomValue(1) / 8 };
+    for (int i = 0; i < npoints; ++i) {
+      const double x = rnd_.PseudoUniform(640);
+      const double y = rnd_.PseudoUniform(480);
+      const int error_range = rnd_.Rand8() & 1 ? 1 : 4;
+      points1[2 * i] = x;
+      points1[2 * i + 1] = y;
+      points2[2 * i] =
+          mat[2] * x + mat[3] * y + mat[0] + RandomValue(error_range);
+      points2[2 * i + 1] =
+          mat[4] * x + mat[5] * y + mat[1] + RandomValue(error_range);
+    }
+    const int min_inliers = rnd_.PseudoUniform(npoints + 1);
+
+    const int num_inliers_c = av1_ransac_find_inliers_c(
+        mat, points1, points2, npoints, min_inliers, indices_c, distances_c);
+    const int num_inliers_simd =
+        target_func(mat, points1, points2, npoints, min_inliers, indices_simd,
+                    distances_simd);
+
+    if (run_times > 1) {
+      aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
+      for (int i = 0; i < run_times; ++i) {
+        av1_ransac_find_inliers_c(mat, points1, points2, npoints, 0, indices_c,
+                                  distances_c);
+      }
+      aom_usec_timer_mark(&timer);
+      const int elapsed_time_c =
+          static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+      aom_usec_timer_start(&timer);
+      for (int i = 0; i < run_times; ++i) {
+        target_func(mat, points1, points2, npoints, 0, indices_simd,
+                    distances_simd);
+      }
+      aom_usec_timer_mark(&timer);
+      const int elapsed_time_simd =
+          static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+      printf("c_time=%d \t simd_time=%d \t gain=%f\n", elapsed_time_c,
+             elapsed_time_simd,
+             static_cast<double>(elapsed_time_c) / elapsed_time_simd);
+    } else if (num_inliers_c < min_inliers) {
+      // The search may stop at different points once there cannot be enough
+      // inliers.
+      ASSERT_LT(num_inliers_simd, min_inliers);
+    } else {
+      ASSERT_EQ(num_inliers_c, num_inliers_simd);
+      for (int i = 0; i < num_inliers_c; ++i) {
+        ASSERT_EQ(indices_c[i], indices_simd[i]) << "i=" << i;
+        ASSERT_EQ(distances_c[i], distances_simd[i]) << "i=" << i;
+      }
+    }
+  }
+}
+
+TEST_P(AV1RansacFindInliersTest, CheckOutput) { RunCheckOutput(1); }
+TEST_P(AV1RansacFindInliersTest, DISABLED_Speed) { RunCheckOutput(100000); }
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_SUITE_P(SSE4_1, AV1RansacFindInliersTest,
+                         ::testing::Values(av1_ransac_find_inliers_sse4_1));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_SUITE_P(AVX2, AV1RansacFindInliersTest,
+                         ::testing::Values(av1_ransac_find_inliers_avx2));
+#endif
+
+}  // namespace
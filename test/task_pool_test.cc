@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <vector>
+
+#include "aom_util/aom_task_pool.h"
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+namespace {
+
+struct TaskData {
+  AVxTaskPool *pool;
+  int value;
+  int result;
+  int num_subtasks;
+  std::vector<TaskData> *subtasks;
+};
+
+// Squares the value of the task, and fails for negative values.
+int SquareHook(void *arg1, void *arg2) {
+  (void)arg2;
+  TaskData *const data = static_cast<TaskData *>(arg1);
+  data->result = data->value * data->value;
+  return data->value >= 0;
+}
+
+// Submits the subtasks of the task from within the task.
+int SubmitHook(void *arg1, void *arg2) {
+  (void)arg2;
+  TaskData *const data = static_cast<TaskData *>(arg1);
+  for (int i = 0; i < data->num_subtasks; ++i) {
+    if (!aom_task_pool_submit(data->pool, SquareHook, &(*data->subtasks)[i],
+                              NULL))
+      return 0;
+  }
+  return 1;
+}
+
+class TaskPoolTest : public ::testing::TestWithParam<int> {
+ protected:
+  void SetUp() override {
+    pool_ = aom_task_pool_create(GetParam(), "aom test pool");
+    ASSERT_NE(pool_, nullptr);
+  }
+
+  void TearDown() override { aom_task_pool_destroy(pool_); }
+
+  AVxTaskPool *pool_;
+};
+
+TEST_P(TaskPoolTest, RunsAllTasks) {
+  // Several batches, each with more tasks than the initial deque capacity.
+  for (int batch = 0; batch < 5; ++batch) {
+    std::vector<TaskData> tasks(100 + 37 * batch);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      tasks[i].value = static_cast<int>(i) + batch;
+      ASSERT_TRUE(aom_task_pool_submit(pool_, SquareHook, &tasks[i], NULL));
+    }
+    EXPECT_TRUE(aom_task_pool_wait(pool_));
+    for (const TaskData &task : tasks)
+      EXPECT_EQ(task.result, task.value * task.value);
+  }
+}
+
+TEST_P(TaskPoolTest, WaitWithoutTasks) {
+  EXPECT_TRUE(aom_task_pool_wait(pool_));
+}
+
+TEST_P(TaskPoolTest, ReportsErrors) {
+  std::vector<TaskData> tasks(20);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    tasks[i].value = (i == 7) ? -1 : static_cast<int>(i);
+    ASSERT_TRUE(aom_task_pool_submit(pool_, SquareHook, &tasks[i], NULL));
+  }
+  EXPECT_FALSE(aom_task_pool_wait(pool_));
+  // All tasks still ran, and the error does not carry over to the next batch.
+  for (const TaskData &task : tasks)
+    EXPECT_EQ(task.result, task.value * task.value);
+  ASSERT_TRUE(aom_task_pool_submit(pool_, SquareHook, &tasks[0], NULL));
+  EXPECT_TRUE(aom_task_pool_wait(pool_));
+}
+
+TEST_P(TaskPoolTest, TasksSubmitTasks) {
+  std::vector<TaskData> parents(8);
+  std::vector<std::vector<TaskData> > children(parents.size());
+  for (size_t i = 0; i < parents.size(); ++i) {
+    children[i].resize(10 * (i + 1));
+    for (size_t j = 0; j < children[i].size(); ++j)
+      children[i][j].value = static_cast<int>(i * j);
+    parents[i].pool = pool_;
+    parents[i].num_subtasks = static_cast<int>(children[i].size());
+    parents[i].subtasks = &children[i];
+    ASSERT_TRUE(aom_task_pool_submit(pool_, SubmitHook, &parents[i], NULL));
+  }
+  EXPECT_TRUE(aom_task_pool_wait(pool_));
+  for (const std::vector<TaskData> &tasks : children) {
+    for (const TaskData &task : tasks)
+      EXPECT_EQ(task.result, task.value * task.value);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(TaskPool, TaskPoolTest, ::testing::Values(1, 2, 4, 8));
+
+}  // namespace